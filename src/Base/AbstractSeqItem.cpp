@@ -37,6 +37,15 @@ AbstractSeqItem::~AbstractSeqItem()
 }
 
 
+size_t AbstractSeqItem::estimateMemoryUsage() const
+{
+    if(auto seq = const_cast<AbstractSeqItem*>(this)->abstractSeq()){
+        return seq->estimateMemoryUsage();
+    }
+    return 0;
+}
+
+
 void AbstractSeqItem::doPutProperties(PutPropertyFunction& putProperty)
 {
     auto seq = abstractSeq();
@@ -23,6 +23,8 @@ public:
 
     virtual std::shared_ptr<AbstractSeq> abstractSeq() = 0;
 
+    virtual size_t estimateMemoryUsage() const override;
+
 protected:
     virtual void doPutProperties(PutPropertyFunction& putProperty) override;
     virtual bool store(Archive& archive) override;
@@ -71,6 +71,7 @@
 #include <cnoid/ExecutablePath>
 #include <cnoid/UTF8>
 #include <cnoid/Format>
+#include <cnoid/Tracer>
 #include <Eigen/Core>
 #include <QApplication>
 #include <QTranslator>
@@ -110,6 +111,7 @@ bool ctrl_c_pressed = false;
 bool exitRequested = false;
 vector<string> additionalPathVariables;
 vector<string> pluginDirsAsPrefix;
+string traceFile;
 
 void onCtrl_C_Input(int)
 {
@@ -375,6 +377,11 @@ void App::Impl::initialize()
     optionManager->add_option(
         "--add-plugin-dir-as-prefix", pluginDirsAsPrefix,
         "Add a plugin directory as an install path prefix");
+
+    optionManager->add_option(
+        "--trace", traceFile,
+        "Record the timeline of the simulation and rendering threads and write it to a JSON file "
+        "of the Chrome trace event format when the application exits");
     
     mainWindow = MainWindow::initialize(appName, ext);
 
@@ -526,6 +533,10 @@ int App::Impl::exec()
         if(isNoWindowMode){
             enableMessageViewRedirectToStdOut();
         }
+        if(!traceFile.empty()){
+            Tracer::setCurrentThreadName("Main");
+            Tracer::setEnabled(true);
+        }
         if(!additionalPathVariables.empty()){
             auto fpvp = FilePathVariableProcessor::systemInstance();
             std::regex re("^([a-zA-Z][a-zA-Z_0-9]*)=([^;-?[\\]^'{-~]+)$");
@@ -591,6 +602,21 @@ int App::Impl::exec()
     delete mainWindow;
     mainWindow = nullptr;
 
+    if(Tracer::isEnabled()){
+        // All the threads recording the events have finished here
+        Tracer::setEnabled(false);
+        string error;
+        if(Tracer::writeJsonFile(traceFile, error)){
+            cout << formatR(_("The trace has been written to \"{0}\"."), traceFile) << endl;
+        } else {
+            cerr << formatR(_("The trace cannot be written: {0}"), error) << endl;
+        }
+        if(Tracer::numDroppedEvents() > 0){
+            cerr << formatR(_("{0} trace events were dropped because the buffers were full."),
+                            Tracer::numDroppedEvents()) << endl;
+        }
+    }
+
     // Note that the application must be terminated without deleting
     // the base extension manager pointed by the 'ext' variable
     // to avoid crashes due to destructors accessing invalid objects.
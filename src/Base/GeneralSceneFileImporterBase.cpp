@@ -9,6 +9,16 @@
 using namespace std;
 using namespace cnoid;
 
+namespace {
+
+struct PreloadedScene : public Referenced
+{
+    SgNodePtr scene;
+    std::shared_ptr<AbstractSceneLoader> actualSceneLoader;
+};
+
+}
+
 namespace cnoid {
 
 //! \todo Share the instance of the following impl class
@@ -19,6 +29,7 @@ public:
     static int sharedImplCounter;
     
     unique_ptr<SceneLoader> sceneLoader;
+    std::shared_ptr<AbstractSceneLoader> preloadedSceneLoader;
     GeneralSceneFileLoadDialog::OptionSet optionSet;
 
     SgNode* loadScene(GeneralSceneFileImporterBase* self, const std::string& filename);
@@ -72,6 +83,12 @@ SgNode* GeneralSceneFileImporterBase::loadScene(const std::string& filename)
 
 SgNode* GeneralSceneFileImporterBase::Impl::loadScene(GeneralSceneFileImporterBase* self, const std::string& filename)
 {
+    preloadedSceneLoader.reset();
+    if(auto preloaded = dynamic_cast<PreloadedScene*>(self->preloadedObject())){
+        preloadedSceneLoader = preloaded->actualSceneLoader;
+        return preloaded->scene.retn();
+    }
+    
     if(!sceneLoader){
         sceneLoader.reset(new SceneLoader);
         sceneLoader->setMessageSink(self->os());
@@ -97,10 +114,41 @@ SgNode* GeneralSceneFileImporterBase::Impl::loadScene(GeneralSceneFileImporterBa
 
 std::shared_ptr<AbstractSceneLoader> GeneralSceneFileImporterBase::sceneLoaderOnLastLoading()
 {
+    if(impl->preloadedSceneLoader){
+        return impl->preloadedSceneLoader;
+    }
     return impl->sceneLoader->actualSceneLoaderOnLastLoading();
 }
 
 
+std::function<ReferencedPtr(std::ostream& os)> GeneralSceneFileImporterBase::getPreloadingFunction
+(const std::string& filename, const Mapping* options)
+{
+    GeneralSceneFileLoadDialog::OptionSet optionSet;
+    if(options){
+        optionSet.restoreOptions(options);
+    }
+    auto lengthUnitHint = optionSet.lengthUnitHint();
+    auto upperAxisHint = optionSet.upperAxisHint();
+
+    return [filename, lengthUnitHint, upperAxisHint](std::ostream& os) -> ReferencedPtr {
+        SceneLoader loader;
+        loader.setMessageSink(os);
+        loader.setLengthUnitHint(lengthUnitHint);
+        loader.setUpperAxisHint(upperAxisHint);
+        bool isSupported;
+        SgNodePtr scene = loader.load(filename, isSupported);
+        if(!scene){
+            return nullptr;
+        }
+        auto preloaded = new PreloadedScene;
+        preloaded->scene = scene;
+        preloaded->actualSceneLoader = loader.actualSceneLoaderOnLastLoading();
+        return preloaded;
+    };
+}
+
+
 bool GeneralSceneFileImporterBase::saveScene(SgNode* /* scene */, const std::string& /* filename */)
 {
     return false;
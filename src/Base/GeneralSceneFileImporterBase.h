@@ -31,6 +31,8 @@ protected:
     virtual void storeOptions(Mapping* archive) override;
     virtual bool restoreOptions(const Mapping* archive) override;
     virtual QWidget* getOptionPanelForLoading() override;
+    virtual std::function<ReferencedPtr(std::ostream& os)> getPreloadingFunction(
+        const std::string& filename, const Mapping* options) override;
 
 private:
     class Impl;
@@ -44,6 +44,139 @@ struct EditHistory
 typedef std::shared_ptr<EditHistory> EditHistoryPtr;
 typedef deque<EditHistoryPtr> EditHistoryList;
 
+/**
+   The pyramid of the minimum and maximum values of the frame blocks. A long sequence is rendered
+   with the blocks of the level matching the pixel width so that the rendering cost does not depend
+   on the number of the visible frames. The pyramid is updated only in the invalidated frame range.
+*/
+class MinMaxPyramid
+{
+public:
+    struct Block
+    {
+        double min;
+        double max;
+        int minFrame;
+        int maxFrame;
+    };
+
+    static constexpr int BaseBlockSize = 8;
+
+    MinMaxPyramid()
+    {
+        numFrames = 0;
+        invalidate();
+    }
+
+    void invalidate()
+    {
+        dirtyBegin = 0;
+        dirtyEnd = std::numeric_limits<int>::max();
+    }
+
+    void invalidate(int frameBegin, int frameEnd)
+    {
+        dirtyBegin = std::min(dirtyBegin, std::max(frameBegin, 0));
+        dirtyEnd = std::max(dirtyEnd, frameEnd);
+    }
+
+    //! \return The level of the largest blocks which do not exceed the frames, or -1 if there is no such level
+    int findLevel(int numFramesPerBucket) const
+    {
+        int level = -1;
+        int size = BaseBlockSize;
+        while(size <= numFramesPerBucket && level + 1 < static_cast<int>(levels.size())){
+            ++level;
+            size *= 2;
+        }
+        return level;
+    }
+
+    int blockSize(int level) const { return BaseBlockSize << level; }
+    const Block& block(int level, int index) const { return levels[level][index]; }
+
+    static void merge(Block& block, const Block& another)
+    {
+        if(another.min < block.min){
+            block.min = another.min;
+            block.minFrame = another.minFrame;
+        }
+        if(another.max > block.max){
+            block.max = another.max;
+            block.maxFrame = another.maxFrame;
+        }
+    }
+
+    template<class ValueFunction>
+    void update(int numFrames, ValueFunction value)
+    {
+        if(numFrames != this->numFrames){
+            this->numFrames = numFrames;
+            levels.clear();
+            int numBlocks = (numFrames + BaseBlockSize - 1) / BaseBlockSize;
+            while(true){
+                levels.emplace_back(numBlocks);
+                if(numBlocks <= 1){
+                    break;
+                }
+                numBlocks = (numBlocks + 1) / 2;
+            }
+            invalidate();
+        }
+        const int frameEnd = std::min(dirtyEnd, numFrames);
+        if(dirtyBegin >= frameEnd){
+            dirtyBegin = std::numeric_limits<int>::max();
+            dirtyEnd = 0;
+            return;
+        }
+
+        int indexBegin = dirtyBegin / BaseBlockSize;
+        int indexEnd = (frameEnd - 1) / BaseBlockSize + 1;
+        auto& baseLevel = levels.front();
+        for(int i = indexBegin; i < indexEnd; ++i){
+            auto& block = baseLevel[i];
+            int frame = i * BaseBlockSize;
+            const int blockEnd = std::min(frame + BaseBlockSize, numFrames);
+            block.min = block.max = value(frame);
+            block.minFrame = block.maxFrame = frame;
+            while(++frame < blockEnd){
+                const double v = value(frame);
+                if(v < block.min){
+                    block.min = v;
+                    block.minFrame = frame;
+                } else if(v > block.max){
+                    block.max = v;
+                    block.maxFrame = frame;
+                }
+            }
+        }
+
+        for(size_t k=1; k < levels.size(); ++k){
+            auto& lower = levels[k - 1];
+            auto& upper = levels[k];
+            indexBegin /= 2;
+            indexEnd = (indexEnd - 1) / 2 + 1;
+            for(int i = indexBegin; i < indexEnd; ++i){
+                auto& block = upper[i];
+                block = lower[i * 2];
+                if(i * 2 + 1 < static_cast<int>(lower.size())){
+                    merge(block, lower[i * 2 + 1]);
+                }
+            }
+        }
+
+        dirtyBegin = std::numeric_limits<int>::max();
+        dirtyEnd = 0;
+    }
+
+private:
+    //! levels[k] consists of the blocks of BaseBlockSize * 2^k frames
+    vector<vector<Block>> levels;
+    int numFrames;
+    int dirtyBegin;
+    int dirtyEnd;
+};
+
 }
 
 namespace cnoid {
@@ -84,6 +217,15 @@ public:
 
     GraphDataHandler::DataRequestCallback dataRequestCallback;
     GraphDataHandler::DataModifiedCallback dataModifiedCallback;
+
+    MinMaxPyramid valuePyramid;
+    MinMaxPyramid velocityPyramid;
+
+    void invalidatePyramids(int frameBegin, int frameEnd){
+        valuePyramid.invalidate(frameBegin, frameEnd);
+        // The velocity of a frame depends on the values of the adjacent frames
+        velocityPyramid.invalidate(frameBegin - 1, frameEnd + 1);
+    }
 };
 
 class GraphWidgetImpl
@@ -226,6 +368,10 @@ public:
     void selectEditTargetByClicking(double screenX, double screenY);
     bool onScreenPaintEvent(QPaintEvent* event);
     void drawTrajectory(QPainter& painter, const QRect& rect, GraphDataHandlerImpl* data);
+    template<class ValueFunction>
+    void setMinMaxPolyline(
+        MinMaxPyramid& pyramid, int numFrames, ValueFunction value,
+        int frame, int frame_begin, int frame_end, double xratio, double screenOffsetX);
     void drawLimits(QPainter& painter, GraphDataHandlerImpl* data);
     void updateControlPoints(GraphDataHandlerImpl* data);
     void drawGrid(QPainter& painter);
@@ -291,6 +437,8 @@ void GraphDataHandler::setFrameProperties(int numFrames, double frameRate, doubl
     impl->stepRatio = 1.0 / frameRate;
     impl->offset = offset;
     impl->isControlPointUpdateNeeded = true;
+    // The cached velocities depend on the step ratio
+    impl->invalidatePyramids(0, numFrames);
 }
 
 
@@ -532,6 +680,7 @@ void GraphWidgetImpl::updateData(GraphDataHandlerPtr handler)
     if(data->dataRequestCallback){
         vector<double>& values = data->values;
         data->dataRequestCallback(0, data->numFrames, &(values[1]));
+        data->invalidatePyramids(0, data->numFrames);
     }
     screen->update();
 }
@@ -1402,6 +1551,7 @@ void GraphWidgetImpl::doTrajectoryEdit(int screenX, int screenY, Qt::KeyboardMod
     if(editMode == GraphWidget::LINE_MODE){
         EditHistoryPtr& history = editTarget->editHistories.back();
         std::copy(history->orgValues.begin(), history->orgValues.end(), &values[history->frame]);
+        editTarget->invalidatePyramids(history->frame, history->frame + history->orgValues.size());
     }
 
     if(frameBegin < frameEnd){
@@ -1442,6 +1592,8 @@ void GraphWidgetImpl::doTrajectoryEdit(int screenX, int screenY, Qt::KeyboardMod
             }
         }
 
+        editTarget->invalidatePyramids(frameBegin, frameEnd);
+
         editedFrameBegin = std::min(editedFrameBegin, frameBegin);
         editedFrameEnd = std::max(editedFrameEnd, frameEnd);
 
@@ -1502,6 +1654,7 @@ void GraphWidgetImpl::undoTrajectoryEdit()
             EditHistoryPtr history = editTarget->editHistories[currentHistory];
             std::copy(history->orgValues.begin(), history->orgValues.end(),
                       editTarget->values.begin() + history->frame + 1);
+            editTarget->invalidatePyramids(history->frame, history->frame + history->orgValues.size());
             editTarget->dataModifiedCallback(history->frame, history->orgValues.size(), &history->orgValues[0]);
             screen->update();
         }
@@ -1518,6 +1671,7 @@ void GraphWidgetImpl::redoTrajectoryEdit()
             EditHistoryPtr history = editTarget->editHistories[currentHistory];
             std::copy(history->newValues.begin(), history->newValues.end(),
                       editTarget->values.begin() + history->frame + 1);
+            editTarget->invalidatePyramids(history->frame, history->frame + history->newValues.size());
             editTarget->dataModifiedCallback(history->frame, history->newValues.size(), &history->newValues[0]);
             currentHistory++;
             screen->update();
@@ -1699,37 +1853,10 @@ void GraphWidgetImpl::drawTrajectory
                     ++frame;
                 }
             } else {
-                const int m = (int)(0.5 / xratio);
-                const int n = ceil(double(frame_end - frame) / m);
-                polyline.resize(n * 2);
-                for(int i=0; i < n; ++i){
-                    double px_min = screenOffsetX + (frame - frame_begin) * xratio;
-                    double px_max = px_min;
-                    const int next = std::min(frame + m, frame_end);
-                    double min = calcVelocity(frame++, values, stepRatio2);
-                    double max = min;
-                    while(frame < next){
-                        const double v = calcVelocity(frame, values, stepRatio2);
-                        if(v > max){
-                            max = v;
-                            px_max = screenOffsetX + (frame - frame_begin) * xratio;
-                        } else if(v < min){
-                            min = v;
-                            px_min = screenOffsetX + (frame - frame_begin) * xratio;
-                        }
-                        frame++;
-                    }
-                    const double upper = screenCenterY - (max + centerY) * scaleY;
-                    const double lower = screenCenterY - (min + centerY) * scaleY;
-
-                    if(px_min <= px_max){
-                        polyline[i*2] = QPointF(px_min, lower);
-                        polyline[i*2+1] = QPointF(px_max, upper);
-                    } else {
-                        polyline[i*2] = QPointF(px_max, upper);
-                        polyline[i*2+1] = QPointF(px_min, lower);
-                    }
-                }
+                setMinMaxPolyline(
+                    data->velocityPyramid, numFrames,
+                    [values, stepRatio2](int frame){ return calcVelocity(frame, values, stepRatio2); },
+                    frame, frame_begin, frame_end, xratio, screenOffsetX);
             }
 
             painter.drawPolyline(polyline);
@@ -1755,35 +1882,10 @@ void GraphWidgetImpl::drawTrajectory
                     ++frame;
                 }
             } else {
-                const int m = (int)(0.5 / xratio);
-                const int n = ceil(double(frame_end - frame) / m);
-                polyline.resize(n * 2);
-                for(int i=0; i < n; ++i){
-                    double px_min = screenOffsetX + (frame - frame_begin) * xratio;
-                    double px_max = px_min;
-                    const int next = std::min(frame + m, frame_end);
-                    double min = values[frame++];
-                    double max = min;
-                    while(frame < next){
-                        const double v = values[frame++];
-                        if(v > max){
-                            max = v;
-                            px_max = screenOffsetX + (frame - frame_begin) * xratio;
-                        } else if(v < min){
-                            min = v;
-                            px_min = screenOffsetX + (frame - frame_begin) * xratio;
-                        }
-                    }
-                    const double upper = screenCenterY - (max + centerY) * scaleY;
-                    const double lower = screenCenterY - (min + centerY) * scaleY;
-                    if(px_min <= px_max){
-                        polyline[i*2] = QPointF(px_min, lower);
-                        polyline[i*2+1] = QPointF(px_max, upper);
-                    } else {
-                        polyline[i*2] = QPointF(px_max, upper);
-                        polyline[i*2+1] = QPointF(px_min, lower);
-                    }
-                }
+                setMinMaxPolyline(
+                    data->valuePyramid, numFrames,
+                    [values](int frame){ return values[frame]; },
+                    frame, frame_begin, frame_end, xratio, screenOffsetX);
             }
 
             painter.drawPolyline(polyline);
@@ -1811,6 +1913,72 @@ void GraphWidgetImpl::drawTrajectory
 }
 
 
+/**
+   The polyline consists of the minimum and maximum values of the frames in each half pixel.
+   The blocks of the pyramid are used when the frames in a half pixel include a block.
+*/
+template<class ValueFunction>
+void GraphWidgetImpl::setMinMaxPolyline
+(MinMaxPyramid& pyramid, int numFrames, ValueFunction value,
+ int frame, int frame_begin, int frame_end, double xratio, double screenOffsetX)
+{
+    int m = (int)(0.5 / xratio);
+    int level = -1;
+    int blockSize = 1;
+    if(m >= MinMaxPyramid::BaseBlockSize){
+        pyramid.update(numFrames, value);
+        level = pyramid.findLevel(m);
+        if(level >= 0){
+            blockSize = pyramid.blockSize(level);
+            // The buckets are aligned with the blocks
+            m = (m / blockSize) * blockSize;
+            frame = (frame / blockSize) * blockSize;
+        }
+    }
+    
+    const int n = ceil(double(frame_end - frame) / m);
+    polyline.resize(n * 2);
+    MinMaxPyramid::Block bucket;
+    for(int i=0; i < n; ++i){
+        const int next = std::min(frame + m, frame_end);
+        if(level >= 0){
+            int index = frame / blockSize;
+            const int indexEnd = (next - 1) / blockSize + 1;
+            bucket = pyramid.block(level, index);
+            while(++index < indexEnd){
+                MinMaxPyramid::merge(bucket, pyramid.block(level, index));
+            }
+        } else {
+            bucket.min = bucket.max = value(frame);
+            bucket.minFrame = bucket.maxFrame = frame;
+            for(int f = frame + 1; f < next; ++f){
+                const double v = value(f);
+                if(v > bucket.max){
+                    bucket.max = v;
+                    bucket.maxFrame = f;
+                } else if(v < bucket.min){
+                    bucket.min = v;
+                    bucket.minFrame = f;
+                }
+            }
+        }
+        frame = next;
+
+        const double px_min = screenOffsetX + (bucket.minFrame - frame_begin) * xratio;
+        const double px_max = screenOffsetX + (bucket.maxFrame - frame_begin) * xratio;
+        const double upper = screenCenterY - (bucket.max + centerY) * scaleY;
+        const double lower = screenCenterY - (bucket.min + centerY) * scaleY;
+        if(px_min <= px_max){
+            polyline[i*2] = QPointF(px_min, lower);
+            polyline[i*2+1] = QPointF(px_max, upper);
+        } else {
+            polyline[i*2] = QPointF(px_max, upper);
+            polyline[i*2+1] = QPointF(px_min, lower);
+        }
+    }
+}
+
+
 void GraphWidgetImpl::updateControlPoints(GraphDataHandlerImpl* data)
 {
     if(data->isControlPointUpdateNeeded){
@@ -1415,6 +1415,12 @@ SignalProxy<void()> Item::sigUpdated()
 }
 
 
+size_t Item::estimateMemoryUsage() const
+{
+    return 0;
+}
+
+
 bool Item::setAddon(ItemAddon* addon)
 {
     ItemAddonPtr holder;
@@ -444,6 +444,13 @@ public:
     void notifyUpdateWithProjectFileConsistency();
     SignalProxy<void()> sigUpdated();
 
+    /**
+       This function returns an estimate of the bytes used by the data of the item.
+       The child items are not included. The default implementation returns zero,
+       and the classes of the items having a large data should override it.
+    */
+    virtual size_t estimateMemoryUsage() const;
+
     bool setAddon(ItemAddon* addon);
     ItemAddon* findAddon(const std::type_info& type);
     const ItemAddon* findAddon(const std::type_info& type) const;
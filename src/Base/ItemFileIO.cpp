@@ -6,13 +6,37 @@
 #include <cnoid/FilePathVariableProcessor>
 #include <cnoid/UTF8>
 #include <cnoid/Format>
+#include <cnoid/ThreadPool>
 #include <cnoid/stdx/filesystem>
+#include <future>
+#include <deque>
+#include <sstream>
 #include "gettext.h"
 
 using namespace std;
 using namespace cnoid;
 namespace filesystem = cnoid::stdx::filesystem;
 
+namespace {
+
+unique_ptr<ThreadPool> preloadingThreadPool;
+
+ThreadPool* getPreloadingThreadPool()
+{
+    if(!preloadingThreadPool){
+        preloadingThreadPool.reset(new ThreadPool(std::max(1u, std::thread::hardware_concurrency())));
+    }
+    return preloadingThreadPool.get();
+}
+
+struct PreloadingResult
+{
+    ReferencedPtr object;
+    string message;
+};
+
+}
+
 namespace cnoid {
 
 class ItemFileIO::Impl
@@ -37,6 +61,8 @@ public:
     std::string errorMessage;
     std::time_t lastSelectedTimeInLoadDialog;
     std::time_t lastSelectedTimeInSaveDialog;
+    deque<pair<string, std::future<PreloadingResult>>> preloadings;
+    ReferencedPtr preloadedObject;
 
     // This variable actualy points a instance of the ClassInfo class defined in ItemManager.cpp
     mutable weak_ref_ptr<Referenced> itemClassInfo;
@@ -47,6 +73,7 @@ public:
     bool loadItem(
         Item* item, std::string filename,
         Item* parentItem, bool doAddition, Item* nextItem, const Mapping* options);
+    void takePreloadedObject(const std::string& filename);
     bool saveItem(Item* item, std::string filename, const Mapping* options);
 };
 
@@ -392,7 +419,9 @@ bool ItemFileIO::Impl::loadItem
     mv->flush();
 
     actuallyLoadedItem = item;
+    takePreloadedObject(filename);
     bool loaded = self->load(item, filename);
+    preloadedObject.reset();
     mv->flush();
 
     if(!loaded){
@@ -432,12 +461,80 @@ bool ItemFileIO::Impl::loadItem
 }
 
 
+void ItemFileIO::Impl::takePreloadedObject(const std::string& filename)
+{
+    preloadedObject.reset();
+    
+    for(auto it = preloadings.begin(); it != preloadings.end(); ++it){
+        if(it->first == filename){
+            auto result = it->second.get();
+            preloadings.erase(it);
+            if(result.object){
+                preloadedObject = result.object;
+                *os << result.message;
+            }
+            break;
+        }
+    }
+}
+
+
 bool ItemFileIO::load(Item* item, const std::string& filename)
 {
     return false;
 }
 
 
+bool ItemFileIO::startPreloading(const std::string& filename, const Mapping* options)
+{
+    string expanded = FilePathVariableProcessor::currentInstance()->expand(filename, true);
+    if(expanded.empty()){
+        return false;
+    }
+    auto preload = getPreloadingFunction(expanded, options);
+    if(!preload){
+        return false;
+    }
+    auto promise = make_shared<std::promise<PreloadingResult>>();
+    impl->preloadings.emplace_back(expanded, promise->get_future());
+    
+    getPreloadingThreadPool()->start(
+        [preload, promise](){
+            PreloadingResult result;
+            std::ostringstream os;
+            try {
+                result.object = preload(os);
+            } catch(...){
+                // The file is loaded again by the load function
+                result.object.reset();
+            }
+            result.message = os.str();
+            promise->set_value(result);
+        });
+
+    return true;
+}
+
+
+void ItemFileIO::clearPreloading()
+{
+    impl->preloadings.clear();
+}
+
+
+std::function<ReferencedPtr(std::ostream& os)> ItemFileIO::getPreloadingFunction
+(const std::string& /* filename */, const Mapping* /* options */)
+{
+    return nullptr;
+}
+
+
+Referenced* ItemFileIO::preloadedObject()
+{
+    return impl->preloadedObject;
+}
+
+
 Item* ItemFileIO::createItem()
 {
     return nullptr;
@@ -5,6 +5,8 @@
 #include <cnoid/Referenced>
 #include <string>
 #include <vector>
+#include <functional>
+#include <iosfwd>
 #include <ctime>
 #include "exportdecl.h"
 
@@ -78,6 +80,17 @@ public:
         Item* parentItem = nullptr, bool doAddition = true, Item* nextItem = nullptr,
         const Mapping* options = nullptr);
 
+    /**
+       This function starts reading the file in a worker thread if the file IO supports the preloading.
+       The object read from the file is used in the next loadItem call for the same file, which is
+       done in the main thread.
+       \return true if the preloading is started
+    */
+    bool startPreloading(const std::string& filename, const Mapping* options = nullptr);
+
+    //! The preloaded objects that have not been used are discarded.
+    void clearPreloading();
+
     // Save API
     bool saveItem(Item* item, const std::string& filename, const Mapping* options = nullptr);
     
@@ -139,6 +152,19 @@ protected:
     virtual bool load(Item* item, const std::string& filename);
     virtual Item* createItem();
 
+    /**
+       Override this function to support the preloading. The returned function reads the file into
+       an object detached from the item. It is executed in a worker thread, so it must not access
+       the item tree, the GUI and the states of this object. The messages must be output to the
+       given stream. The function can return null when the file cannot be read, and then the load
+       function is called without the preloaded object.
+    */
+    virtual std::function<ReferencedPtr(std::ostream& os)> getPreloadingFunction(
+        const std::string& filename, const Mapping* options);
+
+    //! This function returns the preloaded object in the load function if it is available.
+    Referenced* preloadedObject();
+
     // Save API
     virtual bool save(Item* item, const std::string& filename);
     
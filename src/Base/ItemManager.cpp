@@ -343,11 +343,30 @@ Item* ItemFileIO::findSingletonItemInstance() const
 }
 
 
+/**
+   A lazily activated plugin which declares the item class is activated here
+   if the class has not been registered yet.
+*/
+static void activatePluginForItemClassIfNecessary(const std::string& moduleName, const std::string& className)
+{
+    auto p = moduleNameToItemManagerImplMap.find(moduleName);
+    if(p != moduleNameToItemManagerImplMap.end()){
+        auto& itemClassNameToInfoMap = p->second->itemClassNameToInfoMap;
+        if(itemClassNameToInfoMap.find(className) != itemClassNameToInfoMap.end()){
+            return;
+        }
+    }
+    PluginManager::instance()->activatePluginForItemClass(moduleName, className);
+}
+
+
 static Item* createItem
 (const std::string& moduleName, const std::string& className, bool searchOtherModules)
 {
     Item* item = nullptr;
 
+    activatePluginForItemClassIfNecessary(moduleName, className);
+
     auto p = moduleNameToItemManagerImplMap.find(moduleName);
     if(p == moduleNameToItemManagerImplMap.end()){
         if(auto alias = PluginManager::instance()->guessActualPluginName(moduleName)){
@@ -782,28 +801,43 @@ ItemFileIO* ItemManager::findFileIO(const std::type_info& type, const std::strin
 }
 
 
-ItemFileIO* ItemManager::Impl::findMatchedFileIO
-(const type_info& type, const string& filename, const string& format, int ioTypeFlag)
+static ClassInfo* findClassInfo
+(const std::string& moduleName, const std::string& className, bool searchOtherModules)
 {
-    ItemFileIO* targetFileIO = nullptr;
-    
-    auto p = itemClassIdToInfoMap.find(itemClassRegistry->getClassId(type));
-    if(p == itemClassIdToInfoMap.end()){
-        if(filename.empty()){
-            messageView->putln(
-                formatR(_("There is no file I/O processor registered for the \"{0}\" type."), type.name()),
-                MessageView::Error);
-        } else {
-            messageView->putln(
-                formatR(_("\"{0}\" cannot be accessed because there is no file I/O processor registered for the \"{1}\" type."),
-                            filename, type.name()),
-                MessageView::Error);
+    activatePluginForItemClassIfNecessary(moduleName, className);
+
+    auto p = moduleNameToItemManagerImplMap.find(moduleName);
+    if(p == moduleNameToItemManagerImplMap.end()){
+        if(auto alias = PluginManager::instance()->guessActualPluginName(moduleName)){
+            p = moduleNameToItemManagerImplMap.find(alias);
         }
-        return targetFileIO;;
     }
-    
-    ClassInfoPtr& classInfo = p->second;
-    auto& fileIOs = classInfo->fileIOs;
+    if(p != moduleNameToItemManagerImplMap.end()){
+        auto& itemClassNameToInfoMap = p->second->itemClassNameToInfoMap;
+        auto q = itemClassNameToInfoMap.find(className);
+        if(q != itemClassNameToInfoMap.end()){
+            return q->second;
+        }
+    }
+    if(searchOtherModules){
+        auto r = aliasClassNameToAliasModuleNameToTrueNamePairMap.find(className);
+        if(r != aliasClassNameToAliasModuleNameToTrueNamePairMap.end()){
+            auto& aliasModuleNameToTrueNamePairMap = r->second;
+            auto s = aliasModuleNameToTrueNamePairMap.find(moduleName);
+            if(s != aliasModuleNameToTrueNamePairMap.end()){
+                auto& trueNamePair = s->second;
+                return findClassInfo(trueNamePair.first, trueNamePair.second, false);
+            }
+        }
+    }
+    return nullptr;
+}
+
+
+static ItemFileIO* findMatchedFileIOIn
+(const vector<ItemFileIOPtr>& fileIOs, const string& filename, const string& format, int ioTypeFlag)
+{
+    ItemFileIO* targetFileIO = nullptr;
 
     if(!format.empty() || filename.empty()){
         for(auto& fileIO : fileIOs){
@@ -835,6 +869,44 @@ ItemFileIO* ItemManager::Impl::findMatchedFileIO
         }
     }
 
+    return targetFileIO;
+}
+
+
+ItemFileIO* ItemManager::findFileIOForLoading
+(const std::string& moduleName, const std::string& itemClassName,
+ const std::string& filename, const std::string& format)
+{
+    if(auto classInfo = findClassInfo(moduleName, itemClassName, true)){
+        return findMatchedFileIOIn(classInfo->fileIOs, filename, format, ItemFileIO::Load);
+    }
+    return nullptr;
+}
+
+
+ItemFileIO* ItemManager::Impl::findMatchedFileIO
+(const type_info& type, const string& filename, const string& format, int ioTypeFlag)
+{
+    ItemFileIO* targetFileIO = nullptr;
+    
+    auto p = itemClassIdToInfoMap.find(itemClassRegistry->getClassId(type));
+    if(p == itemClassIdToInfoMap.end()){
+        if(filename.empty()){
+            messageView->putln(
+                formatR(_("There is no file I/O processor registered for the \"{0}\" type."), type.name()),
+                MessageView::Error);
+        } else {
+            messageView->putln(
+                formatR(_("\"{0}\" cannot be accessed because there is no file I/O processor registered for the \"{1}\" type."),
+                            filename, type.name()),
+                MessageView::Error);
+        }
+        return targetFileIO;;
+    }
+    
+    ClassInfoPtr& classInfo = p->second;
+    targetFileIO = findMatchedFileIOIn(classInfo->fileIOs, filename, format, ioTypeFlag);
+
     if(!targetFileIO){
         if(format.empty()){
             messageView->putln(
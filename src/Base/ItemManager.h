@@ -166,6 +166,14 @@ public:
         const Item* item, std::function<bool(ItemFileIO* fileIO)> pred, bool includeSuperClassIos = false);
     static ItemFileIO* findFileIO(const std::type_info& type, const std::string& format);
 
+    /**
+       This function finds the file IO used to load a file to an item of the specified class
+       without creating the item instance. No error message is output when it is not found.
+    */
+    static ItemFileIO* findFileIOForLoading(
+        const std::string& moduleName, const std::string& itemClassName,
+        const std::string& filename, const std::string& format);
+
     template <class ItemType>
     ItemManager& addLoader(
         const std::string& caption, const std::string& format, const std::string& extensions, 
@@ -3,9 +3,11 @@
 #include "RootItem.h"
 #include "SubProjectItem.h"
 #include "ItemManager.h"
+#include "ItemFileIO.h"
 #include "MessageView.h"
 #include "Archive.h"
 #include <cnoid/YAMLReader>
+#include <cnoid/FilePathVariableProcessor>
 #include <cnoid/YAMLWriter>
 #include <cnoid/Format>
 #include <list>
@@ -26,6 +28,9 @@ public:
     int numRestoredItems;
     const std::set<std::string>* pOptionalPlugins;
     bool isTemporaryItemSaveEnabled;
+    bool isFilePreloadingEnabled;
+    int restoreDepth;
+    std::set<ItemFileIOPtr> preloadingFileIOs;
 
     Impl();
     ArchivePtr store(Archive& parentArchive, Item* item);
@@ -35,6 +40,7 @@ public:
     bool checkSubTreeTemporality(Item* item);
     void storeAddons(Archive& archive, Item* item);
     ItemList<> restore(Archive& archive, Item* parentItem, const std::set<std::string>& optionalPlugins);
+    void startFilePreloadingIter(Archive& archive);
     void restoreItemIter(Archive& archive, Item* parentItem, ItemList<>& io_topLevelItems, int level);
     ItemPtr restoreItem(
         Archive& archive, Item* parentItem, string& itemName, string& classame,
@@ -56,7 +62,8 @@ ItemTreeArchiver::ItemTreeArchiver()
 ItemTreeArchiver::Impl::Impl()
     : mv(MessageView::instance())
 {
-
+    isFilePreloadingEnabled = true;
+    restoreDepth = 0;
 }
 
 
@@ -88,6 +95,18 @@ bool ItemTreeArchiver::isTemporaryItemSaveEnabled() const
 }
 
 
+void ItemTreeArchiver::setFilePreloadingEnabled(bool on)
+{
+    impl->isFilePreloadingEnabled = on;
+}
+
+
+bool ItemTreeArchiver::isFilePreloadingEnabled() const
+{
+    return impl->isFilePreloadingEnabled;
+}
+
+
 int ItemTreeArchiver::numArchivedItems() const
 {
     return impl->numArchivedItems;
@@ -311,17 +330,80 @@ ItemList<> ItemTreeArchiver::Impl::restore
     ItemList<> topLevelItems;
 
     archive.setCurrentParentItem(nullptr);
+
+    /*
+      The restore function may be called recursively to load a sub project.
+      The preloading is only done by the top level call, which covers the files of its item tree.
+    */
+    bool isTopLevelRestore = (restoreDepth == 0);
+    ++restoreDepth;
+    
+    if(isTopLevelRestore && isFilePreloadingEnabled){
+        try {
+            startFilePreloadingIter(archive);
+        } catch (const ValueNode::Exception&){
+            // The error is reported in restoring the items
+        }
+    }
     try {
         restoreItemIter(archive, parentItem, topLevelItems, 0);
     } catch (const ValueNode::Exception& ex){
         mv->putln(ex.message(), MessageView::Error);
     }
+
+    --restoreDepth;
+    if(isTopLevelRestore){
+        for(auto& fileIO : preloadingFileIOs){
+            fileIO->clearPreloading();
+        }
+        preloadingFileIOs.clear();
+    }
+    
     archive.setCurrentParentItem(nullptr);
 
     return topLevelItems;
 }
 
 
+void ItemTreeArchiver::Impl::startFilePreloadingIter(Archive& archive)
+{
+    string pluginName;
+    string className;
+    if(!archive.get({ "is_sub_item", "isSubItem" }, false) &&
+       archive.read("plugin", pluginName) && archive.read("class", className)){
+        auto dataNode = archive.find("data");
+        if(dataNode->isValid() && dataNode->isMapping()){
+            auto dataArchive = static_cast<Archive*>(dataNode->toMapping());
+            dataArchive->inheritSharedInfoFrom(archive);
+            string file;
+            if(dataArchive->read({ "file", "filename" }, file)){
+                // The path is expanded silently because the error is reported in restoring the item
+                file = dataArchive->filePathVariableProcessor()->expand(file, true);
+                if(!file.empty()){
+                    string format;
+                    dataArchive->read("format", format);
+                    if(auto fileIO = ItemManager::findFileIOForLoading(pluginName, className, file, format)){
+                        if(fileIO->startPreloading(file, dataArchive)){
+                            preloadingFileIOs.insert(fileIO);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    ListingPtr children = archive.findListing("children");
+    if(children->isValid()){
+        for(int i=0; i < children->size(); ++i){
+            if(auto childArchive = dynamic_cast<Archive*>(children->at(i)->toMapping())){
+                childArchive->inheritSharedInfoFrom(archive);
+                startFilePreloadingIter(*childArchive);
+            }
+        }
+    }
+}
+
+
 void ItemTreeArchiver::Impl::restoreItemIter
 (Archive& archive, Item* parentItem, ItemList<>& io_topLevelItems, int level)
 {
@@ -18,6 +18,13 @@ public:
     void reset();
     void setTemporaryItemSaveEnabled(bool on);
     bool isTemporaryItemSaveEnabled() const;
+
+    /**
+       When this is enabled, the files of the items are read concurrently in worker threads
+       before the items are restored in order. This is enabled by default.
+    */
+    void setFilePreloadingEnabled(bool on);
+    bool isFilePreloadingEnabled() const;
     ArchivePtr store(Archive* parentArchive, Item* topItem);
 
     /**
@@ -16,6 +16,7 @@
 #include "PathVariableEditor.h"
 #include "DistanceMeasurementDialog.h"
 #include "RenderableItemSceneStatistics.h"
+#include "MemoryUsageStatistics.h"
 #include "RenderableItemSceneExporter.h"
 #include "MovieRecorderDialog.h"
 #include "SceneWidget.h"
@@ -154,6 +155,7 @@ void MainMenu::setMenuItems()
     set_Tools_Menu(mm.currentMenu());
     setActionAsShowDistanceMeasurementDialog(mm.addItem(_("Distance Measurement")));
     setActionAsPutSceneStatistics(mm.addItem(_("Put Scene Statistics")));
+    setActionAsPutMemoryUsageStatistics(mm.addItem(_("Put Memory Usage")));
     setActionAsExportSelectedRenderableItemScene(mm.addItem(_("Export Scene")));
     setActionAsShowMovieRecorderDialog(mm.addItem(_("Movie Recorder")));
 
@@ -527,6 +529,12 @@ void MainMenu::setActionAsPutSceneStatistics(Action* action)
 }
 
 
+void MainMenu::setActionAsPutMemoryUsageStatistics(Action* action)
+{
+    action->sigTriggered().connect([]{ putMemoryUsageStatistics(); });
+}
+
+
 void MainMenu::setActionAsExportSelectedRenderableItemScene(Action* action)
 {
     action->sigTriggered().connect([]{ showDialogToExportSelectedRenderableItemScene(); });
@@ -0,0 +1,70 @@
+#include "MemoryUsageStatistics.h"
+#include "RootItem.h"
+#include "ItemList.h"
+#include "MessageView.h"
+#include "SceneView.h"
+#include "SceneWidget.h"
+#include <cnoid/GLSLSceneRenderer>
+#include <cnoid/Format>
+#include <algorithm>
+#include "gettext.h"
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+constexpr int MaxNumListedItems = 20;
+
+double toMegaBytes(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+}
+
+void cnoid::putMemoryUsageStatistics()
+{
+    ostream& os = MessageView::instance()->cout();
+    os << _("Estimated memory usage:") << endl;
+
+    vector<pair<Item*, size_t>> itemUsages;
+    size_t totalItemUsage = 0;
+    for(auto& item : RootItem::instance()->descendantItems()){
+        size_t usage = item->estimateMemoryUsage();
+        if(usage > 0){
+            itemUsages.emplace_back(item.get(), usage);
+            totalItemUsage += usage;
+        }
+    }
+    std::sort(itemUsages.begin(), itemUsages.end(),
+              [](const pair<Item*, size_t>& u1, const pair<Item*, size_t>& u2){
+                  return u1.second > u2.second; });
+
+    if(itemUsages.empty()){
+        os << _(" No item has a data to be counted.") << endl;
+    } else {
+        const int n = std::min(static_cast<int>(itemUsages.size()), MaxNumListedItems);
+        for(int i=0; i < n; ++i){
+            auto item = itemUsages[i].first;
+            os << formatC(" {:>10.2f} MB  ", toMegaBytes(itemUsages[i].second));
+            if(auto parentItem = item->parentItem()){
+                if(parentItem != RootItem::instance()){
+                    os << parentItem->displayName() << " / ";
+                }
+            }
+            os << item->displayName() << "\n";
+        }
+        if(static_cast<int>(itemUsages.size()) > n){
+            os << formatR(_(" ... and {0} more items\n"), itemUsages.size() - n);
+        }
+        os << formatR(_(" Total of the items: {0:.2f} MB"), toMegaBytes(totalItemUsage)) << endl;
+    }
+
+    for(auto view : SceneView::instances()){
+        if(auto renderer = dynamic_cast<GLSLSceneRenderer*>(view->sceneWidget()->renderer())){
+            os << formatR(_(" Rendering resources of \"{0}\": {1:.2f} MB"),
+                          view->name(), toMegaBytes(renderer->estimateResourceMemoryUsage())) << endl;
+        }
+    }
+}
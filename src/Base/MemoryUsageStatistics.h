@@ -0,0 +1,10 @@
+#ifndef CNOID_BASE_MEMORY_USAGE_STATISTICS_H
+#define CNOID_BASE_MEMORY_USAGE_STATISTICS_H
+
+namespace cnoid {
+
+void putMemoryUsageStatistics();
+
+}
+
+#endif
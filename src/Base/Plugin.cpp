@@ -23,6 +23,10 @@ public:
     vector<string> requisites;
     vector<string> subsequences;
     vector<string> oldNames;
+    vector<string> itemClasses;
+    vector<string> viewClasses;
+    vector<string> inputFileExtensions;
+    vector<string> menuItems;
     int activationPriority;
     unsigned int internalVersion;
     bool isUnloadable;
@@ -201,6 +205,61 @@ const char* Plugin::LGPLtext()
 }
 
 
+bool Plugin::isLazyActivationEnabled() const
+{
+    return !(impl->itemClasses.empty() && impl->viewClasses.empty() &&
+             impl->inputFileExtensions.empty() && impl->menuItems.empty());
+}
+
+
+void Plugin::declareItemClass(const std::string& className)
+{
+    impl->itemClasses.push_back(className);
+}
+
+
+const std::vector<std::string>& Plugin::declaredItemClasses() const
+{
+    return impl->itemClasses;
+}
+
+
+void Plugin::declareViewClass(const std::string& className)
+{
+    impl->viewClasses.push_back(className);
+}
+
+
+const std::vector<std::string>& Plugin::declaredViewClasses() const
+{
+    return impl->viewClasses;
+}
+
+
+void Plugin::declareInputFileExtension(const std::string& extension)
+{
+    impl->inputFileExtensions.push_back(extension);
+}
+
+
+const std::vector<std::string>& Plugin::declaredInputFileExtensions() const
+{
+    return impl->inputFileExtensions;
+}
+
+
+void Plugin::declareMenuItem(const std::string& path)
+{
+    impl->menuItems.push_back(path);
+}
+
+
+const std::vector<std::string>& Plugin::declaredMenuItems() const
+{
+    return impl->menuItems;
+}
+
+
 int Plugin::activationPriority() const
 {
     return impl->activationPriority;
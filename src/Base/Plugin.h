@@ -8,6 +8,7 @@
 #include "ExtensionManager.h"
 #include <cnoid/Config>
 #include <string>
+#include <vector>
 #include "exportdecl.h"
 
 namespace cnoid {
@@ -49,6 +50,16 @@ public:
 
     int activationPriority() const;
 
+    /**
+       A plugin is activated lazily when it declares any of the item classes, view classes,
+       input file extensions or menu items it provides.
+    */
+    bool isLazyActivationEnabled() const;
+    const std::vector<std::string>& declaredItemClasses() const;
+    const std::vector<std::string>& declaredViewClasses() const;
+    const std::vector<std::string>& declaredInputFileExtensions() const;
+    const std::vector<std::string>& declaredMenuItems() const;
+
     unsigned int internalVersion() const;
 
     // Only called from the getChoreonoidPlugin() function
@@ -79,6 +90,26 @@ protected:
     */
     void addOldName(const std::string& name);
 
+    /**
+       Call the following functions in the constructor to make the plugin activated lazily.
+       Such a plugin is not activated at startup unless another plugin activated at startup
+       requires it. It is activated when any of the declared ones is used for the first time.
+       Note that a plugin which adds command line options or which must do something at startup
+       should not be activated lazily.
+    */
+    void declareItemClass(const std::string& className);
+    void declareViewClass(const std::string& className);
+
+    //! \param extension The extension of the files given as the command line arguments without the dot
+    void declareInputFileExtension(const std::string& extension);
+
+    /**
+       A placeholder of the menu item is added while the plugin is not activated.
+       When it is triggered, the plugin is activated and the actual menu item is triggered.
+       \param path The path of the menu item which consists of the untranslated texts such as "/Tools/Foo"
+    */
+    void declareMenuItem(const std::string& path);
+
 #ifdef CNOID_BACKWARD_COMPATIBILITY
     void depend(const std::string& pluginName);
 #endif
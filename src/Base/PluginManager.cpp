@@ -6,6 +6,8 @@
 #include "AppConfig.h"
 #include "MainWindow.h"
 #include "Action.h"
+#include "MenuManager.h"
+#include "OptionManager.h"
 #include <cnoid/MessageOut>
 #include <cnoid/ValueTree>
 #include <cnoid/ExecutablePath>
@@ -22,6 +24,7 @@
 #include <set>
 #include <list>
 #include <regex>
+#include <chrono>
 
 #ifdef Q_OS_WIN32
 #include <QtGlobal>
@@ -71,6 +74,13 @@ struct PluginInfo
     Action* aboutMenuItem;
     DescriptionDialog* aboutDialog;
     string lastErrorMessage;
+    bool isLazy;
+    bool isActivationDeferred;
+    bool isActivatedOnDemand;
+    vector<Action*> menuItemPlaceholders;
+    // in milliseconds
+    double loadingTime;
+    double initializationTime;
 
     PluginInfo(){
         plugin = nullptr;
@@ -79,9 +89,19 @@ struct PluginInfo
         doReloading = false;
         aboutMenuItem = nullptr;
         aboutDialog = nullptr;
+        isLazy = false;
+        isActivationDeferred = false;
+        isActivatedOnDemand = false;
+        loadingTime = 0.0;
+        initializationTime = 0.0;
     }
 };
 
+double elapsedMilliseconds(const std::chrono::steady_clock::time_point& startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
 }
 
 namespace cnoid {
@@ -94,6 +114,8 @@ public:
 
     bool isStartupLoadingDisabled;
     bool isNamingConventionCheckDisabled;
+    bool isLazyActivationDisabled;
+    bool isStartupProfilingEnabled;
 
     MessageOut* mout;
     MainMenu* mainMenu;
@@ -126,6 +148,17 @@ public:
     void loadScannedPluginFiles(bool doActivation);
     bool loadPlugin(int index, bool isLoadingMultiplePlugins);
     bool activatePlugin(int index);
+    void unmarkLazyPluginsRequiredAtStartup();
+    void addMenuItemPlaceholders(PluginInfoPtr info);
+    void removeMenuItemPlaceholders(PluginInfoPtr info);
+    void onMenuItemPlaceholderTriggered(PluginInfoPtr info, const string& path);
+    PluginInfoPtr findLazyPlugin(const std::string& name);
+    bool activatePluginOnDemand(PluginInfoPtr info);
+    bool activatePluginForClass(
+        const std::string& moduleName, const std::string& className,
+        const std::vector<std::string>& (Plugin::*getDeclaredClasses)() const);
+    bool activatePluginsForInputFile(const std::string& filename);
+    void putProfile();
     bool unloadPlugin(int index);
     bool unloadPlugin(const std::string& name, bool doReloading);
     bool finalizePlugin(PluginInfoPtr info);
@@ -189,6 +222,8 @@ PluginManager::Impl::Impl()
     // The following options are used for debug and can only be specified in the config file.
     isStartupLoadingDisabled = config->get("disable_startup_loading", false);
     isNamingConventionCheckDisabled = config->get("disable_naming_convention_check", false);
+    isLazyActivationDisabled = config->get("disable_lazy_activation", false);
+    isStartupProfilingEnabled = config->get("profile_startup", false);
 }
 
 
@@ -283,6 +318,18 @@ void PluginManager::doStartupLoading()
 {
     if(!impl->isStartupLoadingDisabled){
         impl->loadPlugins(true);
+
+        if(auto om = OptionManager::instance()){
+            om->sigInputFileOptionsParsed().connect(
+                [this](std::vector<std::string>& inputFiles){
+                    for(auto& file : inputFiles){
+                        impl->activatePluginsForInputFile(file);
+                    }
+                });
+        }
+        if(impl->isStartupProfilingEnabled){
+            impl->putProfile();
+        }
     }
 }
 
@@ -398,13 +445,15 @@ void PluginManager::Impl::loadScannedPluginFiles(bool doActivation)
     }
 
     std::sort(allPluginInfos.begin(), allPluginInfos.end(), comparePluginInfo);
+
+    unmarkLazyPluginsRequiredAtStartup();
     
     size_t totalNumActivated = 0;
     while(true){
         size_t numActivated = 0;
         for(size_t i=0; i < allPluginInfos.size(); ++i){
-            int status = allPluginInfos[i]->status;
-            if(status == PluginManager::LOADED){
+            auto& info = allPluginInfos[i];
+            if(info->status == PluginManager::LOADED && !info->isLazy){
                 if(activatePlugin(i)){
                     numActivated++;
                     totalNumActivated++;
@@ -416,7 +465,7 @@ void PluginManager::Impl::loadScannedPluginFiles(bool doActivation)
                 // Put information about plugins which cannot find required plugins
                 for(size_t i=0; i < allPluginInfos.size(); ++i){
                     PluginInfoPtr& info = allPluginInfos[i];
-                    if(info->status == PluginManager::LOADED && !info->areAllRequisitiesResolved){
+                    if(info->status == PluginManager::LOADED && !info->isLazy && !info->areAllRequisitiesResolved){
                         string lacks;
                         int n = 0;
                         for(size_t j=0; j < info->requisites.size(); ++j){
@@ -437,6 +486,53 @@ void PluginManager::Impl::loadScannedPluginFiles(bool doActivation)
             break;
         }
     }
+
+    for(auto& info : allPluginInfos){
+        if(info->status == PluginManager::LOADED && info->isLazy && !info->isActivationDeferred){
+            info->isActivationDeferred = true;
+            addMenuItemPlaceholders(info);
+            mout->put(formatR(_("{}-plugin will be activated on demand.\n"), info->name));
+        }
+    }
+}
+
+
+/**
+   A lazy plugin is activated at startup when a plugin activated at startup requires it or
+   when it must precede a plugin activated at startup.
+*/
+void PluginManager::Impl::unmarkLazyPluginsRequiredAtStartup()
+{
+    bool changed = true;
+    while(changed){
+        changed = false;
+        for(auto& info : allPluginInfos){
+            if(info->status != PluginManager::LOADED){
+                continue;
+            }
+            if(!info->isLazy){
+                for(auto& requisiteName : info->requisites){
+                    auto p = nameToPluginInfoMap.find(requisiteName);
+                    if(p != nameToPluginInfoMap.end() && p->second->isLazy){
+                        p->second->isLazy = false;
+                        changed = true;
+                    }
+                }
+            } else {
+                for(auto& subsequenceName : info->subsequences){
+                    auto p = nameToPluginInfoMap.find(subsequenceName);
+                    if(p != nameToPluginInfoMap.end()){
+                        auto& subsequence = p->second;
+                        if(subsequence->status == PluginManager::LOADED && !subsequence->isLazy){
+                            info->isLazy = false;
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
 }
 
 
@@ -476,6 +572,8 @@ bool PluginManager::Impl::loadPlugin(int index, bool isLoadingMultiplePlugins)
             info->dll.setLoadHints(QLibrary::ExportExternalSymbolsHint);
         }
 
+        auto startTime = std::chrono::steady_clock::now();
+
         if(!(info->dll.load())){
             info->lastErrorMessage = formatR(_("System error: {0}"), info->dll.errorString().toStdString());
             if(isLoadingMultiplePlugins){
@@ -509,6 +607,8 @@ bool PluginManager::Impl::loadPlugin(int index, bool isLoadingMultiplePlugins)
                 } else {
                     info->status = PluginManager::LOADED;
                     info->name = plugin->name();
+                    info->isLazy = !isLazyActivationDisabled && plugin->isLazyActivationEnabled();
+                    info->loadingTime = elapsedMilliseconds(startTime);
                     plugin->setFilePath(info->pathString.c_str());
 
                     if(plugin->internalVersion() != CNOID_INTERNAL_VERSION){
@@ -607,13 +707,18 @@ bool PluginManager::Impl::activatePlugin(int index)
         if(requisitesActive){
 
             info->areAllRequisitiesResolved = true;
+
+            auto startTime = std::chrono::steady_clock::now();
+            bool initialized = info->plugin->initialize();
+            info->initializationTime = elapsedMilliseconds(startTime);
                 
-            if(!info->plugin->initialize()){
+            if(!initialized){
                 info->status = PluginManager::INVALID;
                 errorMessage = _("The plugin object cannot be intialized.");
 
             } else {
                 info->status = PluginManager::ACTIVE;
+                info->isLazy = false;
                 info->plugin->isActive_ = true;
                 
                 pluginsInDeactivationOrder.push_front(info);
@@ -660,6 +765,231 @@ bool PluginManager::Impl::activatePlugin(int index)
 }
 
 
+void PluginManager::Impl::addMenuItemPlaceholders(PluginInfoPtr info)
+{
+    auto plugin = info->plugin;
+    for(auto& path : plugin->declaredMenuItems()){
+        auto pos = path.rfind('/');
+        if(pos == string::npos || pos + 1 == path.size()){
+            continue;
+        }
+        auto& mm = plugin->menuManager();
+        mm.setPath(pos == 0 ? string("/") : path.substr(0, pos));
+        auto item = mm.addItem(path.substr(pos + 1));
+        item->sigTriggered().connect(
+            [this, info, path](){
+                // The placeholder cannot be deleted in its own signal handler
+                callLater([this, info, path](){ onMenuItemPlaceholderTriggered(info, path); });
+            });
+        info->menuItemPlaceholders.push_back(item);
+    }
+}
+
+
+void PluginManager::Impl::removeMenuItemPlaceholders(PluginInfoPtr info)
+{
+    for(auto& item : info->menuItemPlaceholders){
+        delete item;
+    }
+    info->menuItemPlaceholders.clear();
+}
+
+
+void PluginManager::Impl::onMenuItemPlaceholderTriggered(PluginInfoPtr info, const string& path)
+{
+    activatePluginOnDemand(info);
+    if(info->status == PluginManager::ACTIVE){
+        if(auto item = info->plugin->menuManager().findItem(path)){
+            item->trigger();
+        }
+    }
+}
+
+
+PluginInfoPtr PluginManager::Impl::findLazyPlugin(const std::string& name)
+{
+    auto p = nameToPluginInfoMap.find(name);
+    if(p != nameToPluginInfoMap.end()){
+        if(p->second->isLazy){
+            return p->second;
+        }
+        return nullptr;
+    }
+    // The old names of a lazy plugin have not been registered yet
+    for(auto& info : allPluginInfos){
+        if(info->isLazy && info->status == PluginManager::LOADED){
+            auto plugin = info->plugin;
+            const int numOldNames = plugin->numOldNames();
+            for(int i=0; i < numOldNames; ++i){
+                if(plugin->oldName(i) == name){
+                    return info;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+
+bool PluginManager::activatePluginOnDemand(const std::string& name)
+{
+    if(auto info = impl->findLazyPlugin(name)){
+        return impl->activatePluginOnDemand(info);
+    }
+    return false;
+}
+
+
+bool PluginManager::Impl::activatePluginOnDemand(PluginInfoPtr info)
+{
+    if(info->status != PluginManager::LOADED || !info->isLazy){
+        return false;
+    }
+
+    // This avoids the infinite recursion for the circular dependency
+    info->isLazy = false;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // The required plugins and the plugins to precede this plugin must be activated first
+    for(auto& requisiteName : info->requisites){
+        if(info->subsequences.find(requisiteName) == info->subsequences.end()){
+            auto p = nameToPluginInfoMap.find(requisiteName);
+            if(p != nameToPluginInfoMap.end()){
+                activatePluginOnDemand(p->second);
+            }
+        }
+    }
+    for(auto& other : allPluginInfos){
+        if(other->isLazy && other->subsequences.find(info->name) != other->subsequences.end()){
+            activatePluginOnDemand(other);
+        }
+    }
+
+    removeMenuItemPlaceholders(info);
+
+    bool activated = false;
+    for(size_t i=0; i < allPluginInfos.size(); ++i){
+        if(allPluginInfos[i] == info){
+            activated = activatePlugin(i);
+            break;
+        }
+    }
+    if(activated){
+        info->isActivatedOnDemand = true;
+        mout->put(
+            formatR(_("{0}-plugin has been activated on demand in {1:.1f} ms.\n"),
+                    info->name, elapsedMilliseconds(startTime)));
+    } else if(info->status == PluginManager::LOADED){
+        mout->putErrorln(
+            formatR(_("{0}-plugin cannot be activated because its required plugins are not available."),
+                    info->name));
+    }
+
+    return activated;
+}
+
+
+bool PluginManager::activatePluginForItemClass(const std::string& moduleName, const std::string& className)
+{
+    return impl->activatePluginForClass(moduleName, className, &Plugin::declaredItemClasses);
+}
+
+
+bool PluginManager::activatePluginForViewClass(const std::string& moduleName, const std::string& className)
+{
+    return impl->activatePluginForClass(moduleName, className, &Plugin::declaredViewClasses);
+}
+
+
+bool PluginManager::Impl::activatePluginForClass
+(const std::string& moduleName, const std::string& className,
+ const std::vector<std::string>& (Plugin::*getDeclaredClasses)() const)
+{
+    auto declares = [&](PluginInfoPtr& info){
+        auto& classes = (info->plugin->*getDeclaredClasses)();
+        return std::find(classes.begin(), classes.end(), className) != classes.end();
+    };
+
+    if(auto info = findLazyPlugin(moduleName)){
+        if(declares(info)){
+            return activatePluginOnDemand(info);
+        }
+    }
+    for(auto& info : allPluginInfos){
+        if(info->isLazy && info->status == PluginManager::LOADED && declares(info)){
+            return activatePluginOnDemand(info);
+        }
+    }
+    return false;
+}
+
+
+bool PluginManager::activatePluginsForInputFile(const std::string& filename)
+{
+    return impl->activatePluginsForInputFile(filename);
+}
+
+
+bool PluginManager::Impl::activatePluginsForInputFile(const std::string& filename)
+{
+    string extension = filesystem::path(fromUTF8(filename)).extension().string();
+    if(extension.empty()){
+        return false;
+    }
+    extension = toUTF8(extension.substr(1));
+    
+    bool activated = false;
+    vector<PluginInfoPtr> infos = allPluginInfos;
+    for(auto& info : infos){
+        if(info->isLazy && info->status == PluginManager::LOADED){
+            auto& extensions = info->plugin->declaredInputFileExtensions();
+            if(std::find(extensions.begin(), extensions.end(), extension) != extensions.end()){
+                if(activatePluginOnDemand(info)){
+                    activated = true;
+                }
+            }
+        }
+    }
+    return activated;
+}
+
+
+void PluginManager::putProfile()
+{
+    impl->putProfile();
+}
+
+
+void PluginManager::Impl::putProfile()
+{
+    mout->put(_("Plugin loading and initialization time (ms):\n"));
+    mout->put(formatR(" {0:<24}{1:>10}{2:>10}\n", _("Plugin"), _("Loading"), _("Init")));
+
+    double totalLoadingTime = 0.0;
+    double totalInitializationTime = 0.0;
+    for(auto& info : allPluginInfos){
+        if(info->status != PluginManager::LOADED && info->status != PluginManager::ACTIVE){
+            continue;
+        }
+        string initialization;
+        if(info->status == PluginManager::ACTIVE){
+            initialization = formatR("{:10.1f}", info->initializationTime);
+            if(info->isActivatedOnDemand){
+                initialization += _(" (on demand)");
+            } else {
+                totalInitializationTime += info->initializationTime;
+            }
+        } else if(info->isLazy){
+            initialization = formatR("{:>10}", _("deferred"));
+        }
+        mout->put(formatR(" {0:<24}{1:10.1f}{2}\n", info->name, info->loadingTime, initialization));
+        totalLoadingTime += info->loadingTime;
+    }
+    mout->put(formatR(" {0:<24}{1:10.1f}{2:10.1f}\n", _("Total at startup"), totalLoadingTime, totalInitializationTime));
+}
+
+
 bool PluginManager::reloadPlugin(const std::string& name)
 {
     return impl->unloadPlugin(name, true);
@@ -825,7 +1155,8 @@ void PluginManager::Impl::clearUnusedPlugins()
 
     for(size_t i=0; i < oldList.size(); ++i){
         PluginInfoPtr& info = oldList[i];
-        if(info->status == PluginManager::ACTIVE){
+        if(info->status == PluginManager::ACTIVE ||
+           (info->status == PluginManager::LOADED && info->isLazy)){
             allPluginInfos.push_back(info);
         } else {
             pathToPluginInfoMap.erase(info->pathString);
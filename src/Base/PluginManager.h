@@ -45,6 +45,25 @@ public:
     const std::string& getErrorMessage(const std::string& name);
     const char* guessActualPluginName(const std::string& name);
 
+    /**
+       The following functions activate a plugin which is activated lazily. The first two
+       functions activate the plugin which declares the class. The module name can be the name
+       or an old name of the plugin, and any plugin declaring the class is activated when the
+       module name does not match.
+       \return true if a plugin has been activated
+    */
+    bool activatePluginForItemClass(const std::string& moduleName, const std::string& className);
+    bool activatePluginForViewClass(const std::string& moduleName, const std::string& className);
+    bool activatePluginsForInputFile(const std::string& filename);
+    bool activatePluginOnDemand(const std::string& name);
+
+    /**
+       This function outputs the time spent to load and initialize each plugin to the message output.
+       The output is also done after the startup loading when "profile_startup" of the PluginManager
+       config is true.
+    */
+    void putProfile();
+
     void showDialogToLoadPlugin();
 	
 private:
@@ -27,6 +27,8 @@ class PointSetItemPcdFileIo : public ItemFileIoBase<PointSetItem>
 public:
     PointSetItemPcdFileIo();
     virtual bool load(PointSetItem* item, const std::string& filename) override;
+    virtual std::function<ReferencedPtr(std::ostream& os)> getPreloadingFunction(
+        const std::string& filename, const Mapping* options) override;
     virtual bool save(PointSetItem* item, const std::string& filename) override;
 };
 
@@ -131,8 +133,17 @@ PointSetItemPcdFileIo::PointSetItemPcdFileIo()
 bool PointSetItemPcdFileIo::load(PointSetItem* item, const std::string& filename)
 {
     try {
-        cnoid::loadPCD(item->pointSet(), filename);
-        os() << item->pointSet()->vertices()->size() << " points have been loaded.";
+        auto pointSet = item->pointSet();
+        if(auto preloaded = dynamic_cast<SgPointSet*>(preloadedObject())){
+            pointSet->setVertices(preloaded->vertices());
+            pointSet->setNormals(preloaded->normals());
+            pointSet->normalIndices().clear();
+            pointSet->setColors(preloaded->colors());
+            pointSet->colorIndices().clear();
+        } else {
+            cnoid::loadPCD(pointSet, filename);
+        }
+        os() << pointSet->vertices()->size() << " points have been loaded.";
         auto itype = currentInvocationType();
         if(itype == Dialog || itype == DragAndDrop){
             item->setChecked(true);
@@ -145,6 +156,22 @@ bool PointSetItemPcdFileIo::load(PointSetItem* item, const std::string& filename
 }
 
 
+std::function<ReferencedPtr(std::ostream& os)> PointSetItemPcdFileIo::getPreloadingFunction
+(const std::string& filename, const Mapping* /* options */)
+{
+    return [filename](std::ostream& /* os */) -> ReferencedPtr {
+        SgPointSetPtr pointSet = new SgPointSet;
+        try {
+            cnoid::loadPCD(pointSet, filename);
+        } catch (const std::exception&) {
+            // The error is reported when the file is loaded again by the load function
+            return nullptr;
+        }
+        return pointSet;
+    };
+}
+
+
 bool PointSetItemPcdFileIo::save(PointSetItem* item, const std::string& filename)
 {
     try {
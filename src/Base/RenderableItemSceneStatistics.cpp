@@ -3,6 +3,9 @@
 #include "RootItem.h"
 #include "ItemList.h"
 #include "MessageView.h"
+#include "SceneView.h"
+#include "SceneWidget.h"
+#include <cnoid/GLSLSceneRenderer>
 #include <cnoid/SceneDrawables>
 #include <cnoid/PolymorphicSceneNodeFunctionSet>
 #include <cnoid/Format>
@@ -98,4 +101,20 @@ void cnoid::putRenderableItemSceneStatistics()
         os << formatR(_(" Normals: {}\n"), totalNumNormals);
         os << formatR(_(" Triangles: {}"), totalNumTriangles) << endl;
     }
+
+    for(auto view : SceneView::instances()){
+        if(auto renderer = dynamic_cast<GLSLSceneRenderer*>(view->sceneWidget()->renderer())){
+            auto& stat = renderer->renderingStatistics();
+            os << formatR(_("Last rendering in \"{}\":\n"), view->name());
+            if(!renderer->isFrustumCullingEnabled()){
+                os << _(" Frustum culling: disabled\n");
+            }
+            os << formatR(_(" Rendered shapes: {}\n"), stat.numRenderedShapes);
+            os << formatR(_(" Culled shapes: {}\n"), stat.numCulledShapes);
+            os << formatR(_(" Culled transforms: {}\n"), stat.numCulledTransforms);
+            os << formatR(_(" Instanced shapes: {}\n"), stat.numInstancedShapes);
+            os << formatR(_(" Simplified shapes: {}\n"), stat.numLevelOfDetailShapes);
+            os << formatR(_(" Draw calls: {}"), stat.numDrawCalls) << endl;
+        }
+    }
 }
@@ -6,7 +6,7 @@
 #include "CheckBox.h"
 #include "SpinBox.h"
 #include "DoubleSpinBox.h"
-#include <cnoid/GLSceneRenderer>
+#include <cnoid/GLSLSceneRenderer>
 #include <cnoid/SceneLights>
 #include <cnoid/Selection>
 #include <cnoid/ValueTree>
@@ -68,6 +68,7 @@ public:
     DoubleSpinBox* pointSizeSpin;
     DoubleSpinBox* lineWidthSpin;
     CheckBox* upsideDownCheck;
+    CheckBox* frustumCullingCheck;
 
     vector<QObject*> signalObjects;
 
@@ -112,6 +113,7 @@ public:
     bool isTextureEnabled;
     bool isFogEnabled;
     bool isUpsideDownEnabled;
+    bool isFrustumCullingEnabled;
     
     double headLightIntensity;
     double worldLightIntensity;
@@ -190,6 +192,7 @@ SceneRendererConfig::Impl::Impl(SceneRendererConfig* self)
     isTextureEnabled = true;
     isFogEnabled = true;
     isUpsideDownEnabled = false;
+    isFrustumCullingEnabled = false;
 
     headLightIntensity = 0.5;
     worldLightIntensity = 0.5;
@@ -232,6 +235,7 @@ SceneRendererConfig::Impl::Impl(const Impl& org, SceneRendererConfig* self)
     isTextureEnabled = org.isTextureEnabled;
     isFogEnabled = org.isFogEnabled;
     isUpsideDownEnabled = org.isUpsideDownEnabled;
+    isFrustumCullingEnabled = org.isFrustumCullingEnabled;
 
     headLightIntensity = org.headLightIntensity;
     worldLightIntensity = org.worldLightIntensity;
@@ -351,6 +355,9 @@ void SceneRendererConfig::Impl::updateRenderer(GLSceneRenderer* renderer, unsign
         renderer->setDefaultColor(defaultColor);
         renderer->setDefaultPointSize(pointSize);
         renderer->setDefaultLineWidth(lineWidth);
+        if(auto glslRenderer = dynamic_cast<GLSLSceneRenderer*>(renderer)){
+            glslRenderer->setFrustumCullingEnabled(isFrustumCullingEnabled);
+        }
     }
 
     if(categories & Effect){
@@ -437,6 +444,9 @@ bool SceneRendererConfig::Impl::store(Mapping* archive)
     if(isUpsideDownEnabled){
         archive->write("upside_down", true);
     }
+    if(isFrustumCullingEnabled){
+        archive->write("frustum_culling", true);
+    }
 
     return true;
 }
@@ -550,6 +560,7 @@ bool SceneRendererConfig::Impl::restore(const Mapping* archive)
     archive->read({ "line_width", "lineWidth" }, lineWidth);
     archive->read({ "point_size", "pointSize" }, pointSize);
     isUpsideDownEnabled = archive->get({ "upside_down", "upsideDown" }, false);
+    isFrustumCullingEnabled = archive->get("frustum_culling", false);
 
     if(widgetSet){
         widgetSet->updateWidgets();
@@ -624,6 +635,12 @@ CheckBox* SceneRendererConfig::upsideDownCheck()
 }
 
 
+CheckBox* SceneRendererConfig::frustumCullingCheck()
+{
+    return impl->widgetSet->frustumCullingCheck;
+}
+
+
 void SceneRendererConfig::updateConfigWidgets()
 {
     if(impl->widgetSet){
@@ -897,6 +914,14 @@ ConfigWidgetSet::ConfigWidgetSet(SceneRendererConfig::Impl* config_)
         });
     signalObjects.push_back(upsideDownCheck);
 
+    frustumCullingCheck = new CheckBox(_("Frustum culling"), ownerWidget);
+    frustumCullingCheck->sigToggled().connect(
+        [this](bool on){
+            config->isFrustumCullingEnabled = on;
+            config->updateRenderers(Drawing, true);
+        });
+    signalObjects.push_back(frustumCullingCheck);
+
     updateWidgets();
 }
 
@@ -1014,6 +1039,7 @@ void ConfigWidgetSet::updateWidgets()
     lineWidthSpin->setValue(config->lineWidth);
     pointSizeSpin->setValue(config->pointSize);
     upsideDownCheck->setChecked(config->isUpsideDownEnabled);
+    frustumCullingCheck->setChecked(config->isFrustumCullingEnabled);
 
     for(auto& obj : signalObjects){
         obj->blockSignals(false);
@@ -1065,4 +1091,9 @@ ConfigDialog::ConfigDialog(SceneRendererConfig::Impl* config)
     hbox->addWidget(ws->pointSizeSpin);
     hbox->addStretch();
     vbox->addLayout(hbox);
+
+    hbox = new QHBoxLayout;
+    hbox->addWidget(ws->frustumCullingCheck);
+    hbox->addStretch();
+    vbox->addLayout(hbox);
 }
@@ -49,6 +49,7 @@ protected:
     DoubleSpinBox* pointSizeSpin();
     DoubleSpinBox* lineWidthSpin();
     CheckBox* upsideDownCheck();
+    CheckBox* frustumCullingCheck();
 
 private:
     Impl* impl;
@@ -21,6 +21,7 @@
 #include <cnoid/CoordinateAxesOverlay>
 #include <cnoid/ConnectionSet>
 #include <cnoid/Format>
+#include <cnoid/Tracer>
 #include <QOpenGLWidget>
 #include <QKeyEvent>
 #include <QMouseEvent>
@@ -855,6 +856,9 @@ void SceneWidget::Impl::paintGL()
         cout << "SceneWidget::Impl::paintGL() " << counter++ << endl;
     }
 
+    static const int paintTraceId = Tracer::registerName("sceneWidget/paintGL");
+    ScopedTrace trace(paintTraceId);
+
     auto newFramebuffer = defaultFramebufferObject();
     if(newFramebuffer != prevDefaultFramebufferObject){
         /**
@@ -75,6 +75,7 @@ public:
     DoubleSpinBox* lineWidthSpin;
     DoubleSpinBox* pointSizeSpin;;
     CheckBox* upsideDownCheck;
+    CheckBox* frustumCullingCheck;
 
     vector<QObject*> signalObjects;
 
@@ -464,6 +465,7 @@ ConfigWidgetSet* SceneWidgetConfig::Impl::getOrCreateConfigWidgetSet()
         widgetSet->lineWidthSpin = self->lineWidthSpin();
         widgetSet->pointSizeSpin = self->pointSizeSpin();
         widgetSet->upsideDownCheck = self->upsideDownCheck();
+        widgetSet->frustumCullingCheck = self->frustumCullingCheck();
     }
     return widgetSet;
 }
@@ -837,6 +839,7 @@ QWidget* ConfigWidgetSet::createDrawingPanel()
     hbox->addWidget(normalVisualizationCheck);
     hbox->addWidget(normalLengthSpin);
     hbox->addWidget(lightweightViewChangeCheck);
+    hbox->addWidget(frustumCullingCheck);
     hbox->addWidget(fpsTestButton);
     hbox->addWidget(fpsTestIterationSpin);
     hbox->addStretch();
@@ -8,6 +8,7 @@
 #include "Buttons.h"
 #include "CheckBox.h"
 #include "Dialog.h"
+#include <cnoid/SceneUpdate>
 #include <QDialogButtonBox>
 #include <QElapsedTimer>
 #include <cmath>
@@ -846,6 +847,8 @@ bool TimeBar::Impl::setTime
     bool doExpansion = options & Expand;
     bool isWithinTimeRange = setTimeBarTime(newTime, doExpansion, calledFromPlaybackLoop, callerWidget);
     if(isWithinTimeRange || calledFromPlaybackLoop){
+        // The scene updates of all the items following the time are notified at once
+        SgUpdateBatchScope sceneUpdateBatch;
         sigTimeChanged.emitAndGetAllResults(self->time_, playbackContinueFlags);
         for(auto flag : playbackContinueFlags){
             if(flag){
@@ -549,6 +549,10 @@ ViewClassImpl* findViewClassImpl(const std::string& moduleName, const std::strin
             info = it2->second;
         }
     }
+
+    if(!info && PluginManager::instance()->activatePluginForViewClass(moduleName, *pActualClassName)){
+        return findViewClassImpl(moduleName, *pActualClassName, false);
+    }
     
     return info;
 }
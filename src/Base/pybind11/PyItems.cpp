@@ -96,6 +96,7 @@ void exportPyItems(py::module m)
         .def("notifyUpdate", &Item::notifyUpdate)
         .def_property_readonly("sigNameChanged", &Item::sigNameChanged)
         .def_property_readonly("sigUpdated", &Item::sigUpdated)
+        .def("estimateMemoryUsage", &Item::estimateMemoryUsage)
         .def_property_readonly("sigTreePathChanged", &Item::sigTreePositionChanged)
         .def_property_readonly("sigTreePositionChanged", &Item::sigTreePositionChanged)
         .def_property_readonly("sigDisconnectedFromRoot", &Item::sigDisconnectedFromRoot)
@@ -13,6 +13,8 @@
 #include <cnoid/stdx/filesystem>
 #include <map>
 #include <set>
+#include <mutex>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 
@@ -43,11 +45,18 @@ inline void* resolveDllSymbol(DllHandle handle, const char* symbol) { return dls
 inline void unloadDll(DllHandle handle) { dlclose(handle); }
 #endif
 
+/*
+  The bodies may be loaded concurrently by the preloading threads of the item file IO,
+  so the repository and the directories are accessed with the lock
+*/
 typedef std::map<std::string, BodyCustomizerInterface*> NameToInterfaceMap;
 NameToInterfaceMap customizerRepository;
-bool pluginLoadingFunctionsCalled = false;
+std::mutex customizerRepositoryMutex;
+std::atomic<bool> pluginLoadingFunctionsCalled(false);
 
 set<string> customizerDirectories;
+std::mutex customizerDirectoriesMutex;
+std::once_flag defaultBodyCustomizersLoadingFlag;
 
 }
 
@@ -93,6 +102,7 @@ static bool loadCustomizerDll
                         }
                         string name(names[i]);
                         if(!name.empty()){
+                            std::lock_guard<std::mutex> lock(customizerRepositoryMutex);
                             customizerRepository[name] = customizerInterface;
                         }
                         modelNames += name;
@@ -163,9 +173,7 @@ static int loadBodyCustomizers(BodyInterface* bodyInterface, std::ostream& os)
 {
     int numLoaded = 0;
 
-    if(!pluginLoadingFunctionsCalled){
-
-        pluginLoadingFunctionsCalled = true;
+    if(!pluginLoadingFunctionsCalled.exchange(true)){
         
         char* pathListEnv = getenv("CNOID_CUSTOMIZER_PATH");
         if(pathListEnv){
@@ -175,7 +183,12 @@ static int loadBodyCustomizers(BodyInterface* bodyInterface, std::ostream& os)
             }
         }
 
-        for(auto& dir : customizerDirectories){
+        set<string> directories;
+        {
+            std::lock_guard<std::mutex> lock(customizerDirectoriesMutex);
+            directories = customizerDirectories;
+        }
+        for(auto& dir : directories){
             numLoaded += ::loadBodyCustomizers(bodyInterface, dir, os);
         }
     }
@@ -190,12 +203,11 @@ static int loadBodyCustomizers(BodyInterface* bodyInterface, std::ostream& os)
 */
 int cnoid::loadDefaultBodyCustomizers(std::ostream& os)
 {
-    static bool loaded = false;
     int numLoaded = 0;
-    if(!loaded){
-        numLoaded = ::loadBodyCustomizers(Body::bodyInterface(), os);
-        loaded = true;
-    }
+    // The other threads calling this function wait until the customizers are loaded
+    std::call_once(
+        defaultBodyCustomizersLoadingFlag,
+        [&](){ numLoaded = ::loadBodyCustomizers(Body::bodyInterface(), os); });
     return numLoaded;
 }
 
@@ -204,6 +216,7 @@ BodyCustomizerInterface* cnoid::findBodyCustomizer(std::string modelName)
 {
     BodyCustomizerInterface* customizerInterface = 0;
 
+    std::lock_guard<std::mutex> lock(customizerRepositoryMutex);
     NameToInterfaceMap::iterator p = customizerRepository.find(modelName);
     if(p != customizerRepository.end()){
         customizerInterface = p->second;
@@ -215,5 +228,6 @@ BodyCustomizerInterface* cnoid::findBodyCustomizer(std::string modelName)
 
 void Body::addCustomizerDirectory(const std::string& path)
 {
+    std::lock_guard<std::mutex> lock(customizerDirectoriesMutex);
     customizerDirectories.insert(path);
 }
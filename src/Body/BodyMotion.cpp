@@ -112,6 +112,16 @@ void BodyMotion::setNumFrames(int n, bool fillNewElements)
 }
 
 
+size_t BodyMotion::estimateMemoryUsage() const
+{
+    size_t size = stateSeq_->estimateMemoryUsage();
+    for(auto& kv : extraSeqs){
+        size += kv.second->estimateMemoryUsage();
+    }
+    return size;
+}
+
+
 double BodyMotion::getOffsetTime() const
 {
     return stateSeq_->offsetTime();
@@ -36,6 +36,7 @@ public:
     int numFrames() const { return stateSeq_->numFrames(); }
     virtual int getNumFrames() const override;
     virtual void setNumFrames(int n, bool fillNewElements = false) override;
+    virtual size_t estimateMemoryUsage() const override;
 
     std::shared_ptr<BodyStateSeq> stateSeq() { return stateSeq_; }
     std::shared_ptr<const BodyStateSeq> stateSeq() const { return stateSeq_; }
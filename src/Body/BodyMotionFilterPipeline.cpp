@@ -0,0 +1,286 @@
+#include "BodyMotionFilterPipeline.h"
+#include "BodyMotion.h"
+#include "Body.h"
+#include <cnoid/ThreadPool>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+//! Interval of calling the progress function in milliseconds
+constexpr int ProgressNotificationInterval = 100;
+
+}
+
+namespace cnoid {
+
+class BodyMotionFilterPipeline::Impl
+{
+public:
+    struct FilterInfo
+    {
+        Filter filter;
+        LocalFilter localFilter;
+        double leadingMarginTime;
+        double trailingMarginTime;
+    };
+    vector<FilterInfo> filters;
+    int numThreads;
+    double chunkTimeLength;
+    std::function<void(double ratio)> progressFunction;
+    std::atomic<bool> isCanceled;
+
+    std::atomic<int> numProcessedFrames;
+    std::mutex chunkMutex;
+    std::condition_variable chunkCondition;
+    int numFinishedChunks;
+
+    Impl();
+    bool apply(Body* body, BodyMotion& motion);
+    bool applyLocalFilter(FilterInfo& info, int filterIndex, Body* body, BodyMotion& motion);
+    void makeChunks(FilterInfo& info, const BodyMotion& motion, vector<Chunk>& out_chunks);
+    void notifyProgress(int filterIndex, double filterProgressRatio);
+};
+
+}
+
+
+BodyMotionFilterPipeline::BodyMotionFilterPipeline()
+{
+    impl = new Impl;
+}
+
+
+BodyMotionFilterPipeline::Impl::Impl()
+{
+    numThreads = 1;
+    chunkTimeLength = 5.0;
+    isCanceled = false;
+}
+
+
+BodyMotionFilterPipeline::~BodyMotionFilterPipeline()
+{
+    delete impl;
+}
+
+
+void BodyMotionFilterPipeline::clearFilters()
+{
+    impl->filters.clear();
+    impl->isCanceled = false;
+}
+
+
+void BodyMotionFilterPipeline::addFilter(Filter filter)
+{
+    Impl::FilterInfo info;
+    info.filter = filter;
+    info.leadingMarginTime = 0.0;
+    info.trailingMarginTime = 0.0;
+    impl->filters.push_back(info);
+    impl->isCanceled = false;
+}
+
+
+void BodyMotionFilterPipeline::addLocalFilter
+(double leadingMarginTime, double trailingMarginTime, LocalFilter filter)
+{
+    Impl::FilterInfo info;
+    info.localFilter = filter;
+    info.leadingMarginTime = std::max(0.0, leadingMarginTime);
+    info.trailingMarginTime = std::max(0.0, trailingMarginTime);
+    impl->filters.push_back(info);
+    impl->isCanceled = false;
+}
+
+
+int BodyMotionFilterPipeline::numFilters() const
+{
+    return impl->filters.size();
+}
+
+
+void BodyMotionFilterPipeline::setNumThreads(int n)
+{
+    impl->numThreads = std::max(1, n);
+}
+
+
+int BodyMotionFilterPipeline::numThreads() const
+{
+    return impl->numThreads;
+}
+
+
+void BodyMotionFilterPipeline::setChunkTimeLength(double time)
+{
+    impl->chunkTimeLength = time;
+}
+
+
+void BodyMotionFilterPipeline::setProgressFunction(std::function<void(double ratio)> func)
+{
+    impl->progressFunction = func;
+}
+
+
+void BodyMotionFilterPipeline::cancel()
+{
+    impl->isCanceled = true;
+}
+
+
+bool BodyMotionFilterPipeline::isCanceled() const
+{
+    return impl->isCanceled;
+}
+
+
+bool BodyMotionFilterPipeline::apply(Body* body, BodyMotion& motion)
+{
+    return impl->apply(body, motion);
+}
+
+
+bool BodyMotionFilterPipeline::Impl::apply(Body* body, BodyMotion& motion)
+{
+    const int numFilters = filters.size();
+    for(int i=0; i < numFilters; ++i){
+        if(isCanceled){
+            return false;
+        }
+        notifyProgress(i, 0.0);
+        auto& info = filters[i];
+        bool result;
+        if(info.filter){
+            result = info.filter(body, motion);
+        } else {
+            result = applyLocalFilter(info, i, body, motion);
+        }
+        if(!result || isCanceled){
+            return false;
+        }
+    }
+    notifyProgress(numFilters, 0.0);
+
+    return true;
+}
+
+
+bool BodyMotionFilterPipeline::Impl::applyLocalFilter
+(FilterInfo& info, int filterIndex, Body* body, BodyMotion& motion)
+{
+    const int numFrames = motion.numFrames();
+    if(numFrames == 0){
+        return true;
+    }
+
+    vector<Chunk> chunks;
+    makeChunks(info, motion, chunks);
+    const int numChunks = chunks.size();
+
+    // The input frames must not be affected by the output of the other chunks
+    BodyMotion input(motion);
+
+    if(numThreads == 1 || numChunks == 1){
+        for(auto& chunk : chunks){
+            if(isCanceled){
+                return false;
+            }
+            BodyPtr chunkBody = body->clone();
+            if(!info.localFilter(chunkBody, input, motion, chunk)){
+                return false;
+            }
+            notifyProgress(filterIndex, static_cast<double>(chunk.outputEndingFrame + 1) / numFrames);
+        }
+        return true;
+    }
+
+    vector<BodyPtr> bodies(numChunks);
+    for(int i=0; i < numChunks; ++i){
+        bodies[i] = body->clone();
+    }
+    vector<char> results(numChunks, 0);
+    numProcessedFrames = 0;
+    numFinishedChunks = 0;
+
+    ThreadPool threadPool(std::min(numThreads, numChunks));
+
+    for(int i=0; i < numChunks; ++i){
+        threadPool.start(
+            [this, &info, &input, &motion, &bodies, &chunks, &results, i](){
+                auto& chunk = chunks[i];
+                if(!isCanceled){
+                    results[i] = info.localFilter(bodies[i], input, motion, chunk);
+                }
+                numProcessedFrames += chunk.outputEndingFrame - chunk.outputBeginningFrame + 1;
+                {
+                    std::lock_guard<std::mutex> lock(chunkMutex);
+                    ++numFinishedChunks;
+                }
+                chunkCondition.notify_all();
+            });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(chunkMutex);
+        while(numFinishedChunks < numChunks){
+            chunkCondition.wait_for(lock, std::chrono::milliseconds(ProgressNotificationInterval));
+            if(progressFunction){
+                lock.unlock();
+                notifyProgress(filterIndex, static_cast<double>(numProcessedFrames) / numFrames);
+                lock.lock();
+            }
+        }
+    }
+    threadPool.wait();
+
+    for(auto& result : results){
+        if(!result){
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void BodyMotionFilterPipeline::Impl::makeChunks
+(FilterInfo& info, const BodyMotion& motion, vector<Chunk>& out_chunks)
+{
+    const int numFrames = motion.numFrames();
+    const double frameRate = motion.frameRate();
+    const int leadingMargin = static_cast<int>(std::ceil(info.leadingMarginTime * frameRate));
+    const int trailingMargin = static_cast<int>(std::ceil(info.trailingMarginTime * frameRate));
+
+    // The chunks only depend on the motion so that the result does not depend on the threads
+    const int numChunkFrames = std::max(1, static_cast<int>(std::round(chunkTimeLength * frameRate)));
+    const int numChunks = (numFrames + numChunkFrames - 1) / numChunkFrames;
+
+    out_chunks.resize(numChunks);
+    int index = 0;
+    for(int i=0; i < numChunks; ++i){
+        const int size = std::min(numChunkFrames, numFrames - index);
+        auto& chunk = out_chunks[i];
+        chunk.outputBeginningFrame = index;
+        chunk.outputEndingFrame = index + size - 1;
+        chunk.beginningFrame = std::max(0, chunk.outputBeginningFrame - leadingMargin);
+        chunk.endingFrame = std::min(numFrames - 1, chunk.outputEndingFrame + trailingMargin);
+        index += size;
+    }
+}
+
+
+void BodyMotionFilterPipeline::Impl::notifyProgress(int filterIndex, double filterProgressRatio)
+{
+    if(progressFunction && !filters.empty()){
+        progressFunction((filterIndex + filterProgressRatio) / filters.size());
+    }
+}
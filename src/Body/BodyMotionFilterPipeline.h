@@ -0,0 +1,99 @@
+#ifndef CNOID_BODY_BODY_MOTION_FILTER_PIPELINE_H
+#define CNOID_BODY_BODY_MOTION_FILTER_PIPELINE_H
+
+#include <functional>
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class Body;
+class BodyMotion;
+
+/**
+   This class applies a sequence of filters to a body motion. A filter whose output frame only
+   depends on the input frames in a limited time window around it can be registered as a local
+   filter. A local filter is applied to the chunks of the frames concurrently when the number of
+   threads is more than one. The chunks do not depend on the number of threads, so the result of
+   the pipeline is the same on any machine.
+*/
+class CNOID_EXPORT BodyMotionFilterPipeline
+{
+public:
+    BodyMotionFilterPipeline();
+    ~BodyMotionFilterPipeline();
+
+    BodyMotionFilterPipeline(const BodyMotionFilterPipeline& org) = delete;
+    BodyMotionFilterPipeline& operator=(const BodyMotionFilterPipeline& rhs) = delete;
+
+    //! The filter is applied to the whole motion in the calling thread of the apply function.
+    typedef std::function<bool(Body* body, BodyMotion& motion)> Filter;
+
+    /**
+       The frame range of a chunk. The frames from outputBeginningFrame to outputEndingFrame
+       must be written to the output motion, and the input frames from beginningFrame to
+       endingFrame, which include the margins of the window, can be read.
+    */
+    struct Chunk
+    {
+        int beginningFrame;
+        int endingFrame;
+        int outputBeginningFrame;
+        int outputEndingFrame;
+    };
+
+    /**
+       The input motion is a copy of the motion before the filter is applied, and the output
+       motion is the motion given to the apply function. The body is a clone dedicated to the chunk.
+    */
+    typedef std::function<bool(Body* body, const BodyMotion& input, BodyMotion& output, const Chunk& chunk)> LocalFilter;
+
+    void clearFilters();
+    void addFilter(Filter filter);
+
+    /**
+       \param leadingMarginTime Time length of the input frames required before each output frame
+       \param trailingMarginTime Time length of the input frames required after each output frame
+    */
+    void addLocalFilter(double leadingMarginTime, double trailingMarginTime, LocalFilter filter);
+
+    int numFilters() const;
+
+    //! The chunks of the local filters are processed one by one in the calling thread when the number is one.
+    void setNumThreads(int n);
+    int numThreads() const;
+
+    /**
+       The time length of the output frames of a chunk. The last chunk may be shorter.
+       The default value is 5 seconds.
+    */
+    void setChunkTimeLength(double time);
+
+    /**
+       The function is called in the calling thread of the apply function while the filters are being
+       applied. The argument is the ratio of the progress of the whole pipeline from 0.0 to 1.0.
+    */
+    void setProgressFunction(std::function<void(double ratio)> func);
+
+    /**
+       This function can be called from the progress function or from another thread.
+       The chunks which have already been started are completed. The cancel request made before
+       the apply function is called is also effective. The canceled state is kept after the apply
+       function returns, and it is cleared when the filters are cleared or a filter is added.
+    */
+    void cancel();
+    bool isCanceled() const;
+
+    /**
+       \return false if a filter fails or the process is canceled. Note that the motion may be
+       partially modified in the case.
+    */
+    bool apply(Body* body, BodyMotion& motion);
+
+private:
+    class Impl;
+    Impl* impl;
+};
+
+}
+
+#endif
@@ -89,6 +89,18 @@ BodyState::BodyState(const Body& body)
 }
 
 
+size_t BodyState::estimateMemoryUsage(std::unordered_set<const DeviceState*>& countedDeviceStates) const
+{
+    size_t size = data.capacity() * sizeof(double) + deviceData.capacity() * sizeof(DeviceStatePtr);
+    for(auto& state : deviceData){
+        if(state && countedDeviceStates.insert(state.get()).second){
+            size += state->estimateMemoryUsage();
+        }
+    }
+    return size;
+}
+
+
 void BodyState::storeStateOfBody(const Body* body)
 {
     allocate(body->numLinks(), body->numJoints(), body->numDevices());
@@ -4,6 +4,7 @@
 #include "Device.h"
 #include <cnoid/EigenTypes>
 #include <vector>
+#include <unordered_set>
 #include <algorithm>
 #include "exportdecl.h"
 
@@ -352,6 +353,13 @@ public:
         deviceData[index] = state;
     }
 
+    /**
+       An estimate of the bytes used by the state. The device states contained in countedDeviceStates
+       are skipped, and the counted device states are inserted into it so that the device states shared
+       by multiple frames can be counted only once.
+    */
+    size_t estimateMemoryUsage(std::unordered_set<const DeviceState*>& countedDeviceStates) const;
+
     void storeStateOfBody(const Body* body);
     bool restoreStateToBody(Body* body) const;
 
@@ -27,3 +27,16 @@ std::shared_ptr<AbstractSeq> BodyStateSeq::cloneSeq() const
 {
     return make_shared<BodyStateSeq>(*this);
 }
+
+
+size_t BodyStateSeq::estimateMemoryUsage() const
+{
+    // A device state is shared by the frames until the state changes
+    std::unordered_set<const DeviceState*> countedDeviceStates;
+    size_t size = 0;
+    const int n = numFrames();
+    for(int i=0; i < n; ++i){
+        size += sizeof(BodyState) + frame(i).estimateMemoryUsage(countedDeviceStates);
+    }
+    return size;
+}
@@ -23,6 +23,7 @@ public:
     BodyStateSeq(const BodyStateSeq& org);
 
     virtual std::shared_ptr<AbstractSeq> cloneSeq() const override;
+    virtual size_t estimateMemoryUsage() const override;
 
     int numLinkPositionsHint() const { return numLinkPositionsHint_; }
     void setNumLinkPositionsHint(int n) { numLinkPositionsHint_ = n; }
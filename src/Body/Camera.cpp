@@ -181,6 +181,13 @@ int Camera::stateSize() const
 }
 
 
+size_t Camera::estimateMemoryUsage() const
+{
+    return VisionSensor::estimateMemoryUsage() +
+        static_cast<size_t>(image_->width()) * image_->height() * image_->numComponents();
+}
+
+
 const double* Camera::readState(const double* buf)
 {
     buf = VisionSensor::readState(buf);
@@ -76,6 +76,7 @@ public:
     virtual int stateSize() const override;
     virtual const double* readState(const double* buf) override;
     virtual double* writeState(double* out_buf) const override;
+    virtual size_t estimateMemoryUsage() const override;
 
     bool readSpecifications(const Mapping* info);
     bool writeSpecifications(Mapping* info) const;
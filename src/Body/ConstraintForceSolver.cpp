@@ -13,6 +13,7 @@
 #include <cnoid/EigenUtil>
 #include <cnoid/CloneMap>
 #include <cnoid/TimeMeasure>
+#include <cnoid/PhaseProfiler>
 #include <cnoid/Format>
 #include <cnoid/stdx/clamp>
 #include <random>
@@ -247,6 +248,9 @@ public:
     // contact force solution: normal forces at contact points
     VectorX solution;
 
+    // The solution given from the outside to restore the warm start state
+    VectorX warmStartSolution;
+
     // random number generator
     std::uniform_real_distribution<double> randomAngle;
     std::mt19937 randomEngine;
@@ -643,6 +647,9 @@ ConstraintForceSolver::Impl::createContactMaterialFromMaterialPair(int material1
 
 void ConstraintForceSolver::Impl::solve()
 {
+    static const int collisionPhase = PhaseProfiler::registerPhase("aist/collision");
+    static const int constraintPhase = PhaseProfiler::registerPhase("aist/constraint");
+    
     if(CFS_DEBUG){
         os << "Time: " << world.currentTime() << std::endl;
     }
@@ -656,15 +663,21 @@ void ConstraintForceSolver::Impl::solve()
         }
     }
 
-    bodyCollisionDetector.updatePositions();
+    {
+        ScopedPhaseTimer timer(collisionPhase);
+        
+        bodyCollisionDetector.updatePositions();
 
-    globalNumConstraintVectors = 0;
-    globalNumFrictionVectors = 0;
-    areThereImpacts = false;
+        globalNumConstraintVectors = 0;
+        globalNumFrictionVectors = 0;
+        areThereImpacts = false;
 
-    constrainedLinkPairs.clear();
+        constrainedLinkPairs.clear();
 
-    setConstraintPoints();
+        setConstraintPoints();
+    }
+
+    ScopedPhaseTimer constraintTimer(constraintPhase);
 
     if(CFS_PUT_NUM_CONTACT_POINTS){
         cout << globalNumContactNormalVectors;
@@ -711,7 +724,9 @@ void ConstraintForceSolver::Impl::solve()
 #ifdef USE_PIVOTING_LCP
         isConverged = callPathLCPSolver(Mlcp, b, solution);
 #else
-        if(!USE_PREVIOUS_LCP_SOLUTION || constraintsSizeChanged){
+        if(warmStartSolution.size() == solution.size()){
+            solution = warmStartSolution;
+        } else if(!USE_PREVIOUS_LCP_SOLUTION || constraintsSizeChanged){
             solution.setZero();
         }
         solveMCPByProjectedGaussSeidel(Mlcp, b, solution);
@@ -736,6 +751,7 @@ void ConstraintForceSolver::Impl::solve()
 
     prevGlobalNumConstraintVectors = globalNumConstraintVectors;
     prevGlobalNumFrictionVectors = globalNumFrictionVectors;
+    warmStartSolution.resize(0);
 }
 
 
@@ -2354,6 +2370,22 @@ shared_ptr<CollisionLinkPairList> ConstraintForceSolver::getCollisions()
 }
 
 
+void ConstraintForceSolver::getWarmStartSolution(VectorX& out_solution) const
+{
+    if(impl->prevGlobalNumConstraintVectors > 0){
+        out_solution = impl->solution;
+    } else {
+        out_solution.resize(0);
+    }
+}
+
+
+void ConstraintForceSolver::setWarmStartSolution(const VectorX& solution)
+{
+    impl->warmStartSolution = solution;
+}
+
+
 shared_ptr<CollisionLinkPairList> ConstraintForceSolver::Impl::getCollisions()
 {
     auto collisionPairs = std::make_shared<CollisionLinkPairList>();
@@ -2,6 +2,7 @@
 #define CNOID_BODY_CONSTRAINT_FORCE_SOLVER_H
 
 #include "CollisionLinkPairList.h"
+#include <cnoid/EigenTypes>
 #include "exportdecl.h"
 
 namespace cnoid {
@@ -61,6 +62,14 @@ public:
 
     std::shared_ptr<CollisionLinkPairList> getCollisions();
 
+    /**
+       The solution of the last step, which is used as the initial value of the iterative solver
+       in the next step. The solution given by setWarmStartSolution is used in the next step if its
+       dimension matches the constraints of the step.
+    */
+    void getWarmStartSolution(VectorX& out_solution) const;
+    void setWarmStartSolution(const VectorX& solution);
+
     // experimental functions
     typedef std::function<bool(Link* link1, Link* link2,
                                const std::vector<Collision>& collisions,
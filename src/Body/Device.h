@@ -46,6 +46,12 @@ public:
        The value is used when the super class's readState is called by the inherited class.
     */
     virtual double* writeState(double* out_buf) const = 0;
+
+    /**
+       An estimate of the bytes used by the state. The data shared with other states such as
+       an image is also included.
+    */
+    virtual size_t estimateMemoryUsage() const { return stateSize() * sizeof(double); }
 };
 typedef ref_ptr<DeviceState> DeviceStatePtr;
 
@@ -1,4 +1,5 @@
 #include "DyWorld.h"
+#include <cnoid/PhaseProfiler>
 
 using namespace std;
 using namespace cnoid;
@@ -105,6 +106,9 @@ void DyWorldBase::setVirtualJointForces()
 
 void DyWorldBase::calcNextState()
 {
+    static const int integrationPhase = PhaseProfiler::registerPhase("aist/integration");
+    ScopedPhaseTimer timer(integrationPhase);
+    
     for(auto& subBody : subBodies_){
         subBody->forwardDynamics()->calcNextState();
     }
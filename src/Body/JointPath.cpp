@@ -5,10 +5,21 @@
 #include "BodyCustomizerInterface.h"
 #include <cnoid/EigenUtil>
 #include <cnoid/TruncatedSVD>
+#include <chrono>
 
 using namespace std;
 using namespace cnoid;
 
+namespace {
+
+/*
+  The factorization of the Jacobian computed in the previous solve is only reused
+  when every joint displacement is within this range from the one used in the factorization.
+*/
+constexpr double MaxJointDeviationForFactorizationReuse = 0.05;
+
+}
+
 
 double JointPath::numericalIkDefaultDeltaScale()
 {
@@ -30,6 +41,11 @@ double JointPath::numericalIkDefaultDampingConstant()
     return 1.0e-6;
 }
 
+double JointPath::numericalIkDefaultAdaptiveDampingGain()
+{
+    return 0.5;
+}
+
 //! \deprecated
 double JointPath::numericalIkDefaultTruncateRatio()
 {
@@ -49,7 +65,14 @@ public:
     int iteration; 
     double maxIkErrorSqr;
     double dampingConstantSqr;
+    double adaptiveDampingGain;
+    bool isFactorizationReuseEnabled;
+    bool isFactorizationValid;
+    VectorXd qFactorized;
+    Isometry3 T_baseFactorized;
     vector<double> q0;
+    // The joint displacements before the last step by the stored factorization
+    vector<double> qPrev;
     Isometry3 T0;
     MatrixXd J;
     VectorXd dTask;
@@ -70,12 +93,44 @@ public:
         maxIkErrorSqr = e * e;
         double d = JointPath::numericalIkDefaultDampingConstant();
         dampingConstantSqr = d * d;
+        adaptiveDampingGain = 0.0;
+        isFactorizationReuseEnabled = false;
+        isFactorizationValid = false;
     }
 
     void resize(int numJoints){
-        J.resize(dTask.size(), numJoints);
+        if(J.rows() != dTask.size() || J.cols() != numJoints){
+            J.resize(dTask.size(), numJoints);
+            isFactorizationValid = false;
+        }
         dq.resize(numJoints);
     }
+
+    bool checkIfFactorizationReusable(const std::vector<LinkPtr>& joints, Link* baseLink){
+        if(!isFactorizationReuseEnabled || !isFactorizationValid){
+            return false;
+        }
+        if(!baseLink->T().isApprox(T_baseFactorized)){
+            return false;
+        }
+        const int n = joints.size();
+        for(int i=0; i < n; ++i){
+            if(fabs(joints[i]->q() - qFactorized[i]) > MaxJointDeviationForFactorizationReuse){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void storeFactorizationState(const std::vector<LinkPtr>& joints, Link* baseLink){
+        const int n = joints.size();
+        qFactorized.resize(n);
+        for(int i=0; i < n; ++i){
+            qFactorized[i] = joints[i]->q();
+        }
+        T_baseFactorized = baseLink->T();
+        isFactorizationValid = true;
+    }
 };
 
 }
@@ -108,17 +163,29 @@ bool JointPath::setPath(Link* base, Link* end)
     if(!linkPath_.setPath(base, end)){
         return false;
     }
+    if(numericalIK){
+        delete numericalIK;
+    }
     initialize();
     extractJoints();
     return true;
 }
 
 
+JointPath::~JointPath()
+{
+    if(numericalIK){
+        delete numericalIK;
+    }
+}
+
+
 void JointPath::initialize()
 {
     needForwardKinematicsBeforeIK = false;
     numericalIK = nullptr;
     isCustomIkDisabled_ = false;
+    resetIkStatistics();
 }    
 
 
@@ -264,7 +331,31 @@ void JointPath::setNumericalIkMaxIterations(int n)
 
 void JointPath::setNumericalIkDampingConstant(double lambda)
 {
-    getOrCreateNumericalIK()->dampingConstantSqr = lambda * lambda;
+    auto nuIK = getOrCreateNumericalIK();
+    nuIK->dampingConstantSqr = lambda * lambda;
+    nuIK->isFactorizationValid = false;
+}
+
+
+void JointPath::setNumericalIkAdaptiveDampingGain(double gain)
+{
+    getOrCreateNumericalIK()->adaptiveDampingGain = gain;
+}
+
+
+void JointPath::setNumericalIkFactorizationReuseEnabled(bool on)
+{
+    auto nuIK = getOrCreateNumericalIK();
+    nuIK->isFactorizationReuseEnabled = on;
+    if(!on){
+        nuIK->isFactorizationValid = false;
+    }
+}
+
+
+bool JointPath::isNumericalIkFactorizationReuseEnabled() const
+{
+    return numericalIK ? numericalIK->isFactorizationReuseEnabled : false;
 }
 
 
@@ -289,6 +380,7 @@ void JointPath::customizeTarget
     nuIK->dTask.resize(numTargetElements);
     nuIK->errorFunc = errorFunc;
     nuIK->jacobianFunc = jacobianFunc;
+    nuIK->isFactorizationValid = false;
 }
 
 
@@ -332,6 +424,8 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
     }
     const int n = numJoints();
 
+    auto startTime = std::chrono::steady_clock::now();
+
     auto nuIK = getOrCreateNumericalIK();
     
     if(!nuIK->jacobianFunc){
@@ -347,6 +441,7 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
     }
 
     nuIK->q0.resize(n);
+    nuIK->qPrev.resize(n);
     if(!nuIK->isBestEffortIkMode){
         for(int i=0; i < n; ++i){
             nuIK->q0[i] = joints_[i]->q();
@@ -369,6 +464,11 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
         nuIK->svd.setTruncateRatio(std::numeric_limits<double>::max());
     }
 
+    bool isFactorizationReusable =
+        !useUsualInverseSolution && !USE_SVD_FOR_BEST_EFFORT_IK &&
+        nuIK->checkIfFactorizationReusable(joints_, baseLink());
+    bool isLastStepByStoredFactorization = false;
+
     for(nuIK->iteration = 0; nuIK->iteration < nuIK->maxIterations; ++nuIK->iteration){
 
         double errorSqr;
@@ -384,7 +484,22 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
             target->T() = T;
             break;
         }
-        if(prevErrsqr - errorSqr < nuIK->maxIkErrorSqr){
+        if(prevErrsqr - errorSqr < nuIK->maxIkErrorSqr && isLastStepByStoredFactorization){
+            // The stored factorization is no longer effective. Recompute it.
+            isFactorizationReusable = false;
+            if(errorSqr > prevErrsqr){
+                /*
+                  Revert the step by the stored factorization so that the Jacobian is computed
+                  at the better state. The error of the reverted state is evaluated again in the
+                  next iteration, where the Jacobian is recomputed.
+                */
+                for(int j=0; j < n; ++j){
+                    joints_[j]->q() = nuIK->qPrev[j];
+                }
+                calcForwardKinematics();
+                continue;
+            }
+        } else if(prevErrsqr - errorSqr < nuIK->maxIkErrorSqr){
             if(nuIK->isBestEffortIkMode && (errorSqr > prevErrsqr)){
                 // Revert the joint displacements to the previous state in this iteration
                 for(int j=0; j < n; ++j){
@@ -396,20 +511,39 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
         }
         prevErrsqr = errorSqr;
 
-        nuIK->jacobianFunc(nuIK->J);
-
-        if(useUsualInverseSolution){
-            nuIK->dq = nuIK->QR.compute(nuIK->J).solve(nuIK->dTask);
+        if(isFactorizationReusable){
+            // The Jacobian and its factorization of the previous iteration or solve are used as they are
+            nuIK->dq = nuIK->J.transpose() * nuIK->QR.solve(nuIK->dTask);
+            ++ikStatistics_.numFactorizationReuses;
+            isLastStepByStoredFactorization = true;
         } else {
-            if(USE_SVD_FOR_BEST_EFFORT_IK){
-                nuIK->svd.compute(nuIK->J).solve(nuIK->dTask, nuIK->dq);
+            isLastStepByStoredFactorization = false;
+            nuIK->jacobianFunc(nuIK->J);
+            ++ikStatistics_.numJacobianEvaluations;
+        
+            if(useUsualInverseSolution){
+                nuIK->dq = nuIK->QR.compute(nuIK->J).solve(nuIK->dTask);
             } else {
-                // The damped least squares (singurality robust inverse) method
-                nuIK->JJ = nuIK->J * nuIK->J.transpose() + nuIK->dampingConstantSqr * MatrixXd::Identity(nuIK->J.rows(), nuIK->J.rows());
-                nuIK->dq = nuIK->J.transpose() * nuIK->QR.compute(nuIK->JJ).solve(nuIK->dTask);
+                if(USE_SVD_FOR_BEST_EFFORT_IK){
+                    nuIK->svd.compute(nuIK->J).solve(nuIK->dTask, nuIK->dq);
+                } else {
+                    // The damped least squares (singurality robust inverse) method
+                    double dampingSqr = nuIK->dampingConstantSqr + nuIK->adaptiveDampingGain * errorSqr;
+                    nuIK->JJ = nuIK->J * nuIK->J.transpose() + dampingSqr * MatrixXd::Identity(nuIK->J.rows(), nuIK->J.rows());
+                    nuIK->dq = nuIK->J.transpose() * nuIK->QR.compute(nuIK->JJ).solve(nuIK->dTask);
+                    if(nuIK->isFactorizationReuseEnabled){
+                        nuIK->storeFactorizationState(joints_, baseLink());
+                        isFactorizationReusable = true;
+                    }
+                }
             }
         }
 
+        if(isLastStepByStoredFactorization){
+            for(int j=0; j < n; ++j){
+                nuIK->qPrev[j] = joints_[j]->q();
+            }
+        }
         if(nuIK->isBestEffortIkMode){
             for(int j=0; j < n; ++j){
                 double& q = joints_[j]->q();
@@ -433,6 +567,9 @@ bool JointPath::calcInverseKinematics(const Isometry3& T)
         target->T() = nuIK->T0;
     }
 
+    std::chrono::duration<double> solveTime = std::chrono::steady_clock::now() - startTime;
+    updateIkStatistics(completed, nuIK->iteration, solveTime.count());
+
     return completed;
 }
 
@@ -458,6 +595,43 @@ int JointPath::numIterations() const
 }
 
 
+const JointPath::IkStatistics& JointPath::ikStatistics() const
+{
+    return ikStatistics_;
+}
+
+
+void JointPath::resetIkStatistics()
+{
+    ikStatistics_.numSolves = 0;
+    ikStatistics_.numSolved = 0;
+    ikStatistics_.lastNumIterations = 0;
+    ikStatistics_.totalNumIterations = 0;
+    ikStatistics_.numJacobianEvaluations = 0;
+    ikStatistics_.numFactorizationReuses = 0;
+    ikStatistics_.lastSolveTime = 0.0;
+    ikStatistics_.maxSolveTime = 0.0;
+    ikStatistics_.totalSolveTime = 0.0;
+}
+
+
+void JointPath::updateIkStatistics(bool solved, int numIterations, double solveTime)
+{
+    auto& stat = ikStatistics_;
+    ++stat.numSolves;
+    if(solved){
+        ++stat.numSolved;
+    }
+    stat.lastNumIterations = numIterations;
+    stat.totalNumIterations += numIterations;
+    stat.lastSolveTime = solveTime;
+    if(solveTime > stat.maxSolveTime){
+        stat.maxSolveTime = solveTime;
+    }
+    stat.totalSolveTime += solveTime;
+}
+
+
 bool JointPath::hasCustomIK() const
 {
     return false;
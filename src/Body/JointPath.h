@@ -33,6 +33,7 @@ public:
     JointPath(Link* end);
     JointPath(const JointPath& org) = delete;
     JointPath& operator=(const JointPath& rhs) = delete;
+    ~JointPath();
 
     bool setPath(Link* base, Link* end);
 
@@ -97,10 +98,29 @@ public:
     void setNumericalIkDeltaScale(double s);
     void setNumericalIkMaxIterations(int n);
     void setNumericalIkDampingConstant(double lambda);
+
+    /**
+       The damping term of the damped least squares method is increased in proportion to the
+       squared error when the gain is positive. This makes the solution stable near singular
+       configurations while keeping the convergence fast near the goal. Adaptive damping is disabled
+       by default. numericalIkDefaultAdaptiveDampingGain() gives the gain to enable it with.
+    */
+    void setNumericalIkAdaptiveDampingGain(double gain);
+
+    /**
+       When this mode is enabled, the factorization of the Jacobian computed in the last solve is
+       reused while the joint configuration is close to the one where the factorization was computed
+       and the error keeps decreasing. This is effective for successive small target changes such as
+       the ones given by interactive dragging.
+    */
+    void setNumericalIkFactorizationReuseEnabled(bool on);
+    bool isNumericalIkFactorizationReuseEnabled() const;
+    
     static double numericalIkDefaultDeltaScale();
     static int numericalIkDefaultMaxIterations();
     static double numericalIkDefaultMaxIkError();
     static double numericalIkDefaultDampingConstant();
+    static double numericalIkDefaultAdaptiveDampingGain();
     
     void customizeTarget(
         int numTargetElements,
@@ -119,6 +139,21 @@ public:
 
     int numIterations() const;
 
+    struct IkStatistics
+    {
+        int numSolves;
+        int numSolved;
+        int lastNumIterations;
+        long totalNumIterations;
+        int numJacobianEvaluations;
+        int numFactorizationReuses;
+        double lastSolveTime;
+        double maxSolveTime;
+        double totalSolveTime;
+    };
+    const IkStatistics& ikStatistics() const;
+    void resetIkStatistics();
+
     std::string name() const { return name_; }
     void setName(const std::string& name){ name_ = name; }
 
@@ -162,6 +197,9 @@ public:
     [[deprecated]]
     static double numericalIkDefaultTruncateRatio();
 
+protected:
+    void updateIkStatistics(bool solved, int numIterations, double solveTime);
+
 private:
     void initialize();
     void extractJoints();
@@ -176,6 +214,7 @@ private:
     bool needForwardKinematicsBeforeIK;
     bool isCustomIkDisabled_;
     std::string name_;
+    IkStatistics ikStatistics_;
 };
 
 [[deprecated("Use JointPath::getCustomPath.")]]
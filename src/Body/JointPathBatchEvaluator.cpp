@@ -0,0 +1,319 @@
+#include "JointPathBatchEvaluator.h"
+#include "JointPath.h"
+#include "Jacobian.h"
+#include "Body.h"
+#include <cnoid/ThreadPool>
+#include <memory>
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+struct Worker
+{
+    BodyPtr body;
+    shared_ptr<JointPath> path;
+
+    void setConfiguration(const MatrixXd& Q, int column)
+    {
+        const int n = path->numJoints();
+        for(int i=0; i < n; ++i){
+            path->joint(i)->q() = Q(i, column);
+        }
+        path->calcForwardKinematics();
+    }
+};
+
+}
+
+namespace cnoid {
+
+class JointPathBatchEvaluator::Impl
+{
+public:
+    LinkPtr orgBaseLink;
+    LinkPtr orgEndLink;
+    int numJoints;
+    int numThreads;
+    bool isCustomIkEnabled;
+    std::function<void(JointPath& path)> jointPathSetupFunction;
+    vector<Worker> workers;
+    unique_ptr<ThreadPool> threadPool;
+
+    Impl();
+    void clearWorkers();
+    bool makeWorkersReady();
+    void syncWorkerBodiesWithOriginal();
+    void forEachColumn(int numColumns, std::function<void(Worker& worker, int column)> func);
+};
+
+}
+
+
+JointPathBatchEvaluator::JointPathBatchEvaluator()
+{
+    impl = new Impl;
+}
+
+
+JointPathBatchEvaluator::JointPathBatchEvaluator(Link* baseLink, Link* endLink)
+{
+    impl = new Impl;
+    setPath(baseLink, endLink);
+}
+
+
+JointPathBatchEvaluator::Impl::Impl()
+{
+    numJoints = 0;
+    numThreads = 1;
+    isCustomIkEnabled = true;
+}
+
+
+JointPathBatchEvaluator::~JointPathBatchEvaluator()
+{
+    delete impl;
+}
+
+
+bool JointPathBatchEvaluator::setPath(Link* baseLink, Link* endLink)
+{
+    impl->clearWorkers();
+    impl->orgBaseLink.reset();
+    impl->orgEndLink.reset();
+    impl->numJoints = 0;
+
+    if(!baseLink || !endLink || !baseLink->body() || baseLink->body() != endLink->body()){
+        return false;
+    }
+    JointPath path(baseLink, endLink);
+    if(path.empty()){
+        return false;
+    }
+    impl->orgBaseLink = baseLink;
+    impl->orgEndLink = endLink;
+    impl->numJoints = path.numJoints();
+    return true;
+}
+
+
+bool JointPathBatchEvaluator::empty() const
+{
+    return impl->numJoints == 0;
+}
+
+
+int JointPathBatchEvaluator::numJoints() const
+{
+    return impl->numJoints;
+}
+
+
+void JointPathBatchEvaluator::setNumThreads(int n)
+{
+    if(n < 1){
+        n = 1;
+    }
+    if(n != impl->numThreads){
+        impl->numThreads = n;
+        impl->clearWorkers();
+    }
+}
+
+
+int JointPathBatchEvaluator::numThreads() const
+{
+    return impl->numThreads;
+}
+
+
+void JointPathBatchEvaluator::setCustomIkEnabled(bool on)
+{
+    if(on != impl->isCustomIkEnabled){
+        impl->isCustomIkEnabled = on;
+        impl->clearWorkers();
+    }
+}
+
+
+bool JointPathBatchEvaluator::isCustomIkEnabled() const
+{
+    return impl->isCustomIkEnabled;
+}
+
+
+void JointPathBatchEvaluator::setJointPathSetupFunction(std::function<void(JointPath& path)> func)
+{
+    impl->jointPathSetupFunction = func;
+    impl->clearWorkers();
+}
+
+
+void JointPathBatchEvaluator::Impl::clearWorkers()
+{
+    threadPool.reset();
+    workers.clear();
+}
+
+
+bool JointPathBatchEvaluator::Impl::makeWorkersReady()
+{
+    if(numJoints == 0){
+        return false;
+    }
+    if(!workers.empty()){
+        return true;
+    }
+
+    auto orgBody = orgBaseLink->body();
+    workers.resize(numThreads);
+    for(auto& worker : workers){
+        worker.body = orgBody->clone();
+        auto baseLink = worker.body->link(orgBaseLink->index());
+        auto endLink = worker.body->link(orgEndLink->index());
+        if(isCustomIkEnabled){
+            worker.path = JointPath::getCustomPath(baseLink, endLink);
+        } else {
+            worker.path = make_shared<JointPath>(baseLink, endLink);
+        }
+        if(jointPathSetupFunction){
+            jointPathSetupFunction(*worker.path);
+        }
+    }
+    if(numThreads > 1){
+        threadPool.reset(new ThreadPool(numThreads));
+    }
+    return true;
+}
+
+
+void JointPathBatchEvaluator::Impl::syncWorkerBodiesWithOriginal()
+{
+    auto orgBody = orgBaseLink->body();
+    const int numLinks = orgBody->numLinks();
+    for(auto& worker : workers){
+        auto body = worker.body;
+        for(int i=0; i < numLinks; ++i){
+            auto orgLink = orgBody->link(i);
+            auto link = body->link(i);
+            link->T() = orgLink->T();
+            link->q() = orgLink->q();
+        }
+    }
+}
+
+
+void JointPathBatchEvaluator::Impl::forEachColumn
+(int numColumns, std::function<void(Worker& worker, int column)> func)
+{
+    syncWorkerBodiesWithOriginal();
+
+    if(!threadPool || numColumns < 2){
+        auto& worker = workers.front();
+        for(int i=0; i < numColumns; ++i){
+            func(worker, i);
+        }
+        return;
+    }
+
+    const int minSize = numColumns / numThreads;
+    int remainder = numColumns % numThreads;
+    int index = 0;
+    for(int i=0; i < numThreads; ++i){
+        int size = minSize;
+        if(remainder > 0){
+            ++size;
+            --remainder;
+        }
+        if(size == 0){
+            break;
+        }
+        auto worker = &workers[i];
+        threadPool->start([worker, index, size, &func](){
+            const int end = index + size;
+            for(int j=index; j < end; ++j){
+                func(*worker, j);
+            }
+        });
+        index += size;
+    }
+    threadPool->wait();
+}
+
+
+void JointPathBatchEvaluator::calcForwardKinematics(const MatrixXd& Q, std::vector<Isometry3>& out_positions)
+{
+    if(!impl->makeWorkersReady() || Q.rows() != impl->numJoints){
+        out_positions.clear();
+        return;
+    }
+    const int numColumns = Q.cols();
+    out_positions.resize(numColumns);
+
+    impl->forEachColumn(
+        numColumns,
+        [&](Worker& worker, int column){
+            worker.setConfiguration(Q, column);
+            out_positions[column] = worker.path->endLink()->T();
+        });
+}
+
+
+void JointPathBatchEvaluator::calcJacobians(const MatrixXd& Q, std::vector<MatrixXd>& out_Jacobians)
+{
+    if(!impl->makeWorkersReady() || Q.rows() != impl->numJoints){
+        out_Jacobians.clear();
+        return;
+    }
+    const int numColumns = Q.cols();
+    out_Jacobians.resize(numColumns);
+
+    impl->forEachColumn(
+        numColumns,
+        [&](Worker& worker, int column){
+            worker.setConfiguration(Q, column);
+            auto& J = out_Jacobians[column];
+            J.resize(6, impl->numJoints);
+            setJacobian<0x3f, 0, 0>(*worker.path, worker.path->endLink(), J);
+        });
+}
+
+
+int JointPathBatchEvaluator::calcInverseKinematics
+(const std::vector<Isometry3>& targets, const MatrixXd& Q0, MatrixXd& out_Q, std::vector<char>& out_solved)
+{
+    const int numTargets = targets.size();
+    const bool isCommonInitialConfiguration = (Q0.cols() == 1);
+
+    if(!impl->makeWorkersReady() || Q0.rows() != impl->numJoints ||
+       (!isCommonInitialConfiguration && Q0.cols() != numTargets)){
+        out_Q.resize(0, 0);
+        out_solved.clear();
+        return 0;
+    }
+
+    out_Q.resize(impl->numJoints, numTargets);
+    out_solved.assign(numTargets, 0);
+
+    impl->forEachColumn(
+        numTargets,
+        [&](Worker& worker, int column){
+            auto& path = *worker.path;
+            worker.setConfiguration(Q0, isCommonInitialConfiguration ? 0 : column);
+            out_solved[column] = path.calcInverseKinematics(targets[column]);
+            const int n = path.numJoints();
+            for(int i=0; i < n; ++i){
+                out_Q(i, column) = path.joint(i)->q();
+            }
+        });
+
+    int numSolved = 0;
+    for(auto solved : out_solved){
+        if(solved){
+            ++numSolved;
+        }
+    }
+    return numSolved;
+}
@@ -0,0 +1,74 @@
+#ifndef CNOID_BODY_JOINT_PATH_BATCH_EVALUATOR_H
+#define CNOID_BODY_JOINT_PATH_BATCH_EVALUATOR_H
+
+#include <cnoid/EigenTypes>
+#include <functional>
+#include <vector>
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class Link;
+class JointPath;
+
+/**
+   This class evaluates the forward kinematics, the Jacobians and the inverse kinematics of
+   a joint path for many joint configurations at once. Each configuration is given as a column
+   of a matrix whose row count is the number of the joints in the path. The evaluation is done
+   with clones of the body so that the original body is not modified, and the columns are
+   distributed to worker threads when the number of threads is more than one.
+
+   The base link position and the joint displacements of the links that are not included in the
+   path are taken from the original body when each evaluation function is called.
+*/
+class CNOID_EXPORT JointPathBatchEvaluator
+{
+public:
+    JointPathBatchEvaluator();
+    JointPathBatchEvaluator(Link* baseLink, Link* endLink);
+    ~JointPathBatchEvaluator();
+
+    JointPathBatchEvaluator(const JointPathBatchEvaluator& org) = delete;
+    JointPathBatchEvaluator& operator=(const JointPathBatchEvaluator& rhs) = delete;
+
+    bool setPath(Link* baseLink, Link* endLink);
+    bool empty() const;
+    int numJoints() const;
+
+    //! The value less than or equal to one means that the evaluation is done in the calling thread.
+    void setNumThreads(int n);
+    int numThreads() const;
+
+    //! The custom (analytical) IK of the path is used by default if the body has it.
+    void setCustomIkEnabled(bool on);
+    bool isCustomIkEnabled() const;
+
+    /**
+       The function is applied to the joint path of each worker when it is created.
+       This can be used to set the numerical IK parameters such as the maximum iterations.
+    */
+    void setJointPathSetupFunction(std::function<void(JointPath& path)> func);
+
+    void calcForwardKinematics(const MatrixXd& Q, std::vector<Isometry3>& out_positions);
+    void calcJacobians(const MatrixXd& Q, std::vector<MatrixXd>& out_Jacobians);
+
+    /**
+       \param Q0 Initial joint displacements. A single column is used as the initial configuration
+       of all the targets. Otherwise the number of the columns must be the same as the number of the targets.
+       \param out_Q The solutions. The initial configuration is stored in the column whose IK is not solved
+       unless the best effort IK mode is enabled in the joint path setup function.
+       \param out_solved Each element is set to non-zero when the corresponding IK is solved.
+       \return The number of the solved targets
+    */
+    int calcInverseKinematics(
+        const std::vector<Isometry3>& targets, const MatrixXd& Q0,
+        MatrixXd& out_Q, std::vector<char>& out_solved);
+
+private:
+    class Impl;
+    Impl* impl;
+};
+
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <map>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
 using namespace std;
 using namespace cnoid;
@@ -18,13 +19,20 @@ namespace {
 
 const bool SOLVE_CONSTRAINTS_BY_SR_INVERSE = false;
 const bool SOLVE_CONSTRAINTS_BY_SVD = !SOLVE_CONSTRAINTS_BY_SR_INVERSE;
+
+/*
+  The pseudo inverse of the target Jacobian is only reused when every joint displacement
+  and the base position are within this range from the ones used in its computation.
+*/
+constexpr double MaxDeviationForFactorizationReuse = 0.05;
     
 double calcLU(int n, MatrixXd& a, vector<int>& pivots);
 void solveByLU(int n, MatrixXd& a, vector<int>& pivots, const MatrixXd::ColXpr& x, const VectorXd& b);
 bool makeInverseMatrix(int n, MatrixXd& org, MatrixXd& inv, double minValidDet);
-bool makePseudoInverseType1(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv, double minValidDet);
+bool makePseudoInverseType1(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv,
+                            double dampingSqr, double minValidDet);
 bool makePseudoInverseType2(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv,
-                            const VectorXd& weights, double minValidDet);
+                            const VectorXd& weights, double dampingSqr, double minValidDet);
 bool makeSRInverseMatrix(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJ2, MatrixXd& JJinv,
                          vector<int>& pivots, double srk0, double srw0);
 }
@@ -133,6 +141,15 @@ public:
     double srk0; // k of the singular point
     double srw0; // threshold value to calc k
 
+    double dampingConstantSqr;
+    double adaptiveDampingGain;
+
+    bool isFactorizationReuseEnabled;
+    bool isFactorizationValid;
+    bool isLastStepByStoredFactorization;
+    VectorXd q_factorized;
+    Vector3 base_p_factorized;
+
     enum IKStepResult { ERROR, PINS_NOT_CONVERGED, PINS_CONVERGED };
 
     void setBaseLink(Link* baseLink);
@@ -149,6 +166,8 @@ public:
     bool calcInverseKinematics(const Isometry3& T);
             
     IKStepResult calcOneStep(const Vector3& v, const Vector3& omega);
+    bool checkIfFactorizationReusable() const;
+    void storeFactorizationState();
     void solveConstraints();
     void setJacobianForOnePath(MatrixXd& J, int row, JointPath& jointPath, int axes);
     void setJacobianForFreeRoot(MatrixXd& J, int row, JointPath& jointPath, int axes);
@@ -169,7 +188,8 @@ PinDragIKImpl::PinDragIKImpl(Body* body)
     : body_(body),
       NJ(body->numJoints()),
       q_org(NJ),
-      qWeights(NJ + 6)
+      qWeights(NJ + 6),
+      q_factorized(NJ)
 {
     M = 0;
     N = 0;
@@ -189,6 +209,12 @@ PinDragIKImpl::PinDragIKImpl(Body* body)
     setIKErrorThresh(1.0e-5);
     setSRInverseParameters(0.1, 0.001);
 
+    dampingConstantSqr = 0.0;
+    adaptiveDampingGain = 0.0;
+    isFactorizationReuseEnabled = false;
+    isFactorizationValid = false;
+    isLastStepByStoredFactorization = false;
+
     //enableJointRangeConstraints(true);
     enableJointRangeConstraints(false);
 }
@@ -363,6 +389,27 @@ void PinDragIKImpl::enableJointRangeConstraints(bool on)
 }
 
 
+void PinDragIK::setDampingConstant(double lambda)
+{
+    impl->dampingConstantSqr = lambda * lambda;
+    impl->isFactorizationValid = false;
+}
+
+
+void PinDragIK::setAdaptiveDampingGain(double gain)
+{
+    impl->adaptiveDampingGain = gain;
+    impl->isFactorizationValid = false;
+}
+
+
+void PinDragIK::setFactorizationReuseEnabled(bool on)
+{
+    impl->isFactorizationReuseEnabled = on;
+    impl->isFactorizationValid = false;
+}
+
+
 bool PinDragIK::initialize()
 {
     return impl->initialize();
@@ -456,6 +503,8 @@ bool PinDragIKImpl::initialize()
 
     fkTraverse.find(baseLink, true, true);
 
+    isFactorizationValid = false;
+
     return true;
 }
 
@@ -487,15 +536,24 @@ bool PinDragIKImpl::calcInverseKinematics(const Isometry3& T)
 
     IKStepResult result = (C > 0) ? PINS_CONVERGED : PINS_NOT_CONVERGED;
 
+    isLastStepByStoredFactorization = false;
+    double prevErrorSqr = std::numeric_limits<double>::max();
+
     int i;
     for(i=0; i < maxIteration; i++){
         
         const Vector3 dp = T.translation() - targetLink->p();
         const Vector3 omega = targetLink->R() * omegaFromRot(targetLink->R().transpose() * T.linear());
+        const double errorSqr = dp.squaredNorm() + omega.squaredNorm();
         
-        if((dp.squaredNorm() + omega.squaredNorm()) < ikErrorSqrThresh && result == PINS_CONVERGED){
+        if(errorSqr < ikErrorSqrThresh && result == PINS_CONVERGED){
             break;
         }
+        if(isLastStepByStoredFactorization && errorSqr >= prevErrorSqr){
+            // The stored pseudo inverse is no longer effective. Recompute it.
+            isFactorizationValid = false;
+        }
+        prevErrorSqr = errorSqr;
 
         result = calcOneStep(dp, omega);
 
@@ -516,26 +574,75 @@ bool PinDragIKImpl::calcInverseKinematics(const Isometry3& T)
 }
 
 
-PinDragIKImpl::IKStepResult PinDragIKImpl::calcOneStep(const Vector3& v, const Vector3& omega)
+bool PinDragIKImpl::checkIfFactorizationReusable() const
 {
-    // make Jacobian matrix for the target link
-    int axes = PinDragIK::TRANSLATION_3D;
-    if(isTargetAttitudeEnabled){
-        axes |= PinDragIK::ROTATION_3D;
+    if(!isFactorizationReuseEnabled || !isFactorizationValid){
+        return false;
+    }
+    for(int i=0; i < NJ; ++i){
+        if(fabs(body_->joint(i)->q() - q_factorized[i]) > MaxDeviationForFactorizationReuse){
+            return false;
+        }
     }
-    setJacobianForOnePath(J, 0, *targetJointPath, axes);
     if(isBaseLinkFreeMode){
-        setJacobianForFreeRoot(J, 0, *targetJointPath, axes);
+        if((baseLink->p() - base_p_factorized).cwiseAbs().maxCoeff() > MaxDeviationForFactorizationReuse){
+            return false;
+        }
     }
+    return true;
+}
 
-    bool isOk;
-    if(N >= M){
-        isOk = makePseudoInverseType2(M, N, J, Jinv, JJ, JJinv, qWeights, minValidDet);
-    } else {
-        isOk = makePseudoInverseType1(M, N, J, Jinv, JJ, JJinv, minValidDet);
+
+void PinDragIKImpl::storeFactorizationState()
+{
+    for(int i=0; i < NJ; ++i){
+        q_factorized[i] = body_->joint(i)->q();
     }
-    if(!isOk){
-        return ERROR;
+    if(isBaseLinkFreeMode){
+        base_p_factorized = baseLink->p();
+    }
+    isFactorizationValid = true;
+}
+
+
+PinDragIKImpl::IKStepResult PinDragIKImpl::calcOneStep(const Vector3& v, const Vector3& omega)
+{
+    if(checkIfFactorizationReusable()){
+        // The target Jacobian and its pseudo inverse of the previous step or solve are used as they are
+        isLastStepByStoredFactorization = true;
+
+    } else {
+        isLastStepByStoredFactorization = false;
+        
+        // make Jacobian matrix for the target link
+        int axes = PinDragIK::TRANSLATION_3D;
+        if(isTargetAttitudeEnabled){
+            axes |= PinDragIK::ROTATION_3D;
+        }
+        setJacobianForOnePath(J, 0, *targetJointPath, axes);
+        if(isBaseLinkFreeMode){
+            setJacobianForFreeRoot(J, 0, *targetJointPath, axes);
+        }
+
+        double errorSqr = v.squaredNorm();
+        if(isTargetAttitudeEnabled){
+            errorSqr += omega.squaredNorm();
+        }
+        double dampingSqr = dampingConstantSqr + adaptiveDampingGain * errorSqr;
+
+        bool isOk;
+        if(N >= M){
+            isOk = makePseudoInverseType2(M, N, J, Jinv, JJ, JJinv, qWeights, dampingSqr, minValidDet);
+        } else {
+            isOk = makePseudoInverseType1(M, N, J, Jinv, JJ, JJinv, dampingSqr, minValidDet);
+        }
+        if(!isOk){
+            isFactorizationValid = false;
+            return ERROR;
+        }
+        if(isFactorizationReuseEnabled){
+            storeFactorizationState();
+        }
     }
 
     // dq0 = J# dr_p
@@ -901,10 +1008,13 @@ bool makeInverseMatrix(int n, MatrixXd& org, MatrixXd& inv, double minValidDet)
 
 // N < M
 bool makePseudoInverseType1
-(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv, double minValidDet)
+(int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv, double dampingSqr, double minValidDet)
 {
-    // JJ = J^T * J
+    // JJ = J^T * J + dampingSqr * I
     JJ.noalias() = J.transpose() * J;
+    for(int i=0; i < n; i++){
+        JJ(i, i) += dampingSqr;
+    }
 
     // Jinv = (J^T * J)^-1 * J^T
     if(makeInverseMatrix(n, JJ, JJinv, minValidDet)){
@@ -919,9 +1029,9 @@ bool makePseudoInverseType1
 // N > M
 bool makePseudoInverseType2
 (int m, int n, const MatrixXd& J, MatrixXd& Jinv, MatrixXd& JJ, MatrixXd& JJinv,
- const VectorXd& weights, double minValidDet)
+ const VectorXd& weights, double dampingSqr, double minValidDet)
 {
-    // JJ = J * W^-1 * J^T
+    // JJ = J * W^-1 * J^T + dampingSqr * I
     for(int i=0; i < m; i++){
         for(int j=0; j < m; j++){
             JJ(i, j) = 0.0;
@@ -929,6 +1039,7 @@ bool makePseudoInverseType2
                 JJ(i,j) += J(i,k) * (J(j,k) / weights(k));
             }
         }
+        JJ(i, i) += dampingSqr;
     }
 
     // Jinv = W^-1 * J^T * (J * W^-1 * J^T)^-1
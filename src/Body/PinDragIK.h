@@ -40,6 +40,21 @@ public:
     void setSRInverseParameters(double k0, double w0);
     void enableJointRangeConstraints(bool on);
 
+    /**
+       The damping term added to the pseudo inverse of the target Jacobian is increased in
+       proportion to the squared error when the gain is positive.
+       The defaults are zero, which gives the undamped pseudo inverse.
+    */
+    void setDampingConstant(double lambda);
+    void setAdaptiveDampingGain(double gain);
+
+    /**
+       When this mode is enabled, the pseudo inverse of the target Jacobian is reused across
+       the iterations and the successive solves while the joint configuration is close to
+       the one where it was computed and the error keeps decreasing.
+    */
+    void setFactorizationReuseEnabled(bool on);
+
     /**
        this must be called before the initial calcInverseKinematics() call
        after settings have been changed.
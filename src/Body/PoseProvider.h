@@ -22,6 +22,26 @@ public:
     virtual void getJointDisplacements(std::vector<stdx::optional<double>>& out_q) const = 0;
     virtual stdx::optional<Vector3> ZMP() const = 0;
 
+    struct FrameSeq
+    {
+        //! numFrames x numJoints. NaN is set to the joints whose displacements are not determined.
+        MatrixXd jointDisplacements;
+        //! -1 is set to the frames where the base link is not determined.
+        std::vector<int> baseLinkIndices;
+        std::vector<Isometry3, Eigen::aligned_allocator<Isometry3>> baseLinkPositions;
+        //! numFrames x 3. NaN is set to the frames where the ZMP is not determined.
+        MatrixXd zmps;
+    };
+
+    /**
+       Gets the poses of the frames from beginningFrame to beginningFrame + numFrames - 1 at once.
+       The time of each frame is frame / frameRate. The current pose after this function is undefined.
+       @return false if the provider does not support this function. The frames must be sought one by one then.
+    */
+    virtual bool getFrames(int beginningFrame, int numFrames, double frameRate, FrameSeq& out_frames) {
+        return false;
+    }
+
     [[deprecated("Use getJointDisplacements.")]]
     void getJointPositions(std::vector<stdx::optional<double>>& out_q) const {
         getJointDisplacements(out_q);
@@ -4,15 +4,110 @@
 #include "BodyMotion.h"
 #include "ZMPSeq.h"
 #include "PoseProvider.h"
+#include <cnoid/ThreadPool>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 using namespace cnoid;
 
+namespace {
+
+//! The link positions are calculated in the calling thread when the number of frames is less than this
+constexpr int MinNumFramesPerThread = 200;
+
+typedef vector<Isometry3, Eigen::aligned_allocator<Isometry3>> Isometry3Array;
+
+void calcLinkPositions
+(Body* body, BodyStateSeq& sseq, int beginningFrame, int endingFrame, int frameOffset,
+ const vector<int>& baseLinkIndices, const Isometry3Array& baseLinkPositions,
+ int numLinkPositions, bool allLinkPositionOutputMode)
+{
+    const int numJoints = body->numJoints();
+    Link* rootLink = body->rootLink();
+    Link* baseLink = nullptr;
+    LinkTraverse fkTraverse;
+    LinkPath fkPath;
+
+    for(int frameIndex = beginningFrame; frameIndex <= endingFrame; ++frameIndex){
+        auto& frame = sseq.frame(frameIndex);
+        const int k = frameIndex - frameOffset;
+
+        Link* frameBaseLink = body->link(baseLinkIndices[k]);
+        if(frameBaseLink != baseLink){
+            baseLink = frameBaseLink;
+            if(allLinkPositionOutputMode){
+                fkTraverse.find(baseLink, true, true);
+            } else {
+                fkPath.setPath(baseLink, rootLink);
+            }
+        }
+        baseLink->T() = baseLinkPositions[k];
+
+        auto displacements = frame.jointDisplacements();
+        for(int i=0; i < numJoints; ++i){
+            body->joint(i)->q() = displacements[i];
+        }
+
+        if(allLinkPositionOutputMode){
+            fkTraverse.calcForwardKinematics();
+        } else if(baseLink != rootLink){
+            fkPath.calcForwardKinematics();
+        }
+
+        for(int i=0; i < numLinkPositions; ++i){
+            frame.linkPosition(i).set(body->link(i)->position());
+        }
+    }
+}
+
+
+//! Used for the pose providers that do not support PoseProvider::getFrames
+void seekFrames
+(PoseProvider* provider, int beginningFrame, int numFrames, double frameRate, int numJoints,
+ PoseProvider::FrameSeq& out_frames)
+{
+    constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+    out_frames.jointDisplacements.resize(numFrames, numJoints);
+    out_frames.baseLinkIndices.resize(numFrames);
+    out_frames.baseLinkPositions.resize(numFrames);
+    out_frames.zmps.resize(numFrames, 3);
+    std::vector<stdx::optional<double>> q(numJoints);
+
+    for(int k=0; k < numFrames; ++k){
+
+        provider->seek((beginningFrame + k) / frameRate);
+
+        int baseLinkIndex = provider->baseLinkIndex();
+        if(baseLinkIndex >= 0){
+            if(!provider->getBaseLinkPosition(out_frames.baseLinkPositions[k])){
+                baseLinkIndex = -1;
+            }
+        }
+        out_frames.baseLinkIndices[k] = baseLinkIndex;
+
+        provider->getJointDisplacements(q);
+        for(int i=0; i < numJoints; ++i){
+            out_frames.jointDisplacements(k, i) = q[i] ? *q[i] : nan;
+        }
+
+        if(auto zmp = provider->ZMP()){
+            out_frames.zmps.row(k) = zmp->transpose();
+        } else {
+            out_frames.zmps.row(k).setConstant(nan);
+        }
+    }
+}
+
+}
+
 
 PoseProviderToBodyMotionConverter::PoseProviderToBodyMotionConverter()
 {
     setFullTimeRange();
+    clearUpdateTimeRange();
     allLinkPositionOutputMode = true;
+    numThreads_ = 1;
 }
 
     
@@ -36,6 +131,28 @@ void PoseProviderToBodyMotionConverter::setAllLinkPositionOutput(bool on)
 }
 
 
+void PoseProviderToBodyMotionConverter::setUpdateTimeRange(double lower, double upper)
+{
+    updateLowerTime = std::max(0.0, lower);
+    updateUpperTime = std::max(updateLowerTime, upper);
+    isUpdateTimeRangeEnabled = true;
+}
+
+
+void PoseProviderToBodyMotionConverter::clearUpdateTimeRange()
+{
+    updateLowerTime = 0.0;
+    updateUpperTime = std::numeric_limits<double>::max();
+    isUpdateTimeRangeEnabled = false;
+}
+
+
+void PoseProviderToBodyMotionConverter::setNumThreads(int n)
+{
+    numThreads_ = std::max(1, n);
+}
+
+
 bool PoseProviderToBodyMotionConverter::convert(Body* body, PoseProvider* provider, BodyMotion& motion)
 {
     const double frameRate = motion.frameRate();
@@ -45,23 +162,34 @@ bool PoseProviderToBodyMotionConverter::convert(Body* body, PoseProvider* provid
     const int numLinkPositions = (allLinkPositionOutputMode ? body->numLinks() : 1);
 
     auto sseq = motion.stateSeq();
+
+    // Check if the existing frames can be kept
+    int updateBeginningFrame = beginningFrame;
+    int updateEndingFrame = endingFrame;
+    if(isUpdateTimeRangeEnabled &&
+       motion.numFrames() == endingFrame + 1 &&
+       sseq->numLinkPositionsHint() == numLinkPositions &&
+       sseq->numJointDisplacementsHint() == numJoints){
+        updateBeginningFrame = std::max(beginningFrame, static_cast<int>(std::floor(frameRate * updateLowerTime)));
+        if(updateUpperTime < upperTime){
+            updateEndingFrame = std::min(endingFrame, static_cast<int>(std::ceil(frameRate * updateUpperTime)));
+        }
+    }
+    
     sseq->setNumLinkPositionsHint(numLinkPositions);
     sseq->setNumJointDisplacementsHint(numJoints);
     motion.setNumFrames(endingFrame + 1, true);
 
+    if(updateBeginningFrame > updateEndingFrame){
+        return true;
+    }
+
     ZMPSeq& zmpSeq = *getOrCreateZMPSeq(motion);
     bool isZmpValid = false;
 
     Link* rootLink = body->rootLink();
     Link* baseLink = rootLink;
 
-    std::shared_ptr<LinkTraverse> fkTraverse;
-    if(allLinkPositionOutputMode){
-        fkTraverse = make_shared<LinkTraverse>(baseLink, true, true);
-    } else {
-        fkTraverse = make_shared<LinkPath>(baseLink, rootLink);
-    }
-
     // store the original state
     vector<double> orgJointDisplacements(numJoints);
     for(int i=0; i < numJoints; ++i){
@@ -70,47 +198,82 @@ bool PoseProviderToBodyMotionConverter::convert(Body* body, PoseProvider* provid
     Vector3 p0 = rootLink->p();
     Matrix3 R0 = rootLink->R();
 
-    std::vector<stdx::optional<double>> srcJointDisplacements(numJoints);
+    if(updateBeginningFrame > beginningFrame){
+        // Continue from the root link position of the kept frame
+        rootLink->setPosition(sseq->frame(updateBeginningFrame - 1).linkPosition(0).T());
+    }
+
+    /*
+      The pose provider is accessed sequentially because it has the internal state.
+      The joint displacements and the base link positions of all the frames are
+      extracted first, and then the link positions are calculated from them.
+    */
+    const int numUpdatedFrames = updateEndingFrame - updateBeginningFrame + 1;
+    PoseProvider::FrameSeq frames;
+    if(!provider->getFrames(updateBeginningFrame, numUpdatedFrames, frameRate, frames)){
+        seekFrames(provider, updateBeginningFrame, numUpdatedFrames, frameRate, numJoints, frames);
+    }
 
-    for(int frameIndex = beginningFrame; frameIndex <= endingFrame; ++frameIndex){
+    vector<int> baseLinkIndices(numUpdatedFrames);
+    Isometry3Array baseLinkPositions(numUpdatedFrames);
 
-        provider->seek(frameIndex / frameRate);
+    for(int k=0; k < numUpdatedFrames; ++k){
 
-        const int baseLinkIndex = provider->baseLinkIndex();
+        const int baseLinkIndex = frames.baseLinkIndices[k];
         if(baseLinkIndex >= 0){
             if(baseLinkIndex != baseLink->index()){
                 baseLink = body->link(baseLinkIndex);
-                if(allLinkPositionOutputMode){
-                    fkTraverse->find(baseLink, true, true);
-                } else {
-                    static_pointer_cast<LinkPath>(fkTraverse)->setPath(baseLink, rootLink);
-                }
             }
-            provider->getBaseLinkPosition(baseLink->T());
+            baseLink->T() = frames.baseLinkPositions[k];
         }
+        baseLinkIndices[k] = baseLink->index();
+        baseLinkPositions[k] = baseLink->T();
 
+        const int frameIndex = updateBeginningFrame + k;
         auto& frame = sseq->allocateFrame(frameIndex);
 
-        provider->getJointDisplacements(srcJointDisplacements);
         auto displacements = frame.jointDisplacements();
         for(int i=0; i < numJoints; ++i){
-            const auto& q = srcJointDisplacements[i];
-            body->joint(i)->q() = displacements[i] = q ? *q : 0.0;
-        }
-
-        if(allLinkPositionOutputMode || baseLink != rootLink){
-            fkTraverse->calcForwardKinematics();
+            const double q = frames.jointDisplacements(k, i);
+            displacements[i] = std::isnan(q) ? 0.0 : q;
         }
 
-        for(int i=0; i < numLinkPositions; ++i){
-            frame.linkPosition(i).set(body->link(i)->position());
-        }
-
-        if(auto zmp = provider->ZMP()){
-            zmpSeq[frameIndex] = *zmp;
+        if(!std::isnan(frames.zmps(k, 0))){
+            zmpSeq[frameIndex] = frames.zmps.row(k).transpose();
             isZmpValid = true;
         }
+    }
 
+    const int numChunks = std::min(numThreads_, numUpdatedFrames / MinNumFramesPerThread);
+    
+    if(numChunks <= 1){
+        calcLinkPositions(
+            body, *sseq, updateBeginningFrame, updateEndingFrame, updateBeginningFrame,
+            baseLinkIndices, baseLinkPositions, numLinkPositions, allLinkPositionOutputMode);
+    } else {
+        vector<BodyPtr> bodies(numChunks);
+        ThreadPool threadPool(numChunks);
+        const int minSize = numUpdatedFrames / numChunks;
+        int remainder = numUpdatedFrames % numChunks;
+        int index = updateBeginningFrame;
+        for(int i=0; i < numChunks; ++i){
+            int size = minSize;
+            if(remainder > 0){
+                ++size;
+                --remainder;
+            }
+            bodies[i] = body->clone();
+            Body* chunkBody = bodies[i];
+            const int lastIndex = index + size - 1;
+            threadPool.start(
+                [&, chunkBody, index, lastIndex](){
+                    calcLinkPositions(
+                        chunkBody, *sseq, index, lastIndex, updateBeginningFrame,
+                        baseLinkIndices, baseLinkPositions, numLinkPositions, allLinkPositionOutputMode);
+                });
+            index += size;
+        }
+        threadPool.wait();
     }
 
     if(!isZmpValid){
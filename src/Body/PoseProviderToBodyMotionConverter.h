@@ -16,12 +16,33 @@ public:
     void setTimeRange(double lower, double upper);
     void setFullTimeRange();
     void setAllLinkPositionOutput(bool on);
+
+    /**
+       When the update time range is set, only the frames in the range are regenerated
+       if the motion already has the frames of the whole time range with the same layout.
+       Otherwise all the frames in the time range are generated.
+    */
+    void setUpdateTimeRange(double lower, double upper);
+    void clearUpdateTimeRange();
+
+    /**
+       The link positions of the frames are calculated in parallel with clones of the body
+       when the number of threads is more than one. The pose provider is always accessed
+       sequentially in the calling thread.
+    */
+    void setNumThreads(int n);
+    int numThreads() const { return numThreads_; }
+    
     bool convert(Body* body, PoseProvider* provider, BodyMotion& motion);
 
 private:
     double lowerTime;
     double upperTime;
+    double updateLowerTime;
+    double updateUpperTime;
+    bool isUpdateTimeRangeEnabled;
     bool allLinkPositionOutputMode;
+    int numThreads_;
 };
 
 }
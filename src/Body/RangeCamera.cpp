@@ -124,6 +124,12 @@ void RangeCamera::setPoints(std::shared_ptr<PointData>& points)
 }
 
 
+size_t RangeCamera::estimateMemoryUsage() const
+{
+    return Camera::estimateMemoryUsage() + points_->size() * sizeof(Vector3f);
+}
+
+
 void RangeCamera::clearState()
 {
     Camera::clearState();
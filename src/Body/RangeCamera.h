@@ -69,6 +69,8 @@ public:
 
     void clearPoints();
 
+    virtual size_t estimateMemoryUsage() const override;
+
     bool readSpecifications(const Mapping* info);
     bool writeSpecifications(Mapping* info) const;
 
@@ -202,6 +202,12 @@ int RangeSensor::stateSize() const
 }
 
 
+size_t RangeSensor::estimateMemoryUsage() const
+{
+    return VisionSensor::estimateMemoryUsage() + rangeData_->size() * sizeof(double);
+}
+
+
 const double* RangeSensor::readState(const double* buf)
 {
     buf = VisionSensor::readState(buf);
@@ -495,6 +495,12 @@ void SceneBody::cloneShapes(CloneMap& cloneMap)
 
 void SceneBody::updateLinkPositions(SgUpdateRef update)
 {
+    /*
+      The notifications from the links are coalesced so that the upper nodes are notified
+      only once. When the caller has an outer batch scope, they are coalesced into it.
+    */
+    SgUpdateBatchScope batch;
+    
     // Main body
     impl->updateLinkPositions(body_, sceneLinks_, update);
 
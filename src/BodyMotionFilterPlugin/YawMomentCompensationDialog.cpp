@@ -5,6 +5,8 @@
 #include <cnoid/BodyItem>
 #include <cnoid/BodyMotionItem>
 #include <cnoid/MultiValueSeqItem>
+#include <cnoid/BodyMotionFilterPipeline>
+#include <cnoid/MainWindow>
 #include <cnoid/MessageOut>
 #include <cnoid/Archive>
 #include <cnoid/CheckBox>
@@ -19,6 +21,8 @@
 #include <QBoxLayout>
 #include <QLabel>
 #include <QDialogButtonBox>
+#include <QProgressDialog>
+#include <thread>
 #include "gettext.h"
 
 using namespace std;
@@ -442,7 +446,29 @@ bool YawMomentCompensationDialog::Impl::applyFilter(BodyItem* bodyItem, BodyMoti
         filter->setCopSeqOutput(copSeq);
     }
     
-    return filter->apply(body, *motionItem->motion());
+    BodyMotionFilterPipeline pipeline;
+    pipeline.setNumThreads(std::thread::hardware_concurrency());
+    filter->addFiltersTo(pipeline);
+
+    QProgressDialog progress(
+        _("Applying the yaw moment compensation filter..."), _("Cancel"), 0, 100, MainWindow::instance());
+    progress.setWindowTitle(_("Yaw moment compensation filter"));
+    progress.setWindowModality(Qt::WindowModal);
+    pipeline.setProgressFunction(
+        [&](double ratio){
+            progress.setValue(static_cast<int>(ratio * 100.0));
+            if(progress.wasCanceled()){
+                pipeline.cancel();
+            }
+        });
+
+    bool result = pipeline.apply(body, *motionItem->motion());
+
+    if(pipeline.isCanceled()){
+        mout->putWarningln(_("The yaw moment compensation filter has been canceled."));
+    }
+
+    return result;
 }
 
 
@@ -3,11 +3,14 @@
 #include <cnoid/Link>
 #include <cnoid/LeggedBodyHelper>
 #include <cnoid/BodyMotion>
+#include <cnoid/BodyMotionFilterPipeline>
 #include <cnoid/ZMPSeq>
 #include <cnoid/MessageOut>
 #include <cnoid/stdx/clamp>
 #include <cnoid/Format>
 #include <vector>
+#include <map>
+#include <mutex>
 #include "gettext.h"
 
 #include <iostream>
@@ -35,13 +38,19 @@ class YawMomentCompensationFilter::Impl
 public:
     BodyPtr body;
     LeggedBodyHelperPtr leggedBody;
-    BodyMotion* bodyMotion;
+    shared_ptr<const BodyStateSeq> inputStateSeq;
     shared_ptr<BodyStateSeq> stateSeq;
     shared_ptr<ZMPSeq> zmpSeq;
     Vector3 zmp;
     Vector3 cop;
     int currentFrameIndex;
 
+    // The frames before this frame are only processed to make the state ready
+    int outputBeginningFrame;
+
+    int numThreads;
+    double chunkOverlapTime;
+
     int numJoints;
     double ankleHeight;
     Link* leftFoot;
@@ -84,7 +93,7 @@ public:
     bool isJointDisplacementRangeConstraintEnabled;
     int opposingAdjustmentJointId;
     int opposingAdjustmentReferenceJointId;
-    vector<double> opposingAdjustmentReferenceJointDiffSeq;
+    shared_ptr<vector<double>> opposingAdjustmentReferenceJointDiffSeq;
     
     // coefficients of dynamic equation
     vector<double> Hz;
@@ -133,10 +142,21 @@ public:
 
     MessageOut* mout;
 
+    // Messages put in each chunk are output in the order of the frames after all the chunks are processed
+    typedef vector<pair<string, int>> MessageList;
+    std::map<int, MessageList> chunkMessages;
+    std::mutex chunkMessageMutex;
+
     Impl();
-    bool apply(Body* body, BodyMotion* bodyMotion);
-    bool setBody(Body* orgBody);
-    bool setBodyMotion(BodyMotion* bodyMotion);
+    Impl(const Impl& org);
+    void addFiltersTo(BodyMotionFilterPipeline& pipeline);
+    bool prepare(Body* orgBody, BodyMotion& motion);
+    bool applyToChunk(
+        Body* chunkBody, const BodyMotion& input, BodyMotion& output, const BodyMotionFilterPipeline::Chunk& chunk);
+    bool finish(BodyMotion& motion);
+    bool setBody(Body* orgBody, bool doCloneBody = true);
+    bool checkBodyMotion(BodyMotion& motion);
+    void initializeState(int frameIndex);
     void compensateMoment();
     void detectSupportFootChange();
     bool checkIfFootTouchingToFloor(Link* foot);
@@ -184,6 +204,11 @@ double YawMomentCompensationFilter::defaultRecoveryForceDGain()
     return 6.0;
 }
 
+double YawMomentCompensationFilter::defaultChunkOverlapTime()
+{
+    return 2.0;
+}
+
 
 YawMomentCompensationFilter::YawMomentCompensationFilter()
 {
@@ -205,11 +230,39 @@ YawMomentCompensationFilter::Impl::Impl()
     isJointDisplacementRangeConstraintEnabled = true;
     opposingAdjustmentJointId = -1;
     opposingAdjustmentReferenceJointId = -1;
+    numThreads = 1;
+    chunkOverlapTime = defaultChunkOverlapTime();
 
     mout = MessageOut::master();
 }
 
 
+// The settings and the output sequences are copied to process a chunk
+YawMomentCompensationFilter::Impl::Impl(const Impl& org)
+    : yawMomentSeqOutput(org.yawMomentSeqOutput),
+      copSeqOutput(org.copSeqOutput),
+      allJointWeights(org.allJointWeights),
+      opposingAdjustmentReferenceJointDiffSeq(org.opposingAdjustmentReferenceJointDiffSeq)
+{
+    frictionCoefficient = org.frictionCoefficient;
+    soleRadius = org.soleRadius;
+    isDynamicNormalForceMode = org.isDynamicNormalForceMode;
+    constantNormalForceFactor = org.constantNormalForceFactor;
+    isMomentOfBothFeetSupportingEnabled = org.isMomentOfBothFeetSupportingEnabled;
+    kp_recovery = org.kp_recovery;
+    kd_recovery = org.kd_recovery;
+    mass_recovery = org.mass_recovery;
+    jointDisplacementRangeMode = org.jointDisplacementRangeMode;
+    isJointDisplacementRangeConstraintEnabled = org.isJointDisplacementRangeConstraintEnabled;
+    opposingAdjustmentJointId = org.opposingAdjustmentJointId;
+    opposingAdjustmentReferenceJointId = org.opposingAdjustmentReferenceJointId;
+    numThreads = 1;
+    chunkOverlapTime = org.chunkOverlapTime;
+
+    mout = org.mout;
+}
+
+
 YawMomentCompensationFilter::~YawMomentCompensationFilter()
 {
     delete impl;
@@ -331,38 +384,118 @@ void YawMomentCompensationFilter::setCopSeqOutput(shared_ptr<Vector3Seq> copSeq)
 }
 
 
+void YawMomentCompensationFilter::setNumThreads(int n)
+{
+    impl->numThreads = std::max(1, n);
+}
+
+
+void YawMomentCompensationFilter::setChunkOverlapTime(double time)
+{
+    impl->chunkOverlapTime = std::max(0.0, time);
+}
+
+
+void YawMomentCompensationFilter::addFiltersTo(BodyMotionFilterPipeline& pipeline)
+{
+    impl->addFiltersTo(pipeline);
+}
+
+
 bool YawMomentCompensationFilter::apply(Body* body, BodyMotion& bodyMotion)
 {
-    return impl->apply(body, &bodyMotion);
+    BodyMotionFilterPipeline pipeline;
+    pipeline.setNumThreads(impl->numThreads);
+    impl->addFiltersTo(pipeline);
+    return pipeline.apply(body, bodyMotion);
 }
 
 
-bool YawMomentCompensationFilter::Impl::apply(Body* body, BodyMotion* bodyMotion)
+void YawMomentCompensationFilter::Impl::addFiltersTo(BodyMotionFilterPipeline& pipeline)
 {
-    if(!setBody(body)){
+    pipeline.addFilter(
+        [this](Body* body, BodyMotion& motion){ return prepare(body, motion); });
+
+    pipeline.addLocalFilter(
+        chunkOverlapTime, 0.0,
+        [this](Body* body, const BodyMotion& input, BodyMotion& output, const BodyMotionFilterPipeline::Chunk& chunk){
+            return applyToChunk(body, input, output, chunk); });
+
+    pipeline.addFilter(
+        [this](Body*, BodyMotion& motion){ return finish(motion); });
+}
+
+
+bool YawMomentCompensationFilter::Impl::prepare(Body* orgBody, BodyMotion& motion)
+{
+    chunkMessages.clear();
+
+    if(!setBody(orgBody)){
         return false;
     }
+    return checkBodyMotion(motion);
+}
+
+
+bool YawMomentCompensationFilter::Impl::applyToChunk
+(Body* chunkBody, const BodyMotion& input, BodyMotion& output, const BodyMotionFilterPipeline::Chunk& chunk)
+{
+    Impl worker(*this);
 
-    if(!setBodyMotion(bodyMotion)){
+    MessageList messages;
+    MessageOutPtr chunkMout =
+        new MessageOut([&messages](const string& message, int type){ messages.emplace_back(message, type); });
+    worker.mout = chunkMout;
+
+    if(!worker.setBody(chunkBody, false)){
         return false;
     }
+    worker.inputStateSeq = input.stateSeq();
+    worker.zmpSeq = getZMPSeq(input);
+    worker.stateSeq = output.stateSeq();
+    worker.outputBeginningFrame = chunk.outputBeginningFrame;
+    worker.initializeState(chunk.beginningFrame);
+
+    for(int i = chunk.beginningFrame; i <= chunk.outputEndingFrame; ++i){
+        worker.currentFrameIndex = i;
+        worker.compensateMoment();
+    }
+
+    if(!messages.empty()){
+        std::lock_guard<std::mutex> lock(chunkMessageMutex);
+        chunkMessages[chunk.outputBeginningFrame] = std::move(messages);
+    }
+
+    return true;
+}
+
 
-    int numFrames = bodyMotion->numFrames();
-    for(currentFrameIndex = 0; currentFrameIndex < numFrames; ++currentFrameIndex){
-        compensateMoment();
+bool YawMomentCompensationFilter::Impl::finish(BodyMotion& motion)
+{
+    for(auto& kv : chunkMessages){
+        for(auto& message : kv.second){
+            mout->put(message.first, message.second);
+        }
     }
+    chunkMessages.clear();
 
     if(opposingAdjustmentJointId >= 0){
+        stateSeq = motion.stateSeq();
         adjustOpposingAdjustmentJointTrajectory();
     }
+    stateSeq.reset();
 
     return true;
 }
 
 
-bool YawMomentCompensationFilter::Impl::setBody(Body* orgBody)
+bool YawMomentCompensationFilter::Impl::setBody(Body* orgBody, bool doCloneBody)
 {
-    body = orgBody->clone();
+    if(doCloneBody){
+        body = orgBody->clone();
+    } else {
+        body = orgBody;
+    }
     numJoints = body->numJoints();
 
     jointWeights.clear();
@@ -456,16 +589,15 @@ bool YawMomentCompensationFilter::Impl::setBody(Body* orgBody)
 }
 
 
-bool YawMomentCompensationFilter::Impl::setBodyMotion(BodyMotion* bodyMotion)
+bool YawMomentCompensationFilter::Impl::checkBodyMotion(BodyMotion& motion)
 {
-    this->bodyMotion = bodyMotion;
-    int numFrames = bodyMotion->numFrames();
+    int numFrames = motion.numFrames();
     if(numFrames < 2){
         mout->putErrorln(_("The input motion data does not have a valid number of time frames."));
         return false;
     }
 
-    stateSeq = bodyMotion->stateSeq();
+    auto stateSeq = motion.stateSeq();
 
     if(stateSeq->numLinkPositionsHint() != 1){
         mout->putErrorln(
@@ -482,22 +614,58 @@ bool YawMomentCompensationFilter::Impl::setBodyMotion(BodyMotion* bodyMotion)
     }
 
     // ZMP seq should be desired one in the global coordinate system
-    zmpSeq = getZMPSeq(*bodyMotion);
-    if(!zmpSeq){
+    if(!getZMPSeq(motion)){
         mout->putErrorln(_("The input motion data does not contain the ZMP sequence."));
         return false;
     }
 
-    currentFrameIndex = 0;
-    *body << stateSeq->frame(currentFrameIndex);
+    // The output sequences are allocated here because the chunks write the frames concurrently
+    if(yawMomentSeqOutput){
+        yawMomentSeqOutput->clear();
+        yawMomentSeqOutput->setFrameRate(motion.frameRate());
+        yawMomentSeqOutput->setNumParts(3);
+        yawMomentSeqOutput->setNumFrames(numFrames);
+    }
+    if(copSeqOutput){
+        copSeqOutput->clear();
+        copSeqOutput->setFrameRate(motion.frameRate());
+        copSeqOutput->setNumFrames(numFrames);
+    }
+
+    if(opposingAdjustmentJointId >= 0){
+        opposingAdjustmentReferenceJointDiffSeq = make_shared<vector<double>>(numFrames, 0.0);
+    } else {
+        opposingAdjustmentReferenceJointDiffSeq.reset();
+    }
+    
+    return true;
+}
+
+
+/**
+   Initialize the state as if the frames before the specified frame were processed without
+   any compensation. The velocities are initialized with the input motion when the frame is
+   not the first one so that the state can converge during the overlap frames.
+*/
+void YawMomentCompensationFilter::Impl::initializeState(int frameIndex)
+{
+    currentFrameIndex = (frameIndex == 0) ? 0 : frameIndex - 1;
+    auto& prevFrame = inputStateSeq->frame(currentFrameIndex);
+    auto& prevFrame2 = inputStateSeq->frame(currentFrameIndex == 0 ? 0 : currentFrameIndex - 1);
+
+    dt = 1.0 / inputStateSeq->frameRate();
+    dt2 = dt * dt;
+
+    *body << prevFrame;
     body->calcForwardKinematics();
 
     for(int i=0; i < N; i++){
-        double q = body->joint(jointWeights[i].jointId)->q();
+        int jointId = jointWeights[i].jointId;
+        double q = body->joint(jointId)->q();
         theta_in[i] = q;
         prevTheta_in[i] = q;
         dTheta[i] = 0.0;
-        prev_dTheta[i] = 0.0;
+        prev_dTheta[i] = q - prevFrame2.jointDisplacement(jointId);
         theta_dif[i] = 0.0;
         dTheta_recovery[i] = 0.0;
         ddTheta_recovery[i] = 0.0;
@@ -507,31 +675,12 @@ bool YawMomentCompensationFilter::Impl::setBodyMotion(BodyMotion* bodyMotion)
         auto joint = body->joint(i);
         joint->dq() = 0.0;
         joint->ddq() = 0.0;
-        dq_prev[i] = 0.0;
+        dq_prev[i] = (prevFrame.jointDisplacement(i) - prevFrame2.jointDisplacement(i)) / dt;
     }
 
     setSupportFoot(leftFoot);
     detectSupportFootChange();
     updateCop();
-
-    dt = bodyMotion->timeStep();
-    dt2 = dt * dt;
-
-    if(yawMomentSeqOutput){
-        yawMomentSeqOutput->clear();
-        yawMomentSeqOutput->setFrameRate(bodyMotion->frameRate());
-        yawMomentSeqOutput->setNumParts(3);
-    }
-    if(copSeqOutput){
-        copSeqOutput->clear();
-        copSeqOutput->setFrameRate(bodyMotion->frameRate());
-    }
-
-    if(opposingAdjustmentJointId >= 0){
-        opposingAdjustmentReferenceJointDiffSeq.resize(numFrames);
-    }
-    
-    return true;
 }
 
 
@@ -544,7 +693,8 @@ void YawMomentCompensationFilter::Impl::compensateMoment()
     calcCoefficientsOfDynamicEquation();
     calcMaxYawFrictionMoment();
     
-    auto& currentFrame = stateSeq->frame(currentFrameIndex);
+    auto& currentFrame = inputStateSeq->frame(currentFrameIndex);
+    const bool isOutputFrame = (currentFrameIndex >= outputBeginningFrame);
 
     for(int i=0; i < N; i++){
         theta_in[i] = currentFrame.jointDisplacement(jointWeights[i].jointId);
@@ -580,7 +730,7 @@ void YawMomentCompensationFilter::Impl::compensateMoment()
         doPutNotification = true;
     }
     
-    if(doPutNotification){
+    if(doPutNotification && isOutputFrame){
         mout->putWarningln(
             formatR(_("Yaw moment compensation failed at time {0:.3f}: Yaw moment is {1:.3f}, Max yaw friction moment is {2:.3f}"),
                     currentFrameIndex * dt, yawMoment, maxYawFrictionMoment0));
@@ -589,8 +739,8 @@ void YawMomentCompensationFilter::Impl::compensateMoment()
         }
     }
 
-    if(yawMomentSeqOutput){
-        auto frame = yawMomentSeqOutput->appendFrame();
+    if(yawMomentSeqOutput && isOutputFrame){
+        auto frame = yawMomentSeqOutput->frame(currentFrameIndex);
         frame[0] = maxYawFrictionMoment0;
         frame[1] = yawMoment;
         frame[2] = -maxYawFrictionMoment0;
@@ -607,12 +757,14 @@ void YawMomentCompensationFilter::Impl::compensateMoment()
         theta_dif[i] = joint->q() - theta_in[i];
         dTheta_recovery[i] += ddTheta_recovery[i] * dt;
 
-        if(jointId == opposingAdjustmentReferenceJointId){
-            opposingAdjustmentReferenceJointDiffSeq[currentFrameIndex] = theta_dif[i];
+        if(jointId == opposingAdjustmentReferenceJointId && isOutputFrame){
+            (*opposingAdjustmentReferenceJointDiffSeq)[currentFrameIndex] = theta_dif[i];
         }
     }
 
-    checkJointDisplacementRangeOver();
+    if(isOutputFrame){
+        checkJointDisplacementRangeOver();
+    }
     
     for(int i = 0; i < numJoints; ++i){
         if(!allJointWeights[i].isEnabled){
@@ -624,13 +776,18 @@ void YawMomentCompensationFilter::Impl::compensateMoment()
 
     detectSupportFootChange();
     updateCop();
+    if(!isOutputFrame){
+        return;
+    }
+
     if(copSeqOutput){
-        copSeqOutput->append(cop);
+        (*copSeqOutput)[currentFrameIndex] = cop;
     }
 
+    auto& outputFrame = stateSeq->frame(currentFrameIndex);
     for(int i=0; i < N; ++i){
         int jointId = jointWeights[i].jointId;
-        currentFrame.jointDisplacement(jointId) = body->joint(jointId)->q();
+        outputFrame.jointDisplacement(jointId) = body->joint(jointId)->q();
     }
 }
 
@@ -761,8 +918,8 @@ void YawMomentCompensationFilter::Impl::updateCop()
 // Assume that the body has the previous (filtered) joint angles.
 void YawMomentCompensationFilter::Impl::calcCoefficientsOfDynamicEquation()
 {
-    auto& currentFrame = stateSeq->frame(currentFrameIndex);
-    auto& prevFrame = stateSeq->frame(currentFrameIndex == 0 ? 0 : currentFrameIndex - 1);
+    auto& currentFrame = inputStateSeq->frame(currentFrameIndex);
+    auto& prevFrame = inputStateSeq->frame(currentFrameIndex == 0 ? 0 : currentFrameIndex - 1);
 
     for(int i=0; i < N; ++i){
         for(int j=0; j < numJoints; ++j){
@@ -1008,7 +1165,7 @@ void YawMomentCompensationFilter::Impl::adjustOpposingAdjustmentJointTrajectory(
     for(int i=0; i < numFrames; ++i){
         auto& currentFrame = stateSeq->frame(i);
         auto& q = currentFrame.jointDisplacement(opposingAdjustmentJointId);
-        auto q_adjusted = q - opposingAdjustmentReferenceJointDiffSeq[i];
+        auto q_adjusted = q - (*opposingAdjustmentReferenceJointDiffSeq)[i];
         if((q_adjusted <= joint->q_upper() || q_adjusted <= q) &&
            (q_adjusted >= joint->q_lower() || q_adjusted >= q)){
             q = q_adjusted;
@@ -9,6 +9,7 @@ namespace cnoid {
 
 class Body;
 class BodyMotion;
+class BodyMotionFilterPipeline;
 class MessageOut;
 
 class YawMomentCompensationFilter
@@ -41,6 +42,21 @@ public:
     void setYawMomentSeqOutput(std::shared_ptr<MultiValueSeq> yawMomentSeq);
     void setCopSeqOutput(std::shared_ptr<Vector3Seq> copSeq);
 
+    /**
+       The frames are divided into chunks processed concurrently when the number of threads is
+       more than one. The compensation of each chunk is started from the frame which is earlier
+       than the chunk by the overlap time so that the state of the recovery dynamics converges
+       to the one of the sequential processing.
+    */
+    void setNumThreads(int n);
+    void setChunkOverlapTime(double time);
+
+    /**
+       The filter must exist while the pipeline is applied. The number of threads specified
+       in the pipeline is used instead of the one specified in this filter.
+    */
+    void addFiltersTo(BodyMotionFilterPipeline& pipeline);
+
     bool apply(Body* body, BodyMotion& motion);
 
     static double defaultFrictionCoefficient();
@@ -48,6 +64,7 @@ public:
     static double defaultConstantNormalForceFactor();
     static double defaultRecoveryForcePGain();
     static double defaultRecoveryForceDGain();
+    static double defaultChunkOverlapTime();
 
 private:
     class Impl;
@@ -619,6 +619,44 @@ void AISTSimulatorItem::finalizeSimulation()
 }
 
 
+bool AISTSimulatorItem::storeCheckpointState(SimulationCheckpoint* checkpoint)
+{
+    VectorX solution;
+    impl->world.constraintForceSolver.getWarmStartSolution(solution);
+    auto& listing = *checkpoint->simulatorState()->createFlowStyleListing("constraint_force_solution");
+    listing.reserve(solution.size());
+    for(int i=0; i < solution.size(); ++i){
+        listing.append(solution[i], 10, solution.size());
+    }
+    return true;
+}
+
+
+bool AISTSimulatorItem::restoreCheckpointState(const SimulationCheckpoint* checkpoint)
+{
+    /*
+      The forward dynamics calculates the link velocities from the spatial velocities when it is
+      initialized, so the spatial velocities must be given by the restored velocities
+    */
+    for(int i=0; i < impl->world.numBodies(); ++i){
+        for(auto& dyLink : impl->world.body(i)->links()){
+            dyLink->vo() = dyLink->v() - dyLink->w().cross(dyLink->p());
+            dyLink->dvo() = dyLink->dv() - dyLink->dw().cross(dyLink->p()) - dyLink->w().cross(dyLink->v());
+        }
+    }
+
+    auto& listing = *checkpoint->simulatorState()->findListing("constraint_force_solution");
+    if(listing.isValid()){
+        VectorX solution(listing.size());
+        for(int i=0; i < listing.size(); ++i){
+            solution[i] = listing[i].toDouble();
+        }
+        impl->world.constraintForceSolver.setWarmStartSolution(solution);
+    }
+    return true;
+}
+
+
 std::shared_ptr<CollisionLinkPairList> AISTSimulatorItem::getCollisions()
 {
     return impl->world.constraintForceSolver.getCollisions();
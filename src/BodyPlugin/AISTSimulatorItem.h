@@ -78,6 +78,8 @@ protected:
     virtual bool completeInitializationOfSimulation() override;
     virtual bool stepSimulation(const std::vector<SimulationBody*>& activeSimBodies) override;
     virtual void finalizeSimulation() override;
+    virtual bool storeCheckpointState(SimulationCheckpoint* checkpoint) override;
+    virtual bool restoreCheckpointState(const SimulationCheckpoint* checkpoint) override;
     virtual std::shared_ptr<CollisionLinkPairList> getCollisions() override;
         
     virtual Item* doCloneItem(CloneMap* cloneMap) const override;
@@ -4,6 +4,7 @@
 #include "BodyItemKinematicsKitManager.h"
 #include "BodyItemKinematicsKit.h"
 #include "KinematicsBar.h"
+#include "KinematicStateChangeHub.h"
 #include <cnoid/Archive>
 #include <cnoid/RootItem>
 #include <cnoid/ConnectionSet>
@@ -30,6 +31,8 @@
 #include <cnoid/RenderableItemUtil>
 #include <cnoid/EigenArchive>
 #include <cnoid/CloneMap>
+#include <cnoid/SceneUtil>
+#include <cnoid/SceneUpdate>
 #include <cnoid/Format>
 #include <bitset>
 #include <algorithm>
@@ -473,6 +476,19 @@ Body* BodyItem::body() const
 }
 
 
+size_t BodyItem::estimateMemoryUsage() const
+{
+    // The collision shapes usually share the meshes with the visual shapes
+    std::unordered_set<SgObject*> countedObjects;
+    size_t size = 0;
+    for(auto& link : impl->body->links()){
+        size += estimateSceneMemoryUsage(link->visualShape(), &countedObjects);
+        size += estimateSceneMemoryUsage(link->collisionShape(), &countedObjects);
+    }
+    return size;
+}
+
+
 void BodyItem::setBody(Body* body)
 {
     impl->setBody(body);
@@ -990,7 +1006,13 @@ void BodyItem::Impl::emitSigKinematicStateChanged()
         }
     }
 
-    sigKinematicStateChanged.signal()();
+    {
+        // The scene bodies and the markers of the body item notify the scene root only once
+        SgUpdateBatchScope sceneUpdateBatch;
+        sigKinematicStateChanged.signal()();
+    }
+
+    KinematicStateChangeHub::instance()->notifyKinematicStateChange(self);
 }
 
 
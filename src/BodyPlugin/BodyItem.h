@@ -217,6 +217,9 @@ public:
     bool isVisibleLinkSelectionMode() const { return isVisibleLinkSelectionMode_; }
     void setVisibleLinkSelectionMode(bool on) { isVisibleLinkSelectionMode_ = on; }
 
+    //! The meshes and the textures of the link shapes are counted
+    virtual size_t estimateMemoryUsage() const override;
+
     virtual bool store(Archive& archive) override;
     virtual bool restore(const Archive& archive) override;
 
@@ -195,9 +195,12 @@ BodyLoader* BodyItemBodyFileIO::ensureBodyLoader()
 
 bool BodyItemBodyFileIO::load(BodyItem* item, const std::string& filename)
 {
-    BodyPtr newBody = new Body;
-    if(!ensureBodyLoader()->load(newBody, filename)){
-        return false;
+    BodyPtr newBody = dynamic_cast<Body*>(preloadedObject());
+    if(!newBody){
+        newBody = new Body;
+        if(!ensureBodyLoader()->load(newBody, filename)){
+            return false;
+        }
     }
     item->setBody(newBody);
     
@@ -210,6 +213,21 @@ bool BodyItemBodyFileIO::load(BodyItem* item, const std::string& filename)
 }
 
 
+std::function<ReferencedPtr(std::ostream& os)> BodyItemBodyFileIO::getPreloadingFunction
+(const std::string& filename, const Mapping* /* options */)
+{
+    return [filename](std::ostream& os) -> ReferencedPtr {
+        BodyLoader loader;
+        loader.setMessageSink(os);
+        BodyPtr body = new Body;
+        if(loader.load(body, filename)){
+            return body;
+        }
+        return nullptr;
+    };
+}
+
+
 StdBodyWriter* BodyItemBodyFileIO::ensureBodyWriter()
 {
     if(!bodyWriter_){
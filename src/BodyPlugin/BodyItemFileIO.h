@@ -45,6 +45,8 @@ protected:
     StdBodyWriter* ensureBodyWriter();
 
     virtual bool load(BodyItem* item, const std::string& filename) override;
+    virtual std::function<ReferencedPtr(std::ostream& os)> getPreloadingFunction(
+        const std::string& filename, const Mapping* options) override;
     virtual void createOptionPanelForSaving() override;
     virtual void fetchOptionPanelForSaving() override;
     virtual bool save(BodyItem* item, const std::string& filename) override;
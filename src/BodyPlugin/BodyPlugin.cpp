@@ -21,6 +21,7 @@
 #include "BodyContactPointLogItem.h"
 #include "SubSimulatorItem.h"
 #include "GLVisionSimulatorItem.h"
+#include "PhaseProfilerItem.h"
 #include "SimulationScriptItem.h"
 #include "BodyMotionItem.h"
 #include "ZMPSeqItem.h"
@@ -53,6 +54,8 @@
 #include "LeggedBodyBar.h"
 #include "KinematicsBar.h"
 #include "SimulationBar.h"
+#include "SimulationBatchRunner.h"
+#include "SimulationBenchmark.h"
 #include "BodyMotionEngine.h"
 #include "OperableSceneBody.h"
 #include "HrpsysFileIO.h"
@@ -120,6 +123,7 @@ bool BodyPlugin::initialize()
     BodyContactPointLogItem::initializeClass(this);
     SubSimulatorItem::initializeClass(this);
     GLVisionSimulatorItem::initializeClass(this);
+    PhaseProfilerItem::initializeClass(this);
     SimulationScriptItem::initializeClass(this);
     BodyMotionItem::initializeClass(this);
     BodyMotionEngine::initializeClass(this);
@@ -144,6 +148,8 @@ bool BodyPlugin::initialize()
     OperableSceneBody::initializeClass(this);
     
     SimulationBar::initialize(this);
+    SimulationBatchRunner::initializeClass(this);
+    SimulationBenchmark::initializeClass(this);
     addToolBar(BodyBar::instance());
     addToolBar(LeggedBodyBar::instance());
     addToolBar(KinematicsBar::instance());
@@ -21,6 +21,28 @@ CollisionSeq::CollisionSeq(CollisionSeqItem* collisionSeqItem)
 }
 
 
+size_t CollisionSeq::estimateMemoryUsage() const
+{
+    size_t size = BaseSeqType::estimateMemoryUsage();
+    for(auto p = cbegin(); p != cend(); ++p){
+        if(auto& linkPairs = *p){
+            size += estimateFrameMemoryUsage(*linkPairs);
+        }
+    }
+    return size;
+}
+
+
+size_t CollisionSeq::estimateFrameMemoryUsage(const CollisionLinkPairList& linkPairs)
+{
+    size_t size = sizeof(CollisionLinkPairList) + linkPairs.capacity() * sizeof(CollisionLinkPairList::value_type);
+    for(auto& linkPair : linkPairs){
+        size += sizeof(CollisionLinkPair) + linkPair->collisions().capacity() * sizeof(Collision);
+    }
+    return size;
+}
+
+
 bool CollisionSeq::loadStandardYAMLformat(const std::string& filename, std::ostream& os)
 {
     bool loaded = false;
@@ -27,6 +27,9 @@ public:
     void writeCollsionData(YAMLWriter& writer, std::shared_ptr<const CollisionLinkPairList> ptr);
     void readCollisionData(int nFrames, const Listing& values);
 
+    virtual size_t estimateMemoryUsage() const override;
+    static size_t estimateFrameMemoryUsage(const CollisionLinkPairList& linkPairs);
+
 protected:
     virtual bool doReadSeq(const Mapping* archive, std::ostream& os) override;
     virtual bool doWriteSeq(YAMLWriter& writer, std::function<void()> additionalPartCallback) override;
@@ -123,6 +123,18 @@ void ControllerItem::stop()
 }
 
 
+bool ControllerItem::storeCheckpointState(Mapping* /* state */)
+{
+    return false;
+}
+
+
+bool ControllerItem::restoreCheckpointState(const Mapping* /* state */)
+{
+    return true;
+}
+
+
 ReferencedObjectSeqItem* ControllerItem::createLogItem()
 {
     return new ReferencedObjectSeqItem;
@@ -10,6 +10,7 @@ namespace cnoid {
 
 class ControllerIO;
 class ReferencedObjectSeqItem;
+class Mapping;
 
 class CNOID_EXPORT ControllerItem : public Item
 {
@@ -74,6 +75,21 @@ public:
     */
     virtual void stop();
 
+    /**
+       Implement this function to store the internal state of the controller into a simulation
+       checkpoint so that the simulation started from the checkpoint can continue the control.
+       \return false if the controller does not have the state to store
+       \note This function is called from the simulation thread.
+    */
+    virtual bool storeCheckpointState(Mapping* state);
+
+    /**
+       This function is called after the start function when the simulation is started from
+       a checkpoint which has the state stored by the storeCheckpointState function.
+       \note This function is called from the main thread.
+    */
+    virtual bool restoreCheckpointState(const Mapping* state);
+
     /**
        This function works with the enableLog and outputLogFrame functions of ControllerIO.
        The output log data is stored in the item created by this function.
@@ -24,6 +24,7 @@
 #include <cnoid/Tokenizer>
 #include <cnoid/Format>
 #include <cnoid/EigenArchive>
+#include <cnoid/PhaseProfiler>
 #include <QThread>
 #include <QApplication>
 #include <QOpenGLContext>
@@ -46,6 +47,8 @@ constexpr bool PUT_DEBUG_MESSAGES = false;
 // This does not seem to be necessary
 constexpr bool USE_FLUSH_GL_FUNCTION = false;
 
+const char* RenderingThreadName = "GLVision rendering";
+
 enum ScreenId {
     NO_SCREEN = FisheyeLensConverter::NO_SCREEN,
     FRONT_SCREEN = FisheyeLensConverter::FRONT_SCREEN,
@@ -103,6 +106,7 @@ class SensorScene : public Referenced
 public:
     SgGroupPtr root;
     vector<SceneBodyPtr> sceneBodies;
+    SgUpdate update;
     QThreadEx renderingThread;
     std::condition_variable renderingCondition;
     std::mutex renderingMutex;
@@ -1215,6 +1219,8 @@ void GLVisionSimulatorItem::Impl::onPreDynamics()
 
 void GLVisionSimulatorItem::Impl::queueRenderingLoop()
 {
+    PhaseProfiler::setCurrentThreadName(RenderingThreadName);
+    
     SensorRenderer* renderer = nullptr;
     SensorScreenRenderer* currentGLContextScreen = nullptr;
     
@@ -1263,8 +1269,13 @@ void SensorRenderer::updateSensorScene(bool updateSensorForRenderingThread)
 
 void SensorScene::updateScene(double currentTime)
 {
+    /*
+      The update must be passed so that the cached bounding boxes of the upper nodes
+      are invalidated. Otherwise the sensor renderers cull the moved links with the
+      stale bounds.
+    */
     for(auto& sceneBody : sceneBodies){
-        sceneBody->updateLinkPositions();
+        sceneBody->updateLinkPositions(update.withAction(SgUpdate::GeometryModified));
         sceneBody->updateSceneDevices(currentTime);
     }
 }
@@ -1293,6 +1304,8 @@ void SensorScene::startConcurrentRendering()
 
 void SensorScene::concurrentRenderingLoop(std::function<void(SensorScreenRenderer*&)> render, std::function<void()> finalizeRendering)
 {
+    PhaseProfiler::setCurrentThreadName(RenderingThreadName);
+    
     SensorScreenRenderer* currentGLContextScreen = nullptr;
     
     while(true){
@@ -1338,16 +1351,23 @@ void SensorRenderer::render(SensorScreenRenderer*& currentGLContextScreen, bool
 
 void SensorScreenRenderer::render(SensorScreenRenderer*& currentGLContextScreen)
 {
+    static const int renderPhase = PhaseProfiler::registerPhase("glvision/render");
+    static const int readPhase = PhaseProfiler::registerPhase("glvision/readPixels");
+    
     if(this != currentGLContextScreen){
         makeGLContextCurrent();
         currentGLContextScreen = this;
     }
-    renderer->render();
+    {
+        ScopedPhaseTimer timer(renderPhase);
+        renderer->render();
 
-    if(USE_FLUSH_GL_FUNCTION){
-        renderer->flushGL();
+        if(USE_FLUSH_GL_FUNCTION){
+            renderer->flushGL();
+        }
     }
     
+    ScopedPhaseTimer timer(readPhase);
     storeResultToTmpDataBuffer();
 }
 
@@ -1388,6 +1408,9 @@ void SensorScreenRenderer::storeResultToTmpDataBuffer()
 
 void GLVisionSimulatorItem::Impl::onPostDynamics()
 {
+    static const int postDynamicsPhase = PhaseProfiler::registerPhase("glvision/postDynamics");
+    ScopedPhaseTimer timer(postDynamicsPhase);
+    
     if(useThreadsForSensors){
         getVisionDataInThreadsForSensors();
     } else {
@@ -1,6 +1,7 @@
 #include "JointDisplacementWidgetSet.h"
 #include "BodySelectionManager.h"
 #include "BodyItem.h"
+#include "KinematicStateChangeHub.h"
 #include <cnoid/DisplayValueFormat>
 #include <cnoid/Body>
 #include <cnoid/Link>
@@ -213,6 +214,9 @@ JointDisplacementWidgetSet::Impl::Impl
     updateJointDisplacementsLater.setFunction([this](){ updateJointDisplacements(nullptr); });
     updateJointDisplacementsLater.setPriority(LazyCaller::LowPriority);
 
+    // The displacements are updated when the widget is shown because the changes are skipped while it is hidden
+    baseWidget->installEventFilter(this);
+
     bodySelectionManager = BodySelectionManager::instance();
 }
 
@@ -390,7 +394,14 @@ void JointDisplacementWidgetSet::Impl::setBodyItem(BodyItem* bodyItem)
             linkedJointHandler = LinkedJointHandler::findOrCreateLinkedJointHandler(bodyItem->body());
             
             kinematicStateChangeConnection =
-                bodyItem->sigKinematicStateChanged().connect(updateJointDisplacementsLater);
+                KinematicStateChangeHub::instance()->subscribe(
+                    [this](const std::vector<BodyItem*>& changedBodyItems){
+                        if(std::find(changedBodyItems.begin(), changedBodyItems.end(), currentBodyItem)
+                           != changedBodyItems.end()){
+                            updateJointDisplacementsLater();
+                        }
+                    },
+                    [this](){ return baseWidget->isVisible(); });
 
             continuousKinematicUpdateStateChangeConnection =
                 bodyItem->sigContinuousKinematicUpdateStateChanged().connect(
@@ -976,6 +987,13 @@ void JointIndicator::removeWidgetsFrom(QGridLayout* grid)
 
 bool JointDisplacementWidgetSet::Impl::eventFilter(QObject* object, QEvent* event)
 {
+    if(object == baseWidget){
+        if(event->type() == QEvent::Show && currentBodyItem){
+            updateJointDisplacementsLater();
+        }
+        return false;
+    }
+    
     Slider* slider = dynamic_cast<Slider*>(object);
     if(slider && (event->type() == QEvent::KeyPress)){
         return onSliderKeyPressEvent(slider, static_cast<QKeyEvent*>(event));
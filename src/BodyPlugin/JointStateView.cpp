@@ -1,6 +1,7 @@
 #include "JointStateView.h"
 #include "LinkDeviceTreeWidget.h"
 #include "BodySelectionManager.h"
+#include "KinematicStateChangeHub.h"
 #include <cnoid/BodyItem>
 #include <cnoid/Body>
 #include <cnoid/ConnectionSet>
@@ -220,8 +221,14 @@ void JointStateView::Impl::setCurrentBodyItem(BodyItem* bodyItem)
 
     if(bodyItem){
         connectionsToBody.add(
-            bodyItem->sigKinematicStateChanged().connect(
-                [&](){ onKinematicStateChanged(); }));
+            KinematicStateChangeHub::instance()->subscribe(
+                [this, bodyItem](const std::vector<BodyItem*>& changedBodyItems){
+                    if(std::find(changedBodyItems.begin(), changedBodyItems.end(), bodyItem)
+                       != changedBodyItems.end()){
+                        onKinematicStateChanged();
+                    }
+                },
+                [this](){ return self->isActive(); }));
     }
 
     for(size_t i=0; i < accessors.size(); ++i){
@@ -0,0 +1,92 @@
+#include "KinematicStateChangeHub.h"
+#include "BodyItem.h"
+#include <cnoid/LazyCaller>
+#include <unordered_set>
+
+using namespace std;
+using namespace cnoid;
+
+namespace cnoid {
+
+class KinematicStateChangeHub::Impl
+{
+public:
+    Signal<void(const std::vector<BodyItem*>& changedBodyItems)> sigKinematicStateChanged;
+    vector<BodyItemPtr> changedBodyItems;
+    unordered_set<BodyItem*> changedBodyItemSet;
+    vector<BodyItem*> bodyItemsToNotify;
+    LazyCaller dispatchLater;
+
+    Impl();
+    void dispatch();
+};
+
+}
+
+
+KinematicStateChangeHub* KinematicStateChangeHub::instance()
+{
+    static KinematicStateChangeHub* instance_ = new KinematicStateChangeHub;
+    return instance_;
+}
+
+
+KinematicStateChangeHub::KinematicStateChangeHub()
+{
+    impl = new Impl;
+}
+
+
+KinematicStateChangeHub::Impl::Impl()
+    : dispatchLater([this](){ dispatch(); })
+{
+
+}
+
+
+KinematicStateChangeHub::~KinematicStateChangeHub()
+{
+    delete impl;
+}
+
+
+Connection KinematicStateChangeHub::subscribe(Callback callback, std::function<bool()> isActive)
+{
+    return impl->sigKinematicStateChanged.connect(
+        [callback, isActive](const std::vector<BodyItem*>& changedBodyItems){
+            if(!isActive || isActive()){
+                callback(changedBodyItems);
+            }
+        });
+}
+
+
+void KinematicStateChangeHub::notifyKinematicStateChange(BodyItem* bodyItem)
+{
+    if(!impl->sigKinematicStateChanged.hasConnections()){
+        return;
+    }
+    if(impl->changedBodyItemSet.insert(bodyItem).second){
+        impl->changedBodyItems.push_back(bodyItem);
+        impl->dispatchLater();
+    }
+}
+
+
+void KinematicStateChangeHub::Impl::dispatch()
+{
+    // The body items changed in the callbacks are notified in the next dispatch
+    vector<BodyItemPtr> bodyItems;
+    bodyItems.swap(changedBodyItems);
+    changedBodyItemSet.clear();
+
+    bodyItemsToNotify.clear();
+    for(auto& bodyItem : bodyItems){
+        if(bodyItem->isConnectedToRoot()){
+            bodyItemsToNotify.push_back(bodyItem);
+        }
+    }
+    if(!bodyItemsToNotify.empty()){
+        sigKinematicStateChanged(bodyItemsToNotify);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef CNOID_BODY_PLUGIN_KINEMATIC_STATE_CHANGE_HUB_H
+#define CNOID_BODY_PLUGIN_KINEMATIC_STATE_CHANGE_HUB_H
+
+#include <cnoid/Signal>
+#include <functional>
+#include <vector>
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class BodyItem;
+
+/**
+   This class collects the body items whose kinematic states are changed in an event loop cycle
+   such as a time bar tick in the playback, and notifies them to each subscriber with a single call.
+   A view which reacts to the kinematic state changes of many body items should subscribe to this
+   instead of connecting to BodyItem::sigKinematicStateChanged of each body item.
+*/
+class CNOID_EXPORT KinematicStateChangeHub
+{
+public:
+    static KinematicStateChangeHub* instance();
+
+    typedef std::function<void(const std::vector<BodyItem*>& changedBodyItems)> Callback;
+
+    /**
+       \param isActive The callback is skipped while this function returns false. The subscriber
+       should update its display with the current states when it becomes active again.
+    */
+    Connection subscribe(Callback callback, std::function<bool()> isActive = nullptr);
+
+    //! This function is called by BodyItem when its kinematic state changes.
+    void notifyKinematicStateChange(BodyItem* bodyItem);
+
+private:
+    KinematicStateChangeHub();
+    ~KinematicStateChangeHub();
+
+    class Impl;
+    Impl* impl;
+};
+
+}
+
+#endif
@@ -1792,6 +1792,8 @@ bool OperableSceneBody::Impl::initializeIK()
                 pinDragIK = pin;
                 pinDragIK->setBaseLink(bodyItem->currentBaseLink());
                 pinDragIK->setTargetLink(targetLink, kinematicsBar->isPositionDraggerEnabled());
+                pinDragIK->setAdaptiveDampingGain(JointPath::numericalIkDefaultAdaptiveDampingGain());
+                pinDragIK->setFactorizationReuseEnabled(true);
                 if(pinDragIK->initialize()){
                     currentIK = pinDragIK;
                 }
@@ -1804,6 +1806,9 @@ bool OperableSceneBody::Impl::initializeIK()
     if(auto jointPath = dynamic_pointer_cast<JointPath>(currentIK)){
         if(!jointPath->hasCustomIK()){
             jointPath->setBestEffortIkMode(true);
+            // Successive targets given by dragging are close to each other
+            jointPath->setNumericalIkAdaptiveDampingGain(JointPath::numericalIkDefaultAdaptiveDampingGain());
+            jointPath->setNumericalIkFactorizationReuseEnabled(true);
         }
     }
 
@@ -0,0 +1,422 @@
+#include "PhaseProfilerItem.h"
+#include "SimulatorItem.h"
+#include <cnoid/ItemManager>
+#include <cnoid/PutPropertyFunction>
+#include <cnoid/Archive>
+#include <cnoid/MessageView>
+#include <cnoid/Timer>
+#include <cnoid/PhaseProfiler>
+#include <cnoid/UTF8>
+#include <cnoid/Format>
+#include <fstream>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include "gettext.h"
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+// The samples of bin k (k > 0) are in [2^(k - 1), 2^k) nanoseconds
+constexpr int NumHistogramBins = 40;
+
+/*
+  The samples are collected in the simulation thread at this step interval so that the ring
+  buffers of the profiler, which have 65536 samples per thread, do not overflow at a high step
+  rate regardless of the update interval
+*/
+constexpr int NumStepsPerCollection = 256;
+
+constexpr double MinUpdateInterval = 0.1;
+
+struct PhaseStatistics
+{
+    int64_t count;
+    double totalTime;
+    double maxTime;
+    int64_t bins[NumHistogramBins];
+
+    PhaseStatistics(){ clear(); }
+
+    void clear(){
+        count = 0;
+        totalTime = 0.0;
+        maxTime = 0.0;
+        std::fill(bins, bins + NumHistogramBins, 0);
+    }
+
+    void add(double time){
+        ++count;
+        totalTime += time;
+        if(time > maxTime){
+            maxTime = time;
+        }
+        auto ns = static_cast<uint64_t>(time * 1.0e9);
+        int bin = 0;
+        while(ns > 0 && bin < NumHistogramBins - 1){
+            ns >>= 1;
+            ++bin;
+        }
+        ++bins[bin];
+    }
+
+    double meanTime() const {
+        return (count > 0) ? (totalTime / count) : 0.0;
+    }
+
+    //! The upper bound of the bin containing the percentile, which is limited by the max time
+    double percentileTime(double percent) const {
+        int64_t threshold = static_cast<int64_t>(std::ceil(count * percent / 100.0));
+        int64_t accumulated = 0;
+        for(int i=0; i < NumHistogramBins; ++i){
+            accumulated += bins[i];
+            if(accumulated >= threshold){
+                return std::min(binUpperBound(i), maxTime);
+            }
+        }
+        return maxTime;
+    }
+
+    static double binUpperBound(int bin){
+        return std::ldexp(1.0, bin) * 1.0e-9;
+    }
+};
+
+}
+
+namespace cnoid {
+
+class PhaseProfilerItem::Impl
+{
+public:
+    PhaseProfilerItem* self;
+    double updateInterval;
+    string traceFile;
+    Timer updateTimer;
+    vector<PhaseProfiler::Sample> samples;
+    vector<PhaseProfiler::Sample> pendingSamples;
+    std::mutex pendingSamplesMutex;
+    int stepCounter;
+    vector<PhaseProfiler::Sample> traceSamples;
+    vector<PhaseStatistics> statistics;
+    uint64_t startTicks;
+    int64_t numDroppedSamples;
+    bool isProfiling;
+
+    Impl(PhaseProfilerItem* self);
+    Impl(PhaseProfilerItem* self, const Impl& org);
+    void initialize();
+    bool initializeSimulation(SimulatorItem* simulatorItem);
+    void collectSamplesInSimulationThread();
+    void finalizeSimulation();
+    void updateStatistics();
+    void putStatistics();
+    bool writeTraceFile();
+    void doPutProperties(PutPropertyFunction& putProperty);
+};
+
+}
+
+
+void PhaseProfilerItem::initializeClass(ExtensionManager* ext)
+{
+    ext->itemManager().registerClass<PhaseProfilerItem, SubSimulatorItem>(N_("PhaseProfilerItem"));
+    ext->itemManager().addCreationPanel<PhaseProfilerItem>();
+}
+
+
+PhaseProfilerItem::PhaseProfilerItem()
+{
+    impl = new Impl(this);
+}
+
+
+PhaseProfilerItem::Impl::Impl(PhaseProfilerItem* self)
+    : self(self)
+{
+    updateInterval = 1.0;
+    initialize();
+}
+
+
+PhaseProfilerItem::PhaseProfilerItem(const PhaseProfilerItem& org)
+    : SubSimulatorItem(org)
+{
+    impl = new Impl(this, *org.impl);
+}
+
+
+PhaseProfilerItem::Impl::Impl(PhaseProfilerItem* self, const Impl& org)
+    : self(self)
+{
+    updateInterval = org.updateInterval;
+    traceFile = org.traceFile;
+    initialize();
+}
+
+
+void PhaseProfilerItem::Impl::initialize()
+{
+    startTicks = 0;
+    stepCounter = 0;
+    numDroppedSamples = 0;
+    isProfiling = false;
+    updateTimer.sigTimeout().connect([this](){ updateStatistics(); });
+}
+
+
+PhaseProfilerItem::~PhaseProfilerItem()
+{
+    if(impl->isProfiling){
+        PhaseProfiler::setEnabled(false);
+    }
+    delete impl;
+}
+
+
+Item* PhaseProfilerItem::doCloneItem(CloneMap* /* cloneMap */) const
+{
+    return new PhaseProfilerItem(*this);
+}
+
+
+void PhaseProfilerItem::setUpdateInterval(double interval)
+{
+    impl->updateInterval = std::max(interval, MinUpdateInterval);
+}
+
+
+void PhaseProfilerItem::setTraceFile(const std::string& filename)
+{
+    impl->traceFile = filename;
+}
+
+
+bool PhaseProfilerItem::initializeSimulation(SimulatorItem* simulatorItem)
+{
+    return impl->initializeSimulation(simulatorItem);
+}
+
+
+bool PhaseProfilerItem::Impl::initializeSimulation(SimulatorItem* simulatorItem)
+{
+    statistics.clear();
+    traceSamples.clear();
+    pendingSamples.clear();
+    stepCounter = 0;
+    numDroppedSamples = 0;
+
+    PhaseProfiler::clear();
+    PhaseProfiler::setEnabled(true);
+    startTicks = PhaseProfiler::ticks();
+    isProfiling = true;
+
+    simulatorItem->addPostDynamicsFunction([this](){ collectSamplesInSimulationThread(); });
+
+    updateTimer.start(updateInterval * 1000.0);
+
+    return true;
+}
+
+
+void PhaseProfilerItem::Impl::collectSamplesInSimulationThread()
+{
+    if(++stepCounter >= NumStepsPerCollection){
+        stepCounter = 0;
+        std::lock_guard<std::mutex> lock(pendingSamplesMutex);
+        PhaseProfiler::collectSamples(pendingSamples);
+    }
+}
+
+
+void PhaseProfilerItem::finalizeSimulation()
+{
+    impl->finalizeSimulation();
+}
+
+
+void PhaseProfilerItem::Impl::finalizeSimulation()
+{
+    updateTimer.stop();
+    PhaseProfiler::setEnabled(false);
+    isProfiling = false;
+
+    // The simulation thread has finished, so all the samples can be collected here
+    updateStatistics();
+    putStatistics();
+
+    if(!traceFile.empty()){
+        writeTraceFile();
+    }
+    traceSamples.clear();
+    traceSamples.shrink_to_fit();
+}
+
+
+void PhaseProfilerItem::Impl::updateStatistics()
+{
+    {
+        std::lock_guard<std::mutex> lock(pendingSamplesMutex);
+        samples.swap(pendingSamples);
+        pendingSamples.clear();
+    }
+    if(!isProfiling){
+        // The samples recorded after the last collection in the simulation thread
+        PhaseProfiler::collectSamples(samples);
+    }
+    numDroppedSamples = PhaseProfiler::numDroppedSamples();
+
+    const double ticksPerSecond = PhaseProfiler::ticksPerSecond();
+    for(auto& sample : samples){
+        if(sample.phaseId >= static_cast<int>(statistics.size())){
+            statistics.resize(sample.phaseId + 1);
+        }
+        statistics[sample.phaseId].add((sample.endTicks - sample.beginTicks) / ticksPerSecond);
+    }
+    if(!traceFile.empty()){
+        traceSamples.insert(traceSamples.end(), samples.begin(), samples.end());
+    }
+
+    self->notifyUpdate();
+}
+
+
+void PhaseProfilerItem::Impl::putStatistics()
+{
+    auto mv = MessageView::instance();
+
+    mv->putln(formatR(_("Elapsed times of the simulation phases profiled by {0} [us]:"), self->displayName()));
+    mv->putln(formatC("{:<28} {:>10} {:>10} {:>10} {:>10} {:>10}",
+                      "phase", "count", "mean", "p50", "p99", "max"));
+    for(size_t i=0; i < statistics.size(); ++i){
+        auto& s = statistics[i];
+        if(s.count == 0){
+            continue;
+        }
+        mv->putln(formatC("{:<28} {:>10} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.2f}",
+                          PhaseProfiler::phaseName(i), s.count, s.meanTime() * 1.0e6,
+                          s.percentileTime(50.0) * 1.0e6, s.percentileTime(99.0) * 1.0e6,
+                          s.maxTime * 1.0e6));
+        // The histogram of the bins which have any sample
+        int first = 0;
+        while(first < NumHistogramBins && s.bins[first] == 0){
+            ++first;
+        }
+        int last = NumHistogramBins - 1;
+        while(last > first && s.bins[last] == 0){
+            --last;
+        }
+        for(int j = first; j <= last; ++j){
+            int barLength = static_cast<int>(50.0 * s.bins[j] / s.count + 0.5);
+            mv->putln(formatC("    < {:>12.3f} {:>10} {}",
+                              PhaseStatistics::binUpperBound(j) * 1.0e6, s.bins[j], string(barLength, '#')));
+        }
+    }
+    if(numDroppedSamples > 0){
+        mv->putln(formatR(_("{0} samples were dropped because the buffers were full."), numDroppedSamples),
+                  MessageView::Warning);
+    }
+}
+
+
+bool PhaseProfilerItem::Impl::writeTraceFile()
+{
+    ofstream ofs(fromUTF8(traceFile));
+    if(!ofs){
+        MessageView::instance()->putln(
+            formatR(_("The trace file \"{0}\" cannot be opened."), traceFile), MessageView::Error);
+        return false;
+    }
+
+    std::sort(traceSamples.begin(), traceSamples.end(),
+              [](const PhaseProfiler::Sample& s1, const PhaseProfiler::Sample& s2){
+                  return s1.beginTicks < s2.beginTicks; });
+
+    const int numPhases = PhaseProfiler::numPhases();
+    vector<string> phaseNames(numPhases);
+    for(int i=0; i < numPhases; ++i){
+        phaseNames[i] = PhaseProfiler::phaseName(i);
+    }
+    vector<string> threadNames;
+    const double ticksPerMicrosecond = PhaseProfiler::ticksPerSecond() * 1.0e-6;
+
+    ofs << "thread,phase,begin_us,duration_us\n";
+    for(auto& sample : traceSamples){
+        if(sample.threadIndex >= static_cast<int>(threadNames.size())){
+            threadNames.resize(sample.threadIndex + 1);
+        }
+        auto& threadName = threadNames[sample.threadIndex];
+        if(threadName.empty()){
+            threadName = PhaseProfiler::threadName(sample.threadIndex);
+            if(threadName.empty()){
+                threadName = formatC("thread{}", sample.threadIndex);
+            }
+        }
+        double begin = static_cast<int64_t>(sample.beginTicks - startTicks) / ticksPerMicrosecond;
+        double duration = (sample.endTicks - sample.beginTicks) / ticksPerMicrosecond;
+        ofs << formatC("{},{},{:.3f},{:.3f}\n", threadName, phaseNames[sample.phaseId], begin, duration);
+    }
+
+    MessageView::instance()->putln(
+        formatR(_("{0} samples of the simulation phases have been written to \"{1}\"."),
+                traceSamples.size(), traceFile));
+    return true;
+}
+
+
+void PhaseProfilerItem::doPutProperties(PutPropertyFunction& putProperty)
+{
+    SubSimulatorItem::doPutProperties(putProperty);
+    impl->doPutProperties(putProperty);
+}
+
+
+void PhaseProfilerItem::Impl::doPutProperties(PutPropertyFunction& putProperty)
+{
+    putProperty.min(MinUpdateInterval)(_("Update interval"), updateInterval,
+                                       [&](double interval){ self->setUpdateInterval(interval); return true; });
+
+    FilePathProperty traceFileProperty(traceFile, { string(_("CSV File (*.csv)")) });
+    traceFileProperty.setExistingFileMode(false);
+    putProperty(_("Trace file"), traceFileProperty,
+                [&](const string& file){ traceFile = file; return true; });
+
+    putProperty(_("Dropped samples"), static_cast<int>(numDroppedSamples));
+
+    // The statistics of each phase is shown as "mean / p99 / max [us] (count)"
+    for(size_t i=0; i < statistics.size(); ++i){
+        auto& s = statistics[i];
+        if(s.count > 0){
+            putProperty(PhaseProfiler::phaseName(i),
+                        formatC("{:.1f} / {:.1f} / {:.1f} [us] ({})",
+                                s.meanTime() * 1.0e6, s.percentileTime(99.0) * 1.0e6,
+                                s.maxTime * 1.0e6, s.count));
+        }
+    }
+}
+
+
+bool PhaseProfilerItem::store(Archive& archive)
+{
+    SubSimulatorItem::store(archive);
+    archive.write("update_interval", impl->updateInterval);
+    if(!impl->traceFile.empty()){
+        archive.writeRelocatablePath("trace_file", impl->traceFile);
+    }
+    return true;
+}
+
+
+bool PhaseProfilerItem::restore(const Archive& archive)
+{
+    SubSimulatorItem::restore(archive);
+    double interval;
+    if(archive.read("update_interval", interval)){
+        setUpdateInterval(interval);
+    }
+    archive.readRelocatablePath("trace_file", impl->traceFile);
+    return true;
+}
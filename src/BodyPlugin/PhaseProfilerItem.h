@@ -0,0 +1,47 @@
+#ifndef CNOID_BODY_PLUGIN_PHASE_PROFILER_ITEM_H
+#define CNOID_BODY_PLUGIN_PHASE_PROFILER_ITEM_H
+
+#include "SubSimulatorItem.h"
+#include "exportdecl.h"
+
+namespace cnoid {
+
+/**
+   This item enables the phase profiler during the simulation of the parent simulator item and
+   shows the statistics of the elapsed time of each phase of the simulation steps as the
+   properties of the item, which are periodically updated during the simulation.
+   The histograms of the phases are output to the message view when the simulation finishes,
+   and all the samples are written to the trace file as CSV when the file is specified.
+*/
+class CNOID_EXPORT PhaseProfilerItem : public SubSimulatorItem
+{
+public:
+    static void initializeClass(ExtensionManager* ext);
+
+    PhaseProfilerItem();
+    PhaseProfilerItem(const PhaseProfilerItem& org);
+    ~PhaseProfilerItem();
+
+    void setUpdateInterval(double interval);
+    void setTraceFile(const std::string& filename);
+
+    virtual bool initializeSimulation(SimulatorItem* simulatorItem) override;
+    virtual void finalizeSimulation() override;
+
+    class Impl;
+
+protected:
+    virtual Item* doCloneItem(CloneMap* cloneMap) const override;
+    virtual void doPutProperties(PutPropertyFunction& putProperty) override;
+    virtual bool store(Archive& archive) override;
+    virtual bool restore(const Archive& archive) override;
+
+private:
+    Impl* impl;
+};
+
+typedef ref_ptr<PhaseProfilerItem> PhaseProfilerItemPtr;
+
+}
+
+#endif
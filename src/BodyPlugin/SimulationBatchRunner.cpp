@@ -0,0 +1,330 @@
+#include "SimulationBatchRunner.h"
+#include "SimulationBar.h"
+#include "SimulatorItem.h"
+#include "WorldItem.h"
+#include "WorldLogFileItem.h"
+#include <cnoid/ExtensionManager>
+#include <cnoid/OptionManager>
+#include <cnoid/ProjectManager>
+#include <cnoid/MessageOut>
+#include <cnoid/LazyCaller>
+#include <cnoid/App>
+#include <cnoid/UTF8>
+#include <cnoid/Format>
+#include <cnoid/stdx/filesystem>
+#include <QCoreApplication>
+#include <QProcess>
+#include <thread>
+#include <deque>
+#include <set>
+#include <cstdlib>
+#include "gettext.h"
+
+using namespace std;
+using namespace cnoid;
+namespace filesystem = cnoid::stdx::filesystem;
+
+namespace {
+
+int numTrials = 0;
+int numJobs = 0;
+int trialIndex_ = -1;
+unsigned int randomSeed_ = 0;
+double trialTimeLength = 0.0;
+
+class BatchDispatcher
+{
+public:
+    QStringList baseArguments;
+    deque<int> trialsToStart;
+    int numRunningProcesses;
+    vector<int> failedTrials;
+    MessageOut* mout;
+
+    BatchDispatcher();
+    void start();
+    void startNextTrials();
+    void onTrialProcessFinished(QProcess* process, int trial, int exitCode, QProcess::ExitStatus exitStatus);
+    void onTrialProcessError(QProcess* process, int trial, QProcess::ProcessError error);
+    void finishTrial(QProcess* process, int trial, bool isSucceeded);
+};
+
+class TrialRunner
+{
+public:
+    set<SimulatorItem*> runningSimulators;
+    int exitCode;
+    MessageOut* mout;
+
+    TrialRunner();
+    void start();
+    void onSimulationAboutToStart(SimulatorItem* simulator);
+    void setupWorldLogFiles(SimulatorItem* simulator);
+    void onSimulationFinished(SimulatorItem* simulator, bool isForced);
+};
+
+
+void onOptionsParsed(OptionManager*)
+{
+    if(trialIndex_ >= 0){
+        (new TrialRunner)->start();
+    } else if(numTrials > 0){
+        (new BatchDispatcher)->start();
+    }
+}
+
+
+/**
+   The options for the batch simulation and the simulation start option are removed from the
+   arguments of this process, and the remaining arguments such as the project file are given
+   to the trial processes.
+*/
+QStringList getArgumentsForTrials()
+{
+    static const set<QString> optionsWithValue = {
+        "--simulation-batch", "--simulation-batch-jobs", "--simulation-seed", "--simulation-trial" };
+
+    QStringList args = QCoreApplication::arguments();
+    QStringList forwarded;
+    for(int i=1; i < args.size(); ++i){
+        const QString& arg = args[i];
+        QString name = arg.section('=', 0, 0);
+        if(optionsWithValue.count(name)){
+            if(!arg.contains('=')){
+                ++i; // skip the value
+            }
+        } else if(arg != "--start-simulation" && arg != "--no-window"){
+            forwarded << arg;
+        }
+    }
+    return forwarded;
+}
+
+
+BatchDispatcher::BatchDispatcher()
+{
+    numRunningProcesses = 0;
+    mout = MessageOut::master();
+}
+
+
+void BatchDispatcher::start()
+{
+    baseArguments = getArgumentsForTrials();
+    for(int i=0; i < numTrials; ++i){
+        trialsToStart.push_back(i);
+    }
+    if(numJobs <= 0){
+        numJobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    mout->putln(
+        formatR(_("Batch simulation of {0} trials is started with {1} jobs."), numTrials, numJobs));
+
+    startNextTrials();
+}
+
+
+void BatchDispatcher::startNextTrials()
+{
+    while(numRunningProcesses < numJobs && !trialsToStart.empty()){
+        int trial = trialsToStart.front();
+        trialsToStart.pop_front();
+        unsigned int seed = randomSeed_ + trial;
+
+        auto process = new QProcess;
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        auto env = QProcessEnvironment::systemEnvironment();
+        env.insert("CNOID_SIMULATION_SEED", QString::number(seed));
+        if(!env.contains("QT_QPA_PLATFORM")){
+            // The trial processes can run on a node without a display server
+            env.insert("QT_QPA_PLATFORM", "offscreen");
+        }
+        process->setProcessEnvironment(env);
+
+        QObject::connect(
+            process, (void(QProcess::*)(int, QProcess::ExitStatus)) &QProcess::finished,
+            [this, process, trial](int exitCode, QProcess::ExitStatus exitStatus){
+                onTrialProcessFinished(process, trial, exitCode, exitStatus);
+            });
+        QObject::connect(
+            process, &QProcess::errorOccurred,
+            [this, process, trial](QProcess::ProcessError error){
+                onTrialProcessError(process, trial, error);
+            });
+
+        QStringList args = baseArguments;
+        args << "--no-window"
+             << "--simulation-trial" << QString::number(trial)
+             << "--simulation-seed" << QString::number(seed);
+        process->start(QCoreApplication::applicationFilePath(), args);
+        ++numRunningProcesses;
+    }
+}
+
+
+void BatchDispatcher::onTrialProcessFinished
+(QProcess* process, int trial, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    finishTrial(process, trial, exitStatus == QProcess::NormalExit && exitCode == 0);
+}
+
+
+/**
+   The finished signal is not emitted when the process fails to start, so the trial is
+   finished here in that case. The other errors are followed by the finished signal.
+*/
+void BatchDispatcher::onTrialProcessError(QProcess* process, int trial, QProcess::ProcessError error)
+{
+    if(error == QProcess::FailedToStart){
+        mout->putErrorln(
+            formatR(_("The process of trial {0} cannot be started: {1}"),
+                    trial, process->errorString().toStdString()));
+        finishTrial(process, trial, false);
+    }
+}
+
+
+void BatchDispatcher::finishTrial(QProcess* process, int trial, bool isSucceeded)
+{
+    process->deleteLater();
+    --numRunningProcesses;
+
+    if(!isSucceeded){
+        failedTrials.push_back(trial);
+        mout->putErrorln(formatR(_("Trial {0} of the batch simulation failed."), trial));
+    } else {
+        mout->putln(formatR(_("Trial {0} of the batch simulation has finished."), trial));
+    }
+
+    if(!trialsToStart.empty()){
+        startNextTrials();
+
+    } else if(numRunningProcesses == 0){
+        mout->putln(
+            formatR(_("Batch simulation has finished: {0} of {1} trials succeeded."),
+                    numTrials - failedTrials.size(), numTrials));
+        int returnCode = failedTrials.empty() ? 0 : 1;
+        delete this;
+        App::exit(returnCode);
+    }
+}
+
+
+TrialRunner::TrialRunner()
+{
+    exitCode = 0;
+    mout = MessageOut::master();
+}
+
+
+void TrialRunner::start()
+{
+    std::srand(randomSeed_);
+
+    auto bar = SimulationBar::instance();
+    bar->sigSimulationAboutToStart().connect(
+        [this](SimulatorItem* simulator){ onSimulationAboutToStart(simulator); });
+    bar->startSimulation(true);
+
+    if(runningSimulators.empty()){
+        mout->putErrorln(formatR(_("Trial {0}: No simulation has been started."), trialIndex_));
+        callLater([](){ App::exit(1); });
+    }
+}
+
+
+void TrialRunner::onSimulationAboutToStart(SimulatorItem* simulator)
+{
+    // The trials should be run as fast as possible
+    simulator->setRealtimeSyncMode(SimulatorItem::NonRealtimeSync);
+
+    if(trialTimeLength > 0.0){
+        simulator->setTimeRangeMode(SimulatorItem::SpecifiedTime);
+        simulator->setTimeLength(trialTimeLength);
+
+    } else if(simulator->timeRangeMode() == SimulatorItem::UnlimitedTime &&
+              !simulator->isActiveControlTimeRangeMode()){
+        // The trial would never finish, so the simulation is stopped just after it starts
+        mout->putErrorln(
+            formatR(_("Trial {0}: The time range of {1} is unlimited. "
+                      "Specify the time length with the --simulation-time option."),
+                    trialIndex_, simulator->displayName()));
+        callLater([simulator](){ simulator->stopSimulation(true); });
+    }
+
+    setupWorldLogFiles(simulator);
+
+    runningSimulators.insert(simulator);
+    simulator->sigSimulationFinished().connect(
+        [this, simulator](bool isForced){ onSimulationFinished(simulator, isForced); });
+}
+
+
+void TrialRunner::setupWorldLogFiles(SimulatorItem* simulator)
+{
+    auto logItems = simulator->descendantItems<WorldLogFileItem>();
+    if(logItems.empty()){
+        if(auto worldItem = simulator->worldItem()){
+            logItems = worldItem->descendantItems<WorldLogFileItem>();
+        }
+    }
+    if(logItems.empty()){
+        auto logItem = new WorldLogFileItem;
+        logItem->setName(simulator->name() + "-log");
+        simulator->addChildItem(logItem);
+        logItems.push_back(logItem);
+    }
+
+    for(auto& logItem : logItems){
+        filesystem::path path(fromUTF8(logItem->logFile()));
+        if(path.empty()){
+            auto& projectFile = ProjectManager::instance()->currentProjectFile();
+            filesystem::path projectPath(fromUTF8(projectFile));
+            path = projectPath.parent_path() / fromUTF8(simulator->name() + ".log");
+        }
+        string filename =
+            path.stem().string() + formatC("-trial{:04d}", trialIndex_) + path.extension().string();
+        logItem->setTimeStampSuffixEnabled(false);
+        logItem->setLogFile(toUTF8((path.parent_path() / filename).string()));
+    }
+}
+
+
+void TrialRunner::onSimulationFinished(SimulatorItem* simulator, bool isForced)
+{
+    if(isForced){
+        exitCode = 1;
+    }
+    runningSimulators.erase(simulator);
+    if(runningSimulators.empty()){
+        mout->putln(formatR(_("Trial {0} has finished."), trialIndex_));
+        int code = exitCode;
+        callLater([code](){ App::exit(code); });
+    }
+}
+
+}
+
+
+void SimulationBatchRunner::initializeClass(ExtensionManager* /* ext */)
+{
+    auto om = OptionManager::instance();
+    om->add_option("--simulation-batch", numTrials, "run the simulation of the project as a batch of the trials");
+    om->add_option("--simulation-batch-jobs", numJobs, "the number of the trial processes running concurrently");
+    om->add_option("--simulation-seed", randomSeed_, "the random seed of the simulation");
+    om->add_option("--simulation-time", trialTimeLength, "the time length of each trial of the batch simulation");
+    om->add_option("--simulation-trial", trialIndex_, "run the simulation as a trial of the batch simulation");
+    om->sigOptionsParsed(1).connect(onOptionsParsed);
+}
+
+
+int SimulationBatchRunner::trialIndex()
+{
+    return trialIndex_;
+}
+
+
+unsigned int SimulationBatchRunner::randomSeed()
+{
+    return randomSeed_;
+}
@@ -0,0 +1,38 @@
+#ifndef CNOID_BODY_PLUGIN_SIMULATION_BATCH_RUNNER_H
+#define CNOID_BODY_PLUGIN_SIMULATION_BATCH_RUNNER_H
+
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class ExtensionManager;
+
+/**
+   This class runs the simulation of a project many times as the trials of a batch simulation.
+   Each trial is run in a child process of the application in the no window mode, and the number
+   of the processes running concurrently is limited to the number of the jobs. The simulation
+   result of each trial is written to a world log file whose name has the suffix of the trial index.
+   The batch simulation is started with the following command line options.
+
+   --simulation-batch <numTrials>
+   --simulation-batch-jobs <numJobs>  (The default value is the number of the hardware threads)
+   --simulation-seed <seed>  (The seed of the first trial. The following trials use incremented seeds.)
+   --simulation-time <timeLength>  (The time length of each trial)
+
+   A controller can use the random seed of the trial given by the randomSeed function or the
+   CNOID_SIMULATION_SEED environment variable.
+*/
+class CNOID_EXPORT SimulationBatchRunner
+{
+public:
+    static void initializeClass(ExtensionManager* ext);
+
+    //! \return The index of the trial when the process is running a trial, or -1
+    static int trialIndex();
+    
+    static unsigned int randomSeed();
+};
+
+}
+
+#endif
@@ -0,0 +1,415 @@
+#include "SimulationBenchmark.h"
+#include "SimulatorItem.h"
+#include "WorldItem.h"
+#include <cnoid/CollisionLinkPairList>
+#include <cnoid/ExtensionManager>
+#include <cnoid/OptionManager>
+#include <cnoid/ProjectManager>
+#include <cnoid/ItemManager>
+#include <cnoid/RootItem>
+#include <cnoid/MessageOut>
+#include <cnoid/LazyCaller>
+#include <cnoid/App>
+#include <cnoid/UTF8>
+#include <cnoid/Format>
+#include <cnoid/stdx/filesystem>
+#include <fstream>
+#include <chrono>
+#include <deque>
+#include "gettext.h"
+
+using namespace std;
+using namespace cnoid;
+namespace filesystem = cnoid::stdx::filesystem;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+string outputFile;
+double benchmarkTimeLength = 10.0;
+bool isAllEnginesMode = false;
+
+// The module names and the class names of the simulator items of the physics engines
+const pair<const char*, const char*> engineSimulatorClasses[] = {
+    { "Body", "AISTSimulatorItem" },
+    { "ODE", "ODESimulatorItem" },
+    { "Bullet", "BulletSimulatorItem" },
+    { "PhysX", "PhysXSimulatorItem" },
+    { "Springhead", "SpringheadSimulatorItem" },
+    { "Roki", "RokiSimulatorItem" },
+    { "AGXDynamics", "AGXSimulatorItem" }
+};
+
+struct BenchmarkResult
+{
+    string simulatorName;
+    string className;
+    double timeStep;
+    int numFrames;
+    double elapsedTime;
+    double controlTime;
+    double dynamicsTime;
+    double otherTime;
+    double numContactPoints;
+    int maxNumContactPoints;
+    bool isForced;
+
+    double simulationTime() const { return numFrames * timeStep; }
+    double realtimeFactor() const { return (elapsedTime > 0.0) ? simulationTime() / elapsedTime : 0.0; }
+    double averageTime(double time) const { return (numFrames > 0) ? time / numFrames : 0.0; }
+};
+
+class BenchmarkRunner
+{
+public:
+    deque<SimulatorItemPtr> simulators;
+    SimulatorItemPtr currentSimulator;
+    ScopedConnection finishedConnection;
+    vector<BenchmarkResult> results;
+    string projectFile;
+    MessageOut* mout;
+
+    // The following variables are accessed in the simulation thread
+    BenchmarkResult result;
+    Clock::time_point preDynamicsTime;
+    Clock::time_point midDynamicsTime;
+    Clock::time_point stepEndTime;
+
+    BenchmarkRunner();
+    void start();
+    void addEngineSimulators();
+    void startNextSimulation();
+    void onSimulationAboutToBeStarted();
+    void onPreDynamics();
+    void onMidDynamics();
+    void onPostDynamics();
+    void onSimulationFinished(bool isForced);
+    bool writeResults();
+    void writeJsonLine(ostream& os, const BenchmarkResult& r);
+    void writeCsvRow(ostream& os, const BenchmarkResult& r);
+    void finish();
+};
+
+
+double toSeconds(Clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+
+string escapeJsonString(const string& s)
+{
+    string escaped;
+    for(auto c : s){
+        if(c == '"' || c == '\\'){
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+
+string escapeCsvField(const string& s)
+{
+    if(s.find_first_of(",\"") == string::npos){
+        return s;
+    }
+    string escaped("\"");
+    for(auto c : s){
+        if(c == '"'){
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    escaped += '"';
+    return escaped;
+}
+
+
+void onOptionsParsed(OptionManager*)
+{
+    if(!outputFile.empty()){
+        // The benchmark is started after the projects given by the other options such as
+        // the Python scripts are loaded
+        callLater([](){ (new BenchmarkRunner)->start(); });
+    }
+}
+
+
+BenchmarkRunner::BenchmarkRunner()
+{
+    mout = MessageOut::master();
+}
+
+
+void BenchmarkRunner::start()
+{
+    projectFile = ProjectManager::instance()->currentProjectFile();
+
+    for(auto& simulator : RootItem::instance()->descendantItems<SimulatorItem>()){
+        simulators.push_back(simulator);
+    }
+    if(isAllEnginesMode){
+        addEngineSimulators();
+    }
+    if(simulators.empty()){
+        mout->putErrorln(_("Simulation benchmark: The project does not have any simulator item."));
+        finish();
+        return;
+    }
+
+    mout->putln(
+        formatR(_("Simulation benchmark of {0} simulator items is started."), simulators.size()));
+
+    startNextSimulation();
+}
+
+
+void BenchmarkRunner::addEngineSimulators()
+{
+    WorldItem* worldItem = nullptr;
+    if(!simulators.empty()){
+        worldItem = simulators.front()->worldItem();
+    }
+    if(!worldItem){
+        worldItem = RootItem::instance()->findItem<WorldItem>();
+    }
+    if(!worldItem){
+        mout->putErrorln(_("Simulation benchmark: The project does not have any world item."));
+        return;
+    }
+
+    for(auto& engine : engineSimulatorClasses){
+        bool isUsed = false;
+        string moduleName, className;
+        for(auto& simulator : simulators){
+            if(ItemManager::getClassIdentifier(simulator, moduleName, className) &&
+               className == engine.second){
+                isUsed = true;
+                break;
+            }
+        }
+        if(isUsed){
+            continue;
+        }
+        // The plugin of the engine is activated here if it is lazily loaded
+        ItemPtr item = ItemManager::createItem(engine.first, engine.second);
+        SimulatorItemPtr simulator = dynamic_cast<SimulatorItem*>(item.get());
+        if(!simulator){
+            mout->putln(formatR(_("Simulation benchmark: {0} is not available."), engine.second));
+            continue;
+        }
+        simulator->setName(engine.second);
+        worldItem->addChildItem(simulator);
+        simulators.push_back(simulator);
+    }
+}
+
+
+void BenchmarkRunner::startNextSimulation()
+{
+    while(!simulators.empty()){
+        currentSimulator = simulators.front();
+        simulators.pop_front();
+
+        currentSimulator->setRealtimeSyncMode(SimulatorItem::NonRealtimeSync);
+        currentSimulator->setTimeRangeMode(SimulatorItem::SpecifiedTime);
+        currentSimulator->setTimeLength(benchmarkTimeLength);
+
+        ScopedConnection aboutToBeStartedConnection(
+            currentSimulator->sigSimulationAboutToBeStarted().connect(
+                [this](){ onSimulationAboutToBeStarted(); }));
+
+        finishedConnection.reset(
+            currentSimulator->sigSimulationFinished().connect(
+                [this](bool isForced){ onSimulationFinished(isForced); }));
+
+        mout->putln(formatR(_("Simulation benchmark: {0} is started."), currentSimulator->displayName()));
+
+        if(currentSimulator->startSimulation(true)){
+            return;
+        }
+        finishedConnection.disconnect();
+        mout->putErrorln(
+            formatR(_("Simulation benchmark: {0} cannot be started."), currentSimulator->displayName()));
+    }
+
+    currentSimulator.reset();
+    finish();
+}
+
+
+void BenchmarkRunner::onSimulationAboutToBeStarted()
+{
+    auto simulator = currentSimulator;
+
+    result = BenchmarkResult();
+    result.simulatorName = simulator->displayName();
+    string moduleName;
+    if(!ItemManager::getClassIdentifier(simulator, moduleName, result.className)){
+        result.className.clear();
+    }
+    result.timeStep = simulator->worldTimeStep();
+    result.numFrames = 0;
+    result.elapsedTime = 0.0;
+    result.controlTime = 0.0;
+    result.dynamicsTime = 0.0;
+    result.otherTime = 0.0;
+    result.numContactPoints = 0.0;
+    result.maxNumContactPoints = 0;
+    result.isForced = false;
+
+    // The functions are cleared by the simulator item when the next simulation is started
+    simulator->addPreDynamicsFunction([this](){ onPreDynamics(); });
+    simulator->addMidDynamicsFunction([this](){ onMidDynamics(); });
+    simulator->addPostDynamicsFunction([this](){ onPostDynamics(); });
+}
+
+
+void BenchmarkRunner::onPreDynamics()
+{
+    preDynamicsTime = Clock::now();
+    if(result.numFrames > 0){
+        result.otherTime += toSeconds(preDynamicsTime - stepEndTime);
+    }
+}
+
+
+void BenchmarkRunner::onMidDynamics()
+{
+    midDynamicsTime = Clock::now();
+    result.controlTime += toSeconds(midDynamicsTime - preDynamicsTime);
+}
+
+
+void BenchmarkRunner::onPostDynamics()
+{
+    result.dynamicsTime += toSeconds(Clock::now() - midDynamicsTime);
+    ++result.numFrames;
+
+    int numContactPoints = 0;
+    if(auto collisions = currentSimulator->getCollisions()){
+        for(auto& linkPair : *collisions){
+            numContactPoints += linkPair->collisions().size();
+        }
+    }
+    result.numContactPoints += numContactPoints;
+    if(numContactPoints > result.maxNumContactPoints){
+        result.maxNumContactPoints = numContactPoints;
+    }
+
+    // The time to count the contact points is not included in the elapsed time
+    stepEndTime = Clock::now();
+}
+
+
+void BenchmarkRunner::onSimulationFinished(bool isForced)
+{
+    finishedConnection.disconnect();
+
+    result.isForced = isForced;
+    result.elapsedTime = result.controlTime + result.dynamicsTime + result.otherTime;
+    if(result.numFrames > 0){
+        result.numContactPoints /= result.numFrames;
+    }
+    results.push_back(result);
+
+    mout->putln(
+        formatR(_("Simulation benchmark: {0} has finished. The real-time factor is {1:.3f}."),
+                result.simulatorName, result.realtimeFactor()));
+
+    // The next simulation must be started after the current simulation is completely finished
+    callLater([this](){ startNextSimulation(); });
+}
+
+
+bool BenchmarkRunner::writeResults()
+{
+    filesystem::path path(fromUTF8(outputFile));
+    bool isCsv = (path.extension().string() == ".csv");
+    bool isNewFile = !filesystem::exists(path) || filesystem::file_size(path) == 0;
+
+    ofstream ofs(path.string(), ios::out | ios::app);
+    if(!ofs){
+        mout->putErrorln(formatR(_("Simulation benchmark: \"{0}\" cannot be opened."), outputFile));
+        return false;
+    }
+    if(isCsv && isNewFile){
+        ofs << "project,simulator,class,time_step,simulation_time,elapsed_time,realtime_factor,"
+            "frames,control_time,dynamics_time,other_time,contact_points,max_contact_points,forced\n";
+    }
+    for(auto& r : results){
+        if(isCsv){
+            writeCsvRow(ofs, r);
+        } else {
+            writeJsonLine(ofs, r);
+        }
+    }
+    return true;
+}
+
+
+/**
+   The elapsed times of the phases are the average times per step in milliseconds.
+*/
+void BenchmarkRunner::writeJsonLine(ostream& os, const BenchmarkResult& r)
+{
+    os << formatC(
+        "{{\"project\": \"{}\", \"simulator\": \"{}\", \"class\": \"{}\", \"time_step\": {}, "
+        "\"simulation_time\": {}, \"elapsed_time\": {:.6f}, \"realtime_factor\": {:.6f}, \"frames\": {}, "
+        "\"control_time\": {:.6f}, \"dynamics_time\": {:.6f}, \"other_time\": {:.6f}, "
+        "\"contact_points\": {:.3f}, \"max_contact_points\": {}, \"forced\": {}}}\n",
+        escapeJsonString(projectFile), escapeJsonString(r.simulatorName), escapeJsonString(r.className),
+        r.timeStep, r.simulationTime(), r.elapsedTime, r.realtimeFactor(), r.numFrames,
+        r.averageTime(r.controlTime) * 1.0e3, r.averageTime(r.dynamicsTime) * 1.0e3,
+        r.averageTime(r.otherTime) * 1.0e3, r.numContactPoints, r.maxNumContactPoints,
+        r.isForced ? "true" : "false");
+}
+
+
+void BenchmarkRunner::writeCsvRow(ostream& os, const BenchmarkResult& r)
+{
+    os << formatC(
+        "{},{},{},{},{},{:.6f},{:.6f},{},{:.6f},{:.6f},{:.6f},{:.3f},{},{}\n",
+        escapeCsvField(projectFile), escapeCsvField(r.simulatorName), escapeCsvField(r.className),
+        r.timeStep, r.simulationTime(), r.elapsedTime, r.realtimeFactor(), r.numFrames,
+        r.averageTime(r.controlTime) * 1.0e3, r.averageTime(r.dynamicsTime) * 1.0e3,
+        r.averageTime(r.otherTime) * 1.0e3, r.numContactPoints, r.maxNumContactPoints,
+        r.isForced ? 1 : 0);
+}
+
+
+void BenchmarkRunner::finish()
+{
+    int exitCode = 1;
+    if(!results.empty() && writeResults()){
+        mout->putln(
+            formatR(_("Simulation benchmark has finished. The results are written to \"{0}\"."), outputFile));
+        exitCode = 0;
+        for(auto& r : results){
+            if(r.isForced){
+                exitCode = 1;
+            }
+        }
+    }
+    delete this;
+    App::exit(exitCode);
+}
+
+}
+
+
+void SimulationBenchmark::initializeClass(ExtensionManager* /* ext */)
+{
+    auto om = OptionManager::instance();
+    om->add_option("--simulation-benchmark", outputFile,
+                   "run the simulations of all the simulator items of the project as a benchmark "
+                   "and write the results to the file");
+    om->add_option("--simulation-benchmark-time", benchmarkTimeLength,
+                   "the time length of each simulation of the benchmark");
+    om->add_flag("--simulation-benchmark-all-engines", isAllEnginesMode,
+                 "add a simulator item of each available physics engine to the world of the benchmark");
+    om->sigOptionsParsed(1).connect(onOptionsParsed);
+}
@@ -0,0 +1,45 @@
+#ifndef CNOID_BODY_PLUGIN_SIMULATION_BENCHMARK_H
+#define CNOID_BODY_PLUGIN_SIMULATION_BENCHMARK_H
+
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class ExtensionManager;
+
+/**
+   This class runs the simulations of a project as a benchmark of the physics engines.
+   All the simulator items of the project are run one by one without the realtime sync for the
+   specified time length, and the result of each simulator item is appended to the output file
+   as a line of the JSON object or a row of CSV when the file name has the ".csv" extension.
+   The result contains the real-time factor, the average elapsed times of the control phase,
+   the dynamics phase and the other phase of a simulation step, and the average and maximum
+   numbers of the contact points. The numbers of the contact points are only available for the
+   simulator items which implement the getCollisions function, and the time taken to count them
+   is excluded from the elapsed times. The benchmark is started with the following options.
+
+   --simulation-benchmark <outputFile>
+   --simulation-benchmark-time <timeLength>  (The default value is 10 seconds)
+   --simulation-benchmark-all-engines
+
+   The last option adds a simulator item of each available physics engine which is not used in
+   the project to the world item so that the engines can be compared with the same world.
+   The items are created with the default parameters, and the plugins of the engines are
+   activated when they are lazily loaded.
+
+   The application exits after all the simulations have finished, so a set of the projects
+   such as the following ones can be benchmarked with a shell loop in the no window mode.
+
+   sample/SimpleController/Tank.cnoid
+   sample/HRP4C/HRP4C-TurnToTheFuture.cnoid
+   sample/WRS2018/script/T1M-AizuSpiderSS.py
+*/
+class CNOID_EXPORT SimulationBenchmark
+{
+public:
+    static void initializeClass(ExtensionManager* ext);
+};
+
+}
+
+#endif
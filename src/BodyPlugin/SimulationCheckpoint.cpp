@@ -0,0 +1,357 @@
+#include "SimulationCheckpoint.h"
+#include <cnoid/Body>
+#include <cnoid/Link>
+#include <cnoid/Device>
+#include <cnoid/ValueTree>
+#include <cnoid/YAMLReader>
+#include <cnoid/YAMLWriter>
+#include <cnoid/EigenUtil>
+#include <cnoid/Format>
+#include <vector>
+#include <map>
+#include <ostream>
+#include "gettext.h"
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+/*
+  The order of the elements is x, y, z, qx, qy, qz, qw, vx, vy, vz, wx, wy, wz,
+  dvx, dvy, dvz, dwx, dwy, dwz, q, dq, ddq, u
+*/
+constexpr int LinkStateSize = 23;
+
+// The values must be written without the loss of the precision to restore the same simulation
+const char* FloatingNumberFormat = "%.17g";
+
+struct BodyStateRecord
+{
+    string name;
+    vector<double> linkStates;
+    vector<vector<double>> deviceStates;
+};
+
+}
+
+namespace cnoid {
+
+class SimulationCheckpoint::Impl
+{
+public:
+    double time;
+    vector<BodyStateRecord> bodies;
+    MappingPtr simulatorState;
+    map<string, MappingPtr> controllerStates;
+
+    Impl();
+    MappingPtr createArchive();
+    bool restoreFromArchive(const Mapping* archive, std::ostream& os);
+};
+
+}
+
+
+SimulationCheckpoint::SimulationCheckpoint()
+{
+    impl = new Impl;
+}
+
+
+SimulationCheckpoint::Impl::Impl()
+{
+    time = 0.0;
+    simulatorState = new Mapping;
+    simulatorState->setFloatingNumberFormat(FloatingNumberFormat);
+}
+
+
+SimulationCheckpoint::~SimulationCheckpoint()
+{
+    delete impl;
+}
+
+
+double SimulationCheckpoint::time() const
+{
+    return impl->time;
+}
+
+
+void SimulationCheckpoint::setTime(double time)
+{
+    impl->time = time;
+}
+
+
+int SimulationCheckpoint::numBodies() const
+{
+    return impl->bodies.size();
+}
+
+
+const std::string& SimulationCheckpoint::bodyName(int index) const
+{
+    return impl->bodies[index].name;
+}
+
+
+void SimulationCheckpoint::storeBodyState(int index, const std::string& name, const Body* body)
+{
+    if(index >= static_cast<int>(impl->bodies.size())){
+        impl->bodies.resize(index + 1);
+    }
+    auto record = &impl->bodies[index];
+    record->name = name;
+
+    const int numLinks = body->numLinks();
+    record->linkStates.resize(numLinks * LinkStateSize);
+    double* p = record->linkStates.data();
+    for(int i=0; i < numLinks; ++i){
+        auto link = body->link(i);
+        Vector3::Map(p) = link->translation();
+        Eigen::Map<Quaternion> rotation(p + 3);
+        rotation = link->rotation();
+        Vector3::Map(p + 7) = link->v();
+        Vector3::Map(p + 10) = link->w();
+        Vector3::Map(p + 13) = link->dv();
+        Vector3::Map(p + 16) = link->dw();
+        p[19] = link->q();
+        p[20] = link->dq();
+        p[21] = link->ddq();
+        p[22] = link->u();
+        p += LinkStateSize;
+    }
+
+    const int numDevices = body->numDevices();
+    record->deviceStates.resize(numDevices);
+    for(int i=0; i < numDevices; ++i){
+        auto device = body->device(i);
+        auto& state = record->deviceStates[i];
+        state.resize(device->stateSize());
+        device->writeState(state.data());
+    }
+}
+
+
+bool SimulationCheckpoint::restoreBodyState(int index, const std::string& name, Body* body) const
+{
+    if(index < 0 || index >= static_cast<int>(impl->bodies.size())){
+        return false;
+    }
+    auto record = &impl->bodies[index];
+    if(record->name != name){
+        return false;
+    }
+    const int numLinks = body->numLinks();
+    const int numDevices = body->numDevices();
+    if(static_cast<int>(record->linkStates.size()) != numLinks * LinkStateSize ||
+       static_cast<int>(record->deviceStates.size()) != numDevices){
+        return false;
+    }
+    for(int i=0; i < numDevices; ++i){
+        if(static_cast<int>(record->deviceStates[i].size()) != body->device(i)->stateSize()){
+            return false;
+        }
+    }
+
+    const double* p = record->linkStates.data();
+    for(int i=0; i < numLinks; ++i){
+        auto link = body->link(i);
+        link->setTranslation(Eigen::Map<const Vector3>(p));
+        link->setRotation(Eigen::Map<const Quaternion>(p + 3).toRotationMatrix());
+        link->v() = Eigen::Map<const Vector3>(p + 7);
+        link->w() = Eigen::Map<const Vector3>(p + 10);
+        link->dv() = Eigen::Map<const Vector3>(p + 13);
+        link->dw() = Eigen::Map<const Vector3>(p + 16);
+        link->q() = p[19];
+        link->dq() = p[20];
+        link->ddq() = p[21];
+        link->u() = p[22];
+        link->q_target() = link->q();
+        link->dq_target() = link->dq();
+        p += LinkStateSize;
+    }
+
+    for(int i=0; i < numDevices; ++i){
+        body->device(i)->readState(record->deviceStates[i].data());
+    }
+
+    return true;
+}
+
+
+Mapping* SimulationCheckpoint::simulatorState()
+{
+    return impl->simulatorState;
+}
+
+
+const Mapping* SimulationCheckpoint::simulatorState() const
+{
+    return impl->simulatorState;
+}
+
+
+Mapping* SimulationCheckpoint::getOrCreateControllerState(const std::string& key)
+{
+    auto& state = impl->controllerStates[key];
+    if(!state){
+        state = new Mapping;
+        state->setFloatingNumberFormat(FloatingNumberFormat);
+    }
+    return state;
+}
+
+
+void SimulationCheckpoint::removeControllerState(const std::string& key)
+{
+    impl->controllerStates.erase(key);
+}
+
+
+const Mapping* SimulationCheckpoint::findControllerState(const std::string& key) const
+{
+    auto p = impl->controllerStates.find(key);
+    if(p != impl->controllerStates.end()){
+        return p->second;
+    }
+    return nullptr;
+}
+
+
+bool SimulationCheckpoint::save(const std::string& filename, std::ostream& os)
+{
+    YAMLWriter writer;
+    if(!writer.openFile(filename)){
+        os << formatR(_("\"{}\" cannot be opened."), filename) << endl;
+        return false;
+    }
+    writer.setKeyOrderPreservationMode(true);
+    writer.putNode(impl->createArchive());
+    writer.closeFile();
+    return true;
+}
+
+
+MappingPtr SimulationCheckpoint::Impl::createArchive()
+{
+    MappingPtr archive = new Mapping;
+    archive->setFloatingNumberFormat(FloatingNumberFormat);
+    archive->write("type", "SimulationCheckpoint");
+    archive->write("format_version", "1.0");
+    archive->write("time", time);
+
+    auto bodyList = archive->createListing("bodies");
+    for(auto& body : bodies){
+        auto node = bodyList->newMapping();
+        node->write("name", body.name, DOUBLE_QUOTED);
+        auto linkStates = node->createListing("link_states");
+        for(size_t i=0; i < body.linkStates.size(); i += LinkStateSize){
+            ListingPtr state = new Listing;
+            state->setFlowStyle(true);
+            state->setFloatingNumberFormat(FloatingNumberFormat);
+            linkStates->append(state);
+            for(int j=0; j < LinkStateSize; ++j){
+                state->append(body.linkStates[i + j]);
+            }
+        }
+        auto deviceStates = node->createListing("device_states");
+        for(auto& deviceState : body.deviceStates){
+            ListingPtr state = new Listing;
+            state->setFlowStyle(true);
+            state->setFloatingNumberFormat(FloatingNumberFormat);
+            deviceStates->append(state);
+            for(auto& value : deviceState){
+                state->append(value);
+            }
+        }
+    }
+
+    archive->insert("simulator_state", simulatorState);
+
+    auto controllers = archive->createMapping("controller_states");
+    for(auto& kv : controllerStates){
+        controllers->insert(kv.first, kv.second);
+    }
+
+    return archive;
+}
+
+
+bool SimulationCheckpoint::load(const std::string& filename, std::ostream& os)
+{
+    YAMLReader reader;
+    bool loaded = false;
+    try {
+        auto archive = reader.loadDocument(filename)->toMapping();
+        loaded = impl->restoreFromArchive(archive, os);
+    } catch(const ValueNode::Exception& ex){
+        os << ex.message() << endl;
+    }
+    return loaded;
+}
+
+
+bool SimulationCheckpoint::Impl::restoreFromArchive(const Mapping* archive, std::ostream& os)
+{
+    if(archive->get<string>("type") != "SimulationCheckpoint"){
+        os << _("The file is not a simulation checkpoint.") << endl;
+        return false;
+    }
+
+    time = archive->get<double>("time");
+
+    bodies.clear();
+    auto bodyList = archive->findListing("bodies");
+    if(bodyList->isValid()){
+        for(auto& bodyNode : *bodyList){
+            auto node = bodyNode->toMapping();
+            bodies.emplace_back();
+            auto& body = bodies.back();
+            body.name = node->get<string>("name");
+            auto linkStates = node->findListing("link_states");
+            if(linkStates->isValid()){
+                for(auto& stateNode : *linkStates){
+                    auto state = stateNode->toListing();
+                    if(state->size() != LinkStateSize){
+                        stateNode->throwException(_("The size of the link state is invalid."));
+                    }
+                    for(auto& value : *state){
+                        body.linkStates.push_back(value->toDouble());
+                    }
+                }
+            }
+            auto deviceStates = node->findListing("device_states");
+            if(deviceStates->isValid()){
+                for(auto& stateNode : *deviceStates){
+                    body.deviceStates.emplace_back();
+                    for(auto& value : *stateNode->toListing()){
+                        body.deviceStates.back().push_back(value->toDouble());
+                    }
+                }
+            }
+        }
+    }
+
+    auto stateNode = archive->findMapping("simulator_state");
+    if(stateNode->isValid()){
+        simulatorState = stateNode;
+    } else {
+        simulatorState = new Mapping;
+    }
+    simulatorState->setFloatingNumberFormat(FloatingNumberFormat);
+
+    controllerStates.clear();
+    auto controllers = archive->findMapping("controller_states");
+    if(controllers->isValid()){
+        for(auto& kv : *controllers){
+            MappingPtr state = kv.second->toMapping();
+            state->setFloatingNumberFormat(FloatingNumberFormat);
+            controllerStates[kv.first] = state;
+        }
+    }
+
+    return true;
+}
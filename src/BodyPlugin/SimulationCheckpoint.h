@@ -0,0 +1,76 @@
+#ifndef CNOID_BODY_PLUGIN_SIMULATION_CHECKPOINT_H
+#define CNOID_BODY_PLUGIN_SIMULATION_CHECKPOINT_H
+
+#include <cnoid/Referenced>
+#include <string>
+#include <iosfwd>
+#include "exportdecl.h"
+
+namespace cnoid {
+
+class Body;
+class Mapping;
+
+/**
+   This class keeps the dynamic state of a simulation at a certain time. The state consists of
+   the link states including the velocities and accelerations, the device states, the simulator
+   specific state such as the warm start data of the constraint force solver, and the controller
+   states. A checkpoint is created by SimulatorItem::createCheckpoint or requestCheckpoint and
+   a new simulation can be started from it by SimulatorItem::startSimulationFromCheckpoint.
+   A checkpoint can also be saved to a file and loaded from the file.
+*/
+class CNOID_EXPORT SimulationCheckpoint : public Referenced
+{
+public:
+    SimulationCheckpoint();
+    ~SimulationCheckpoint();
+
+    SimulationCheckpoint(const SimulationCheckpoint& org) = delete;
+    SimulationCheckpoint& operator=(const SimulationCheckpoint& rhs) = delete;
+
+    //! The simulation time when the checkpoint was created
+    double time() const;
+    void setTime(double time);
+
+    int numBodies() const;
+    const std::string& bodyName(int index) const;
+
+    /**
+       The body states are identified by the indices of the simulation bodies so that the bodies
+       with the same name can be distinguished. The name is stored to check the correspondence.
+    */
+    void storeBodyState(int index, const std::string& name, const Body* body);
+
+    /**
+       \return false if the checkpoint does not have the state of the body index, the name does not
+       match the stored name or the state does not match the structure of the body.
+    */
+    bool restoreBodyState(int index, const std::string& name, Body* body) const;
+
+    /**
+       The state specific to the simulator implementation. The state is stored and
+       restored by the simulator item.
+    */
+    Mapping* simulatorState();
+    const Mapping* simulatorState() const;
+
+    Mapping* getOrCreateControllerState(const std::string& key);
+    void removeControllerState(const std::string& key);
+
+    //! \return nullptr if the checkpoint does not have the state of the controller
+    const Mapping* findControllerState(const std::string& key) const;
+
+    bool save(const std::string& filename, std::ostream& os);
+    bool load(const std::string& filename, std::ostream& os);
+
+    class Impl;
+
+private:
+    Impl* impl;
+};
+
+typedef ref_ptr<SimulationCheckpoint> SimulationCheckpointPtr;
+
+}
+
+#endif
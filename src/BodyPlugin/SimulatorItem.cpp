@@ -16,6 +16,7 @@
 #include <cnoid/ItemTreeView>
 #include <cnoid/ControllerIO>
 #include <cnoid/BodyState>
+#include <cnoid/SceneUpdate>
 #include <cnoid/App>
 #include <cnoid/TimeBar>
 #include <cnoid/MessageView>
@@ -31,6 +32,8 @@
 #include <cnoid/CloneMap>
 #include <cnoid/CollisionDetector>
 #include <cnoid/Format>
+#include <cnoid/PhaseProfiler>
+#include <cnoid/Tracer>
 #include <QThread>
 #include <QMutex>
 #include <QElapsedTimer>
@@ -53,6 +56,39 @@ static const char* timeRangeModeSymbols[] = { "unlimited", "specified", "timebar
 
 typedef map<weak_ref_ptr<BodyItem>, SimulationBodyPtr> BodyItemToSimBodyMap;
 
+struct PhaseIds
+{
+    int step;
+    int bufferRecords;
+    int controllerInput;
+    int controllerControl;
+    int controllerOutput;
+    int preDynamics;
+    int midDynamics;
+    int postDynamics;
+    int stepSimulation;
+    int flushRecords;
+
+    PhaseIds(){
+        step = PhaseProfiler::registerPhase("simulation/step");
+        bufferRecords = PhaseProfiler::registerPhase("simulation/bufferRecords");
+        controllerInput = PhaseProfiler::registerPhase("controller/input");
+        controllerControl = PhaseProfiler::registerPhase("controller/control");
+        controllerOutput = PhaseProfiler::registerPhase("controller/output");
+        preDynamics = PhaseProfiler::registerPhase("simulation/preDynamics");
+        midDynamics = PhaseProfiler::registerPhase("simulation/midDynamics");
+        postDynamics = PhaseProfiler::registerPhase("simulation/postDynamics");
+        stepSimulation = PhaseProfiler::registerPhase("simulation/stepSimulation");
+        flushRecords = PhaseProfiler::registerPhase("simulation/flushRecords");
+    }
+};
+
+const PhaseIds& phaseIds()
+{
+    static PhaseIds ids;
+    return ids;
+}
+
 struct FunctionSet
 {
     struct FunctionInfo {
@@ -226,6 +262,7 @@ public:
     void bufferBodyDeviceState(Body* body, BodyStateBlock& stateBlock);
     void flushRecords();
     void flushRecordsToBodyMotionItems();
+    size_t estimateMemoryUsageOfRecordFrames(int firstFrame);
     void flushRecordsToLastStateBuffers();
     void updateFrontendBodyStatelWithLastRecords(double time);
     void flushRecordsToWorldLogFile(int bufferFrame);
@@ -281,6 +318,8 @@ public:
     double timeLength;
     int maxFrame;
     int ringBufferSize;
+    double recordingMemoryLimit;
+    size_t recordMemoryUsage;
     int currentRealtimeSyncMode;
     bool isRecordingEnabled;
     bool isRingBufferMode;
@@ -341,6 +380,11 @@ public:
     VirtualElasticString virtualElasticString;
 
     SimulationLogEnginePtr logEngine;
+
+    SimulationCheckpointPtr checkpointToRestore;
+    std::mutex checkpointMutex;
+    vector<std::function<void(SimulationCheckpoint* checkpoint)>> checkpointCallbacks;
+    volatile bool isCheckpointRequested;
     
     Connection aboutToQuitConnection;
 
@@ -355,6 +399,9 @@ public:
     void resetSimulatorItemForControllerItem(ControllerItem* controllerItem);
     bool startSimulation(bool doReset);
     bool initializeSimulation(bool doReset);
+    bool startSimulationFromCheckpoint(SimulationCheckpoint* checkpoint);
+    string getCheckpointKeyOfController(ControllerInfo* info);
+    void restoreControllerStateFromCheckpoint(ControllerInfo* info);
     virtual void run() override;
     void onSimulationLoopStarted();
     void updateSimBodyLists();
@@ -364,9 +411,14 @@ public:
     void startFlushTimer();
     void flushRecords();
     int flushMainRecords();
+    void switchRecordingToRingBufferMode();
+    size_t estimateMemoryUsage();
     void stopSimulation(bool isForced, bool doSync);
     void pauseSimulation();
     void restartSimulation();
+    SimulationCheckpointPtr createCheckpoint();
+    bool requestCheckpoint(std::function<void(SimulationCheckpoint* checkpoint)> callback);
+    void serveCheckpointRequests();
     void onSimulationLoopStopped(bool isForced);
     bool isActive() const;
     void setExternalForce(BodyItem* bodyItem, Link* link, const Vector3& point, const Vector3& f, double time);
@@ -1098,6 +1150,7 @@ void SimulationBody::Impl::flushRecords()
 void SimulationBody::Impl::flushRecordsToBodyMotionItems()
 {
     const int ringBufferSize = simImpl->ringBufferSize;
+    const int prevNumFrames = bodyStateRecord->numFrames();
     bool offsetChanged = false;
 
     // Step 1 (Use the move copy)
@@ -1132,7 +1185,26 @@ void SimulationBody::Impl::flushRecordsToBodyMotionItems()
         const int nextFrame = simImpl->currentFrame + 1;
         int offset = nextFrame - ringBufferSize;
         bodyStateRecord->setOffsetTimeFrame(offset);
+
+    } else if(simImpl->recordingMemoryLimit > 0.0 && !simImpl->isRingBufferMode){
+        simImpl->recordMemoryUsage += estimateMemoryUsageOfRecordFrames(prevNumFrames);
+    }
+}
+
+
+size_t SimulationBody::Impl::estimateMemoryUsageOfRecordFrames(int firstFrame)
+{
+    // The device states shared with the previous frame have already been counted
+    std::unordered_set<const DeviceState*> countedDeviceStates;
+    if(firstFrame > 0){
+        bodyStateRecord->frame(firstFrame - 1).estimateMemoryUsage(countedDeviceStates);
+    }
+    size_t size = 0;
+    const int numFrames = bodyStateRecord->numFrames();
+    for(int i = firstFrame; i < numFrames; ++i){
+        size += sizeof(BodyState) + bodyStateRecord->frame(i).estimateMemoryUsage(countedDeviceStates);
     }
+    return size;
 }
 
 
@@ -1248,6 +1320,7 @@ SimulatorItem::Impl::Impl(SimulatorItem* self)
     realtimeSyncMode.select(CompensatoryRealtimeSync);
 
     timeLength = 180.0; // 3 min.
+    recordingMemoryLimit = 0.0;
     useControllerThreadsProperty = true;
     isActiveControlTimeRangeMode = false;
     isAllLinkPositionOutputMode = true;
@@ -1256,6 +1329,7 @@ SimulatorItem::Impl::Impl(SimulatorItem* self)
     isCollisionDataRecordingEnabled = false;
     isSceneViewEditModeBlockedDuringSimulation = false;
     isSimulationFromInitialState = false;
+    isCheckpointRequested = false;
 
     timeBar = TimeBar::instance();
 }
@@ -1280,6 +1354,7 @@ SimulatorItem::Impl::Impl(SimulatorItem* self, const Impl& org)
     realtimeSyncMode = org.realtimeSyncMode;
 
     timeLength = org.timeLength;
+    recordingMemoryLimit = org.recordingMemoryLimit;
     useControllerThreadsProperty = org.useControllerThreadsProperty;
     isActiveControlTimeRangeMode = org.isActiveControlTimeRangeMode;
     isAllLinkPositionOutputMode = org.isAllLinkPositionOutputMode;
@@ -1287,6 +1362,7 @@ SimulatorItem::Impl::Impl(SimulatorItem* self, const Impl& org)
     isCollisionDataRecordingEnabled = org.isCollisionDataRecordingEnabled;
     controllerOptionString_ = org.controllerOptionString_;
     isSimulationFromInitialState = false;
+    isCheckpointRequested = false;
 }
     
 
@@ -1375,12 +1451,30 @@ void SimulatorItem::setTimeRangeMode(int mode)
 }
 
 
+int SimulatorItem::timeRangeMode() const
+{
+    return impl->timeRangeMode.which();
+}
+
+
 void SimulatorItem::setTimeLength(double length)
 {
     impl->timeLength = length;
 }
 
 
+void SimulatorItem::setRecordingMemoryLimit(double megaBytes)
+{
+    impl->recordingMemoryLimit = megaBytes;
+}
+
+
+double SimulatorItem::recordingMemoryLimit() const
+{
+    return impl->recordingMemoryLimit;
+}
+
+
 void SimulatorItem::setActiveControlTimeRangeMode(bool on)
 {
     impl->isActiveControlTimeRangeMode = on;
@@ -1683,6 +1777,42 @@ bool SimulatorItem::Impl::startSimulation(bool doReset)
 }
 
 
+bool SimulatorItem::startSimulationFromCheckpoint(SimulationCheckpoint* checkpoint)
+{
+    return impl->startSimulationFromCheckpoint(checkpoint);
+}
+
+
+bool SimulatorItem::Impl::startSimulationFromCheckpoint(SimulationCheckpoint* checkpoint)
+{
+    checkpointToRestore = checkpoint;
+    bool started = startSimulation(false);
+    checkpointToRestore.reset();
+    return started;
+}
+
+
+string SimulatorItem::Impl::getCheckpointKeyOfController(ControllerInfo* info)
+{
+    if(auto bodyItem = info->simBodyImpl->bodyItem){
+        return bodyItem->name() + "/" + info->controller->name();
+    }
+    return info->controller->name();
+}
+
+
+void SimulatorItem::Impl::restoreControllerStateFromCheckpoint(ControllerInfo* info)
+{
+    if(auto state = checkpointToRestore->findControllerState(getCheckpointKeyOfController(info))){
+        if(!info->controller->restoreCheckpointState(state)){
+            mv->putln(formatR(_("The state of {0} cannot be restored from the checkpoint."),
+                              info->controller->displayName()),
+                      MessageView::Warning);
+        }
+    }
+}
+
+
 /*
   Note that the following function is is not the implementation of the
   SimulatorItem::initializeSimulation function. SimulatorItem::initializeSimulation implements
@@ -1763,6 +1893,13 @@ bool SimulatorItem::Impl::initializeSimulation(bool doReset)
                         simBodyMap.erase(bodyItem);
 
                     } else {
+                        if(checkpointToRestore &&
+                           !checkpointToRestore->restoreBodyState(
+                               simBodiesWithBody.size(), bodyItem->name(), simBody->body())){
+                            mv->putln(formatR(_("The state of {0} cannot be restored from the checkpoint."),
+                                              bodyItem->displayName()),
+                                      MessageView::Warning);
+                        }
                         // copy the body state overwritten by the controller
                         simBody->impl->copyStateToBodyItem();
 
@@ -1798,6 +1935,12 @@ bool SimulatorItem::Impl::initializeSimulation(bool doReset)
         return false;
     }
 
+    if(checkpointToRestore && !self->restoreCheckpointState(checkpointToRestore)){
+        mv->putln(formatR(_("The simulator specific state of {0} cannot be restored from the checkpoint."),
+                          self->displayName()),
+                  MessageView::Warning);
+    }
+
     subSimulatorItems.extractAssociatedItems(self);
     auto p = subSimulatorItems.begin();
     while(p != subSimulatorItems.end()){
@@ -1842,6 +1985,7 @@ bool SimulatorItem::Impl::initializeSimulation(bool doReset)
     // Initialize recording
     numBufferedFrames = 0;
     frameAtLastBufferWriting = 0;
+    recordMemoryUsage = 0;
     for(auto& simBody : activeSimBodies){
         if(simBody->body()){
             simBody->impl->initializeRecording();
@@ -1897,6 +2041,9 @@ bool SimulatorItem::Impl::initializeSimulation(bool doReset)
                 }
             }
             if(ready){
+                if(checkpointToRestore){
+                    restoreControllerStateFromCheckpoint(info);
+                }
                 activeControllerInfos.push_back(info);
                 ++iter;
             } else {
@@ -2051,6 +2198,8 @@ SimulationBody* SimulatorItem::findSimulationBody(const std::string& name)
 // Simulation loop
 void SimulatorItem::Impl::run()
 {
+    PhaseProfiler::setCurrentThreadName("Simulation");
+    
     self->initializeSimulationThread();
 
     double elapsedTime = 0.0;
@@ -2071,6 +2220,9 @@ void SimulatorItem::Impl::run()
                     isOnPause = true;
                     sigSimulationPaused();
                 }
+                if(isCheckpointRequested){
+                    serveCheckpointRequests();
+                }
                 QThread::msleep(50);
             } else {
                 if(isOnPause){
@@ -2098,6 +2250,9 @@ void SimulatorItem::Impl::run()
                     isOnPause = true;
                     sigSimulationPaused();
                 }
+                if(isCheckpointRequested){
+                    serveCheckpointRequests();
+                }
                 QThread::msleep(50);
             } else {
                 if(isOnPause){
@@ -2140,6 +2295,10 @@ void SimulatorItem::Impl::run()
     actualSimulationTime = (elapsedTime / 1000.0);
     finishTime = frame / worldFrameRate;
 
+    if(isCheckpointRequested){
+        serveCheckpointRequests();
+    }
+
     isDoingSimulationLoop = false;
 
     if(useControllerThreads){
@@ -2163,19 +2322,32 @@ void SimulatorItem::Impl::run()
 
 bool SimulatorItem::Impl::stepSimulationMain()
 {
+    auto& phase = phaseIds();
+    ScopedPhaseTimer stepTimer(phase.step);
+    
     // Recored the positions at the beginning of the current frame
     bufferRecords();
 
     bool doContinue = !doStopSimulationWhenNoActiveControllers;
 
-    preDynamicsFunctions.call();
+    {
+        ScopedPhaseTimer timer(phase.preDynamics);
+        preDynamicsFunctions.call();
+    }
 
     if(!useControllerThreads){
         for(auto& info : activeControllerInfos){
             auto& controller = info->controller;
-            controller->input();
-            doContinue |= controller->control();
+            {
+                ScopedPhaseTimer timer(phase.controllerInput);
+                controller->input();
+            }
+            {
+                ScopedPhaseTimer timer(phase.controllerControl);
+                doContinue |= controller->control();
+            }
             if(controller->isNoDelayMode()){
+                ScopedPhaseTimer timer(phase.controllerOutput);
                 controller->output();
             }
         }
@@ -2186,7 +2358,10 @@ bool SimulatorItem::Impl::stepSimulationMain()
             if(controller->isNoDelayMode()){
                 hasNoDelayModeControllers = true;
             }
-            info->controller->input();
+            {
+                ScopedPhaseTimer timer(phase.controllerInput);
+                info->controller->input();
+            }
             {
                 std::lock_guard<std::mutex> lock(info->controlMutex);                
                 info->isControlRequested = true;
@@ -2201,15 +2376,22 @@ bool SimulatorItem::Impl::stepSimulationMain()
                     if(info->waitForControlInThreadToFinish()){
                         doContinue = true;
                     }
+                    ScopedPhaseTimer timer(phase.controllerOutput);
                     info->controller->output();
                 }
             }
         }
     }
 
-    midDynamicsFunctions.call();
+    {
+        ScopedPhaseTimer timer(phase.midDynamics);
+        midDynamicsFunctions.call();
+    }
 
-    self->stepSimulation(activeSimBodies);
+    {
+        ScopedPhaseTimer timer(phase.stepSimulation);
+        self->stepSimulation(activeSimBodies);
+    }
 
     if(doRecordCollisionData){
         bufferCollisionRecords();
@@ -2225,10 +2407,14 @@ bool SimulatorItem::Impl::stepSimulationMain()
         }
     }
 
-    postDynamicsFunctions.call();
+    {
+        ScopedPhaseTimer timer(phase.postDynamics);
+        postDynamicsFunctions.call();
+    }
 
     for(auto& info : activeControllerInfos){
         if(!info->controller->isNoDelayMode()){
+            ScopedPhaseTimer timer(phase.controllerOutput);
             info->controller->output();
         }
     }
@@ -2236,6 +2422,10 @@ bool SimulatorItem::Impl::stepSimulationMain()
     ++currentFrame;
     currentTime_ = currentFrame / worldFrameRate;
 
+    if(isCheckpointRequested){
+        serveCheckpointRequests();
+    }
+
     return doContinue;
 }
 
@@ -2253,6 +2443,8 @@ bool ControllerInfo::waitForControlInThreadToFinish()
 
 void ControllerInfo::concurrentControlLoop()
 {
+    PhaseProfiler::setCurrentThreadName(controller->name());
+    
     while(true){
         {
             std::unique_lock<std::mutex> lock(controlMutex);
@@ -2269,7 +2461,11 @@ void ControllerInfo::concurrentControlLoop()
             }
         }
 
-        bool doContinue = controller->control();
+        bool doContinue;
+        {
+            ScopedPhaseTimer timer(phaseIds().controllerControl);
+            doContinue = controller->control();
+        }
         
         {
             std::lock_guard<std::mutex> lock(controlMutex);
@@ -2286,6 +2482,8 @@ exitConcurrentControlLoop:
 
 void SimulatorItem::Impl::bufferRecords()
 {
+    ScopedPhaseTimer timer(phaseIds().bufferRecords);
+    
     recordBufMutex.lock();
 
     for(size_t i=0; i < activeSimBodies.size(); ++i){
@@ -2318,6 +2516,8 @@ void SimulatorItem::Impl::startFlushTimer()
 
 void SimulatorItem::Impl::flushRecords()
 {
+    ScopedPhaseTimer timer(phaseIds().flushRecords);
+    
     int frame = flushMainRecords();
 
     sigLogFlushRequested();
@@ -2328,6 +2528,7 @@ void SimulatorItem::Impl::flushRecords()
 
     if(!isRecordingEnabled){
         const double time = frame / worldFrameRate;
+        SgUpdateBatchScope sceneUpdateBatch;
         for(auto& simBody : activeSimBodies){
             simBody->impl->updateFrontendBodyStatelWithLastRecords(time);
         }
@@ -2339,8 +2540,12 @@ void SimulatorItem::Impl::flushRecords()
 
 int SimulatorItem::Impl::flushMainRecords()
 {
+    static const int bufferedFramesCounter = Tracer::registerName("simulation/bufferedFrames");
+    
     recordBufMutex.lock();
 
+    Tracer::counter(bufferedFramesCounter, numBufferedFrames);
+
     if(worldLogFileItem){
         if(numBufferedFrames > 0){
             int firstFrame = frameAtLastBufferWriting - (numBufferedFrames - 1);
@@ -2362,6 +2567,8 @@ int SimulatorItem::Impl::flushMainRecords()
         simBody->flushRecords();
     }
 
+    const bool isRecordMemoryUsageCounted = (recordingMemoryLimit > 0.0 && !isRingBufferMode);
+
     bool offsetChanged;
     if(doRecordCollisionData){
         offsetChanged = false;
@@ -2372,6 +2579,9 @@ int SimulatorItem::Impl::flushMainRecords()
             }
             CollisionSeq::Frame collisionSeq0 = collisionSeq->appendFrame();
             collisionSeq0[0] = collisionPairsBuf[i];
+            if(isRecordMemoryUsageCounted && collisionPairsBuf[i]){
+                recordMemoryUsage += CollisionSeq::estimateFrameMemoryUsage(*collisionPairsBuf[i]);
+            }
         }
         if(offsetChanged){
             collisionSeq->setOffsetTimeFrame(currentFrame + 1 - collisionSeq->numFrames());
@@ -2379,6 +2589,10 @@ int SimulatorItem::Impl::flushMainRecords()
     }
     collisionPairsBuf.clear();
 
+    if(isRecordMemoryUsageCounted && recordMemoryUsage > recordingMemoryLimit * 1024.0 * 1024.0){
+        switchRecordingToRingBufferMode();
+    }
+
     int frame = frameAtLastBufferWriting;
     
     numBufferedFrames = 0;
@@ -2389,6 +2603,45 @@ int SimulatorItem::Impl::flushMainRecords()
 }
 
 
+/**
+   The frames recorded so far are kept as the ring buffer, so the memory usage of the records
+   does not increase any more.
+*/
+void SimulatorItem::Impl::switchRecordingToRingBufferMode()
+{
+    isRingBufferMode = true;
+    ringBufferSize = std::max(1, frameAtLastBufferWriting + 1);
+
+    mv->putln(formatR(_("The estimated memory usage of the records of {0} exceeded the limit of {1} MB. "
+                        "Only the latest {2:.1f} seconds of the simulation are recorded from now."),
+                      self->displayName(), recordingMemoryLimit, ringBufferSize * worldTimeStep_),
+              MessageView::Warning);
+}
+
+
+size_t SimulatorItem::estimateMemoryUsage() const
+{
+    return impl->estimateMemoryUsage();
+}
+
+
+size_t SimulatorItem::Impl::estimateMemoryUsage()
+{
+    // The flushed records are counted by the record items such as BodyMotionItem
+    QMutexLocker locker(&recordBufMutex);
+    size_t size = 0;
+    for(auto& simBody : activeSimBodies){
+        size += simBody->impl->bodyStateBuf.estimateMemoryUsage();
+    }
+    for(auto& linkPairs : collisionPairsBuf){
+        if(linkPairs){
+            size += CollisionSeq::estimateFrameMemoryUsage(*linkPairs);
+        }
+    }
+    return size;
+}
+
+
 void SimulatorItem::pauseSimulation()
 {
     impl->pauseSimulation();
@@ -2420,6 +2673,72 @@ void SimulatorItem::Impl::restartSimulation()
 }
 
 
+SimulationCheckpointPtr SimulatorItem::createCheckpoint()
+{
+    return impl->createCheckpoint();
+}
+
+
+SimulationCheckpointPtr SimulatorItem::Impl::createCheckpoint()
+{
+    SimulationCheckpointPtr checkpoint = new SimulationCheckpoint;
+    checkpoint->setTime(currentTime_);
+
+    for(size_t i=0; i < simBodiesWithBody.size(); ++i){
+        auto simBodyImpl = simBodiesWithBody[i]->impl;
+        checkpoint->storeBodyState(i, simBodyImpl->bodyItem->name(), simBodyImpl->body_);
+    }
+
+    self->storeCheckpointState(checkpoint);
+
+    for(auto& info : activeControllerInfos){
+        string key = getCheckpointKeyOfController(info);
+        if(!info->controller->storeCheckpointState(checkpoint->getOrCreateControllerState(key))){
+            checkpoint->removeControllerState(key);
+        }
+    }
+
+    return checkpoint;
+}
+
+
+bool SimulatorItem::requestCheckpoint(std::function<void(SimulationCheckpoint* checkpoint)> callback)
+{
+    return impl->requestCheckpoint(callback);
+}
+
+
+bool SimulatorItem::Impl::requestCheckpoint(std::function<void(SimulationCheckpoint* checkpoint)> callback)
+{
+    if(!isDoingSimulationLoop){
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(checkpointMutex);
+    checkpointCallbacks.push_back(callback);
+    isCheckpointRequested = true;
+    return true;
+}
+
+
+//! Called from the simulation thread
+void SimulatorItem::Impl::serveCheckpointRequests()
+{
+    vector<std::function<void(SimulationCheckpoint* checkpoint)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        callbacks.swap(checkpointCallbacks);
+        isCheckpointRequested = false;
+    }
+    SimulationCheckpointPtr checkpoint = createCheckpoint();
+    callLater(
+        [callbacks, checkpoint](){
+            for(auto& callback : callbacks){
+                callback(checkpoint);
+            }
+        });
+}
+
+
 void SimulatorItem::stopSimulation(bool isForced)
 {
     impl->stopSimulation(isForced, true);
@@ -2716,6 +3035,18 @@ bool SimulatorItem::Impl::onAllLinkPositionOutputModeChanged(bool on)
 }
 
 
+bool SimulatorItem::storeCheckpointState(SimulationCheckpoint* /* checkpoint */)
+{
+    return true;
+}
+
+
+bool SimulatorItem::restoreCheckpointState(const SimulationCheckpoint* /* checkpoint */)
+{
+    return true;
+}
+
+
 std::shared_ptr<CollisionLinkPairList> SimulatorItem::getCollisions()
 {
     return std::make_shared<CollisionLinkPairList>();
@@ -2758,6 +3089,8 @@ void SimulatorItem::Impl::doPutProperties(PutPropertyFunction& putProperty)
                 [&](bool on){ self->setActiveControlTimeRangeMode(on); return true; });
     putProperty(_("Recording"), recordingMode,
                 [&](int index){ return recordingMode.select(index); });
+    putProperty.min(0.0)(_("Recording memory limit [MB]"), recordingMemoryLimit,
+                         [&](double limit){ self->setRecordingMemoryLimit(limit); return true; });
     putProperty(_("All link position recording"), isAllLinkPositionOutputMode,
                 [&](bool on){ return onAllLinkPositionOutputModeChanged(on); });
     putProperty(_("Device state output"), isDeviceStateOutputEnabled,
@@ -2791,6 +3124,7 @@ bool SimulatorItem::Impl::store(Archive& archive)
     archive.write("recording", recordingMode.selectedSymbol());
     archive.write("time_range_mode", timeRangeModeSymbols[timeRangeMode.which()]);
     archive.write("time_length", timeLength);
+    archive.write("recording_memory_limit", recordingMemoryLimit);
     archive.write("is_active_control_time_range_mode", isActiveControlTimeRangeMode);
     archive.write("output_all_link_positions", isAllLinkPositionOutputMode);
     archive.write("output_device_states", isDeviceStateOutputEnabled);
@@ -2878,6 +3212,7 @@ bool SimulatorItem::Impl::restore(const Archive& archive)
     }
 
     archive.read({ "time_length", "timeLength" }, timeLength);
+    archive.read("recording_memory_limit", recordingMemoryLimit);
 
     bool on = archive.get({ "output_all_link_positions", "allLinkPositionOutputMode" }, isAllLinkPositionOutputMode);
     self->setAllLinkPositionOutputMode(on);
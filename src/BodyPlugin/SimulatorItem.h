@@ -4,6 +4,7 @@
 #include <cnoid/Item>
 #include <cnoid/CollisionLinkPairList>
 #include <cnoid/EigenTypes>
+#include "SimulationCheckpoint.h"
 #include <vector>
 #include <memory>
 #include "exportdecl.h"
@@ -85,6 +86,27 @@ public:
     bool isPausing() const;
     bool isActive() const; ///< isRunning() && !isPausing()
 
+    /**
+       Start a new simulation from the state of a checkpoint. The bodies whose states are not
+       in the checkpoint start from their current states. Note that the simulation time of the
+       new simulation starts from zero as well as the simulation started from the current state.
+    */
+    bool startSimulationFromCheckpoint(SimulationCheckpoint* checkpoint);
+
+    /**
+       Create a checkpoint of the current simulation state.
+       \note This can only be called from the simulation thread, for example in a post dynamics function.
+    */
+    SimulationCheckpointPtr createCheckpoint();
+
+    /**
+       Request a checkpoint of the running simulation. The checkpoint is created in the simulation
+       thread after the current simulation step or during the pause, and the callback function is
+       called with it in the main thread.
+       \return false if the simulation is not running
+    */
+    bool requestCheckpoint(std::function<void(SimulationCheckpoint* checkpoint)> callback);
+
     //! This can only be called from the simulation thread
     int currentFrame() const;
     
@@ -137,9 +159,18 @@ public:
     };
     
     void setTimeRangeMode(int mode);
+    int timeRangeMode() const;
 
     void setTimeLength(double length);
 
+    /**
+       The full recording is switched to the ring buffer mode, which keeps the frames of the
+       recorded length, when the estimated memory usage of the records exceeds the limit.
+       The limit is specified in megabytes, and zero means no limit.
+    */
+    void setRecordingMemoryLimit(double megaBytes);
+    double recordingMemoryLimit() const;
+
     [[deprecated("Use setTimeLength")]]
     void setSpecifiedRecordingTimeLength(double length){
         setTimeLength(length);
@@ -173,6 +204,9 @@ public:
 
     const std::string& controllerOptionString() const;
 
+    //! The buffers of the records which have not been flushed to the record items are counted
+    virtual size_t estimateMemoryUsage() const override;
+
     void setSceneViewEditModeBlockedDuringSimulation(bool on);    
     
     /**
@@ -193,6 +227,12 @@ public:
     void removePreDynamicsFunction(int id);
     void removeMidDynamicsFunction(int id);
     void removePostDynamicsFunction(int id);
+
+    /**
+       The collisions detected in the last simulation step.
+       This can only be called from the simulation thread.
+    */
+    virtual std::shared_ptr<CollisionLinkPairList> getCollisions();
         
     //void addRecordFunction(std::function<void()> func);
 
@@ -281,7 +321,14 @@ protected:
     */
     virtual void finalizeSimulation();
 
-    virtual std::shared_ptr<CollisionLinkPairList> getCollisions();
+    /**
+       Implement these functions to store the simulator specific state such as the internal state
+       of the constraint solver into a checkpoint and to restore it.
+       \note storeCheckpointState is called from the simulation thread. restoreCheckpointState is
+       called from the main thread after initializeSimulation.
+    */
+    virtual bool storeCheckpointState(SimulationCheckpoint* checkpoint);
+    virtual bool restoreCheckpointState(const SimulationCheckpoint* checkpoint);
 
     virtual void doPutProperties(PutPropertyFunction& putProperty) override;
     virtual bool store(Archive& archive) override;
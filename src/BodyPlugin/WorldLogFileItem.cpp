@@ -22,6 +22,7 @@
 #include <cnoid/Archive>
 #include <cnoid/UTF8>
 #include <cnoid/Format>
+#include <cnoid/Tracer>
 #include <cnoid/stdx/filesystem>
 #include <QDateTime>
 #include <fstream>
@@ -51,6 +52,12 @@ enum DataTypeID {
 
 struct CorruptLogException { };
 
+int frameOutputTraceId()
+{
+    static int id = Tracer::registerName("worldLog/frameOutput");
+    return id;
+}
+
 class ReadBuf
 {
 public:
@@ -809,6 +816,9 @@ bool WorldLogFileItem::recallStateAtTime(double time)
 
 bool WorldLogFileItem::Impl::recallStateAtTime(double time)
 {
+    static const int recallTraceId = Tracer::registerName("worldLog/recallState");
+    ScopedTrace trace(recallTraceId);
+    
     bool isValid = false;
     
     try {
@@ -1097,6 +1107,8 @@ void WorldLogFileItem::beginFrameOutput(double time)
 
 void WorldLogFileItem::Impl::beginFrameOutput(double time)
 {
+    Tracer::begin(frameOutputTraceId());
+    
     size_t pos = writeBuf.seekPos();
     
     if(lastOutputFramePos){
@@ -1214,6 +1226,8 @@ void WorldLogFileItem::endFrameOutput()
     impl->fixSizeHeader();
     impl->writeBuf.flush();
     impl->exchangeDeviceStateCacheArrays();
+
+    Tracer::end(frameOutputTraceId());
 }
 
 
@@ -37,7 +37,10 @@ void exportSimulationClasses(py::module m)
         .def("setRecordingMode", &SimulatorItem::setRecordingMode)
         .def_property_readonly("recordingMode", &SimulatorItem::recordingMode)
         .def("setTimeRangeMode", &SimulatorItem::setTimeRangeMode)
+        .def_property_readonly("timeRangeMode", &SimulatorItem::timeRangeMode)
         .def("setTimeLength", &SimulatorItem::setTimeLength)
+        .def("setRecordingMemoryLimit", &SimulatorItem::setRecordingMemoryLimit)
+        .def_property_readonly("recordingMemoryLimit", &SimulatorItem::recordingMemoryLimit)
         .def("setActiveControlTimeRangeMode", &SimulatorItem::setActiveControlTimeRangeMode)
         .def("isActiveControlTimeRangeMode", &SimulatorItem::isActiveControlTimeRangeMode)
         .def("isRecordingEnabled", &SimulatorItem::isRecordingEnabled)
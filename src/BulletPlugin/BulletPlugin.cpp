@@ -17,6 +17,10 @@ public:
     BulletPlugin() : Plugin("Bullet")
         { 
             require("Body");
+
+            // The plugin is activated when the simulator item is used for the first time
+            declareItemClass("BulletSimulatorItem");
+            declareMenuItem("/File/New .../BulletSimulator");
         }
         
     virtual ~BulletPlugin()
@@ -11,6 +11,7 @@
 #include <cnoid/BasicSensorSimulationHelper>
 #include <cnoid/MeshExtractor>
 #include <cnoid/SceneDrawables>
+#include <cnoid/MessageView>
 #include <btBulletDynamicsCommon.h>
 #include <HACD/hacdHACD.h>
 #include <BulletCollision/Gimpact/btGImpactShape.h>
@@ -24,6 +25,11 @@
 #include <BulletDynamics/Featherstone/btMultiBodyJointMotor.h>
 #include <BulletDynamics/Featherstone/btMultiBodyPoint2Point.h>
 #include <BulletDynamics/Featherstone/btMultiBodyJointFeedback.h>
+#ifdef BT_VER_GT_287
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <LinearMath/btThreads.h>
+#endif
 #include "gettext.h"
 
 using namespace std;
@@ -86,6 +92,7 @@ public:
     bool isStatic;
     btMultiBodyJointMotor* motor;
     double qold;
+    double dq_target_old;
         
     BulletLink(BulletSimulatorItemImpl* simImpl, BulletBody* bulletBody, BulletLink* parent,
                const Vector3& parentOrigin, Link* link, short group, bool isSelfCollisionDetectionEnabled);
@@ -97,7 +104,7 @@ public:
     void getKinematicStateFromBullet();
     void setKinematicStateToBullet();
     void setTorqueToBullet();
-    void setVelocityToBullet();
+    void setVelocityToBullet(double ratio);
 };
 typedef ref_ptr<BulletLink> BulletLinkPtr;
 
@@ -121,7 +128,7 @@ public:
     void createBody(BulletSimulatorItemImpl* simImpl, short group);
     void getKinematicStateFromBullet();
     void setKinematicStateToBullet();
-    void setControlValToBullet();
+    void setControlValToBullet(double ratio = 1.0);
     void setExtraJoints();
     void updateForceSensors();
     bool haveExtraJoints();
@@ -155,6 +162,8 @@ public:
     bool useHACD;                           // Hierarchical Approximate Convex Decomposition
     double collisionMargin;
     bool usefeatherstoneAlgorithm;
+    int numSubsteps;
+    int numThreads;
 
     BulletSimulatorItemImpl(BulletSimulatorItem* self);
     BulletSimulatorItemImpl(BulletSimulatorItem* self, const BulletSimulatorItemImpl& org);
@@ -168,6 +177,7 @@ public:
     void clear();
     void addBody(BulletBody* bulletBody, short group);
     void setSolverParameter();
+    bool initializeTaskScheduler();
 };
 
 }
@@ -257,6 +267,7 @@ BulletLink::BulletLink(BulletSimulatorItemImpl* _simImpl, BulletBody* _bulletBod
     motor = 0;
     isStatic = false;
     qold = 0;
+    dq_target_old = link->dq_target();
     
     Vector3 o = parentOrigin + link->b();
     
@@ -985,18 +996,25 @@ void BulletLink::setTorqueToBullet()
     }
 }
 
-void BulletLink::setVelocityToBullet()
+/**
+   The velocity target is interpolated between the targets of the previous and current
+   control steps by the given ratio when the control step is divided into the substeps.
+*/
+void BulletLink::setVelocityToBullet(double ratio)
 {
+    double v = (1.0 - ratio) * dq_target_old + ratio * link->dq_target();
+    if(ratio >= 1.0){
+        dq_target_old = link->dq_target();
+    }
+
     if(bulletBody->multiBody){
         if(motor)
-            motor->setVelocityTarget(link->dq_target());
+            motor->setVelocityTarget(v);
     }else{
         if(link->isRevoluteJoint()){
-            double v = link->dq_target();
             ((btHingeConstraint*)joint)->enableAngularMotor(true, v, numeric_limits<double>::max());
 
         } else if(link->isPrismaticJoint()){
-            double v = link->dq_target();
             ((btGeneric6DofConstraint*)joint)->getTranslationalLimitMotor()->m_enableMotor[2] = true;
             ((btGeneric6DofConstraint*)joint)->getTranslationalLimitMotor()->m_targetVelocity[2] = v;
             ((btGeneric6DofConstraint*)joint)->getTranslationalLimitMotor()->m_maxMotorForce[2] =  numeric_limits<double>::max();
@@ -1224,7 +1242,7 @@ void BulletBody::getKinematicStateFromBullet()
     }
 }
 
-void BulletBody::setControlValToBullet()
+void BulletBody::setControlValToBullet(double ratio)
 {
     for(size_t i=1; i < bulletLinks.size(); ++i){
         switch(bulletLinks[i]->link->actuationMode()){
@@ -1234,7 +1252,7 @@ void BulletBody::setControlValToBullet()
             bulletLinks[i]->setTorqueToBullet();
             break;
         case Link::JointVelocity :
-            bulletLinks[i]->setVelocityToBullet();
+            bulletLinks[i]->setVelocityToBullet(ratio);
             break;
         default :
             break;
@@ -1312,7 +1330,8 @@ BulletSimulatorItemImpl::BulletSimulatorItemImpl(BulletSimulatorItem* self)
     useHACD = false;
     collisionMargin = DEFAULT_COLLISION_MARGIN;
     usefeatherstoneAlgorithm = true;
-
+    numSubsteps = 1;
+    numThreads = 1;
 }
 
 
@@ -1337,7 +1356,8 @@ BulletSimulatorItemImpl::BulletSimulatorItemImpl(BulletSimulatorItem* self, cons
     useHACD = org.useHACD;
     collisionMargin = org.collisionMargin;
     usefeatherstoneAlgorithm = org.usefeatherstoneAlgorithm;
-
+    numSubsteps = org.numSubsteps;
+    numThreads = org.numThreads;
 }
 
 void BulletSimulatorItemImpl::initialize()
@@ -1399,14 +1419,32 @@ bool BulletSimulatorItemImpl::initializeSimulation(const std::vector<SimulationB
 {
     clear();
 
+    const bool isMultiThreaded = initializeTaskScheduler();
+
     collisionConfiguration = new btDefaultCollisionConfiguration();
+#ifdef BT_VER_GT_287
+    if(isMultiThreaded){
+        dispatcher = new btCollisionDispatcherMt(collisionConfiguration);
+    } else {
+        dispatcher = new btCollisionDispatcher(collisionConfiguration);
+    }
+#else
     dispatcher = new btCollisionDispatcher(collisionConfiguration);
+#endif
     broadphase = new btDbvtBroadphase();
 
     if(usefeatherstoneAlgorithm){
         btMultiBodyConstraintSolver* solver_ = new btMultiBodyConstraintSolver;
         solver = solver_;
         dynamicsWorld = new btMultiBodyDynamicsWorld(dispatcher,broadphase,solver_,collisionConfiguration);
+#ifdef BT_VER_GT_287
+    }else if(isMultiThreaded){
+        // The simulation islands are solved in parallel by the solvers of the pool
+        btConstraintSolverPoolMt* solverPool = new btConstraintSolverPoolMt(numThreads);
+        solver = solverPool;
+        dynamicsWorld = new btDiscreteDynamicsWorldMt(dispatcher,broadphase,solverPool,nullptr,collisionConfiguration);
+        self->setAllLinkPositionOutputMode(true);
+#endif
     }else{
         solver = new btSequentialImpulseConstraintSolver();
         dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher,broadphase,solver,collisionConfiguration);
@@ -1434,6 +1472,34 @@ bool BulletSimulatorItemImpl::initializeSimulation(const std::vector<SimulationB
     return true;
 }
 
+/**
+   The task scheduler of Bullet is shared by the process, so the number of its threads
+   is set by the simulator item which initializes the simulation.
+   \return true if the simulation is processed by multiple threads
+*/
+bool BulletSimulatorItemImpl::initializeTaskScheduler()
+{
+#ifdef BT_VER_GT_287
+    static btITaskScheduler* scheduler = btCreateDefaultTaskScheduler();
+
+    if(numThreads > 1){
+        if(!scheduler){
+            MessageView::instance()->putln(
+                _("Bullet is built without the multithreading support. "
+                  "The simulation is processed by a single thread."),
+                MessageView::Warning);
+        } else {
+            scheduler->setNumThreads(std::min(numThreads, scheduler->getMaxNumThreads()));
+            btSetTaskScheduler(scheduler);
+            return true;
+        }
+    }
+    btSetTaskScheduler(btGetSequentialTaskScheduler());
+#endif
+    return false;
+}
+
+
 void BulletSimulatorItemImpl::clear()
 {
     if(dynamicsWorld)
@@ -1490,11 +1556,22 @@ bool BulletSimulatorItemImpl::stepSimulation(const std::vector<SimulationBody*>&
     for(size_t i=0; i < activeSimBodies.size(); ++i){
         BulletBody* bulletBody = static_cast<BulletBody*>(activeSimBodies[i]);
         bulletBody->body->setVirtualJointForces();
-        bulletBody->setControlValToBullet();
     }
 
-    //dynamicsWorld->stepSimulation(timeStep,2,timeStep/2.);
-    dynamicsWorld->stepSimulation(timeStep,1,timeStep);
+    /*
+      The substeps are processed by separate calls of stepSimulation instead of the internal
+      substeps of Bullet so that the number of the substeps is exact and the control values,
+      which are cleared by each call, can be given to each substep. The joint torques are held
+      and the velocity targets are interpolated in the substeps.
+    */
+    const double substep = timeStep / numSubsteps;
+    for(int i=0; i < numSubsteps; ++i){
+        const double ratio = static_cast<double>(i + 1) / numSubsteps;
+        for(size_t j=0; j < activeSimBodies.size(); ++j){
+            static_cast<BulletBody*>(activeSimBodies[j])->setControlValToBullet(ratio);
+        }
+        dynamicsWorld->stepSimulation(substep,1,substep);
+    }
 
 #if DEBUG_OUT
     int numManifolds = dispatcher->getNumManifolds();
@@ -1555,6 +1632,9 @@ void BulletSimulatorItemImpl::doPutProperties(PutPropertyFunction& putProperty)
     putProperty(_("use HACD"), useHACD, changeProperty(useHACD));
     putProperty(_("Collision Margin"), collisionMargin, changeProperty(collisionMargin));
     putProperty(_("use Featherstone Algorithm"), usefeatherstoneAlgorithm, changeProperty(usefeatherstoneAlgorithm));
+    putProperty.min(1);
+    putProperty(_("Num of Substeps"), numSubsteps, changeProperty(numSubsteps));
+    putProperty(_("Num of Threads"), numThreads, changeProperty(numThreads));
 }
 
 
@@ -1577,6 +1657,8 @@ void BulletSimulatorItemImpl::store(Archive& archive)
     archive.write("useHACD", useHACD);
     archive.write("CollisionMargin", collisionMargin);
     archive.write("usefeatherstoneAlgorithm", usefeatherstoneAlgorithm);
+    archive.write("NumSubsteps", numSubsteps);
+    archive.write("NumThreads", numThreads);
 }
 
 
@@ -1599,6 +1681,12 @@ void BulletSimulatorItemImpl::restore(const Archive& archive)
     archive.read("useHACD", useHACD);
     archive.read("CollisionMargin", collisionMargin);
     archive.read("usefeatherstoneAlgorithm", usefeatherstoneAlgorithm);
+    if(archive.read("NumSubsteps", numSubsteps)){
+        numSubsteps = std::max(1, numSubsteps);
+    }
+    if(archive.read("NumThreads", numThreads)){
+        numThreads = std::max(1, numThreads);
+    }
 }
 
 void BulletSimulatorItemImpl::setSolverParameter()
@@ -112,6 +112,12 @@ class CorbaPlugin : public Plugin
 public:
     CorbaPlugin() : Plugin("Corba") {
         commonInitializationDone = false;
+
+        /*
+          The plugins using CORBA require this plugin, so it is still activated at startup
+          when any of them is activated at startup.
+        */
+        declareViewClass("NameServerView");
     }
         
     virtual bool initialize() {
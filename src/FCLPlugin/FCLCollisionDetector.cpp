@@ -3,8 +3,13 @@
 #include <cnoid/IdPair>
 #include <cnoid/MeshExtractor>
 #include <cnoid/SceneDrawables>
+#include <cnoid/ThreadPool>
 #include <cnoid/stdx/optional>
 #include <memory>
+#include <set>
+#include <thread>
+#include <algorithm>
+#include <tuple>
 
 #include <fcl/config.h>
 #if FCL_MAJOR_VERSION==0 && FCL_MINOR_VERSION < 6
@@ -13,8 +18,10 @@
 #include <fcl/BVH/BVH_model.h>
 #include <fcl/BV/BV.h>
 #include <fcl/narrowphase/gjk.h>
+#include <fcl/broadphase/broadphase_dynamic_AABB_tree.h>
 #else
 #include <fcl/fcl.h>
+#include <fcl/broadphase/broadphase_dynamic_AABB_tree.h>
 #endif
 
 using namespace std;
@@ -24,6 +31,9 @@ namespace {
 
 const bool USE_PRIMITIVE = true;
 
+//! The narrow phase is done by the threads when the number of the candidate model pairs is this value or more
+constexpr int MinNumModelPairsForParallelDetection = 16;
+
 #ifdef CNOID_FCL_05
 typedef fcl::BVHModel<fcl::OBBRSS> MeshModelf;
 typedef fcl::CollisionObject CollisionObjectf;
@@ -34,6 +44,7 @@ typedef fcl::Cone Conef;
 typedef fcl::CollisionRequest CollisionRequestf;
 typedef fcl::CollisionResult CollisionResultf;
 typedef fcl::Contact Contactf;
+typedef fcl::DynamicAABBTreeCollisionManager BroadPhaseManagerf;
 #else
 typedef fcl::BVHModel<fcl::OBBRSSf> MeshModelf;
 typedef fcl::CollisionObject<float> CollisionObjectf;
@@ -44,6 +55,7 @@ typedef fcl::Cone<float> Conef;
 typedef fcl::CollisionRequest<float> CollisionRequestf;
 typedef fcl::CollisionResult<float> CollisionResultf;
 typedef fcl::Contact<float> Contactf;
+typedef fcl::DynamicAABBTreeCollisionManager<float> BroadPhaseManagerf;
 #endif
 
 class ColdetModel : public Referenced
@@ -62,8 +74,27 @@ public:
     vector<fcl::Triangle> tri_indices;
     bool isStatic;
 
+    // The user data of the collision objects registered to the broad phase managers
+    struct ObjectRef {
+        ColdetModel* model;
+        int subIndex;
+    };
+    vector<ObjectRef> objectRefs;
+    int index;
+
     ColdetModel(){
         isStatic = false;
+        index = -1;
+    }
+
+    template<class Function>
+    void forEachObject(Function func){
+        if(meshObject){
+            func(meshObject.get());
+        }
+        for(auto& primitive : primitiveObjects){
+            func(primitive.get());
+        }
     }
 };
 
@@ -81,6 +112,25 @@ GeometryHandle getHandle(ColdetModel* model)
     return reinterpret_cast<GeometryHandle>(model);
 }
 
+/**
+   A pair of the collision objects whose bounding boxes overlap. The objects are sorted so that
+   the model with the smaller index comes first to keep the direction of the collision normals.
+*/
+struct CandidatePair
+{
+    int modelIndex1;
+    int modelIndex2;
+    int subIndex1;
+    int subIndex2;
+    CollisionObjectf* object1;
+    CollisionObjectf* object2;
+
+    bool operator<(const CandidatePair& rhs) const {
+        return std::tie(modelIndex1, modelIndex2, subIndex1, subIndex2) <
+            std::tie(rhs.modelIndex1, rhs.modelIndex2, rhs.subIndex1, rhs.subIndex2);
+    }
+};
+
 #ifdef CNOID_FCL_05
 fcl::Transform3f convertToFclTransform(const Isometry3& T)
 {
@@ -108,20 +158,39 @@ class FCLCollisionDetector::Impl
 {
 public:
     vector<ColdetModelPtr> models;
-    vector<pair<ColdetModelPtr, ColdetModelPtr>> modelPairs;
     set<IdPair<GeometryHandle>> ignoredPairs;
     MeshExtractor meshExtractor;
     bool isReady;
 
+    // The managers must be destroyed before the models because they refer to the collision objects
+    unique_ptr<BroadPhaseManagerf> dynamicObjectManager;
+    unique_ptr<BroadPhaseManagerf> staticObjectManager;
+    bool isDynamicObjectManagerUpdateNeeded;
+    bool isStaticObjectManagerUpdateNeeded;
+    vector<CandidatePair> candidatePairs;
+    // The range of the candidate pairs for each model pair
+    vector<pair<int, int>> modelPairRanges;
+    CollisionRequestf request;
+
+    // for multithread version
+    int maxNumThreads;
+    unique_ptr<ThreadPool> threadPool;
+    vector<vector<CollisionPair>> collisionPairArrays;
+
     Impl();
+    void clearBroadPhaseManagers();
     stdx::optional<GeometryHandle> addGeometry(SgNode* geometry);
     void addMesh(ColdetModel* geometry, SgMesh* mesh);
     bool addPrimitive(ColdetModel* model, SgMesh* mesh);
     void makeReady();
     void updatePosition(ColdetModel* model, const Isometry3& position);
+    void extractCandidatePairs();
+    static bool collectCandidatePair(CollisionObjectf* object1, CollisionObjectf* object2, void* data);
     void detectCollisions(std::function<void(const CollisionPair&)> callback);
+    void detectCollisionsInParallel(std::function<void(const CollisionPair&)> callback);
+    bool detectModelPairCollisions(const pair<int, int>& range, CollisionResultf& result, CollisionPair& collisionPair);
     void detectObjectCollisions(
-        CollisionObjectf* object1, CollisionObjectf* object2, CollisionPair& collisionPair);
+        CollisionObjectf* object1, CollisionObjectf* object2, CollisionResultf& result, vector<Collision>& collisions);
 };
 
 }
@@ -136,6 +205,10 @@ FCLCollisionDetector::FCLCollisionDetector()
 FCLCollisionDetector::Impl::Impl()
 {
     isReady = false;
+    isDynamicObjectManagerUpdateNeeded = false;
+    isStaticObjectManagerUpdateNeeded = false;
+    request = CollisionRequestf(std::numeric_limits<int>::max(), true);
+    maxNumThreads = std::thread::hardware_concurrency();
 }    
 
 
@@ -157,15 +230,34 @@ CollisionDetector* FCLCollisionDetector::clone() const
 }
 
         
+void FCLCollisionDetector::setNumThreads(int n)
+{
+    impl->maxNumThreads = std::max(0, n);
+    impl->threadPool.reset();
+}
+
+
 void FCLCollisionDetector::clearGeometries()
 {
+    impl->clearBroadPhaseManagers();
     impl->models.clear();
-    impl->modelPairs.clear();
     impl->ignoredPairs.clear();
     impl->isReady = false;
 }
 
 
+void FCLCollisionDetector::Impl::clearBroadPhaseManagers()
+{
+    dynamicObjectManager.reset();
+    staticObjectManager.reset();
+    candidatePairs.clear();
+    modelPairRanges.clear();
+    for(auto& collisionPairs : collisionPairArrays){
+        collisionPairs.clear();
+    }
+}
+
+
 int FCLCollisionDetector::numGeometries() const
 {
     return impl->models.size();
@@ -385,22 +477,33 @@ bool FCLCollisionDetector::makeReady()
 
 void FCLCollisionDetector::Impl::makeReady()
 {
-    modelPairs.clear();
+    clearBroadPhaseManagers();
+    dynamicObjectManager.reset(new BroadPhaseManagerf);
+    staticObjectManager.reset(new BroadPhaseManagerf);
+
     const int n = models.size();
     for(int i=0; i < n; ++i){
-        if(auto& model1 = models[i]){
-            for(int j = i+1; j < n; ++j){
-                if(auto& model2 = models[j]){
-                    if(!model1->isStatic || !model2->isStatic){
-                        IdPair<GeometryHandle> handlePair(getHandle(model1), getHandle(model2));
-                        if(ignoredPairs.find(handlePair) == ignoredPairs.end()){
-                            modelPairs.push_back(make_pair(model1, model2));
-                        }
-                    }
-                }
-            }
+        auto& model = models[i];
+        if(!model){
+            continue;
         }
+        model->index = i;
+        model->objectRefs.clear();
+        model->objectRefs.reserve(model->primitiveObjects.size() + 1);
+        auto manager = model->isStatic ? staticObjectManager.get() : dynamicObjectManager.get();
+        model->forEachObject(
+            [&](CollisionObjectf* object){
+                int subIndex = model->objectRefs.size();
+                model->objectRefs.push_back({ model, subIndex });
+                object->setUserData(&model->objectRefs.back());
+                object->computeAABB();
+                manager->registerObject(object);
+            });
     }
+    dynamicObjectManager->setup();
+    staticObjectManager->setup();
+    isDynamicObjectManagerUpdateNeeded = false;
+    isStaticObjectManagerUpdateNeeded = false;
 
     isReady = true;
 }
@@ -422,6 +525,7 @@ void FCLCollisionDetector::Impl::updatePosition(ColdetModel* model, const Isomet
 #else
         model->meshObject->setTransform(T.cast<float>());
 #endif
+        model->meshObject->computeAABB();
     }
     const int n = model->primitiveObjects.size();
     for(int i=0; i < n; ++i){
@@ -434,8 +538,15 @@ void FCLCollisionDetector::Impl::updatePosition(ColdetModel* model, const Isomet
 #else
             primitive->setTransform(Tp.cast<float>());
 #endif
+            primitive->computeAABB();
         }
     }
+
+    if(model->isStatic){
+        isStaticObjectManagerUpdateNeeded = true;
+    } else {
+        isDynamicObjectManagerUpdateNeeded = true;
+    }
 }
 
 
@@ -461,70 +572,172 @@ void FCLCollisionDetector::detectCollisions(std::function<void(const CollisionPa
 }
 
 
-void FCLCollisionDetector::Impl::detectCollisions(std::function<void(const CollisionPair&)> callback)
+void FCLCollisionDetector::Impl::extractCandidatePairs()
 {
-    CollisionPair collisionPair;
-    auto& collisions = collisionPair.collisions();
+    if(isDynamicObjectManagerUpdateNeeded){
+        dynamicObjectManager->update();
+        isDynamicObjectManagerUpdateNeeded = false;
+    }
+    if(isStaticObjectManagerUpdateNeeded){
+        staticObjectManager->update();
+        isStaticObjectManagerUpdateNeeded = false;
+    }
+
+    candidatePairs.clear();
+    dynamicObjectManager->collide(this, collectCandidatePair);
+    dynamicObjectManager->collide(staticObjectManager.get(), this, collectCandidatePair);
+
+    // The order of the pairs given by the broad phase depends on the tree structure
+    std::sort(candidatePairs.begin(), candidatePairs.end());
+
+    modelPairRanges.clear();
+    const int n = candidatePairs.size();
+    int begin = 0;
+    for(int i=1; i <= n; ++i){
+        if(i == n ||
+           candidatePairs[i].modelIndex1 != candidatePairs[begin].modelIndex1 ||
+           candidatePairs[i].modelIndex2 != candidatePairs[begin].modelIndex2){
+            modelPairRanges.emplace_back(begin, i);
+            begin = i;
+        }
+    }
+}
 
-    for(auto& modelPair : modelPairs){
-        auto& model1 = modelPair.first;
-        auto& model2 = modelPair.second;
-        collisions.clear();
 
-        if(model1->meshObject){
-            if(model2->meshObject){
-                detectObjectCollisions(model1->meshObject.get(), model2->meshObject.get(), collisionPair);
-            }
-            for(auto& primitive : model2->primitiveObjects){
-                detectObjectCollisions(model1->meshObject.get(), primitive.get(), collisionPair);
-            }
+bool FCLCollisionDetector::Impl::collectCandidatePair
+(CollisionObjectf* object1, CollisionObjectf* object2, void* data)
+{
+    auto self = static_cast<Impl*>(data);
+    auto ref1 = static_cast<ColdetModel::ObjectRef*>(object1->getUserData());
+    auto ref2 = static_cast<ColdetModel::ObjectRef*>(object2->getUserData());
+
+    if(ref1->model != ref2->model){
+        if(ref1->model->index > ref2->model->index){
+            std::swap(ref1, ref2);
+            std::swap(object1, object2);
         }
-        for(auto& primitive1 : model1->primitiveObjects){
-            if(model2->meshObject){
-                detectObjectCollisions(primitive1.get(), model2->meshObject.get(), collisionPair);
-            }
-            for(auto& primitive2 : model2->primitiveObjects){
-                detectObjectCollisions(primitive1.get(), primitive2.get(), collisionPair);
-            }
+        bool isIgnored = false;
+        if(!self->ignoredPairs.empty()){
+            IdPair<GeometryHandle> handlePair(getHandle(ref1->model), getHandle(ref2->model));
+            isIgnored = (self->ignoredPairs.find(handlePair) != self->ignoredPairs.end());
+        }
+        if(!isIgnored){
+            self->candidatePairs.push_back(
+                { ref1->model->index, ref2->model->index, ref1->subIndex, ref2->subIndex, object1, object2 });
         }
+    }
+
+    return false; // Continue the broad phase
+}
+
+
+void FCLCollisionDetector::Impl::detectCollisions(std::function<void(const CollisionPair&)> callback)
+{
+    extractCandidatePairs();
 
-        if(!collisions.empty()){
-            collisionPair.geometry(0) = getHandle(model1);
-            collisionPair.geometry(1) = getHandle(model2);
-            collisionPair.object(0) = model1->object;
-            collisionPair.object(1) = model2->object;
+    if(maxNumThreads > 0 && static_cast<int>(modelPairRanges.size()) >= MinNumModelPairsForParallelDetection){
+        detectCollisionsInParallel(callback);
+        return;
+    }
+
+    CollisionPair collisionPair;
+    CollisionResultf result;
+    for(auto& range : modelPairRanges){
+        if(detectModelPairCollisions(range, result, collisionPair)){
             callback(collisionPair);
         }
     }
 }
 
 
-void FCLCollisionDetector::Impl::detectObjectCollisions
-(CollisionObjectf* object1, CollisionObjectf* object2, CollisionPair& collisionPair)
+void FCLCollisionDetector::Impl::detectCollisionsInParallel(std::function<void(const CollisionPair&)> callback)
 {
-    vector<Collision>& collisions = collisionPair.collisions();
+    if(!threadPool){
+        threadPool.reset(new ThreadPool(maxNumThreads));
+        collisionPairArrays.resize(maxNumThreads);
+    }
 
-    CollisionRequestf request(std::numeric_limits<int>::max(), true);
-    CollisionResultf result;
-    int numContacts = collide(object1, object2, request, result);
-    std::vector<Contactf> contacts;
-    result.getContacts(contacts);
+    const int numModelPairs = modelPairRanges.size();
+    const int numChunks = std::min(maxNumThreads, numModelPairs);
+    const int minSize = numModelPairs / numChunks;
+    int remainder = numModelPairs % numChunks;
+    int index = 0;
+    for(int i=0; i < numChunks; ++i){
+        int size = minSize;
+        if(remainder > 0){
+            ++size;
+            --remainder;
+        }
+        threadPool->start(
+            [this, i, index, size](){
+                auto& collisionPairs = collisionPairArrays[i];
+                collisionPairs.clear();
+                CollisionResultf result;
+                for(int j = index; j < index + size; ++j){
+                    collisionPairs.emplace_back();
+                    if(!detectModelPairCollisions(modelPairRanges[j], result, collisionPairs.back())){
+                        collisionPairs.pop_back();
+                    }
+                }
+            });
+        index += size;
+    }
+    threadPool->wait();
 
-    for(auto& contact : contacts){
-        if(contact.penetration_depth < 0.0){
-            contact.penetration_depth *= -1.0;
+    // The collision pairs are given to the callback in the order of the model pairs
+    for(int i=0; i < numChunks; ++i){
+        for(auto& collisionPair : collisionPairArrays[i]){
+            callback(collisionPair);
         }
-        if(contact.penetration_depth < 1.0e-6){
+    }
+}
+
+
+bool FCLCollisionDetector::Impl::detectModelPairCollisions
+(const pair<int, int>& range, CollisionResultf& result, CollisionPair& collisionPair)
+{
+    auto& collisions = collisionPair.collisions();
+    collisions.clear();
+
+    for(int i = range.first; i < range.second; ++i){
+        auto& candidate = candidatePairs[i];
+        detectObjectCollisions(candidate.object1, candidate.object2, result, collisions);
+    }
+    if(collisions.empty()){
+        return false;
+    }
+
+    auto& candidate = candidatePairs[range.first];
+    ColdetModel* model1 = models[candidate.modelIndex1];
+    ColdetModel* model2 = models[candidate.modelIndex2];
+    collisionPair.geometry(0) = getHandle(model1);
+    collisionPair.geometry(1) = getHandle(model2);
+    collisionPair.object(0) = model1->object;
+    collisionPair.object(1) = model2->object;
+    return true;
+}
+
+
+void FCLCollisionDetector::Impl::detectObjectCollisions
+(CollisionObjectf* object1, CollisionObjectf* object2, CollisionResultf& result, vector<Collision>& collisions)
+{
+    result.clear();
+    collide(object1, object2, request, result);
+
+    const int numContacts = result.numContacts();
+    for(int i=0; i < numContacts; ++i){
+        auto& contact = result.getContact(i);
+        double depth = std::abs(contact.penetration_depth);
+        if(depth < 1.0e-6){
             continue;
         }
-
         collisions.push_back(Collision());
         auto& collision = collisions.back();
         auto& p = contact.pos;
         collision.point << p[0], p[1], p[2];
         auto& n = contact.normal;
         collision.normal << n[0], n[1], n[2];
-        collision.depth = contact.penetration_depth;
+        collision.depth = depth;
     }
 }
 
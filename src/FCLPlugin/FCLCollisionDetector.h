@@ -24,6 +24,13 @@ public:
         std::function<void(Referenced* object, Isometry3*& out_position)> positionQuery) override;
     virtual void detectCollisions(std::function<void(const CollisionPair&)> callback) override;
 
+    /**
+       The narrow phase collision detection of the candidate pairs given by the broad phase
+       is done by the threads when there are enough pairs. The number of the hardware threads
+       is used by default. Set zero to disable the multithreading.
+    */
+    void setNumThreads(int n);
+
 private:
     class Impl;
     Impl* impl;
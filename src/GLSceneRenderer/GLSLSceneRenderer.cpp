@@ -10,6 +10,8 @@
 #include <cnoid/SceneCameras>
 #include <cnoid/SceneLights>
 #include <cnoid/SceneEffects>
+#include <cnoid/MeshFilter>
+#include <cnoid/ThreadPool>
 #include <cnoid/EigenUtil>
 #include <cnoid/NullOut>
 #include <cnoid/Format>
@@ -17,6 +19,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <deque>
+#include <cmath>
+#include <atomic>
 #include <mutex>
 #include <regex>
 #include <stdexcept>
@@ -38,6 +42,17 @@ constexpr int DepthTextureUnit = 0;
 constexpr int ImageTextureUnit = 1;
 constexpr int ShadowMapTextureUnit = 2;
 
+//! Shapes are rendered with an instanced draw call when the number of the instances is equal to or more than this
+constexpr int MinNumInstancesForInstancedRendering = 2;
+
+//! The simplified meshes are generated for the meshes having this number of triangles or more
+constexpr int MinNumTrianglesForLevelOfDetail = 20000;
+//! Ratio of the number of triangles between the adjacent levels
+constexpr double LevelOfDetailReductionRatio = 0.25;
+constexpr int MaxNumLevelsOfDetail = 3;
+//! The original mesh is rendered when the projected size of its bounding box is this number of pixels or more
+constexpr double FullDetailPixelSize = 400.0;
+
 typedef vector<Affine3, Eigen::aligned_allocator<Affine3>> Affine3Array;
 
 std::mutex extensionMutex;
@@ -62,10 +77,22 @@ struct LockVertexArrayAPI
     }
 };
         
+/**
+   The simplified meshes for the level of detail rendering are generated by this pool shared by
+   all the renderers so that the number of the generation threads is bounded.
+*/
+ThreadPool* getLevelOfDetailThreadPool()
+{
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency() / 2));
+    return &pool;
+}
+
 class GLResource : public Referenced
 {
 public:
     virtual void discard() = 0;
+    //! An estimate of the bytes used by the buffers and the textures of the resource
+    virtual size_t estimateMemoryUsage() const { return 0; }
 };
 
 typedef ref_ptr<GLResource> GLResourcePtr;
@@ -79,6 +106,68 @@ struct SgObjectPtrHash {
 
 typedef std::unordered_map<SgObjectPtr, GLResourcePtr, SgObjectPtrHash> GLResourceMap;
 
+/**
+   The state of a simplified mesh generation shared with the job running in the thread pool.
+   The job is canceled instead of being waited for when the result is no longer needed.
+*/
+class LevelOfDetailGeneration : public Referenced
+{
+public:
+    std::atomic<bool> isCanceled;
+    std::atomic<bool> isFinished;
+    vector<SgMeshPtr> levelMeshes;
+    LevelOfDetailGeneration() : isCanceled(false), isFinished(false) { }
+};
+
+typedef ref_ptr<LevelOfDetailGeneration> LevelOfDetailGenerationPtr;
+
+
+/**
+   This resource keeps the simplified meshes of a mesh. The meshes are generated in a
+   background thread and the original mesh is rendered until the generation is finished.
+   The resource is owned by the vertex resource of the original mesh so that the meshes
+   are shared by the shapes using the same mesh.
+*/
+class LevelOfDetailResource : public GLResource
+{
+public:
+    SgMeshPtr mesh;
+    vector<SgMeshPtr> levelMeshes;
+    LevelOfDetailGenerationPtr generation;
+    ScopedConnection meshConnection;
+
+    ~LevelOfDetailResource(){
+        cancelGeneration();
+    }
+
+    void cancelGeneration(){
+        if(generation){
+            generation->isCanceled = true;
+            generation.reset();
+        }
+    }
+
+    void reset(){
+        cancelGeneration();
+        mesh.reset();
+        levelMeshes.clear();
+        meshConnection.disconnect();
+    }
+
+    virtual void discard() override { }
+
+    //! The simplified meshes are counted because they are only owned by this resource
+    virtual size_t estimateMemoryUsage() const override {
+        size_t size = 0;
+        for(auto& levelMesh : levelMeshes){
+            size += levelMesh->estimateMemoryUsage();
+        }
+        return size;
+    }
+};
+
+typedef ref_ptr<LevelOfDetailResource> LevelOfDetailResourcePtr;
+
 class VertexResource : public GLResource
 {
 public:
@@ -89,11 +178,13 @@ public:
     GLuint vbos[MAX_NUM_BUFFERS];
     GLsizei numVertices;
     int numBuffers;
+    size_t bufferDataSize;
     // Local transform is used with the short integer type vertex elements
     Matrix4* pLocalTransform;
     Matrix4 localTransform;
     SgLineSetPtr boundingBoxLines;
     SgLineSetPtr normalVisualization;
+    LevelOfDetailResourcePtr levelOfDetail;
     ScopedConnection connection;
 
     VertexResource(const VertexResource&) = delete;
@@ -117,10 +208,15 @@ public:
         }
         numBuffers = 0;
         numVertices = 0;
+        bufferDataSize = 0;
     }
 
     virtual void discard() override { clearHandles(); }
 
+    virtual size_t estimateMemoryUsage() const override {
+        return bufferDataSize + (levelOfDetail ? levelOfDetail->estimateMemoryUsage() : 0);
+    }
+
     bool isValid(){
         if(numVertices > 0){
             return true;
@@ -137,6 +233,12 @@ public:
         return buffer;
     }
 
+    //! The data is stored in the buffer bound to GL_ARRAY_BUFFER
+    void setBufferData(GLsizeiptr size, const GLvoid* data){
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        bufferDataSize += size;
+    }
+
     void deleteBuffers(){
         if(numBuffers > 0){
             glDeleteBuffers(numBuffers, vbos);
@@ -144,6 +246,7 @@ public:
                 vbos[i] = 0;
             }
             numBuffers = 0;
+            bufferDataSize = 0;
         }
     }
 
@@ -194,6 +297,10 @@ public:
 
     virtual void discard() override { isLoaded = false; }
 
+    virtual size_t estimateMemoryUsage() const override {
+        return isLoaded ? static_cast<size_t>(width) * height * numComponents : 0;
+    }
+
     void clear() {
         if(isLoaded){
             if(textureId){
@@ -270,6 +377,20 @@ public:
 };
 
 
+/**
+   This resource caches whether the bounding box of the sub tree of a transform node can be used
+   for the frustum culling. The cache is updated when the bounding box cache of the node is invalidated.
+*/
+class TransformCullingResource : public GLResource
+{
+public:
+    bool isValid;
+    bool isCullable;
+    TransformCullingResource(SgTransform*) : isValid(false), isCullable(false) { }
+    virtual void discard() override { }
+};
+
+
 class ScopedShaderProgramActivator
 {
     GLSLSceneRenderer::Impl* renderer;
@@ -367,6 +488,51 @@ public:
     Matrix4 PV;
     SgUpdate boundingBoxUpdate;
 
+    bool isFrustumCullingEnabled;
+    bool isFrustumCullingActive;
+    Eigen::Matrix<double, 6, 4> frustumPlanes;
+    int shapeClassId;
+    int lineSetClassId;
+
+    bool isInstancedRenderingEnabled;
+    bool isInstancedRenderingActive;
+
+    bool isLevelOfDetailEnabled;
+    bool isLevelOfDetailActive;
+
+    struct InstancingKey
+    {
+        SgMesh* mesh;
+        SgMaterial* material;
+        SgTexture* texture;
+        bool operator==(const InstancingKey& rhs) const {
+            return mesh == rhs.mesh && material == rhs.material && texture == rhs.texture;
+        }
+    };
+    struct InstancingKeyHash
+    {
+        std::size_t operator()(const InstancingKey& key) const {
+            std::size_t seed = std::hash<SgMesh*>()(key.mesh);
+            seed ^= std::hash<SgMaterial*>()(key.material) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<SgTexture*>()(key.texture) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+    struct InstancingBatch
+    {
+        SgShapePtr shape;
+        SgMeshPtr mesh;
+        VertexResource* resource;
+        vector<int> modelMatrixIndices;
+    };
+    unordered_map<InstancingKey, int, InstancingKeyHash> instancingBatchIndexMap;
+    vector<InstancingBatch> instancingBatches;
+    vector<GLfloat> instanceModelMatrixBuf;
+    GLuint instanceModelMatrixBuffer;
+
+    GLSLSceneRenderer::RenderingStatistics renderingStatistics;
+    GLSLSceneRenderer::RenderingStatistics lastRenderingStatistics;
+
     vector<SgPolygonDrawStyle*> solidWireframeStyleStack;
 
     struct DispatchedNodeInfo
@@ -507,6 +673,15 @@ public:
     void renderChildNodesWithNodeDecorationCheck(SgGroup* group);
     void renderGroup(SgGroup* group);
     void renderTransform(SgTransform* transform);
+    void updateFrustumPlanes();
+    void startFrustumCulling();
+    void finishFrustumCulling();
+    bool isBoundingBoxOutsideFrustum(const BoundingBox& bbox, const Affine3& T) const;
+    bool checkIfTransformCulled(SgTransform* transform);
+    bool checkIfTransformCullable(SgTransform* transform);
+    bool checkIfSubTreeCullable(SgGroup* group);
+    void retainSubTreeResources(SgNode* node);
+    void retainResource(SgObject* object);
     void renderFixedPixelSizeGroup(SgFixedPixelSizeGroup* fixedPixelSizeGroup);
     void renderSwitchableGroup(SgSwitchableGroup* group);
     void renderUnpickableGroup(SgUnpickableGroup* group);
@@ -516,7 +691,13 @@ public:
     void drawVertexResource(VertexResource* resource, GLenum primitiveMode, const Affine3& modelTransform);
     void drawBoundingBox(VertexResource* resource, const BoundingBox& bbox);
     void renderShape(SgShape* shape);
-    void renderShapeMain(SgShape* shape, const Affine3& modelTransform, int pickIndex);
+    bool checkIfInstancedRenderingAvailable(SgShape* shape);
+    SgMesh* selectLevelOfDetailMesh(SgShape* shape, SgMesh* mesh);
+    void requestLevelOfDetailMeshGeneration(LevelOfDetailResource* resource, SgMesh* mesh);
+    void addShapeToInstancingBatch(SgShape* shape, SgMesh* mesh);
+    void renderInstancingBatches();
+    void renderShapeMain(SgShape* shape, SgMesh* mesh, const Affine3& modelTransform, int pickIndex);
+    void renderShapeAppearance(SgShape* shape, SgMesh* mesh);
     void applyCullingMode(SgMesh* mesh);
     void renderShapeVertices(SgShape* shape);
     void renderPlot(
@@ -542,7 +723,7 @@ public:
     void renderMaterial(const SgMaterial* material);
     bool renderTexture(SgTexture* texture);
     bool loadTextureImage(TextureResource* resource, const Image& image);
-    void makeVertexBufferObjects(SgShape* shape, VertexResource* resource);
+    void makeVertexBufferObjects(SgShape* shape, SgMesh* mesh, VertexResource* resource);
     void writeMeshVertices(SgMesh* mesh, VertexResource* resource, SgTexture* texResource);
     template<typename value_type, GLenum gltype, GLboolean normalized, class VertexArrayWrapper>
     void writeMeshVerticesSub(SgMesh* mesh, VertexResource* resource, VertexArrayWrapper& normals);
@@ -706,6 +887,17 @@ void GLSLSceneRenderer::Impl::initialize()
     isLowMemoryConsumptionMode = false;
     isBoundingBoxRenderingMode = false;
     isBoundingBoxRenderingForLightweightRenderingGroupEnabled = false;
+    isFrustumCullingEnabled = false;
+    isFrustumCullingActive = false;
+    frustumPlanes.setZero();
+    shapeClassId = SgNode::findClassId<SgShape>();
+    lineSetClassId = SgNode::findClassId<SgLineSet>();
+    isInstancedRenderingEnabled = true;
+    isInstancedRenderingActive = false;
+    isLevelOfDetailEnabled = true;
+    isLevelOfDetailActive = false;
+    renderingStatistics = { 0, 0, 0, 0, 0, 0 };
+    lastRenderingStatistics = renderingStatistics;
 
     defaultFBO = 0;
     
@@ -882,6 +1074,9 @@ void GLSLSceneRenderer::Impl::clearGL(bool isGLContextActive, bool isCalledFromC
         if(depthBufferForOverlay){
             glDeleteRenderbuffers(1, &depthBufferForOverlay);
         }
+        if(instanceModelMatrixBuffer){
+            glDeleteBuffers(1, &instanceModelMatrixBuffer);
+        }
     }
 
     if(!isCalledFromDestructor){
@@ -907,6 +1102,7 @@ void GLSLSceneRenderer::Impl::clearGL(bool isGLContextActive, bool isCalledFromC
         colorBufferForPicking = 0;
         depthBufferForPicking = 0;
         depthBufferForOverlay = 0;
+        instanceModelMatrixBuffer = 0;
         pickingImageWidth = 0;
         pickingImageHeight = 0;
         needToUpdateOverlayDepthBufferSize = true;
@@ -1304,7 +1500,16 @@ void GLSLSceneRenderer::Impl::doRender()
 
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
+        isInstancedRenderingActive = isInstancedRenderingEnabled && (currentProgram == fullLightingProgram.get());
+        isLevelOfDetailActive = isLevelOfDetailEnabled;
+        startFrustumCulling();
         renderChildNodes(self->sceneRoot());
+        finishFrustumCulling();
+        isLevelOfDetailActive = false;
+        if(isInstancedRenderingActive){
+            renderInstancingBatches();
+            isInstancedRenderingActive = false;
+        }
         
         /*
           \todo Render transparent objects directly
@@ -1324,6 +1529,8 @@ void GLSLSceneRenderer::Impl::doRender()
         if(!overlayRenderingQueue.empty()){
             renderOverlayObjects();
         }
+
+        lastRenderingStatistics = renderingStatistics;
     }
     
     popProgram();
@@ -1454,7 +1661,9 @@ bool GLSLSceneRenderer::Impl::doPick(int x, int y)
         
         transparentRenderingQueue.clear();
         overlayRenderingQueue.clear();
+        startFrustumCulling();
         renderChildNodes(self->sceneRoot());
+        finishFrustumCulling();
 
         if(!transparentRenderingQueue.empty()){
             renderTransparentObjects();
@@ -2108,16 +2317,179 @@ void GLSLSceneRenderer::Impl::renderTransform(SgTransform* transform)
         Affine3 T;
         transform->getTransform(T);
         modelMatrixStack.push_back(modelMatrixStack.back() * T);
-        pushPickNode(transform);
 
-        renderChildNodes(transform);
+        if(!isFrustumCullingActive || !checkIfTransformCulled(transform)){
+            pushPickNode(transform);
+            renderChildNodes(transform);
+            popPickNode();
+        }
 
-        popPickNode();
         modelMatrixStack.pop_back();
     }
 }
 
 
+void GLSLSceneRenderer::Impl::updateFrustumPlanes()
+{
+    // The planes are extracted from the view projection matrix. A point p is inside the frustum
+    // when the dot products of (p, 1) and all the plane coefficients are non-negative.
+    auto r0 = PV.row(0);
+    auto r1 = PV.row(1);
+    auto r2 = PV.row(2);
+    auto r3 = PV.row(3);
+    frustumPlanes.row(0) = r3 + r0; // left
+    frustumPlanes.row(1) = r3 - r0; // right
+    frustumPlanes.row(2) = r3 + r1; // bottom
+    frustumPlanes.row(3) = r3 - r1; // top
+    frustumPlanes.row(4) = r3 + r2; // near
+    frustumPlanes.row(5) = r3 - r2; // far
+}
+
+
+void GLSLSceneRenderer::Impl::startFrustumCulling()
+{
+    if(isFrustumCullingEnabled){
+        updateFrustumPlanes();
+        isFrustumCullingActive = true;
+    }
+    renderingStatistics = { 0, 0, 0, 0, 0, 0 };
+}
+
+
+void GLSLSceneRenderer::Impl::finishFrustumCulling()
+{
+    isFrustumCullingActive = false;
+}
+
+
+bool GLSLSceneRenderer::Impl::isBoundingBoxOutsideFrustum(const BoundingBox& bbox, const Affine3& T) const
+{
+    const Vector3 c = T * bbox.center();
+    const Vector3 e = T.linear().cwiseAbs() * (0.5 * (bbox.max() - bbox.min()));
+    for(int i=0; i < 6; ++i){
+        auto plane = frustumPlanes.row(i);
+        double d = plane.head<3>().dot(c) + plane[3];
+        double r = plane.head<3>().cwiseAbs().dot(e);
+        if(d + r < 0.0){
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool GLSLSceneRenderer::Impl::checkIfTransformCulled(SgTransform* transform)
+{
+    if(checkIfTransformCullable(transform)){
+        auto& bbox = transform->untransformedBoundingBox();
+        if(!bbox.empty() && isBoundingBoxOutsideFrustum(bbox, modelMatrixStack.back())){
+            ++renderingStatistics.numCulledTransforms;
+            if(isCheckingUnusedResources){
+                retainSubTreeResources(transform);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+   The bounding box of a sub tree cannot be used for the culling when the sub tree contains a node
+   that is rendered without being included in the bounding box, such as a marker node or a node whose
+   bounding box is not defined, or a node whose size is determined in rendering.
+   Only the shapes and the line sets are regarded as the nodes whose bounding boxes enclose what
+   they draw. Point sets are drawn with the point size and the nodes of the other types, including
+   the ones rendered by the functions registered by plugins, may draw outside their bounding boxes.
+*/
+bool GLSLSceneRenderer::Impl::checkIfTransformCullable(SgTransform* transform)
+{
+    auto resource = getOrCreateGLResource<TransformCullingResource>(transform);
+    if(!resource->isValid || !transform->hasValidBoundingBoxCache()){
+        resource->isCullable = checkIfSubTreeCullable(transform);
+        resource->isValid = true;
+        transform->untransformedBoundingBox();
+    }
+    return resource->isCullable;
+}
+
+
+bool GLSLSceneRenderer::Impl::checkIfSubTreeCullable(SgGroup* group)
+{
+    for(auto& node : *group){
+        if(node->hasAttribute(SgNode::Marker)){
+            return false;
+        }
+        if(node->isGroupNode()){
+            if(auto transform = node->toTransformNode()){
+                if(!checkIfTransformCullable(transform)){
+                    return false;
+                }
+            } else if(dynamic_cast<SgOverlay*>(node.get()) ||
+                      dynamic_cast<SgFixedPixelSizeGroup*>(node.get())){
+                return false;
+            } else if(!checkIfSubTreeCullable(node->toGroupNode())){
+                return false;
+            }
+        } else {
+            int id = node->classId();
+            if(id != shapeClassId && id != lineSetClassId){
+                return false;
+            }
+            if(node->boundingBox().empty()){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+   The resources of the nodes skipped by the culling are carried over to the next resource map
+   so that they are not released by the unused resource check.
+*/
+void GLSLSceneRenderer::Impl::retainSubTreeResources(SgNode* node)
+{
+    retainResource(node);
+    
+    if(auto group = node->toGroupNode()){
+        for(auto& child : *group){
+            retainSubTreeResources(child);
+        }
+    } else if(auto shape = dynamic_cast<SgShape*>(node)){
+        if(auto mesh = shape->mesh()){
+            retainResource(mesh);
+            if(auto vertices = mesh->vertices()){
+                retainResource(vertices);
+            }
+            auto p = currentResourceMap->find(mesh);
+            if(p != currentResourceMap->end()){
+                if(auto& lod = static_cast<VertexResource*>(p->second.get())->levelOfDetail){
+                    for(auto& levelMesh : lod->levelMeshes){
+                        retainResource(levelMesh);
+                    }
+                }
+            }
+        }
+        if(auto texture = shape->texture()){
+            if(auto image = texture->image()){
+                retainResource(image);
+            }
+        }
+    }
+}
+
+
+void GLSLSceneRenderer::Impl::retainResource(SgObject* object)
+{
+    auto p = currentResourceMap->find(object);
+    if(p != currentResourceMap->end()){
+        nextResourceMap->insert(*p);
+    }
+}
+
+
 void GLSLSceneRenderer::renderCustomTransform(SgTransform* transform, std::function<void()> traverseFunction)
 {
     Affine3 T;
@@ -2178,6 +2550,7 @@ void GLSLSceneRenderer::Impl::drawVertexResource
     currentProgram->setTransform(PV, viewTransform, modelTransform, resource->pLocalTransform);
     glBindVertexArray(resource->vao);
     glDrawArrays(primitiveMode, 0, resource->numVertices);
+    ++renderingStatistics.numDrawCalls;
 }
 
 
@@ -2220,6 +2593,20 @@ void GLSLSceneRenderer::Impl::renderShape(SgShape* shape)
 {
     SgMesh* mesh = shape->mesh();
     if(mesh && mesh->hasVertices()){
+        if(isFrustumCullingActive){
+            auto& bbox = mesh->boundingBox();
+            if(!bbox.empty() && isBoundingBoxOutsideFrustum(bbox, modelMatrixStack.back())){
+                ++renderingStatistics.numCulledShapes;
+                if(isCheckingUnusedResources){
+                    retainSubTreeResources(shape);
+                }
+                return;
+            }
+        }
+        ++renderingStatistics.numRenderedShapes;
+        if(isLevelOfDetailActive && !isBoundingBoxRenderingMode){
+            mesh = selectLevelOfDetailMesh(shape, mesh);
+        }
         SgMaterial* material = shape->material();
         bool isTransparent = false;
         if(currentProgram->hasCapability(ShaderProgram::Transparency)){
@@ -2228,18 +2615,23 @@ void GLSLSceneRenderer::Impl::renderShape(SgShape* shape)
             }
         }
         if(!isTransparent){
-            auto pickIndex = pushPickEndNode(shape, false);
-            renderShapeMain(shape, modelMatrixStack.back(), pickIndex);
-            popPickNode();
+            if(isInstancedRenderingActive && checkIfInstancedRenderingAvailable(shape)){
+                addShapeToInstancingBatch(shape, mesh);
+            } else {
+                auto pickIndex = pushPickEndNode(shape, false);
+                renderShapeMain(shape, mesh, modelMatrixStack.back(), pickIndex);
+                popPickNode();
+            }
         } else {
             if(!isRenderingShadowMap){
                 SgShapePtr shapePtr = shape;
+                SgMeshPtr meshPtr = mesh;
                 int matrixIndex = modelMatrixBuffer.size();
                 modelMatrixBuffer.push_back(modelMatrixStack.back());
                 auto pickIndex = pushPickEndNode(shape, false);
                 transparentRenderingQueue.emplace_back(
-                    [this, shapePtr, matrixIndex, pickIndex](){
-                        renderShapeMain(shapePtr, modelMatrixBuffer[matrixIndex], pickIndex); });
+                    [this, shapePtr, meshPtr, matrixIndex, pickIndex](){
+                        renderShapeMain(shapePtr, meshPtr, modelMatrixBuffer[matrixIndex], pickIndex); });
                 popPickNode();
             }
         }
@@ -2247,32 +2639,248 @@ void GLSLSceneRenderer::Impl::renderShape(SgShape* shape)
 }
 
 
-void GLSLSceneRenderer::Impl::renderShapeMain(SgShape* shape, const Affine3& modelTransform, int pickIndex)
+/**
+   The shapes whose rendering depends on the states that are changed during the traversal,
+   such as the wireframe overlay, are rendered individually.
+*/
+bool GLSLSceneRenderer::Impl::checkIfInstancedRenderingAvailable(SgShape* shape)
 {
-    auto mesh = shape->mesh();
-    
-    if(isRenderingPickingImage){
-        setPickColor(pickIndex);
-    } else {
-        renderMaterial(shape->material());
-        if(mesh->hasColors()){
-            currentProgram->setVertexColorEnabled(true);
+    return currentProgram == fullLightingProgram.get() &&
+        !isBoundingBoxRenderingMode &&
+        !isLowMemoryConsumptionRenderingBeingProcessed &&
+        !isNormalVisualizationEnabled &&
+        solidWireframeStyleStack.empty();
+}
+
+
+/**
+   The level of the mesh is selected from the projected size of its bounding box. The meshes with
+   the vertex colors or the texture are always rendered in the original detail. The vertex resource
+   of the original mesh is kept while the simplified meshes are used because it owns them.
+*/
+SgMesh* GLSLSceneRenderer::Impl::selectLevelOfDetailMesh(SgShape* shape, SgMesh* mesh)
+{
+    if(mesh->numTriangles() < MinNumTrianglesForLevelOfDetail ||
+       mesh->hasColors() || (mesh->hasTexCoords() && shape->texture())){
+        return mesh;
+    }
+    auto& bbox = mesh->boundingBox();
+    if(bbox.empty()){
+        return mesh;
+    }
+
+    auto& resource = getOrCreateVertexResource(mesh)->levelOfDetail;
+    if(!resource){
+        resource = new LevelOfDetailResource;
+    }
+    if(auto& generation = resource->generation){
+        if(!generation->isFinished){
+            return mesh;
         }
+        resource->levelMeshes = std::move(generation->levelMeshes);
+        generation.reset();
+    }
+    if(resource->mesh != mesh){
+        requestLevelOfDetailMeshGeneration(resource, mesh);
+        return mesh;
+    }
+    const int numLevels = resource->levelMeshes.size();
+    if(numLevels == 0){
+        return mesh;
+    }
 
-        if(currentMaterialLightingProgram){
-            bool isTextureValid = false;
-            if(isTextureBeingRendered){
-                if(auto texture = shape->texture()){
-                    isTextureValid = renderTexture(texture);
+    auto& T = modelMatrixStack.back();
+    double scale = T.linear().colwise().norm().maxCoeff();
+    double pixelSize =
+        2.0 * bbox.boundingSphereRadius() * scale * self->projectedPixelSizeRatio(T * bbox.center());
+    if(pixelSize >= FullDetailPixelSize){
+        return mesh;
+    }
+    int level = numLevels;
+    if(pixelSize > 0.0){
+        level = std::min(numLevels, static_cast<int>(std::floor(std::log2(FullDetailPixelSize / pixelSize))) + 1);
+    }
+    ++renderingStatistics.numLevelOfDetailShapes;
+    return resource->levelMeshes[level - 1];
+}
+
+
+void GLSLSceneRenderer::Impl::requestLevelOfDetailMeshGeneration(LevelOfDetailResource* resource, SgMesh* mesh)
+{
+    resource->reset();
+    resource->mesh = mesh;
+    resource->meshConnection =
+        mesh->sigUpdated().connect(
+            [resource](const SgUpdate&){
+                resource->cancelGeneration();
+                resource->mesh.reset();
+                resource->levelMeshes.clear();
+            });
+
+    // The source mesh is copied here because the original one may be modified during the generation
+    SgMeshPtr source = new SgMesh;
+    source->setVertices(new SgVertexArray(*mesh->vertices()));
+    source->triangleVertices() = mesh->triangleVertices();
+    const float creaseAngle = mesh->creaseAngle();
+    const bool isSolid = mesh->isSolid();
+
+    LevelOfDetailGenerationPtr generation = new LevelOfDetailGeneration;
+    resource->generation = generation;
+
+    getLevelOfDetailThreadPool()->start(
+        [generation, source, creaseAngle, isSolid](){
+            vector<SgMeshPtr> levelMeshes;
+            MeshFilter filter;
+            SgMesh* prevMesh = source;
+            for(int i=0; i < MaxNumLevelsOfDetail; ++i){
+                if(generation->isCanceled){
+                    return;
+                }
+                SgMeshPtr levelMesh = new SgMesh;
+                levelMesh->setVertices(new SgVertexArray(*prevMesh->vertices()));
+                levelMesh->triangleVertices() = prevMesh->triangleVertices();
+                int targetNumTriangles = prevMesh->numTriangles() * LevelOfDetailReductionRatio;
+                if(!filter.decimate(levelMesh, targetNumTriangles)){
+                    break;
                 }
+                levelMesh->setCreaseAngle(creaseAngle);
+                levelMesh->setSolid(isSolid);
+                levelMeshes.push_back(levelMesh);
+                prevMesh = levelMesh;
+            }
+            for(auto& levelMesh : levelMeshes){
+                if(generation->isCanceled){
+                    return;
+                }
+                filter.generateNormals(levelMesh, creaseAngle);
+            }
+            generation->levelMeshes = std::move(levelMeshes);
+            generation->isFinished = true;
+        });
+}
+
+
+void GLSLSceneRenderer::Impl::addShapeToInstancingBatch(SgShape* shape, SgMesh* mesh)
+{
+    InstancingKey key;
+    key.mesh = mesh;
+    key.material = shape->material();
+    key.texture = isTextureBeingRendered ? shape->texture() : nullptr;
+
+    int batchIndex;
+    auto inserted = instancingBatchIndexMap.insert(make_pair(key, instancingBatches.size()));
+    if(inserted.second){
+        batchIndex = instancingBatches.size();
+        instancingBatches.emplace_back();
+        instancingBatches.back().shape = shape;
+        instancingBatches.back().mesh = mesh;
+        instancingBatches.back().resource = nullptr;
+    } else {
+        batchIndex = inserted.first->second;
+    }
+    auto& batch = instancingBatches[batchIndex];
+    batch.modelMatrixIndices.push_back(modelMatrixBuffer.size());
+    modelMatrixBuffer.push_back(modelMatrixStack.back());
+}
+
+
+void GLSLSceneRenderer::Impl::renderInstancingBatches()
+{
+    constexpr int MatrixSize = 16;
+    
+    instanceModelMatrixBuf.clear();
+    for(auto& batch : instancingBatches){
+        if(static_cast<int>(batch.modelMatrixIndices.size()) >= MinNumInstancesForInstancedRendering){
+            auto resource = getOrCreateVertexResource(batch.mesh);
+            if(!resource->isValid()){
+                makeVertexBufferObjects(batch.shape, batch.mesh, resource);
+            }
+            batch.resource = resource;
+            // The local transform of the compressed vertices is included in the instance matrices
+            for(auto& index : batch.modelMatrixIndices){
+                const size_t top = instanceModelMatrixBuf.size();
+                instanceModelMatrixBuf.resize(top + MatrixSize);
+                Eigen::Map<Matrix4f> M(&instanceModelMatrixBuf[top]);
+                if(resource->pLocalTransform){
+                    M = (modelMatrixBuffer[index].matrix() * (*resource->pLocalTransform)).cast<float>();
+                } else {
+                    M = modelMatrixBuffer[index].matrix().cast<float>();
+                }
+            }
+        }
+    }
+    if(!instanceModelMatrixBuf.empty()){
+        if(!instanceModelMatrixBuffer){
+            glGenBuffers(1, &instanceModelMatrixBuffer);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceModelMatrixBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instanceModelMatrixBuf.size() * sizeof(GLfloat),
+                     instanceModelMatrixBuf.data(), GL_STREAM_DRAW);
+    }
+
+    const GLuint location0 = FullLightingProgram::InstanceModelMatrixLocation;
+    size_t offset = 0;
+    
+    for(auto& batch : instancingBatches){
+        auto shape = batch.shape.get();
+        auto mesh = batch.mesh.get();
+        const int numInstances = batch.modelMatrixIndices.size();
+
+        if(numInstances < MinNumInstancesForInstancedRendering){
+            for(auto& index : batch.modelMatrixIndices){
+                renderShapeMain(shape, mesh, modelMatrixBuffer[index], 0);
             }
-            currentMaterialLightingProgram->setTextureEnabled(isTextureValid);
+            continue;
         }
+        
+        renderShapeAppearance(shape, mesh);
+        VertexResource* resource = batch.resource;
+        applyCullingMode(mesh);
+        fullLightingProgram->enableInstancing(PV, viewTransform);
+        {
+            LockVertexArrayAPI lock;
+            glBindVertexArray(resource->vao);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceModelMatrixBuffer);
+            for(GLuint i=0; i < 4; ++i){
+                glEnableVertexAttribArray(location0 + i);
+                glVertexAttribPointer(
+                    location0 + i, 4, GL_FLOAT, GL_FALSE, MatrixSize * sizeof(GLfloat),
+                    ((GLubyte*)NULL + (offset + i * 4 * sizeof(GLfloat))));
+                glVertexAttribDivisor(location0 + i, 1);
+            }
+        }
+        glDrawArraysInstanced(GL_TRIANGLES, 0, resource->numVertices, numInstances);
+        {
+            LockVertexArrayAPI lock;
+            for(GLuint i=0; i < 4; ++i){
+                glVertexAttribDivisor(location0 + i, 0);
+                glDisableVertexAttribArray(location0 + i);
+            }
+        }
+        fullLightingProgram->disableInstancing();
+        
+        offset += numInstances * MatrixSize * sizeof(GLfloat);
+        ++renderingStatistics.numDrawCalls;
+        renderingStatistics.numInstancedShapes += numInstances;
+    }
+
+    instancingBatchIndexMap.clear();
+    instancingBatches.clear();
+}
+
+
+void GLSLSceneRenderer::Impl::renderShapeMain
+(SgShape* shape, SgMesh* mesh, const Affine3& modelTransform, int pickIndex)
+{
+    if(isRenderingPickingImage){
+        setPickColor(pickIndex);
+    } else {
+        renderShapeAppearance(shape, mesh);
     }
 
     VertexResource* resource = getOrCreateVertexResource(mesh);
     if(!resource->isValid()){
-        makeVertexBufferObjects(shape, resource);
+        makeVertexBufferObjects(shape, mesh, resource);
     }
     if(isBoundingBoxRenderingMode){
         drawBoundingBox(resource, mesh->boundingBox());
@@ -2289,6 +2897,25 @@ void GLSLSceneRenderer::Impl::renderShapeMain(SgShape* shape, const Affine3& mod
 }
 
 
+void GLSLSceneRenderer::Impl::renderShapeAppearance(SgShape* shape, SgMesh* mesh)
+{
+    renderMaterial(shape->material());
+    if(mesh->hasColors()){
+        currentProgram->setVertexColorEnabled(true);
+    }
+
+    if(currentMaterialLightingProgram){
+        bool isTextureValid = false;
+        if(isTextureBeingRendered){
+            if(auto texture = shape->texture()){
+                isTextureValid = renderTexture(texture);
+            }
+        }
+        currentMaterialLightingProgram->setTextureEnabled(isTextureValid);
+    }
+}
+
+
 void GLSLSceneRenderer::Impl::applyCullingMode(SgMesh* mesh)
 {
     if(!stateFlag[CULL_FACE]){
@@ -2424,10 +3051,8 @@ bool GLSLSceneRenderer::Impl::loadTextureImage(TextureResource* resource, const
 }
 
 
-void GLSLSceneRenderer::Impl::makeVertexBufferObjects(SgShape* shape, VertexResource* resource)
+void GLSLSceneRenderer::Impl::makeVertexBufferObjects(SgShape* shape, SgMesh* mesh, VertexResource* resource)
 {
-    auto mesh = shape->mesh();
-
     if(isLowMemoryConsumptionRenderingBeingProcessed){
         writeMeshVerticesNormalizedShort(mesh, resource);
     } else {
@@ -2486,7 +3111,7 @@ void GLSLSceneRenderer::Impl::writeMeshVerticesSub
         glVertexAttribPointer((GLuint)0, 3, gltype, normalized, 0, ((GLubyte*)NULL + (0)));
     }
     auto size = vertices.array.size() * sizeof(value_type);
-    glBufferData(GL_ARRAY_BUFFER, size, vertices.array.data(), GL_STATIC_DRAW);
+    resource->setBufferData(size, vertices.array.data());
     glEnableVertexAttribArray(0);
 }
 
@@ -2602,7 +3227,7 @@ bool GLSLSceneRenderer::Impl::writeMeshNormalsSub
             glBindBuffer(GL_ARRAY_BUFFER, resource->newBuffer());
             glVertexAttribPointer((GLuint)1, glsize, gltype, normalized, 0, ((GLubyte*)NULL + (0)));
         }
-        glBufferData(GL_ARRAY_BUFFER, normals.array.size() * sizeof(value_type), normals.array.data(), GL_STATIC_DRAW);
+        resource->setBufferData(normals.array.size() * sizeof(value_type), normals.array.data());
         glEnableVertexAttribArray(1);
     }
     
@@ -2769,7 +3394,7 @@ void GLSLSceneRenderer::Impl::writeMeshTexCoordsSub
         glVertexAttribPointer((GLuint)2, 2, gltype, normalized, 0, 0);
     }
     auto size = texCoords.array.size() * sizeof(value_type);
-    glBufferData(GL_ARRAY_BUFFER, size, texCoords.array.data(), GL_STATIC_DRAW);
+    resource->setBufferData(size, texCoords.array.data());
     glEnableVertexAttribArray(2);
 }
 
@@ -2887,7 +3512,7 @@ void GLSLSceneRenderer::Impl::writeMeshColors(SgMesh* mesh, VertexResource* reso
         glBindBuffer(GL_ARRAY_BUFFER, resource->newBuffer());
         glVertexAttribPointer((GLuint)3, 3, GL_UNSIGNED_BYTE, GL_TRUE, 0, ((GLubyte*)NULL + (0)));
     }
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(Color), colors.data(), GL_STATIC_DRAW);
+    resource->setBufferData(colors.size() * sizeof(Color), colors.data());
     glEnableVertexAttribArray(3);
 }
     
@@ -2905,7 +3530,7 @@ void GLSLSceneRenderer::Impl::renderShapeVertices(SgShape* shape)
                 glBindBuffer(GL_ARRAY_BUFFER, resource->newBuffer());
                 glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
             }
-            glBufferData(GL_ARRAY_BUFFER, vertices->size() * sizeof(Vector3f), vertices->data(), GL_STATIC_DRAW);
+            resource->setBufferData(vertices->size() * sizeof(Vector3f), vertices->data());
             glEnableVertexAttribArray(0);
             resource->numVertices = vertices->size();
         }
@@ -2930,7 +3555,7 @@ void GLSLSceneRenderer::Impl::renderPlot
             glBindBuffer(GL_ARRAY_BUFFER, resource->newBuffer());
             glVertexAttribPointer((GLuint)0, 3, GL_FLOAT, GL_FALSE, 0, ((GLubyte *)NULL + (0)));
         }
-        glBufferData(GL_ARRAY_BUFFER, vertices->size() * sizeof(Vector3f), vertices->data(), GL_STATIC_DRAW);
+        resource->setBufferData(vertices->size() * sizeof(Vector3f), vertices->data());
         glEnableVertexAttribArray(0);
 
         if(plot->hasColors()){
@@ -2968,7 +3593,7 @@ void GLSLSceneRenderer::Impl::renderPlot
                 glBindBuffer(GL_ARRAY_BUFFER, resource->newBuffer());
                 glVertexAttribPointer((GLuint)3, 3, GL_UNSIGNED_BYTE, GL_TRUE, 0, ((GLubyte*)NULL +(0)));
             }
-            glBufferData(GL_ARRAY_BUFFER, n * sizeof(Color), colors.data(), GL_STATIC_DRAW);
+            resource->setBufferData(n * sizeof(Color), colors.data());
             glEnableVertexAttribArray(3);
         }
     }        
@@ -3615,3 +4240,61 @@ void GLSLSceneRenderer::setLowMemoryConsumptionMode(bool on)
         requestToClearResources();
     }
 }
+
+
+void GLSLSceneRenderer::setFrustumCullingEnabled(bool on)
+{
+    impl->isFrustumCullingEnabled = on;
+}
+
+
+bool GLSLSceneRenderer::isFrustumCullingEnabled() const
+{
+    return impl->isFrustumCullingEnabled;
+}
+
+
+void GLSLSceneRenderer::setInstancedRenderingEnabled(bool on)
+{
+    impl->isInstancedRenderingEnabled = on;
+}
+
+
+bool GLSLSceneRenderer::isInstancedRenderingEnabled() const
+{
+    return impl->isInstancedRenderingEnabled;
+}
+
+
+void GLSLSceneRenderer::setLevelOfDetailEnabled(bool on)
+{
+    impl->isLevelOfDetailEnabled = on;
+}
+
+
+bool GLSLSceneRenderer::isLevelOfDetailEnabled() const
+{
+    return impl->isLevelOfDetailEnabled;
+}
+
+
+const GLSLSceneRenderer::RenderingStatistics& GLSLSceneRenderer::renderingStatistics() const
+{
+    return impl->lastRenderingStatistics;
+}
+
+
+size_t GLSLSceneRenderer::estimateResourceMemoryUsage() const
+{
+    // The same resource may be contained in both the current and next maps
+    std::unordered_set<GLResource*> countedResources;
+    size_t size = 0;
+    for(auto& resourceMap : impl->resourceMaps){
+        for(auto& kv : resourceMap){
+            if(countedResources.insert(kv.second.get()).second){
+                size += kv.second->estimateMemoryUsage();
+            }
+        }
+    }
+    return size;
+}
@@ -89,6 +89,53 @@ class CNOID_EXPORT GLSLSceneRenderer : public GLSceneRenderer
 
     void setLowMemoryConsumptionMode(bool on);
 
+    /**
+       The shapes and the transform nodes whose bounding boxes are out of the view frustum
+       are skipped in rendering the visible image and the picking image. The culling relies on the
+       cached bounding boxes, which are only updated by the updates notified to the scene graph,
+       so it should only be enabled for the views whose scenes are updated with the notifications.
+       This is disabled by default.
+    */
+    void setFrustumCullingEnabled(bool on);
+    bool isFrustumCullingEnabled() const;
+
+    /**
+       The shapes sharing the same mesh, material and texture are rendered with an instanced
+       draw call in rendering the visible image with the normal lighting mode.
+       This is enabled by default.
+    */
+    void setInstancedRenderingEnabled(bool on);
+    bool isInstancedRenderingEnabled() const;
+
+    /**
+       The simplified meshes of the large meshes are generated in background and they are rendered
+       instead of the original meshes when the projected sizes of the meshes are small.
+       This is enabled by default.
+    */
+    void setLevelOfDetailEnabled(bool on);
+    bool isLevelOfDetailEnabled() const;
+
+    struct RenderingStatistics
+    {
+        int numRenderedShapes;
+        int numCulledShapes;
+        int numCulledTransforms;
+        int numInstancedShapes;
+        //! The number of the shapes rendered with the simplified meshes
+        int numLevelOfDetailShapes;
+        //! The number of the draw calls for the shapes and the plots
+        int numDrawCalls;
+    };
+
+    //! The statistics of the last rendering of the visible image
+    const RenderingStatistics& renderingStatistics() const;
+
+    /**
+       An estimate of the bytes of the vertex buffers and the textures allocated by the renderer,
+       and the simplified meshes kept for the level of detail rendering
+    */
+    size_t estimateResourceMemoryUsage() const;
+
     virtual void setPickingImageOutputEnabled(bool on) override;
     virtual bool getPickingImage(Image& out_image) override;
 
@@ -198,6 +198,11 @@ public:
     GLint normalMatrixLocation;
     GLint MVPLocation;
 
+    // For the instanced rendering
+    GLint isInstancingEnabledLocation;
+    GLint viewMatrixLocation;
+    GLint viewProjectionMatrixLocation;
+
     // For the wireframe overlay rendering
     int viewportWidth, viewportHeight;
     GLint viewportMatrixLocation;
@@ -232,6 +237,7 @@ public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
         int lightIndex;
         GLint shadowMatrixLocation;
+        GLint shadowViewProjectionMatrixLocation;
         GLint lightIndexLocation;
         GLint shadowMapLocation;
         GLuint depthTexture;
@@ -1231,6 +1237,10 @@ void FullLightingProgram::Impl::initialize(GLSLProgram& glsl)
         MVPLocation = glsl.getUniformLocation("MVP");
     }
 
+    isInstancingEnabledLocation = glsl.getUniformLocation("isInstancingEnabled");
+    viewMatrixLocation = glsl.getUniformLocation("viewMatrix");
+    viewProjectionMatrixLocation = glsl.getUniformLocation("viewProjectionMatrix");
+
     viewportMatrixLocation = glsl.getUniformLocation("viewportMatrix");
     isViewportMatrixInvalidated = true;
     isWireframeEnabledLocation = glsl.getUniformLocation("isWireframeEnabled");
@@ -1270,6 +1280,8 @@ void FullLightingProgram::Impl::initializeShadowInfo(GLSLProgram& glsl, int inde
     ShadowInfo& shadow = shadowInfos[index];
 
     shadow.shadowMatrixLocation = glsl.getUniformLocation(formatC("shadowMatrices[{}]", index));
+    shadow.shadowViewProjectionMatrixLocation =
+        glsl.getUniformLocation(formatC("shadowViewProjectionMatrices[{}]", index));
     
     string prefix = formatC("shadows[{}].", index);
     shadow.lightIndexLocation = glsl.getUniformLocation(prefix + "lightIndex");
@@ -1417,6 +1429,28 @@ bool FullLightingProgram::isWireframeEnabled() const
 }
 
 
+void FullLightingProgram::enableInstancing(const Matrix4& PV, const Isometry3& V)
+{
+    const Matrix4f PVf = PV.cast<float>();
+    const Matrix4f Vf = V.matrix().cast<float>();
+    glUniform1i(impl->isInstancingEnabledLocation, true);
+    glUniformMatrix4fv(impl->viewProjectionMatrixLocation, 1, GL_FALSE, PVf.data());
+    glUniformMatrix4fv(impl->viewMatrixLocation, 1, GL_FALSE, Vf.data());
+
+    for(int i=0; i < impl->numShadows; ++i){
+        auto& shadow = impl->shadowInfos[i];
+        const Matrix4f BPV = shadow.BPV.cast<float>();
+        glUniformMatrix4fv(shadow.shadowViewProjectionMatrixLocation, 1, GL_FALSE, BPV.data());
+    }
+}
+
+
+void FullLightingProgram::disableInstancing()
+{
+    glUniform1i(impl->isInstancingEnabledLocation, false);
+}
+
+
 void FullLightingProgram::Impl::updateShaderWireframeState()
 {
     if(isWireframeEnabled && isViewportMatrixInvalidated){
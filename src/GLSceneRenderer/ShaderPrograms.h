@@ -327,6 +327,15 @@ public:
     void enableWireframe(const Vector4f& color, float width);
     void disableWireframe();
     bool isWireframeEnabled() const;
+
+    /**
+       In the instancing mode, the model matrix of each instance is given by the vertex attribute
+       at InstanceModelMatrixLocation to the (InstanceModelMatrixLocation + 3) with the divisor one,
+       and the transform given by the setTransform function is not used.
+    */
+    static constexpr int InstanceModelMatrixLocation = 4;
+    void enableInstancing(const Matrix4& PV, const Isometry3& V);
+    void disableInstancing();
     
     void activateShadowMapGenerationPass(int shadowIndex);
     void activateMainRenderingPass();
@@ -6,6 +6,8 @@ layout (location = 0) in vec4 vertexPosition;
 layout (location = 1) in vec3 vertexNormal;
 layout (location = 2) in vec2 vertexTexCoord;
 layout (location = 3) in vec3 vertexColor;
+// The locations from 4 to 7 are used for the columns of the matrix
+layout (location = 4) in mat4 instanceModelMatrix;
 
 out VertexData {
     vec3 position;
@@ -36,17 +38,34 @@ uniform mat3 normalMatrix;
 uniform int numShadows;
 uniform mat4 shadowMatrices[MAX_NUM_SHADOWS];
 
+// The model matrix is given by the instance attribute instead of the above matrices
+uniform bool isInstancingEnabled = false;
+uniform mat4 viewMatrix;
+uniform mat4 viewProjectionMatrix;
+uniform mat4 shadowViewProjectionMatrices[MAX_NUM_SHADOWS];
+
 void main()
 {
-    outData.normal = normalize(normalMatrix * vertexNormal);
-    outData.position = vec3(modelViewMatrix * vertexPosition);
-
     outData.texCoord = vertexTexCoord;
     outData.colorV = vertexColor;
-    
-    for(int i=0; i < numShadows; ++i){
-        outData.shadowCoords[i] = shadowMatrices[i] * vertexPosition;
+
+    if(isInstancingEnabled){
+        vec4 worldPosition = instanceModelMatrix * vertexPosition;
+        // The inverse transpose is required for the non-uniform scaling of the model matrix
+        mat3 N = mat3(viewMatrix) * transpose(inverse(mat3(instanceModelMatrix)));
+        outData.normal = normalize(N * vertexNormal);
+        outData.position = vec3(viewMatrix * worldPosition);
+        for(int i=0; i < numShadows; ++i){
+            outData.shadowCoords[i] = shadowViewProjectionMatrices[i] * worldPosition;
+        }
+        gl_Position = viewProjectionMatrix * worldPosition;
+
+    } else {
+        outData.normal = normalize(normalMatrix * vertexNormal);
+        outData.position = vec3(modelViewMatrix * vertexPosition);
+        for(int i=0; i < numShadows; ++i){
+            outData.shadowCoords[i] = shadowMatrices[i] * vertexPosition;
+        }
+        gl_Position = MVP * vertexPosition;
     }
-    
-    gl_Position = MVP * vertexPosition;
 }
@@ -31,7 +31,11 @@ class MediaPlugin : public Plugin
 public:
     MediaPlugin() : Plugin("Media")
         { 
-
+            declareItemClass("MediaItem");
+            declareItemClass("AudioItem");
+            declareViewClass("MediaView");
+            declareMenuItem("/File/Load .../Media file");
+            declareMenuItem("/File/Load .../Audio File");
         }
         
     virtual ~MediaPlugin()
@@ -95,74 +95,73 @@ void FFCalculator::calcAddMass (LinkForce* pLinkForceT, LinkForce* pLinkForceR)
 }
 
 void FFCalculator::calcSurfaceGeneral(LinkForce* pLinkForceN, LinkForce* pLinkForceT,int degreeNumber)
+{
+    SurfacePointArray points;
+    points.build (_triAttrAry, degreeNumber);
+    points.update (_linkState);
+    calcSurfaceGeneral (pLinkForceN, pLinkForceT, points);
+}
+
+void FFCalculator::calcSurfaceGeneral(LinkForce* pLinkForceN, LinkForce* pLinkForceT, const SurfacePointArray& points)
 {
 
-    const int numIP = degreeNumber;
+    const double repLength = std::pow (_linkVolume, 1.0/3.0);
 
-    for (const auto& triAttr : _triAttrAry)
+    const int numPoints = points.size();
+
+    for (int i=0; i<numPoints; ++i)
     {
-        const GaussTriangle3d tri (triAttr.triangle(), _linkState.trans());
+        const Vector3 posIP = points.position(i);
 
-        for (int iIP=0; iIP<numIP; ++iIP)
-        {
+        FluidEnvironment::FluidValue fluid;
+        bool inBounds = _fluidEnv.get (posIP, fluid);
 
-            const double cutCoef = triAttr.cutoffCoefficient(iIP);
-            if (cutCoef < 1.0e-12)
-                continue;
+        if ( inBounds==false  && _fluidEnvAll.isFluid ==false)
+            continue;
 
-            const Vector3 posIP = tri.getGaussPoint(iIP,numIP);
+        if(inBounds==true){
+            if(fluid.isFluid ==true){
+            }else continue;
+        }else if(_fluidEnvAll.isFluid == true){
+            fluid=_fluidEnvAll;
+        }else continue;
 
-            FluidEnvironment::FluidValue fluid;
-            bool inBounds = _fluidEnv.get (posIP, fluid);
+        const double coefIP = points.coef(i);
+        const Vector3 normal = points.normal(i);
 
-            if ( inBounds==false  && _fluidEnvAll.isFluid ==false)
-                continue;
+        double velPerp;
+        double velPara;
+        Vector3 vePara;
 
-            if(inBounds==true){
-                if(fluid.isFluid ==true){
-                }else continue;
-            }else if(_fluidEnvAll.isFluid == true){
-                fluid=_fluidEnvAll;
-            }else continue;
+        Vector3 velRelative = fluid.velocity - points.velocity(i);
+        _calcVectorDecomp (velRelative, -normal, &velPerp, &velPara, &vePara);
 
-            const double coefIP = cutCoef * tri.getGaussWeight(iIP,numIP) * tri.area();
+        if (velPerp >= TINY_VELOCITY)
+        {
+            double pressure = 0.5 * fluid.density * std::pow (std::max (0.0, velPerp), 2);
+            Vector3 force = -normal * pressure;
+            pLinkForceN->addForce (coefIP * force, posIP);
+        }
 
-            double velPerp;
-            double velPara;
-            Vector3 vePara;
+        if (velPara >= TINY_VELOCITY)
+        {
 
-            Vector3 velRelative = fluid.velocity - _linkState.translationalVelocityAt(posIP);
-            _calcVectorDecomp (velRelative, -tri.normal(), &velPerp, &velPara, &vePara);
+            double coefReynolds = fluid.density * velPara * repLength / fluid.viscosity;
 
-            if (velPerp >= TINY_VELOCITY)
+            if (coefReynolds < 4.0e5)
             {
-                double pressure = 0.5 * fluid.density * std::pow (std::max (0.0, velPerp), 2);
-                Vector3 force = -tri.normal() * pressure;
-                pLinkForceN->addForce (coefIP * force, posIP);
+                Vector3 forceT = 0.664 * velPara * vePara *
+                                 std::sqrt (fluid.viscosity * fluid.density * velPara / repLength);
+                pLinkForceT->addForce (coefIP * forceT, posIP);
             }
-
-            if (velPara >= TINY_VELOCITY)
+            else
             {
+                double coefResist = 0.455 / std::pow (std::log10(coefReynolds), 2.58) - 1700.0 / coefReynolds;
+                if (coefReynolds < 6.0e5)
+                    coefResist = std::max (coefResist, 1.328 / std::sqrt(coefReynolds));
 
-                double repLength = std::pow (_linkVolume, 1.0/3.0);
-
-                double coefReynolds = fluid.density * velPara * repLength / fluid.viscosity;
-
-                if (coefReynolds < 4.0e5)
-                {
-                    Vector3 forceT = 0.664 * velPara * vePara *
-                                     std::sqrt (fluid.viscosity * fluid.density * velPara / repLength);
-                    pLinkForceT->addForce (coefIP * forceT, posIP);
-                }
-                else
-                {
-                    double coefResist = 0.455 / std::pow (std::log10(coefReynolds), 2.58) - 1700.0 / coefReynolds;
-                    if (coefReynolds < 6.0e5)
-                        coefResist = std::max (coefResist, 1.328 / std::sqrt(coefReynolds));
-
-                    Vector3 forceT = coefResist * 0.5 * fluid.density * velPara * velPara * vePara;
-                    pLinkForceT->addForce (coefIP * forceT, posIP);
-                }
+                Vector3 forceT = coefResist * 0.5 * fluid.density * velPara * velPara * vePara;
+                pLinkForceT->addForce (coefIP * forceT, posIP);
             }
         }
     }
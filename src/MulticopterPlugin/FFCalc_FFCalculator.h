@@ -53,6 +53,9 @@ public:
 
     void calcSurfaceGeneral (LinkForce* pLinkForceN, LinkForce* pLinkForceT,int);
 
+    //! The points must be updated with the link state given to the constructor
+    void calcSurfaceGeneral (LinkForce* pLinkForceN, LinkForce* pLinkForceT, const SurfacePointArray& points);
+
     void calcGravity_forDebug (LinkForce* pLinkForce);
 
 private:
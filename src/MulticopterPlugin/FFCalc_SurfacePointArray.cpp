@@ -0,0 +1,114 @@
+/**
+   @author Japan Atomic Energy Agency
+*/
+
+#include "MulticopterPluginHeader.h"
+
+namespace Multicopter {
+namespace FFCalc {
+
+void SurfacePointArray::build (const std::vector<LinkTriangleAttribute>& triAttrAry, int degreeNumber)
+{
+    const int numIP = degreeNumber;
+
+    _localX.clear();
+    _localY.clear();
+    _localZ.clear();
+    _localNormalX.clear();
+    _localNormalY.clear();
+    _localNormalZ.clear();
+    _coef.clear();
+
+    for (const auto& triAttr : triAttrAry)
+    {
+        const GaussTriangle3d tri (triAttr.triangle());
+
+        // A degenerate triangle does not have a valid normal and does not contribute to the force
+        if (!(tri.area() > 0.0))
+            continue;
+
+        for (int iIP=0; iIP<numIP; ++iIP)
+        {
+            const double cutCoef = triAttr.cutoffCoefficient(iIP);
+            if (cutCoef < 1.0e-12)
+                continue;
+
+            const Vector3 posIP = tri.getGaussPoint(iIP,numIP);
+            _localX.push_back(posIP.x());
+            _localY.push_back(posIP.y());
+            _localZ.push_back(posIP.z());
+            _localNormalX.push_back(tri.normal().x());
+            _localNormalY.push_back(tri.normal().y());
+            _localNormalZ.push_back(tri.normal().z());
+            _coef.push_back(cutCoef * tri.getGaussWeight(iIP,numIP) * tri.area());
+        }
+    }
+
+    const size_t n = _coef.size();
+    _x.resize(n);
+    _y.resize(n);
+    _z.resize(n);
+    _normalX.resize(n);
+    _normalY.resize(n);
+    _normalZ.resize(n);
+    _velocityX.resize(n);
+    _velocityY.resize(n);
+    _velocityZ.resize(n);
+}
+
+void SurfacePointArray::update (const LinkState& linkState)
+{
+    const Transform3& trans = linkState.trans();
+    const Matrix3 R = trans.linear();
+    const Vector3 p = trans.translation();
+    const Vector3 v = linkState.translationalVelocityAt(p);
+    const Vector3& w = linkState.rotationalVelocity();
+
+    const double r00 = R(0,0), r01 = R(0,1), r02 = R(0,2);
+    const double r10 = R(1,0), r11 = R(1,1), r12 = R(1,2);
+    const double r20 = R(2,0), r21 = R(2,1), r22 = R(2,2);
+    const double px = p.x(), py = p.y(), pz = p.z();
+    const double vx = v.x(), vy = v.y(), vz = v.z();
+    const double wx = w.x(), wy = w.y(), wz = w.z();
+
+    const int n = size();
+    const double* lx = _localX.data();
+    const double* ly = _localY.data();
+    const double* lz = _localZ.data();
+    const double* lnx = _localNormalX.data();
+    const double* lny = _localNormalY.data();
+    const double* lnz = _localNormalZ.data();
+    double* x = _x.data();
+    double* y = _y.data();
+    double* z = _z.data();
+    double* nx = _normalX.data();
+    double* ny = _normalY.data();
+    double* nz = _normalZ.data();
+    double* velx = _velocityX.data();
+    double* vely = _velocityY.data();
+    double* velz = _velocityZ.data();
+
+    for (int i=0; i<n; ++i)
+    {
+        // The position relative to the link origin
+        const double rx = r00*lx[i] + r01*ly[i] + r02*lz[i];
+        const double ry = r10*lx[i] + r11*ly[i] + r12*lz[i];
+        const double rz = r20*lx[i] + r21*ly[i] + r22*lz[i];
+        x[i] = rx + px;
+        y[i] = ry + py;
+        z[i] = rz + pz;
+        velx[i] = vx + wy*rz - wz*ry;
+        vely[i] = vy + wz*rx - wx*rz;
+        velz[i] = vz + wx*ry - wy*rx;
+    }
+
+    for (int i=0; i<n; ++i)
+    {
+        nx[i] = r00*lnx[i] + r01*lny[i] + r02*lnz[i];
+        ny[i] = r10*lnx[i] + r11*lny[i] + r12*lnz[i];
+        nz[i] = r20*lnx[i] + r21*lny[i] + r22*lnz[i];
+    }
+}
+
+
+}}
@@ -0,0 +1,67 @@
+/**
+   @author Japan Atomic Energy Agency
+*/
+
+#pragma once
+#include "FFCalc_Common.h"
+#include <vector>
+
+namespace Multicopter {
+namespace FFCalc {
+
+class LinkState;
+
+/**
+   The Gauss integration points of the link surface stored as the structure of arrays.
+   The local coordinates and the integration coefficients are computed once at the
+   initialization, and the global positions, normals and link velocities of the points
+   are updated for each step by the loops that the compiler can vectorize.
+*/
+class SurfacePointArray
+{
+private:
+
+    std::vector<double> _localX, _localY, _localZ;
+    std::vector<double> _localNormalX, _localNormalY, _localNormalZ;
+
+    // The product of the cutoff coefficient, the Gauss weight and the triangle area
+    std::vector<double> _coef;
+
+    std::vector<double> _x, _y, _z;
+    std::vector<double> _normalX, _normalY, _normalZ;
+    std::vector<double> _velocityX, _velocityY, _velocityZ;
+
+public:
+
+    void build (const std::vector<LinkTriangleAttribute>& triAttrAry, int degreeNumber);
+
+    void update (const LinkState& linkState);
+
+    int size() const
+    {
+        return _coef.size();
+    }
+
+    double coef (int idx) const
+    {
+        return _coef[idx];
+    }
+
+    Vector3 position (int idx) const
+    {
+        return Vector3 (_x[idx], _y[idx], _z[idx]);
+    }
+
+    Vector3 normal (int idx) const
+    {
+        return Vector3 (_normalX[idx], _normalY[idx], _normalZ[idx]);
+    }
+
+    Vector3 velocity (int idx) const
+    {
+        return Vector3 (_velocityX[idx], _velocityY[idx], _velocityZ[idx]);
+    }
+};
+
+
+}}
@@ -22,6 +22,7 @@
 #include <cnoid/AISTCollisionDetector>
 #include <cnoid/EigenArchive>
 #include <cnoid/Tokenizer>
+#include <cnoid/ThreadPool>
 
 #include "gettext.h"
 #include "exportdecl.h"
@@ -49,6 +50,7 @@
 
 #include "FFCalc_LinkForce.h"
 #include "FFCalc_LinkState.h"
+#include "FFCalc_SurfacePointArray.h"
 #include "FFCalc_FFCalculator.h"
 #include "FFCalc_calcFluidForce.h"
 
@@ -7,6 +7,9 @@
 #include <cnoid/Format>
 #include <cmath>
 #include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 using namespace cnoid;
@@ -15,6 +18,9 @@ using namespace Multicopter;
 
 const double DEFAULT_GRAVITY_ACCELERATION = 9.80665;
 
+// The links are processed sequentially when the number of the links with the surface forces is less than this
+const int MIN_NUM_SURFACE_LINKS_FOR_PARALLEL_COMPUTATION = 2;
+
 SimulationManager* SimulationManager::_inst = 0;
 
 SimulationManager*
@@ -96,6 +102,8 @@ SimulationManager::SimulationManager()
 
     _effectLinkBodyMapSize=0;
 
+    _fluidForceTime=0.0;
+    _numFluidForceSteps=0;
 }
 
 SimulationManager::~SimulationManager()
@@ -151,6 +159,25 @@ SimulationManager::initializeSimulation(SimulatorItem* simItem, MulticopterSimul
 
     calculateSurfaceCuttoffCoefficient(_fluidLinkBodyMap,_linkPolygonMap);
 
+    updateSurfacePoints();
+
+    int numSurfaceLinks = 0;
+    for(auto& surfacePoints : _linkSurfacePointMap){
+        if(surfacePoints.second.size() > 0){
+            ++numSurfaceLinks;
+        }
+    }
+    int numThreads = std::min(numSurfaceLinks, static_cast<int>(std::thread::hardware_concurrency()));
+    if(numSurfaceLinks < MIN_NUM_SURFACE_LINKS_FOR_PARALLEL_COMPUTATION || numThreads < 2){
+        _threadPool.reset();
+    }
+    else if(!_threadPool || _threadPool->size() != numThreads){
+        _threadPool.reset(new ThreadPool(numThreads));
+    }
+
+    _fluidForceTime = 0.0;
+    _numFluidForceSteps = 0;
+
     double curTime = simItem->currentTime();
     _nextLogTime         = curTime;
 
@@ -308,6 +335,18 @@ void
 SimulationManager::clearLinkPolygon()
 {
     _linkPolygonMap.clear();
+    _linkSurfacePointMap.clear();
+}
+
+void
+SimulationManager::updateSurfacePoints()
+{
+    _linkSurfacePointMap.clear();
+
+    const int numIP = getDegreeNumber();
+    for(auto& linkPolygon : _linkPolygonMap){
+        _linkSurfacePointMap[linkPolygon.first].build(linkPolygon.second, numIP);
+    }
 }
 
 void
@@ -339,9 +378,18 @@ SimulationManager::finalizeSimulation(SimulatorItem* simItem, MulticopterSimulat
         return;
     }
 
+    if( _numFluidForceSteps > 0 ){
+        UtilityImpl::printMessage(
+            formatR(_("Fluid force computation time is {0:.3f} [s] ({1:.3f} [ms] per step)."),
+                    _fluidForceTime, _fluidForceTime * 1.0e3 / _numFluidForceSteps));
+    }
+
     clearBodyLinkMap();
     clearLinkPolygon();
     clearLinkState();
+
+    _effectMapAry.clear();
+    _linkTaskAry.clear();
 }
 
 void
@@ -516,11 +564,18 @@ SimulationManager::midDynamicFunction(SimulatorItem* simItem, MulticopterSimulat
         return;
     }
 
+    auto startTime = std::chrono::steady_clock::now();
+
     _rotorOutValAry.clear();
     _linkOutValAry.clear();
 
-    for(auto itb = begin(_bodyLinkMap) ; itb != end(_bodyLinkMap) ; ++itb){
-        std::map<int,std::tuple<double,Vector3>> effectMap;
+    _effectMapAry.clear();
+    _effectMapAry.resize(_bodyLinkMap.size());
+    _linkTaskAry.clear();
+
+    int bodyIndex = 0;
+    for(auto itb = begin(_bodyLinkMap) ; itb != end(_bodyLinkMap) ; ++itb, ++bodyIndex){
+        EffectMap& effectMap = _effectMapAry[bodyIndex];
         bool calFlag=false;
 
 
@@ -553,33 +608,92 @@ SimulationManager::midDynamicFunction(SimulatorItem* simItem, MulticopterSimulat
 
         for(auto itl = begin(linkAry) ; itl != end(linkAry) ; ++itl){
 
+            _linkTaskAry.emplace_back();
+            LinkTask& task = _linkTaskAry.back();
+            task.link = *itl;
+            task.linkState = nullptr;
+            task.effectMapIndex = bodyIndex;
+            task.calFlag = calFlag;
+
             try{
                 FFCalc::LinkStatePtr pLinkState;
                 pLinkState = _linkStateMap[*itl];
                 pLinkState->update (simItem->currentTime(), **itl);
-
-                std::unique_ptr<FFCalc::LinkForce> pLinkForce = midDynamicFunctionLink (
-                    simItem, multicopterSimItem, **itl, *pLinkState,effectMap,calFlag);
-
-                (*itl)->f_ext()   += pLinkForce->getForce();
-                (*itl)->tau_ext() += pLinkForce->getMoment();
-
+                task.linkState = pLinkState.get();
             }
             catch(runtime_error& err){
-                UtilityImpl::printErrorMessage(
-                    //formatC("{0:s} in {1:s} at {2:lf}",
-                    formatC("{0} in {1} at {2}",
-                            err.what(), (*itl)->name(), simItem->currentTime()));
-                continue;
+                task.errorMessage =
+                    formatC("{0} in {1} at {2}", err.what(), (*itl)->name(), simItem->currentTime());
             }
         }
     }
+
+    executeLinkTasks(simItem, multicopterSimItem);
+
+    // The results are applied in the order of the links to keep the simulation deterministic
+    for(auto& task : _linkTaskAry){
+        if(!task.errorMessage.empty()){
+            UtilityImpl::printErrorMessage(task.errorMessage);
+            continue;
+        }
+        task.link->f_ext()   += task.linkForce->getForce();
+        task.link->tau_ext() += task.linkForce->getMoment();
+
+        if(task.fluidOutValue){
+            _linkOutValAry.push_back(*task.fluidOutValue);
+        }
+    }
+
+    _fluidForceTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    ++_numFluidForceSteps;
+}
+
+
+void
+SimulationManager::executeLinkTasks(SimulatorItem* simItem, MulticopterSimulatorItem* multicopterSimItem)
+{
+    if(!_threadPool){
+        for(auto& task : _linkTaskAry){
+            executeLinkTask(simItem, multicopterSimItem, task);
+        }
+        return;
+    }
+
+    const int numTasks = _linkTaskAry.size();
+    const int numThreads = _threadPool->size();
+    for(int i=0 ; i < numThreads ; ++i){
+        _threadPool->start(
+            [this, simItem, multicopterSimItem, i, numTasks, numThreads](){
+                for(int j=i ; j < numTasks ; j += numThreads){
+                    executeLinkTask(simItem, multicopterSimItem, _linkTaskAry[j]);
+                }
+            });
+    }
+    _threadPool->wait();
+}
+
+
+void
+SimulationManager::executeLinkTask(SimulatorItem* simItem, MulticopterSimulatorItem* multicopterSimItem, LinkTask& task)
+{
+    if(!task.errorMessage.empty()){
+        return;
+    }
+    try{
+        task.linkForce = midDynamicFunctionLink (
+            simItem, multicopterSimItem, *task.link, *task.linkState,
+            _effectMapAry[task.effectMapIndex], task.calFlag, task.fluidOutValue);
+    }
+    catch(runtime_error& err){
+        task.errorMessage =
+            formatC("{0} in {1} at {2}", err.what(), task.link->name(), simItem->currentTime());
+    }
 }
 
 
 std::unique_ptr<FFCalc::LinkForce> SimulationManager::midDynamicFunctionLink (
     SimulatorItem* simItem, MulticopterSimulatorItem* multicopterSimItem, cnoid::Link& link, const FFCalc::LinkState& linkState,
-    std::map<int,std::tuple<double,Vector3>> effectMap,bool calFlag=false)
+    const EffectMap& effectMap, bool calFlag, std::unique_ptr<FluidOutValue>& fluOutVal)
 {
 
     const Eigen::Vector3d loadingPoint = Vector3 (0.0, 0.0, 0.0);
@@ -591,7 +705,7 @@ std::unique_ptr<FFCalc::LinkForce> SimulationManager::midDynamicFunctionLink (
 
     if(linkAttr.isNull()==false){
 
-        const std::vector<LinkTriangleAttribute>& triAttrAry = _linkPolygonMap[&link];
+        const std::vector<LinkTriangleAttribute>& triAttrAry = linkPolygon(&link);
         const std::vector<bool>linkForceApplyTarget = linkAttr.linkForceApplyFlgAry();
 
         FFCalc::FFCalculator ffc (_gravity, fluidEnv, _fluEnvAllSim,link, linkAttr, linkState, triAttrAry);
@@ -620,31 +734,29 @@ std::unique_ptr<FFCalc::LinkForce> SimulationManager::midDynamicFunctionLink (
         FFCalc::LinkForce lfGenSurface(pLinkForce->point());
 
         if(linkForceApplyTarget[3] == true){
-            ffc.calcSurfaceGeneral (&lfGenSurface, &lfGenSurface,getDegreeNumber());
+            FFCalc::SurfacePointArray& points = _linkSurfacePointMap.find(&link)->second;
+            points.update (linkState);
+            ffc.calcSurfaceGeneral (&lfGenSurface, &lfGenSurface, points);
             lfSurface.add(lfGenSurface);
         }
         pLinkForce->add(lfSurface);
 
 
-        FluidOutValue fluOutVal;
-        fluOutVal.logMode      = linkAttr.logMode();
-        fluOutVal.linkName     = link.name();
-        fluOutVal.bodyName     = link.body()->name();
-        fluOutVal.position     = link.R()*link.c()+link.p();
-        fluOutVal.velocity     = linkState.translationalVelocityAt(fluOutVal.position);
-        fluOutVal.accelerationRaw  = linkState.translationalRawAccelerationAt(fluOutVal.position);
-        fluOutVal.acceleration     = linkState.translationalAccelerationAt(fluOutVal.position);
-        fluOutVal.rotationalVelocity =linkState.rotationalVelocity();
-        fluOutVal.rotationalAccelerationRaw =linkState.rotationalRawAcceleration();
-        fluOutVal.rotationalAcceleration =linkState.rotationalAcceleration();
-        fluOutVal.buoyancyForce    = lfBuoyancy.getForce();
-        fluOutVal.addMassForce     = lfAddMass.getForce();
-        fluOutVal.addInertiaTorque = lfAddMoment.getMoment();
-        fluOutVal.surfaceForce     = lfSurface.getForce();
-
-        _linkOutValAry.push_back(fluOutVal);
-
-
+        fluOutVal.reset(new FluidOutValue);
+        fluOutVal->logMode      = linkAttr.logMode();
+        fluOutVal->linkName     = link.name();
+        fluOutVal->bodyName     = link.body()->name();
+        fluOutVal->position     = link.R()*link.c()+link.p();
+        fluOutVal->velocity     = linkState.translationalVelocityAt(fluOutVal->position);
+        fluOutVal->accelerationRaw  = linkState.translationalRawAccelerationAt(fluOutVal->position);
+        fluOutVal->acceleration     = linkState.translationalAccelerationAt(fluOutVal->position);
+        fluOutVal->rotationalVelocity =linkState.rotationalVelocity();
+        fluOutVal->rotationalAccelerationRaw =linkState.rotationalRawAcceleration();
+        fluOutVal->rotationalAcceleration =linkState.rotationalAcceleration();
+        fluOutVal->buoyancyForce    = lfBuoyancy.getForce();
+        fluOutVal->addMassForce     = lfAddMass.getForce();
+        fluOutVal->addInertiaTorque = lfAddMoment.getMoment();
+        fluOutVal->surfaceForce     = lfSurface.getForce();
 
     #ifdef ENABLE_MULTICOPTER_PLUGIN_DEBUG
             if( _enableLinkForceDump == true ){
@@ -693,7 +805,7 @@ std::unique_ptr<FFCalc::LinkForce> SimulationManager::midDynamicFunctionLink (
                 for(auto effect:effectMap){
                     if(_groundEffectSim==true){
                         if(std::get<0>(effect.second) < rotor->wallEffectDistance()){
-                            FFCalc::CutoffCoefImpl* func= FFCalc::CutoffCoefImpl::createInstance(rotor->wallEffectDistance(),rotor->wallEffectNormMiddleValue());
+                            std::unique_ptr<FFCalc::CutoffCoefImpl> func(FFCalc::CutoffCoefImpl::createInstance(rotor->wallEffectDistance(),rotor->wallEffectNormMiddleValue()));
                             double rate=func->eval(rotor->wallEffectDistance() - std::get<0>(effect.second)) * rotor->wallEffectMaxRate();
                             double cosine;
                             double directionChange=1;
@@ -714,7 +826,7 @@ std::unique_ptr<FFCalc::LinkForce> SimulationManager::midDynamicFunctionLink (
                     }
                     if(_wallEffectSim==true){
                         if(std::get<0>(effect.second) < rotor->groundEffectDistance()){
-                            FFCalc::CutoffCoefImpl* func= FFCalc::CutoffCoefImpl::createInstance(rotor->groundEffectDistance(),rotor->groundEffectNormMiddleValue());
+                            std::unique_ptr<FFCalc::CutoffCoefImpl> func(FFCalc::CutoffCoefImpl::createInstance(rotor->groundEffectDistance(),rotor->groundEffectNormMiddleValue()));
                             double rate=func->eval(rotor->groundEffectDistance() - std::get<0>(effect.second) )* rotor->groundEffectMaxRate();
                             double sine;
                             double directionChange=1;
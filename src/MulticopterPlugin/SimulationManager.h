@@ -96,6 +96,19 @@ protected:
         Eigen::Vector3d rotationalAcceleration;
     };
 
+    typedef std::map<int,std::tuple<double,cnoid::Vector3>> EffectMap;
+
+    class LinkTask{
+    public:
+        cnoid::Link* link;
+        const FFCalc::LinkState* linkState;
+        int effectMapIndex;
+        bool calFlag;
+        std::unique_ptr<FFCalc::LinkForce> linkForce;
+        std::unique_ptr<FluidOutValue> fluidOutValue;
+        std::string errorMessage;
+    };
+
     SimulationManager();
 
     ~SimulationManager();
@@ -136,8 +149,14 @@ protected:
 
     void calcCuttoffCoef (const FFCalc::CutoffCoef& cutoffCalc, const FFCalc::GaussTriangle3d& tri, const std::vector<FFCalc::GaussTriangle3d>& trgTriAry,double coefs[]);
 
+    void updateSurfacePoints();
+
+    void executeLinkTasks(cnoid::SimulatorItem* simItem, cnoid::MulticopterSimulatorItem* fluidSimItem);
+
+    void executeLinkTask(cnoid::SimulatorItem* simItem, cnoid::MulticopterSimulatorItem* fluidSimItem, LinkTask& task);
+
     std::unique_ptr<FFCalc::LinkForce>
-    midDynamicFunctionLink(cnoid::SimulatorItem* simItem, cnoid::MulticopterSimulatorItem* fluidSimItem, cnoid::Link& link, const FFCalc::LinkState& linkState,std::map<int,std::tuple<double,cnoid::Vector3>> effectMap,bool calFlag);
+    midDynamicFunctionLink(cnoid::SimulatorItem* simItem, cnoid::MulticopterSimulatorItem* fluidSimItem, cnoid::Link& link, const FFCalc::LinkState& linkState, const EffectMap& effectMap, bool calFlag, std::unique_ptr<FluidOutValue>& fluOutVal);
 
     std::list<RotorDevice*> targetRotorDevices() const;
     std::list<RotorDevice*> targetRotorDevices(cnoid::Link* link) const;
@@ -157,6 +176,14 @@ private:
     std::map<cnoid::Link*, std::tuple<cnoid::Body*, LinkAttribute> > _effectLinkBodyMap;
     std::map<cnoid::Link*, std::vector<LinkTriangleAttribute>>_linkPolygonMap;
     std::map<const cnoid::Link*, FFCalc::LinkStatePtr> _linkStateMap;
+    std::map<const cnoid::Link*, FFCalc::SurfacePointArray> _linkSurfacePointMap;
+
+    std::vector<EffectMap> _effectMapAry;
+    std::vector<LinkTask> _linkTaskAry;
+    std::unique_ptr<cnoid::ThreadPool> _threadPool;
+
+    double _fluidForceTime;
+    int _numFluidForceSteps;
 
     std::list<RotorOutValue> _rotorOutValAry;
     std::list<FluidOutValue> _linkOutValAry;
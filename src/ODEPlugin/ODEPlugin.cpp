@@ -9,9 +9,11 @@
 #include <gazebo/ode/ode.h>
 #define ODESimulatorItem GazeboODESimulatorItem
 #define PLUGIN_NAME "GAZEBO_ODE"
+#define SIMULATOR_NAME "GazeboODESimulator"
 #else
 #include <ode/ode.h>
 #define PLUGIN_NAME "ODE"
+#define SIMULATOR_NAME "ODESimulator"
 #endif
 
 using namespace std;
@@ -25,6 +27,10 @@ public:
     ODEPlugin() : Plugin(PLUGIN_NAME)
     { 
         require("Body");
+
+        // The plugin is activated when the simulator item is used for the first time
+        declareItemClass(SIMULATOR_NAME "Item");
+        declareMenuItem("/File/New .../" SIMULATOR_NAME);
     }
         
     virtual ~ODEPlugin()
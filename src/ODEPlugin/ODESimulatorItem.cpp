@@ -13,6 +13,8 @@
 #include <cnoid/BasicSensorSimulationHelper>
 #include <cnoid/BodyItem>
 #include <cnoid/BodyCollisionDetector>
+#include <cnoid/MessageView>
+#include <cnoid/ThreadPool>
 #include <QElapsedTimer>
 #include "gettext.h"
 
@@ -23,6 +25,7 @@
 #include <ode/ode.h>
 #define ITEM_NAME N_("ODESimulatorItem")
 #endif
+#include <memory>
 #include <iostream>
 
 using namespace std;
@@ -37,6 +40,11 @@ const bool MEASURE_PHYSICS_CALCULATION_TIME = true;
 
 const double DEFAULT_GRAVITY_ACCELERATION = 9.80665;
 
+const int MaxNumContacts = 100;
+
+//! The contacts are generated by the threads when the number of the top-level space pairs is this value or more
+constexpr int MinNumContactShardsForParallelGeneration = 4;
+
 typedef Eigen::Matrix<float, 3, 1> Vertex;
 
 struct Triangle {
@@ -157,6 +165,24 @@ public:
     bool useWorldCollisionDetector;
     BodyCollisionDetector bodyCollisionDetector;
 
+    int numThreads;
+#ifndef GAZEBO_ODE
+    dThreadingImplementationID threadingImpl;
+    dThreadingThreadPoolID threadingThreadPool;
+#endif
+
+    // The geometry pairs and the contacts of a top-level space pair
+    struct ContactShard {
+        vector<pair<dGeomID, dGeomID>> geomPairs;
+        vector<int> numContacts;
+        vector<dContact> contacts;
+    };
+    vector<ContactShard> contactShards;
+    int numContactShards;
+    bool isContactGenerationParallel;
+    unique_ptr<ThreadPool> contactThreadPool;
+    vector<char> contactTaskFailures;
+
     double physicsTime;
     QElapsedTimer physicsTimer;
     double collisionTime;
@@ -169,7 +195,13 @@ public:
     void clear();
     bool initializeSimulation(const std::vector<SimulationBody*>& simBodies);
     void addBody(ODEBody* odeBody);
+    void initializeThreading();
+    void clearThreading();
     bool stepSimulation(const std::vector<SimulationBody*>& activeSimBodies);
+    void addContactJoints(dGeomID g1, dGeomID g2, dContact* contacts, int numContacts);
+    ContactShard& newContactShard();
+    void generateContacts(ContactShard& shard);
+    void generateContactsInParallel();
     void doPutProperties(PutPropertyFunction& putProperty);
     void store(Archive& archive);
     void restore(const Archive& archive);
@@ -912,6 +944,7 @@ ODESimulatorItemImpl::ODESimulatorItemImpl(ODESimulatorItem* self)
     is2Dmode = false;
     doFlipYZ = false;
     useWorldCollisionDetector = false;
+    numThreads = 1;
 }
 
 
@@ -941,6 +974,7 @@ ODESimulatorItemImpl::ODESimulatorItemImpl(ODESimulatorItem* self, const ODESimu
     is2Dmode = org.is2Dmode;
     doFlipYZ = org.doFlipYZ;
     useWorldCollisionDetector = org.useWorldCollisionDetector;
+    numThreads = org.numThreads;
 }
 
 
@@ -948,6 +982,12 @@ void ODESimulatorItemImpl::initialize()
 {
     worldID = 0;
     spaceID = 0;
+#ifndef GAZEBO_ODE
+    threadingImpl = 0;
+    threadingThreadPool = 0;
+#endif
+    numContactShards = 0;
+    isContactGenerationParallel = false;
     contactJointGroupID = dJointGroupCreate(0);
     self->SimulatorItem::setAllLinkPositionOutputMode(true);
 }
@@ -1047,6 +1087,12 @@ void ODESimulatorItem::useWorldCollisionDetector(bool on)
 }
 
 
+void ODESimulatorItem::setNumThreads(int n)
+{
+    impl->numThreads = std::max(1, n);
+}
+
+
 void ODESimulatorItem::setAllLinkPositionOutputMode(bool)
 {
     // The mode is not changed.
@@ -1065,6 +1111,8 @@ void ODESimulatorItemImpl::clear()
 {
     dJointGroupEmpty(contactJointGroupID);
 
+    clearThreading();
+
     if(worldID){
         dWorldDestroy(worldID);
         worldID = 0;
@@ -1128,6 +1176,8 @@ bool ODESimulatorItemImpl::initializeSimulation(const std::vector<SimulationBody
 
     timeStep = self->worldTimeStep();
 
+    initializeThreading();
+
     for(size_t i=0; i < simBodies.size(); ++i){
         addBody(static_cast<ODEBody*>(simBodies[i]));
     }
@@ -1170,6 +1220,63 @@ void ODESimulatorItemImpl::addBody(ODEBody* odeBody)
 }
 
 
+void ODESimulatorItemImpl::initializeThreading()
+{
+    if(contactThreadPool && contactThreadPool->size() != numThreads){
+        contactThreadPool.reset();
+    }
+
+    isContactGenerationParallel = false;
+    if(numThreads > 1){
+        // The collision data of ODE must be allocated for each thread generating the contacts
+        if(dAllocateODEDataForThread(dAllocateMaskAll)){
+            isContactGenerationParallel = true;
+        } else {
+            MessageView::instance()->putln(
+                _("The contacts are generated by a single thread because the collision data of ODE "
+                  "cannot be allocated for the threads."),
+                MessageView::Warning);
+        }
+    }
+
+#ifndef GAZEBO_ODE
+    if(numThreads > 1){
+        // The islands of the world are stepped by the threads of the pool
+        threadingImpl = dThreadingAllocateMultiThreadedImplementation();
+        if(!threadingImpl){
+            MessageView::instance()->putln(
+                _("The world is stepped by a single thread because ODE does not support the threading."),
+                MessageView::Warning);
+        } else {
+            threadingThreadPool = dThreadingAllocateThreadPool(numThreads, 0, dAllocateFlagBasicData, nullptr);
+            dThreadingThreadPoolServeMultiThreadedImplementation(threadingThreadPool, threadingImpl);
+            dWorldSetStepThreadingImplementation(
+                worldID, dThreadingImplementationGetFunctions(threadingImpl), threadingImpl);
+            dWorldSetStepIslandsProcessingMaxThreadCount(worldID, numThreads);
+        }
+    }
+#endif
+}
+
+
+void ODESimulatorItemImpl::clearThreading()
+{
+#ifndef GAZEBO_ODE
+    if(threadingImpl){
+        if(worldID){
+            dWorldSetStepThreadingImplementation(worldID, nullptr, nullptr);
+        }
+        dThreadingImplementationShutdownProcessing(threadingImpl);
+        dThreadingThreadPoolWaitIdleState(threadingThreadPool);
+        dThreadingFreeThreadPool(threadingThreadPool);
+        dThreadingFreeImplementation(threadingImpl);
+        threadingThreadPool = 0;
+        threadingImpl = 0;
+    }
+#endif
+}
+
+
 void ODESimulatorItem::initializeSimulationThread()
 {
     dAllocateODEDataForThread(dAllocateMaskAll);
@@ -1190,65 +1297,87 @@ static void nearCallback(void* data, dGeomID g1, dGeomID g2)
         }
     } else {
         ODESimulatorItemImpl* impl = (ODESimulatorItemImpl*)data;
-        static const int MaxNumContacts = 100;
         dContact contacts[MaxNumContacts];
         int numContacts = dCollide(g1, g2, MaxNumContacts, &contacts[0].geom, sizeof(dContact));
-        
         if(numContacts > 0){
-            dBodyID body1ID = dGeomGetBody(g1);
-            dBodyID body2ID = dGeomGetBody(g2);
-            Link* crawlerlink = 0;
-            double sign = 1.0;
-            if(!impl->crawlerLinks.empty()){
-                CrawlerLinkMap::iterator p = impl->crawlerLinks.find(body1ID);
-                if(p != impl->crawlerLinks.end()){
-                    crawlerlink = p->second;
-                }
-                p = impl->crawlerLinks.find(body2ID);
-                if(p != impl->crawlerLinks.end()){
-                    crawlerlink = p->second;
-                    sign = -1.0;
-                }
-            }
-            for(int i=0; i < numContacts; ++i){
-                dSurfaceParameters& surface = contacts[i].surface;
-                if(!crawlerlink){
-                    //surface.mode = dContactApprox1 | dContactBounce;
-                    //surface.bounce = 0.0;
-                    //surface.bounce_vel = 1.0;
-                    surface.mode = dContactApprox1;
-                    surface.mu = impl->friction;
+            impl->addContactJoints(g1, g2, contacts, numContacts);
+        }
+    }
+}
 
-                } else {
-                    if(contacts[i].geom.depth > 0.001){
-                        continue;
-                    }
-                    surface.mode = dContactFDir1 | dContactMotion1 | dContactMu2 | dContactApprox1_2 | dContactApprox1_1;
-                    const Vector3 axis = crawlerlink->R() * crawlerlink->a();
-                    const Vector3 n(contacts[i].geom.normal);
-                    Vector3 dir = axis.cross(n);
-                    if(dir.norm() < 1.0e-5){
-                        surface.mode = dContactApprox1;
-                        surface.mu = impl->friction;
-                    } else {
-                        dir *= sign;
-                        dir.normalize();
-                        contacts[i].fdir1[0] = dir[0];
-                        contacts[i].fdir1[1] = dir[1];
-                        contacts[i].fdir1[2] = dir[2];
-                        //dVector3& dpos = contacts[i].geom.pos;
-                        //Vector3 pos(dpos[0], dpos[1], dpos[2]);
-                        //Vector3 v = crawlerlink->v + crawlerlink->w.cross(pos-crawlerlink->p);
-                        //surface.motion1 = dir.dot(v) + crawlerlink->u;
-                        surface.motion1 = crawlerlink->dq_target();
-                        surface.mu = impl->friction;
-                        surface.mu2 = 0.5;
-                    }
-                }
-                dJointID jointID = dJointCreateContact(impl->worldID, impl->contactJointGroupID, &contacts[i]);
-                dJointAttach(jointID, body1ID, body2ID);
+
+static void collectGeomPairs(void* data, dGeomID g1, dGeomID g2)
+{
+    auto shard = static_cast<ODESimulatorItemImpl::ContactShard*>(data);
+    if(dGeomIsSpace(g1) || dGeomIsSpace(g2)){
+        dSpaceCollide2(g1, g2, data, &collectGeomPairs);
+    } else {
+        shard->geomPairs.emplace_back(g1, g2);
+    }
+}
+
+
+static void collectContactShards(void* data, dGeomID g1, dGeomID g2)
+{
+    ODESimulatorItemImpl* impl = (ODESimulatorItemImpl*)data;
+    collectGeomPairs(&impl->newContactShard(), g1, g2);
+}
+
+
+void ODESimulatorItemImpl::addContactJoints(dGeomID g1, dGeomID g2, dContact* contacts, int numContacts)
+{
+    dBodyID body1ID = dGeomGetBody(g1);
+    dBodyID body2ID = dGeomGetBody(g2);
+    Link* crawlerlink = 0;
+    double sign = 1.0;
+    if(!crawlerLinks.empty()){
+        CrawlerLinkMap::iterator p = crawlerLinks.find(body1ID);
+        if(p != crawlerLinks.end()){
+            crawlerlink = p->second;
+        }
+        p = crawlerLinks.find(body2ID);
+        if(p != crawlerLinks.end()){
+            crawlerlink = p->second;
+            sign = -1.0;
+        }
+    }
+    for(int i=0; i < numContacts; ++i){
+        dSurfaceParameters& surface = contacts[i].surface;
+        if(!crawlerlink){
+            //surface.mode = dContactApprox1 | dContactBounce;
+            //surface.bounce = 0.0;
+            //surface.bounce_vel = 1.0;
+            surface.mode = dContactApprox1;
+            surface.mu = friction;
+
+        } else {
+            if(contacts[i].geom.depth > 0.001){
+                continue;
+            }
+            surface.mode = dContactFDir1 | dContactMotion1 | dContactMu2 | dContactApprox1_2 | dContactApprox1_1;
+            const Vector3 axis = crawlerlink->R() * crawlerlink->a();
+            const Vector3 n(contacts[i].geom.normal);
+            Vector3 dir = axis.cross(n);
+            if(dir.norm() < 1.0e-5){
+                surface.mode = dContactApprox1;
+                surface.mu = friction;
+            } else {
+                dir *= sign;
+                dir.normalize();
+                contacts[i].fdir1[0] = dir[0];
+                contacts[i].fdir1[1] = dir[1];
+                contacts[i].fdir1[2] = dir[2];
+                //dVector3& dpos = contacts[i].geom.pos;
+                //Vector3 pos(dpos[0], dpos[1], dpos[2]);
+                //Vector3 v = crawlerlink->v + crawlerlink->w.cross(pos-crawlerlink->p);
+                //surface.motion1 = dir.dot(v) + crawlerlink->u;
+                surface.motion1 = crawlerlink->dq_target();
+                surface.mu = friction;
+                surface.mu2 = 0.5;
             }
         }
+        dJointID jointID = dJointCreateContact(worldID, contactJointGroupID, &contacts[i]);
+        dJointAttach(jointID, body1ID, body2ID);
     }
 }
 
@@ -1287,7 +1416,11 @@ bool ODESimulatorItemImpl::stepSimulation(const std::vector<SimulationBody*>& ac
         if(MEASURE_PHYSICS_CALCULATION_TIME){
             collisionTimer.start();
         }
-        dSpaceCollide(spaceID, (void*)this, &nearCallback);
+        if(isContactGenerationParallel){
+            generateContactsInParallel();
+        } else {
+            dSpaceCollide(spaceID, (void*)this, &nearCallback);
+        }
         if(MEASURE_PHYSICS_CALCULATION_TIME){
             collisionTime += collisionTimer.nsecsElapsed();
         }
@@ -1326,6 +1459,97 @@ bool ODESimulatorItemImpl::stepSimulation(const std::vector<SimulationBody*>& ac
 }
 
 
+ODESimulatorItemImpl::ContactShard& ODESimulatorItemImpl::newContactShard()
+{
+    if(numContactShards == static_cast<int>(contactShards.size())){
+        contactShards.emplace_back();
+    }
+    auto& shard = contactShards[numContactShards++];
+    shard.geomPairs.clear();
+    return shard;
+}
+
+
+void ODESimulatorItemImpl::generateContacts(ContactShard& shard)
+{
+    const int numGeomPairs = shard.geomPairs.size();
+    shard.numContacts.resize(numGeomPairs);
+    shard.contacts.clear();
+    dContact contacts[MaxNumContacts];
+    for(int i=0; i < numGeomPairs; ++i){
+        auto& geoms = shard.geomPairs[i];
+        int numContacts = dCollide(geoms.first, geoms.second, MaxNumContacts, &contacts[0].geom, sizeof(dContact));
+        shard.numContacts[i] = numContacts;
+        shard.contacts.insert(shard.contacts.end(), contacts, contacts + numContacts);
+    }
+}
+
+
+/**
+   The candidate geometry pairs are collected by the broad phase of this thread for each
+   top-level space pair because the spaces cannot be traversed by multiple threads.
+   The narrow phase of the space pairs is done by the threads, and the contact joints are
+   created in the order of the space pairs so that the result does not depend on the threads.
+*/
+void ODESimulatorItemImpl::generateContactsInParallel()
+{
+    numContactShards = 0;
+    dSpaceCollide(spaceID, (void*)this, &collectContactShards);
+
+    if(numContactShards < MinNumContactShardsForParallelGeneration){
+        for(int i=0; i < numContactShards; ++i){
+            generateContacts(contactShards[i]);
+        }
+    } else {
+        if(!contactThreadPool){
+            contactThreadPool.reset(new ThreadPool(numThreads));
+        }
+        const int numTasks = std::min(numThreads, numContactShards);
+        contactTaskFailures.assign(numTasks, 0);
+        for(int i=0; i < numTasks; ++i){
+            contactThreadPool->start(
+                [this, i, numTasks](){
+                    // The collision data of ODE is allocated once for each thread of the pool
+                    thread_local bool isODEDataAllocated = false;
+                    if(!isODEDataAllocated){
+                        isODEDataAllocated = dAllocateODEDataForThread(dAllocateMaskAll);
+                        if(!isODEDataAllocated){
+                            contactTaskFailures[i] = 1;
+                            return;
+                        }
+                    }
+                    for(int j = i; j < numContactShards; j += numTasks){
+                        generateContacts(contactShards[j]);
+                    }
+                });
+        }
+        contactThreadPool->wait();
+
+        // The shards of the failed tasks are processed by this thread
+        for(int i=0; i < numTasks; ++i){
+            if(contactTaskFailures[i]){
+                for(int j = i; j < numContactShards; j += numTasks){
+                    generateContacts(contactShards[j]);
+                }
+            }
+        }
+    }
+
+    for(int i=0; i < numContactShards; ++i){
+        auto& shard = contactShards[i];
+        dContact* contacts = shard.contacts.data();
+        for(size_t j=0; j < shard.geomPairs.size(); ++j){
+            int numContacts = shard.numContacts[j];
+            if(numContacts > 0){
+                auto& geoms = shard.geomPairs[j];
+                addContactJoints(geoms.first, geoms.second, contacts, numContacts);
+                contacts += numContacts;
+            }
+        }
+    }
+}
+
+
 void ODESimulatorItemImpl::onCollisionPairDetected(const CollisionPair& collisionPair)
 {
     ODELink* link1 = static_cast<ODELink*>(collisionPair.object(0));
@@ -1434,6 +1658,8 @@ void ODESimulatorItemImpl::doPutProperties(PutPropertyFunction& putProperty)
     putProperty(_("2D mode"), is2Dmode, changeProperty(is2Dmode));
 
     putProperty(_("Use WorldItem's Collision Detector"), useWorldCollisionDetector, changeProperty(useWorldCollisionDetector));
+
+    putProperty.min(1)(_("Number of threads"), numThreads, changeProperty(numThreads));
 }
 
 
@@ -1459,6 +1685,7 @@ void ODESimulatorItemImpl::store(Archive& archive)
     archive.write("maxCorrectingVel", maxCorrectingVel);
     archive.write("2Dmode", is2Dmode);
     archive.write("useWorldCollisionDetector", useWorldCollisionDetector);
+    archive.write("numThreads", numThreads);
 }
 
 
@@ -1489,4 +1716,5 @@ void ODESimulatorItemImpl::restore(const Archive& archive)
     if(!archive.read("useWorldCollisionDetector", useWorldCollisionDetector)){
         archive.read("UseWorldItem'sCollisionDetector", useWorldCollisionDetector);
     }
+    archive.read("numThreads", numThreads);
 }
@@ -37,6 +37,13 @@ public:
     void setSurfaceLayerDepth(double value);
     void useWorldCollisionDetector(bool on);
 
+    /**
+       The islands of the world are stepped and the contacts are generated by the given number
+       of threads when it is more than one. ODE must be built with the threading support to
+       step the world by the threads.
+    */
+    void setNumThreads(int n);
+
     virtual void setAllLinkPositionOutputMode(bool on) override;
     virtual Vector3 getGravity() const override;
 
@@ -17,6 +17,10 @@ public:
     PhysXPlugin() : Plugin("PhysX")
         { 
             require("Body");
+
+            // The plugin is activated when the simulator item is used for the first time
+            declareItemClass("PhysXSimulatorItem");
+            declareMenuItem("/File/New .../PhysXSimulator");
         }
         
     virtual ~PhysXPlugin()
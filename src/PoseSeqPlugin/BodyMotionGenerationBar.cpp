@@ -26,6 +26,7 @@
 #include <cnoid/Format>
 #include <QDialogButtonBox>
 #include <set>
+#include <thread>
 #include "gettext.h"
 
 using namespace std;
@@ -98,6 +99,7 @@ public:
     TimeBar* timeBar;
     BodyMotionGenerationSetupDialog* setup;
     LazySignal< Signal<void()> >sigInterpolationParametersChanged;
+    Signal<void()> sigMotionFiltersChanged;
     Action* autoGenerationForNewBodyCheck;
     QIcon balancerIcon;
     ToolButton* balancerToggle;
@@ -122,9 +124,11 @@ public:
     void updateBalancerToggles();
     void onGenerationButtonClicked();
     bool shapeBodyMotion(
-        BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* motionItem, bool putMessages);
+        BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* motionItem, bool putMessages,
+        bool isPartialUpdate = false, double updateLowerTime = 0.0, double updateUpperTime = 0.0);
     bool shapeBodyMotionWithSimpleInterpolation(
-        BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem);
+        BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem,
+        bool isPartialUpdate, double updateLowerTime, double updateUpperTime);
     bool storeState(Archive& archive);
     bool restoreState(const Archive& archive);
 };
@@ -189,6 +193,7 @@ BodyMotionGenerationBar::Impl::Impl(BodyMotionGenerationBar* self)
     balancerToggle->setToolTip(_("Enable the balancer"));
     balancerToggle->setEnabled(false);
     balancerToggle->setChecked(false);
+    balancerToggle->sigToggled().connect([this](bool){ sigMotionFiltersChanged(); });
 
     secondBalancerToggle = nullptr;
 
@@ -235,6 +240,7 @@ void BodyMotionGenerationBar::Impl::updateBalancerToggles()
             secondBalancerToggle = self->addToggleButton(balancerIcon);
             secondBalancerToggle->setToolTip(_("Enable the second balancer"));
             secondBalancerToggle->setChecked(balancerToggle->isChecked());
+            secondBalancerToggle->sigToggled().connect([this](bool){ sigMotionFiltersChanged(); });
         }
         if(on){
             secondBalancerToggle->setEnabled(on);
@@ -250,6 +256,7 @@ void BodyMotionGenerationBar::addMotionFilter
     setInsertionPosition(3);
     auto button = addToggleButton(buttonIcon);
     button->setToolTip(toolTip);
+    button->sigToggled().connect([this](bool){ impl->sigMotionFiltersChanged(); });
     impl->extraMotionFilters.emplace_back(key, button, filter);
     impl->updateBalancerToggles();
 }
@@ -261,6 +268,12 @@ SignalProxy<void()> BodyMotionGenerationBar::sigInterpolationParametersChanged()
 }
 
 
+SignalProxy<void()> BodyMotionGenerationBar::sigMotionFiltersChanged()
+{
+    return impl->sigMotionFiltersChanged;
+}
+
+
 void BodyMotionGenerationBar::Impl::onGenerationButtonClicked()
 {
     set<BodyMotionItem*> motionItems; // for avoiding overlap
@@ -319,11 +332,26 @@ bool BodyMotionGenerationBar::shapeBodyMotion
 }
 
 
+bool BodyMotionGenerationBar::shapeBodyMotionPartially
+(BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem,
+ double updateLowerTime, double updateUpperTime, bool putMessages)
+{
+    return impl->shapeBodyMotion(
+        bodyItem, provider, outputMotionItem, putMessages, true, updateLowerTime, updateUpperTime);
+}
+
+
 bool BodyMotionGenerationBar::Impl::shapeBodyMotion
-(BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* motionItem, bool putMessages)
+(BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* motionItem, bool putMessages,
+ bool isPartialUpdate, double updateLowerTime, double updateUpperTime)
 {
     bool isProcessed = false;
     bool failed = false;
+
+    if(isPartialUpdate && self->isMotionFilterEnabled()){
+        // The balancer and the extra filters process the whole motion
+        isPartialUpdate = false;
+    }
     
     if(provider){
         if(balancerToggle->isChecked() && balancer){
@@ -333,7 +361,8 @@ bool BodyMotionGenerationBar::Impl::shapeBodyMotion
                 failed = true;
             }
         } else {
-            if(shapeBodyMotionWithSimpleInterpolation(bodyItem, provider, motionItem)){
+            if(shapeBodyMotionWithSimpleInterpolation(
+                   bodyItem, provider, motionItem, isPartialUpdate, updateLowerTime, updateUpperTime)){
                 isProcessed = true;
             } else {
                 failed = true;
@@ -379,10 +408,17 @@ bool BodyMotionGenerationBar::Impl::shapeBodyMotion
         
 
 bool BodyMotionGenerationBar::Impl::shapeBodyMotionWithSimpleInterpolation
-(BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem)
+(BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem,
+ bool isPartialUpdate, double updateLowerTime, double updateUpperTime)
 {
     if(!poseProviderToBodyMotionConverter){
         poseProviderToBodyMotionConverter = make_unique<PoseProviderToBodyMotionConverter>();
+        poseProviderToBodyMotionConverter->setNumThreads(std::thread::hardware_concurrency());
+    }
+    if(isPartialUpdate){
+        poseProviderToBodyMotionConverter->setUpdateTimeRange(updateLowerTime, updateUpperTime);
+    } else {
+        poseProviderToBodyMotionConverter->clearUpdateTimeRange();
     }
     if(setup->onlyTimeBarRangeCheck.isChecked()){
         poseProviderToBodyMotionConverter->setTimeRange(timeBar->minTime(), timeBar->maxTime());
@@ -466,6 +502,19 @@ bool BodyMotionGenerationBar::isBalancerEnabled() const
     return impl->balancerToggle->isChecked();
 }
             
+bool BodyMotionGenerationBar::isMotionFilterEnabled() const
+{
+    if(impl->balancerToggle->isChecked() && impl->balancer){
+        return true;
+    }
+    for(auto& filter : impl->extraMotionFilters){
+        if(filter.toggleButton->isChecked()){
+            return true;
+        }
+    }
+    return false;
+}
+
 bool BodyMotionGenerationBar::isAutoGenerationMode() const
 {
     return impl->autoGenerationToggle->isChecked();
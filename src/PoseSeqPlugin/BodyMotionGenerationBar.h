@@ -26,6 +26,15 @@ public:
     bool shapeBodyMotion(
         BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem, bool putMessages = false);
 
+    /**
+       This function only regenerates the frames in the given time range when the motion is generated
+       by the simple interpolation and the output motion item has the frames of the whole time range.
+       Otherwise the whole motion is generated as the shapeBodyMotion function.
+    */
+    bool shapeBodyMotionPartially(
+        BodyItem* bodyItem, PoseProvider* provider, BodyMotionItem* outputMotionItem,
+        double updateLowerTime, double updateUpperTime, bool putMessages = false);
+
     class Balancer
     {
     public:
@@ -46,7 +55,13 @@ public:
 
     SignalProxy<void()> sigInterpolationParametersChanged();
 
+    //! This signal is emitted when the balancer or a motion filter is turned on or off.
+    SignalProxy<void()> sigMotionFiltersChanged();
+
     bool isBalancerEnabled() const;
+
+    //! \return true if the balancer or a motion filter is applied to the whole generated motion
+    bool isMotionFilterEnabled() const;
     bool isAutoGenerationMode() const;
     bool isAutoGenerationForNewBodyEnabled() const;
             
@@ -17,6 +17,7 @@
 #include <vector>
 #include <algorithm>
 #include <unordered_map>
+#include <limits>
 
 using namespace std;
 using namespace cnoid;
@@ -135,6 +136,30 @@ struct JointSample
     typedef std::list<JointSample> Seq;
 };
 
+/**
+   Polynomial coefficients of the trajectory segments of a dimension stored in the contiguous arrays.
+   Each segment is expressed as c0 + c1 h + ... + c5 h^5 where h is the elapsed time from the
+   beginning of the segment so that a time grid can be evaluated with a simple loop.
+*/
+struct CoeffTable
+{
+    vector<double> x; // segment boundaries (the number of segments + 1)
+    vector<double> c[6];
+    vector<char> isValid;
+    double yFirst;
+    double yLast;
+
+    void clear()
+    {
+        x.clear();
+        for(int i=0; i < 6; ++i){
+            c[i].clear();
+        }
+        isValid.clear();
+    }
+    int numSegments() const { return x.empty() ? 0 : x.size() - 1; }
+};
+
 struct JointInfo
 {
     JointInfo()
@@ -160,6 +185,8 @@ struct JointInfo
 
     // interpolated state
     stdx::optional<double> q;
+
+    CoeffTable coeffTable;
 };
 
 struct ZmpSample
@@ -282,6 +309,7 @@ public:
             
     ZmpSample::Seq zmpSamples;
     ZmpSample::Seq::iterator zmpIter;
+    CoeffTable zmpCoeffTables[3];
 
     struct ZmpSampleIterPair {
         ZmpSampleIterPair(PoseSeq::iterator poseIter, ZmpSample::Seq::iterator sampleIter)
@@ -329,6 +357,8 @@ public:
 
     double currentTime;
     double timeScaleRatio;
+    bool areCoeffTablesValid;
+    vector<double> frameTimes;
     LinkInfoMap::iterator currentBaseLinkInfoIter;
     vector<bool> validIkLinkFlag;
     Vector3 waistTranslation;
@@ -373,6 +403,8 @@ public:
     void insertAuxKeyPosesForStealthySteps();
     void insertAuxKeyPosesForToeSteps();
     bool update();
+    void updateCoeffTables();
+    bool getFrames(int beginningFrame, int numFrames, double frameRate, FrameSeq& out_frames);
     LinkInfo* getIkLinkInfo(int linkIndex);
     void onPoseInserted(PoseSeq::iterator it);
     void onPoseAboutToBeRemoved(PoseSeq::iterator it, bool isMoving);
@@ -740,6 +772,147 @@ bool interpolate(
 }
 
 
+template <class SampleType>
+void setSegmentCoeffs(const SampleType& s0, const SampleType& s1, int dimIndex, CoeffTable& table)
+{
+    double c[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    bool isValid = true;
+
+    const Coeff& c0 = s0.c[dimIndex];
+    const Coeff& c1 = s1.c[dimIndex];
+    const double y0 = c0.y;
+    const double y1 = c1.y;
+    const double h = s1.x - s0.x;
+
+    if(s0.isDirty){
+        isValid = false;
+
+    } else {
+        switch(s0.segmentType){
+
+        case UNDETERMINED:
+        case INVALID:
+            isValid = false;
+            break;
+
+        case CUBIC_SPLINE:
+        {
+            // Expansion of the form used in the interpolate function into the polynomial
+            const double a0 = c0.a;
+            const double a_end = (s1.isEndPoint ? c1.a_end : c1.a);
+            c[0] = y0;
+            c[1] = (y1 - y0) / h - h * (2.0 * a0 + a_end) / 6.0;
+            c[2] = a0 / 2.0;
+            c[3] = (a_end - a0) / (6.0 * h);
+            break;
+        }
+        case CUBIC_CONNECTION:
+            c[0] = y0;
+            c[1] = c0.a;
+            c[2] = c0.b;
+            c[3] = c0.c;
+            break;
+
+        case MIN_JERK_CONNECTION:
+        {
+            const double d = y1 - y0;
+            const double h3 = h * h * h;
+            c[0] = y0;
+            c[3] = 10.0 * d / h3;
+            c[4] = -15.0 * d / (h3 * h);
+            c[5] = 6.0 * d / (h3 * h * h);
+            break;
+        }
+        case LINEAR:
+            c[0] = y0;
+            c[1] = (y1 - y0) / h;
+            break;
+
+        case ZERO_LENGTH:
+            c[0] = y1;
+            break;
+        }
+    }
+
+    for(int i=0; i < 6; ++i){
+        table.c[i].push_back(c[i]);
+    }
+    table.isValid.push_back(isValid);
+}
+
+
+template <class SampleType>
+void buildCoeffTable(const typename SampleType::Seq& samples, int dimIndex, CoeffTable& table)
+{
+    table.clear();
+
+    if(samples.empty()){
+        return;
+    }
+    table.yFirst = samples.front().c[dimIndex].y;
+    table.yLast = samples.back().c[dimIndex].y;
+
+    auto s0 = samples.begin();
+    table.x.push_back(s0->x);
+    for(auto s1 = std::next(s0); s1 != samples.end(); s0 = s1++){
+        setSegmentCoeffs<SampleType>(*s0, *s1, dimIndex, table);
+        table.x.push_back(s1->x);
+    }
+}
+
+
+/**
+   The results are the same as the ones of the interpolate function except for the rounding errors.
+   The sample times must be sorted in ascending order. NaN is set to the undetermined values.
+*/
+void evaluateCoeffTable(const CoeffTable& table, const double* xs, int numFrames, double* out_y)
+{
+    if(table.x.empty()){
+        std::fill(out_y, out_y + numFrames, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    
+    int i = 0;
+    while(i < numFrames && xs[i] < table.x.front()){
+        out_y[i++] = table.yFirst;
+    }
+
+    const int numSegments = table.numSegments();
+    for(int k=0; k < numSegments && i < numFrames; ++k){
+        const double xe = table.x[k + 1];
+        int iEnd = i;
+        while(iEnd < numFrames && xs[iEnd] < xe){
+            ++iEnd;
+        }
+        if(iEnd == i){
+            continue;
+        }
+        if(!table.isValid[k]){
+            std::fill(out_y + i, out_y + iEnd, std::numeric_limits<double>::quiet_NaN());
+        } else {
+            const double xb = table.x[k];
+            const double c0 = table.c[0][k];
+            const double c1 = table.c[1][k];
+            const double c2 = table.c[2][k];
+            const double c3 = table.c[3][k];
+            const double c4 = table.c[4][k];
+            const double c5 = table.c[5][k];
+            // This loop has no dependency between the iterations so that it can be vectorized
+            for(int j=i; j < iEnd; ++j){
+                const double h = xs[j] - xb;
+                out_y[j] = ((((c5 * h + c4) * h + c3) * h + c2) * h + c1) * h + c0;
+            }
+        }
+        i = iEnd;
+    }
+
+    while(i < numFrames){
+        out_y[i++] = table.yLast;
+    }
+}
+
+
+
 template <class SampleType>
 void insertSampleAtTransitionStartPoint
 (typename SampleType::Seq& samples, typename SampleType::Seq::iterator it, const PoseSeq::iterator& poseIter)
@@ -780,6 +953,7 @@ PoseSeqInterpolator::Impl::Impl(PoseSeqInterpolator* self)
     : self(self)
 {
     timeScaleRatio = 1.0;
+    areCoeffTablesValid = false;
     isAutoZmpAdjustmentMode = false;
     minZmpTransitionTime = 0.1;
     zmpCenteringTimeThresh = 0.03;
@@ -1525,6 +1699,84 @@ void PoseSeqInterpolator::getJointDisplacements(std::vector<stdx::optional<doubl
 }
 
 
+bool PoseSeqInterpolator::getFrames(int beginningFrame, int numFrames, double frameRate, FrameSeq& out_frames)
+{
+    return impl->getFrames(beginningFrame, numFrames, frameRate, out_frames);
+}
+
+
+/**
+   The joint trajectories and the ZMP trajectory are evaluated from the coefficient tables.
+   Only the link interpolation, the IK and the lip sync mix are processed frame by frame,
+   and the joint displacements determined by them overwrite the evaluated ones.
+*/
+bool PoseSeqInterpolator::Impl::getFrames(int beginningFrame, int numFrames, double frameRate, FrameSeq& out_frames)
+{
+    if(!body || numFrames < 0 || frameRate <= 0.0){
+        return false;
+    }
+    if(needUpdate){
+        if(!update()){
+            return false;
+        }
+    }
+    if(!areCoeffTablesValid){
+        updateCoeffTables();
+    }
+
+    // The same time values as the ones given to the interpolate function
+    frameTimes.resize(numFrames);
+    for(int i=0; i < numFrames; ++i){
+        frameTimes[i] = ((beginningFrame + i) / frameRate) / timeScaleRatio;
+    }
+
+    const int numJoints = jointInfos.size();
+    out_frames.jointDisplacements.resize(numFrames, numJoints);
+    for(int i=0; i < numJoints; ++i){
+        evaluateCoeffTable(
+            jointInfos[i].coeffTable, frameTimes.data(), numFrames, out_frames.jointDisplacements.col(i).data());
+    }
+    out_frames.zmps.resize(numFrames, 3);
+    for(int i=0; i < 3; ++i){
+        evaluateCoeffTable(zmpCoeffTables[i], frameTimes.data(), numFrames, out_frames.zmps.col(i).data());
+    }
+
+    out_frames.baseLinkIndices.assign(numFrames, -1);
+    out_frames.baseLinkPositions.resize(numFrames);
+
+    if(!ikLinkInfos.empty() || (isLipSyncMixEnabled && !lipSyncSeq.empty())){
+        for(int k=0; k < numFrames; ++k){
+            if(!interpolate((beginningFrame + k) / frameRate, -1, Vector3::Zero())){
+                continue;
+            }
+            if(currentBaseLinkInfoIter != ikLinkInfos.end()){
+                out_frames.baseLinkIndices[k] = currentBaseLinkInfoIter->first;
+                out_frames.baseLinkPositions[k] = currentBaseLinkInfoIter->second.T;
+            }
+            for(int i=0; i < numJoints; ++i){
+                if(auto& q = jointInfos[i].q){
+                    out_frames.jointDisplacements(k, i) = *q;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+void PoseSeqInterpolator::Impl::updateCoeffTables()
+{
+    for(auto& info : jointInfos){
+        buildCoeffTable<JointSample>(info.samples, 0, info.coeffTable);
+    }
+    for(int i=0; i < 3; ++i){
+        buildCoeffTable<ZmpSample>(zmpSamples, i, zmpCoeffTables[i]);
+    }
+    areCoeffTablesValid = true;
+}
+
+
 stdx::optional<Vector3> PoseSeqInterpolator::ZMP() const
 {
     Vector3 p;
@@ -1648,6 +1900,7 @@ bool PoseSeqInterpolator::Impl::update()
     lipSyncIter = lipSyncSeq.begin();
 
     invalidateCurrentInterpolation();
+    areCoeffTablesValid = false;
     needUpdate = false;
 
     sigUpdated();
@@ -80,6 +80,8 @@ public:
 
     virtual void getJointDisplacements(std::vector<stdx::optional<double>>& out_q) const override;
 
+    virtual bool getFrames(int beginningFrame, int numFrames, double frameRate, FrameSeq& out_frames) override;
+
 private:
     class Impl;
     Impl* impl;
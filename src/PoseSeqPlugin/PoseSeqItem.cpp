@@ -34,6 +34,8 @@ public:
     PoseSeqInterpolatorPtr interpolator;
     BodyMotionItemPtr bodyMotionItem;
     Connection sigInterpolationParametersChangedConnection;
+    Connection sigMotionFiltersChangedConnection;
+    ConnectionSet bodyMotionItemConnections;
 
     struct PoseSeqIteratorComp {
         bool operator()(const PoseSeq::iterator& it1, const PoseSeq::iterator& it2) const {
@@ -88,6 +90,16 @@ public:
     bool isSelectedPoseBeingMoved;
     bool isPoseSelectionChangedByEditing;
 
+    // The time range of the motion affected by the current editing
+    double editedTimeLower;
+    double editedTimeUpper;
+    /*
+      The frames of the motion can be partially regenerated only when the whole motion was
+      generated by the simple interpolation and it has not been modified by the others since then
+    */
+    bool isPartialTrajectoryUpdateAvailable;
+    bool isGeneratingTrajectory;
+
     double barLength;
 
     Impl(PoseSeqItem* self);
@@ -104,12 +116,15 @@ public:
     void updateInterpolationParameters();
     bool updateInterpolation();
     bool updateTrajectory(bool putMessages);
+    bool updateTrajectoryPartially(double lower, double upper);
     void beginEditing();
     bool endEditing(bool actuallyModified);
     void onPoseInserted(PoseSeq::iterator pose, bool isMoving);
     void onPoseAboutToBeRemoved(PoseSeq::iterator pose, bool isMoving);
     void onPoseAboutToBeModified(PoseSeq::iterator pose);
     void onPoseModified(PoseSeq::iterator pose);
+    void expandEditedTimeRange(PoseSeq::iterator poseIter);
+    double findAffectedRangeBoundaryTime(PoseSeq::iterator poseIter, BodyKeyPose* pose, bool isForward);
     void clearEditHistory();
     PoseSeq::iterator removeSameElement(PoseSeq::iterator current, PoseSeq::iterator p);
     bool undo();
@@ -289,12 +304,28 @@ void PoseSeqItem::Impl::init()
     bodyMotionItem->setName("motion");
     self->addSubItem(bodyMotionItem);
 
+    bodyMotionItemConnections.add(
+        bodyMotionItem->sigUpdated().connect(
+            [this](){
+                if(!isGeneratingTrajectory){
+                    isPartialTrajectoryUpdateAvailable = false;
+                }
+            }));
+    bodyMotionItemConnections.add(
+        bodyMotionItem->sigDisconnectedFromRoot().connect(
+            [this](){ isPartialTrajectoryUpdateAvailable = false; }));
+
     clearEditHistory();
 
     generationBar = BodyMotionGenerationBar::instance();
 
     isSelectedPoseBeingMoved = false;
     isPoseSelectionChangedByEditing = false;
+
+    editedTimeLower = std::numeric_limits<double>::max();
+    editedTimeUpper = std::numeric_limits<double>::lowest();
+    isPartialTrajectoryUpdateAvailable = false;
+    isGeneratingTrajectory = false;
 }
 
 
@@ -308,6 +339,8 @@ PoseSeqItem::Impl::~Impl()
 {
     editConnections.disconnect();
     sigInterpolationParametersChangedConnection.disconnect();
+    sigMotionFiltersChangedConnection.disconnect();
+    bodyMotionItemConnections.disconnect();
 }
 
 
@@ -490,6 +523,12 @@ void PoseSeqItem::Impl::onTreePathChanged()
                 [&](){ updateInterpolationParameters(); });
         updateInterpolationParameters();
     }
+    if(!sigMotionFiltersChangedConnection.connected()){
+        // The existing motion may have been processed by the filters which are turned off
+        sigMotionFiltersChangedConnection =
+            generationBar->sigMotionFiltersChanged().connect(
+                [&](){ isPartialTrajectoryUpdateAvailable = false; });
+    }
 
     BodyItemPtr prevBodyItem = targetBodyItem;
     targetBodyItem = self->findOwnerItem<BodyItem>();
@@ -631,6 +670,9 @@ void PoseSeqItem::Impl::convertSub(BodyPtr orgBody, const Mapping& convInfo)
 
 void PoseSeqItem::Impl::updateInterpolationParameters()
 {
+    // The existing motion does not match the new parameters
+    isPartialTrajectoryUpdateAvailable = false;
+    
     interpolator->setTimeScaleRatio(generationBar->timeScaleRatio());
 
     /*
@@ -683,9 +725,29 @@ bool PoseSeqItem::Impl::updateTrajectory(bool putMessages)
     bool result = false;
 
     if(targetBodyItem){
+        isGeneratingTrajectory = true;
         result = generationBar->shapeBodyMotion(
             targetBodyItem, interpolator.get(), bodyMotionItem, putMessages);
+        isGeneratingTrajectory = false;
     }
+    isPartialTrajectoryUpdateAvailable = result && !generationBar->isMotionFilterEnabled();
+
+    return result;
+}
+
+
+bool PoseSeqItem::Impl::updateTrajectoryPartially(double lower, double upper)
+{
+    bool result = false;
+
+    if(targetBodyItem){
+        double r = generationBar->timeScaleRatio();
+        isGeneratingTrajectory = true;
+        result = generationBar->shapeBodyMotionPartially(
+            targetBodyItem, interpolator.get(), bodyMotionItem, r * lower, r * upper, false);
+        isGeneratingTrajectory = false;
+    }
+    isPartialTrajectoryUpdateAvailable = result && !generationBar->isMotionFilterEnabled();
 
     return result;
 }
@@ -705,6 +767,8 @@ void PoseSeqItem::Impl::beginEditing()
     modifyingPoseIter = seq->end();
     isSelectedPoseBeingMoved = false;
     isPoseSelectionChangedByEditing = false;
+    editedTimeLower = std::numeric_limits<double>::max();
+    editedTimeUpper = std::numeric_limits<double>::lowest();
 
     if(editConnections.empty()){
         editConnections.add(
@@ -761,7 +825,11 @@ bool PoseSeqItem::Impl::endEditing(bool actuallyModified)
         updateInterpolation();
     
         if(BodyMotionGenerationBar::instance()->isAutoGenerationMode()){
-            updateTrajectory(false);
+            if(isPartialTrajectoryUpdateAvailable && editedTimeLower <= editedTimeUpper){
+                updateTrajectoryPartially(editedTimeLower, editedTimeUpper);
+            } else {
+                updateTrajectory(false);
+            }
         }
     }
     
@@ -792,11 +860,14 @@ void PoseSeqItem::Impl::onPoseInserted(PoseSeq::iterator pose, bool isMoving)
         isSelectedPoseBeingMoved = false;
     }
     inserted.insert(pose);
+    expandEditedTimeRange(pose);
 }
 
 
 void PoseSeqItem::Impl::onPoseAboutToBeRemoved(PoseSeq::iterator pose, bool isMoving)
 {
+    expandEditedTimeRange(pose);
+    
     if(deselectPose(pose, false)){
         if(isMoving){
             isSelectedPoseBeingMoved = true;
@@ -819,6 +890,7 @@ void PoseSeqItem::Impl::onPoseAboutToBeRemoved(PoseSeq::iterator pose, bool isMo
 
 void PoseSeqItem::Impl::onPoseAboutToBeModified(PoseSeq::iterator pose)
 {
+    expandEditedTimeRange(pose);
     modifyingPoseIter = pose;
     preModifiedPose = pose->pose()->clone();
     preModifiedPoseTime = pose->time();
@@ -828,6 +900,8 @@ void PoseSeqItem::Impl::onPoseAboutToBeModified(PoseSeq::iterator pose)
 
 void PoseSeqItem::Impl::onPoseModified(PoseSeq::iterator pose)
 {
+    expandEditedTimeRange(pose);
+    
     if(pose == modifyingPoseIter){
         if(modified.find(pose) == modified.end()){
             modified.insert(pose);
@@ -843,6 +917,99 @@ void PoseSeqItem::Impl::onPoseModified(PoseSeq::iterator pose)
 }
 
 
+/**
+   The interpolation of each element (joint, IK link or ZMP) of a key pose depends on the
+   element values of the two adjacent key poses on each side because the velocity at a key pose
+   is determined by the adjacent key poses. The motion between the second previous key pose and
+   the second next key pose of each element is therefore affected by the change of the pose.
+*/
+void PoseSeqItem::Impl::expandEditedTimeRange(PoseSeq::iterator poseIter)
+{
+    double lower;
+    double upper;
+    
+    auto pose = poseIter->get<BodyKeyPose>();
+    if(!pose || generationBar->isLipSyncMixMode()){
+        lower = 0.0;
+        upper = std::numeric_limits<double>::max();
+
+    } else if((pose->numIkLinks() > 0 || pose->isZmpValid()) &&
+              (generationBar->isAutoZmpAdjustmentMode() ||
+               generationBar->stepTrajectoryAdjustmentMode() != PoseSeqInterpolator::NoStepAdjustmentMode)){
+        // The automatically inserted ZMP and foot key poses may change in the whole motion
+        lower = 0.0;
+        upper = std::numeric_limits<double>::max();
+
+    } else {
+        lower = findAffectedRangeBoundaryTime(poseIter, pose, false);
+        upper = findAffectedRangeBoundaryTime(poseIter, pose, true);
+    }
+
+    editedTimeLower = std::min(editedTimeLower, lower);
+    editedTimeUpper = std::max(editedTimeUpper, upper);
+}
+
+
+double PoseSeqItem::Impl::findAffectedRangeBoundaryTime(PoseSeq::iterator poseIter, BodyKeyPose* pose, bool isForward)
+{
+    constexpr int NumAffectedKeyPoses = 2;
+
+    vector<int> jointIds;
+    for(int i=0; i < pose->numJoints(); ++i){
+        if(pose->isJointValid(i)){
+            jointIds.push_back(i);
+        }
+    }
+    vector<int> linkIndices;
+    for(auto it = pose->ikLinkBegin(); it != pose->ikLinkEnd(); ++it){
+        linkIndices.push_back(it->first);
+    }
+    vector<int> jointCounts(jointIds.size(), 0);
+    vector<int> linkCounts(linkIndices.size(), 0);
+    int zmpCount = pose->isZmpValid() ? 0 : NumAffectedKeyPoses;
+    int numRemainingElements = jointIds.size() + linkIndices.size() + (pose->isZmpValid() ? 1 : 0);
+
+    auto it = poseIter;
+    while(numRemainingElements > 0){
+        if(isForward){
+            if(++it == seq->end()){
+                return std::numeric_limits<double>::max();
+            }
+        } else {
+            if(it == seq->begin()){
+                return 0.0;
+            }
+            --it;
+        }
+        auto keyPose = it->get<BodyKeyPose>();
+        if(!keyPose){
+            continue;
+        }
+        for(size_t i=0; i < jointIds.size(); ++i){
+            if(jointCounts[i] < NumAffectedKeyPoses && keyPose->isJointValid(jointIds[i])){
+                if(++jointCounts[i] == NumAffectedKeyPoses){
+                    --numRemainingElements;
+                }
+            }
+        }
+        for(size_t i=0; i < linkIndices.size(); ++i){
+            if(linkCounts[i] < NumAffectedKeyPoses && keyPose->ikLinkInfo(linkIndices[i])){
+                if(++linkCounts[i] == NumAffectedKeyPoses){
+                    --numRemainingElements;
+                }
+            }
+        }
+        if(zmpCount < NumAffectedKeyPoses && keyPose->isZmpValid()){
+            if(++zmpCount == NumAffectedKeyPoses){
+                --numRemainingElements;
+            }
+        }
+    }
+
+    return it->time();
+}
+
+
 void PoseSeqItem::clearEditHistory()
 {
     impl->clearEditHistory();
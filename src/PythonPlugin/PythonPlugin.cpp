@@ -15,6 +15,7 @@
 #include <cnoid/UTF8>
 #include <cnoid/MessageView>
 #include <cnoid/OptionManager>
+#include <cnoid/PluginManager>
 #include <cnoid/Archive>
 #include <cnoid/Format>
 #include <pybind11/embed.h>
@@ -137,13 +138,30 @@ PythonPlugin::PythonPlugin()
 {
     impl = new Impl(this);
     pythonPlugin = this;
+
+    declareItemClass("PythonScriptItem");
+    declareViewClass("PythonConsoleView");
+    declareInputFileExtension("py");
+    declareMenuItem("/File/Load .../Python Script");
 }
 
 
+/**
+   The options are added here instead of the initialize function because the plugin is
+   activated lazily. The plugin is activated when any of the options is given.
+*/
 PythonPlugin::Impl::Impl(PythonPlugin* self)
     : self(self)
 {
-
+    auto om = OptionManager::instance();
+    om->add_option("--python,-p", scriptFilesToExecute, "execute a python script");
+    om->add_option("--python-item", scriptFilesToLoad, "load a python script as an item");
+    
+    om->sigInputFileOptionsParsed(1).connect(
+        [this](std::vector<std::string>& inputFiles){ onInputFileOptionsParsed(inputFiles); });
+    
+    om->sigOptionsParsed(1).connect(
+        [this](OptionManager*){ onSigOptionsParsed(); });
 }
 
 
@@ -197,16 +215,6 @@ bool PythonPlugin::Impl::initialize()
 
     PythonScriptItem::initializeClass(self);
     PythonConsoleView::initializeClass(self);
-    
-    auto om = OptionManager::instance();
-    om->add_option("--python,-p", scriptFilesToExecute, "execute a python script");
-    om->add_option("--python-item", scriptFilesToLoad, "load a python script as an item");
-    
-    om->sigInputFileOptionsParsed(1).connect(
-        [&](std::vector<std::string>& inputFiles){ onInputFileOptionsParsed(inputFiles); });
-    
-    om->sigOptionsParsed(1).connect(
-        [&](OptionManager*){ onSigOptionsParsed(); });
 
     self->setProjectArchiver(
         [&](Archive& archive){ return storeProperties(archive); },
@@ -218,6 +226,10 @@ bool PythonPlugin::Impl::initialize()
 
 void PythonPlugin::Impl::onInputFileOptionsParsed(std::vector<std::string>& inputFiles)
 {
+    // The plugin manager activates the plugin in advance when any script file is given
+    if(!self->isActive()){
+        return;
+    }
     auto iter = inputFiles.begin();
     while(iter != inputFiles.end()){
         if(filesystem::path(fromUTF8(*iter)).extension().string() == ".py"){
@@ -232,6 +244,15 @@ void PythonPlugin::Impl::onInputFileOptionsParsed(std::vector<std::string>& inpu
 
 void PythonPlugin::Impl::onSigOptionsParsed()
 {
+    if(scriptFilesToExecute.empty() && scriptFilesToLoad.empty()){
+        return;
+    }
+    if(!self->isActive()){
+        PluginManager::instance()->activatePluginOnDemand(self->name());
+        if(!self->isActive()){
+            return;
+        }
+    }
     for(auto& script : scriptFilesToExecute){
         executeScriptFileOnStartup(script);
     }
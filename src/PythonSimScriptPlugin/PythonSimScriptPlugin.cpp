@@ -15,6 +15,8 @@ public:
     PythonSimScriptPlugin() : Plugin("PythonSimScript") {
         require("Body");
         require("Python");
+        declareItemClass("PythonSimScriptItem");
+        declareMenuItem("/File/Load .../Python Script for Simulation");
     }
 
     virtual bool initialize() {
@@ -14,6 +14,10 @@ class RokiPlugin : public Plugin
 public:
     RokiPlugin() : Plugin("Roki") {
         require("Body");
+
+        // The plugin is activated when the simulator item is used for the first time
+        declareItemClass("RokiSimulatorItem");
+        declareMenuItem("/File/New .../RokiSimulator");
     }
 
     virtual bool initialize(){
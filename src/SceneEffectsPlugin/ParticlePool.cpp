@@ -0,0 +1,260 @@
+#include "ParticlePool.h"
+#include "ParticleSystem.h"
+#include <cnoid/EigenUtil>
+#include <random>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+using namespace cnoid;
+
+
+ParticlePool::ParticlePool()
+{
+    numParticles_ = 0;
+    lifeTime_ = 0.0f;
+    emissionRange_ = 0.0f;
+    initialSpeedAverage_ = 0.0f;
+    initialSpeedVariation_ = 0.0f;
+    alphaCurve_ = LinearAlpha;
+    isUpdateNeeded_ = true;
+    isFlow_ = false;
+    flowRadius_ = 0.0f;
+    flowTop_ = 0.0f;
+    flowBottom_ = 0.0f;
+    flowVelocity_.setZero();
+    time_ = 0.0f;
+    acceleration_.setZero();
+}
+
+
+void ParticlePool::initialize(const ParticleSystem& ps)
+{
+    initialize(ps, ps.initialSpeedAverage(), ps.initialSpeedVariation());
+}
+
+
+void ParticlePool::initialize
+(const ParticleSystem& ps, float initialSpeedAverage, float initialSpeedVariation)
+{
+    numParticles_ = std::max(0, ps.numParticles());
+    lifeTime_ = ps.lifeTime();
+    emissionRange_ = ps.emissionRange();
+    initialSpeedAverage_ = ps.initialSpeedAverage();
+    initialSpeedVariation_ = ps.initialSpeedVariation();
+
+    isFlow_ = false;
+
+    const int n = numParticles_;
+    for(auto array : { &vx_, &vy_, &vz_, &emissionTime_, &elapsedTime_, &x_, &y_, &z_, &alpha_ }){
+        array->resize(n);
+    }
+    // The particles are emitted from the origin
+    for(auto array : { &x0_, &y0_, &z0_ }){
+        array->assign(n, 0.0f);
+    }
+
+    // The random sequence must be the same as the one of ParticlesProgramBase::frandom
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_real_distribution<float> frandom(0.0f, 1.0f);
+    Vector3f v;
+    for(int i = 0; i < n; ++i){
+        float theta = emissionRange_ / 2.0f * frandom(randomNumberGenerator);
+        float phi = 2.0 * PI * frandom(randomNumberGenerator);
+
+        v.x() = sinf(theta) * cosf(phi);
+        v.y() = sinf(theta) * sinf(phi);
+        v.z() = cosf(theta);
+
+        float speed = std::max(
+            0.0f, initialSpeedAverage + initialSpeedVariation * (frandom(randomNumberGenerator) - 0.5f));
+        v = v.normalized() * speed;
+
+        vx_[i] = v.x();
+        vy_[i] = v.y();
+        vz_[i] = v.z();
+    }
+
+    float rate = lifeTime_ / n;
+    float time = 0.0f;
+    for(int i = 0; i < n; ++i){
+        emissionTime_[i] = time;
+        time += rate;
+    }
+
+    isUpdateNeeded_ = true;
+}
+
+
+void ParticlePool::initializeFlow
+(const ParticleSystem& ps, float radius, float top, float bottom, const Vector3f& velocity)
+{
+    numParticles_ = std::max(0, ps.numParticles());
+    lifeTime_ = fabsf((top - bottom) / velocity.z());
+    emissionRange_ = 0.0f;
+    initialSpeedAverage_ = 0.0f;
+    initialSpeedVariation_ = 0.0f;
+    alphaCurve_ = ConstantAlpha;
+    isFlow_ = true;
+    flowRadius_ = radius;
+    flowTop_ = top;
+    flowBottom_ = bottom;
+    flowVelocity_ = velocity;
+
+    const int n = numParticles_;
+    for(auto array : { &emissionTime_, &elapsedTime_, &x_, &y_, &z_, &alpha_, &x0_, &y0_ }){
+        array->resize(n);
+    }
+    vx_.assign(n, velocity.x());
+    vy_.assign(n, velocity.y());
+    vz_.assign(n, velocity.z());
+    z0_.assign(n, top);
+
+    // The random sequence and the area must be the same as the ones of RainSnowProgram
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_real_distribution<float> frandom(0.0f, 1.0f);
+    const float r2 = radius * 4;
+    for(int i = 0; i < n; ++i){
+        float x, y;
+        while(true){
+            x = 2.0 * radius * frandom(randomNumberGenerator) - radius;
+            y = 2.0 * radius * frandom(randomNumberGenerator) - radius;
+            if(x * x + y * y <= r2){
+                break;
+            }
+        }
+        x0_[i] = x;
+        y0_[i] = y;
+    }
+
+    /*
+      The shader wraps the negative elapsed time into the life time, so every particle is visible
+      from the beginning. The emission times are shifted by the life time to give the same states.
+    */
+    float rate = lifeTime_ / n;
+    float time = -lifeTime_;
+    for(int i = 0; i < n; ++i){
+        emissionTime_[i] = time;
+        time += rate;
+    }
+
+    isUpdateNeeded_ = true;
+}
+
+
+bool ParticlePool::isInitializationNeeded(const ParticleSystem& ps) const
+{
+    return (isFlow_ ||
+            numParticles_ != ps.numParticles() ||
+            lifeTime_ != ps.lifeTime() ||
+            emissionRange_ != ps.emissionRange() ||
+            initialSpeedAverage_ != ps.initialSpeedAverage() ||
+            initialSpeedVariation_ != ps.initialSpeedVariation());
+}
+
+
+bool ParticlePool::isFlowInitializationNeeded
+(const ParticleSystem& ps, float radius, float top, float bottom, const Vector3f& velocity) const
+{
+    return (!isFlow_ ||
+            numParticles_ != ps.numParticles() ||
+            flowRadius_ != radius ||
+            flowTop_ != top ||
+            flowBottom_ != bottom ||
+            flowVelocity_ != velocity);
+}
+
+
+void ParticlePool::update(float time, const Vector3f& acceleration)
+{
+    if(!isUpdateNeeded_ && time == time_ && acceleration == acceleration_){
+        return;
+    }
+    time_ = time;
+    acceleration_ = acceleration;
+    isUpdateNeeded_ = false;
+
+    const int n = numParticles_;
+    const float lifeTime = lifeTime_;
+    // alpha = 1 - kl * r - kq * r^2
+    const float kl = (alphaCurve_ == LinearAlpha) ? 1.0f : 0.0f;
+    const float kq = (alphaCurve_ == QuadraticAlpha) ? 1.0f : 0.0f;
+
+    float* elapsedTime = elapsedTime_.data();
+    float* alpha = alpha_.data();
+
+    /*
+       The loops do not have any branch and only access a few arrays so that they can be
+       vectorized. Note that std::floor prevents the vectorization unless the trapping math
+       is disabled, so the modulo is computed with the truncation of the non-negative time.
+    */
+    const float* emissionTime = emissionTime_.data();
+    for(int i = 0; i < n; ++i){
+        float t = std::max(time - emissionTime[i], 0.0f);
+        const float emitted = (t > 0.0f) ? 1.0f : 0.0f;
+        t -= lifeTime * static_cast<float>(static_cast<int>(t / lifeTime));
+        const float r = t / lifeTime;
+        elapsedTime[i] = t;
+        alpha[i] = emitted * (1.0f - r * (kl + kq * r));
+    }
+
+    Vector3f a = isFlow_ ? Vector3f::Zero() : acceleration;
+    const std::vector<float>* initialPositions[] = { &x0_, &y0_, &z0_ };
+    const std::vector<float>* velocities[] = { &vx_, &vy_, &vz_ };
+    std::vector<float>* positions[] = { &x_, &y_, &z_ };
+    for(int k = 0; k < 3; ++k){
+        const float ak = a[k];
+        const float* p0 = initialPositions[k]->data();
+        const float* v = velocities[k]->data();
+        float* p = positions[k]->data();
+        for(int i = 0; i < n; ++i){
+            const float t = elapsedTime[i];
+            p[i] = p0[i] + v[i] * t + ak * t * t;
+        }
+    }
+}
+
+
+int ParticlePool::castRay
+(const Vector3f& origin, const Vector3f& direction, float maxDistance, float particleSize,
+ float& out_distance) const
+{
+    const int n = numParticles_;
+    const float ox = origin.x();
+    const float oy = origin.y();
+    const float oz = origin.z();
+    const float dx = direction.x();
+    const float dy = direction.y();
+    const float dz = direction.z();
+    const float radius = particleSize / 2.0f;
+    const float r2 = radius * radius;
+    const float* x = x_.data();
+    const float* y = y_.data();
+    const float* z = z_.data();
+    const float* alpha = alpha_.data();
+
+    int nearestIndex = -1;
+    float nearestDistance = std::numeric_limits<float>::max();
+
+    for(int i = 0; i < n; ++i){
+        const float wx = x[i] - ox;
+        const float wy = y[i] - oy;
+        const float wz = z[i] - oz;
+        // The distance to the point on the ray nearest to the particle center
+        const float s = wx * dx + wy * dy + wz * dz;
+        const float d2 = wx * wx + wy * wy + wz * wz - s * s;
+        if(alpha[i] > 0.0f && d2 <= r2){
+            const float distance = s - std::sqrt(r2 - d2);
+            if(distance >= 0.0f && distance <= maxDistance && distance < nearestDistance){
+                nearestDistance = distance;
+                nearestIndex = i;
+            }
+        }
+    }
+
+    if(nearestIndex >= 0){
+        out_distance = nearestDistance;
+    }
+    return nearestIndex;
+}
@@ -0,0 +1,117 @@
+#ifndef CNOID_SCENE_EFFECTS_PLUGIN_PARTICLE_POOL_H
+#define CNOID_SCENE_EFFECTS_PLUGIN_PARTICLE_POOL_H
+
+#include <cnoid/EigenTypes>
+#include <vector>
+
+namespace cnoid {
+
+class ParticleSystem;
+
+/**
+   This class computes the states of the particles emitted by a particle system on CPU.
+   The particles are stored in the fixed size arrays of each element so that the update loop
+   can be vectorized, and the states are the same as the ones computed by the vertex shaders
+   of the fountain, fire, smoke, rain and snow effects. The states are expressed in the local
+   coordinate of the particle system. The pool can be used without any GL context, so it can be
+   updated with the simulation or in a headless process.
+*/
+class ParticlePool
+{
+public:
+    enum AlphaCurve { LinearAlpha, QuadraticAlpha, ConstantAlpha };
+
+    ParticlePool();
+
+    AlphaCurve alphaCurve() const { return alphaCurve_; }
+    void setAlphaCurve(AlphaCurve curve) { alphaCurve_ = curve; }
+
+    /**
+       The initial velocities and the emission times of the particles are generated with
+       the same random sequence as the one used for the GPU rendering.
+       The arrays are only reallocated when the number of the particles is changed.
+       The speed parameters given to the first function are used instead of the ones of the
+       particle system.
+    */
+    void initialize(const ParticleSystem& ps, float initialSpeedAverage, float initialSpeedVariation);
+    void initialize(const ParticleSystem& ps);
+
+    /**
+       Initializes the pool for the particles flowing down with a constant velocity from the
+       random positions on the top plane, such as rain and snow. The positions are generated with
+       the same random sequence as the one used for the GPU rendering, and the particles are always
+       visible. The acceleration given to the update is not applied to these particles.
+    */
+    void initializeFlow(const ParticleSystem& ps, float radius, float top, float bottom, const Vector3f& velocity);
+
+    //! Returns true when the parameters of the particle system are changed from the initialization
+    bool isInitializationNeeded(const ParticleSystem& ps) const;
+    bool isFlowInitializationNeeded(
+        const ParticleSystem& ps, float radius, float top, float bottom, const Vector3f& velocity) const;
+
+    /**
+       The update is skipped when the time and the acceleration are the same as the last update.
+       \param time The time of the particle system including the offset time
+       \param acceleration The acceleration expressed in the local coordinate
+    */
+    void update(float time, const Vector3f& acceleration);
+
+    //! The time given to the last update
+    float time() const { return time_; }
+
+    int size() const { return numParticles_; }
+    const float* x() const { return x_.data(); }
+    const float* y() const { return y_.data(); }
+    const float* z() const { return z_.data(); }
+    //! The alpha value is zero for the particles which have not been emitted yet
+    const float* alpha() const { return alpha_.data(); }
+
+    Vector3f position(int index) const { return Vector3f(x_[index], y_[index], z_[index]); }
+
+    /**
+       Finds the nearest visible particle intersecting with a ray. Each particle is regarded as
+       a sphere whose diameter is the particle size. This is the query used to make the particles
+       visible to a range sensor simulated by the ray casting on CPU. The ray must be transformed
+       into the local coordinate of the particle system by the caller, and the pool must be updated
+       for the time of the sensor. Each query visits all the particles.
+       \param origin The origin of the ray in the local coordinate
+       \param direction The unit direction vector of the ray in the local coordinate
+       \param out_distance The distance to the intersection is set when a particle is found
+       \return The index of the particle or -1 if no particle intersects with the ray
+    */
+    int castRay(const Vector3f& origin, const Vector3f& direction, float maxDistance,
+                float particleSize, float& out_distance) const;
+
+private:
+    int numParticles_;
+    float lifeTime_;
+    float emissionRange_;
+    float initialSpeedAverage_;
+    float initialSpeedVariation_;
+    AlphaCurve alphaCurve_;
+    bool isUpdateNeeded_;
+    bool isFlow_;
+    float flowRadius_;
+    float flowTop_;
+    float flowBottom_;
+    Vector3f flowVelocity_;
+    float time_;
+    Vector3f acceleration_;
+
+    std::vector<float> vx_;
+    std::vector<float> vy_;
+    std::vector<float> vz_;
+    std::vector<float> emissionTime_;
+    std::vector<float> elapsedTime_;
+    std::vector<float> x0_;
+    std::vector<float> y0_;
+    std::vector<float> z0_;
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+    std::vector<float> alpha_;
+};
+
+}
+
+#endif
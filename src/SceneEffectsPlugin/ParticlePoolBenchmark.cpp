@@ -0,0 +1,101 @@
+/**
+   This program measures the update time of the particle pool used for the CPU particles and
+   the time of the ray query used by the range sensors. The results of the query are checked
+   against the particle states, and the program returns a non-zero status if they are wrong.
+   Usage: choreonoid-particle-pool-benchmark [number of particles] [number of steps] [time step]
+*/
+
+#include "ParticlePool.h"
+#include "ParticleSystem.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace cnoid;
+
+
+int main(int argc, char* argv[])
+{
+    int numParticles = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    int numSteps = (argc > 2) ? std::atoi(argv[2]) : 1000;
+    float timeStep = (argc > 3) ? std::atof(argv[3]) : 0.001f;
+
+    if(numParticles <= 0 || numSteps <= 0 || timeStep <= 0.0f){
+        cerr << "Usage: " << argv[0] << " [number of particles] [number of steps] [time step]" << endl;
+        return 1;
+    }
+
+    ParticleSystem ps;
+    ps.setNumParticles(numParticles);
+    ps.setLifeTime(3.0f);
+    ps.setInitialSpeedAverage(1.0f);
+    ps.setInitialSpeedVariation(0.5f);
+    const Vector3f acceleration(0.0f, 0.0f, -9.8f);
+
+    ParticlePool pool;
+    pool.initialize(ps);
+
+    // The first update touches all the pages of the arrays
+    pool.update(0.0f, acceleration);
+
+    // The sum of the states prevents the updates from being optimized away
+    double sum = 0.0;
+    auto startTime = std::chrono::steady_clock::now();
+    for(int i = 1; i <= numSteps; ++i){
+        pool.update(i * timeStep, acceleration);
+        sum += pool.z()[i % numParticles] + pool.alpha()[i % numParticles];
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    double timePerStep = elapsed / numSteps;
+    cout << "particles: " << numParticles << "\n"
+         << "steps: " << numSteps << "\n"
+         << "time per step [ms]: " << timePerStep << "\n"
+         << "particles per second: " << (numParticles / timePerStep * 1000.0) << "\n"
+         << "checksum: " << sum << endl;
+
+    /*
+      Each ray is cast toward a visible particle from the point one meter away from it,
+      so the ray must hit the particle or another one nearer than it.
+    */
+    const float particleSize = 0.01f;
+    vector<int> visibleParticles;
+    for(int i = 0; i < numParticles; ++i){
+        if(pool.alpha()[i] > 0.0f){
+            visibleParticles.push_back(i);
+        }
+    }
+    const int numRays = visibleParticles.empty() ? 0 : 100;
+    int numErrors = 0;
+    const Vector3f direction = Vector3f(1.0f, 2.0f, -3.0f).normalized();
+    startTime = std::chrono::steady_clock::now();
+    for(int i = 0; i < numRays; ++i){
+        int target = visibleParticles[(static_cast<long>(i) * 7919) % visibleParticles.size()];
+        Vector3f origin = pool.position(target) - direction;
+        float distance;
+        int index = pool.castRay(origin, direction, 2.0f, particleSize, distance);
+        if(index < 0 || distance > 1.0f - particleSize / 2.0f + 1.0e-4f){
+            ++numErrors;
+        }
+    }
+    elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    cout << "time per ray [ms]: " << (numRays > 0 ? elapsed / numRays : 0.0) << "\n"
+         << "ray errors: " << numErrors << endl;
+
+    // The flow mode used for rain and snow
+    ParticlePool flowPool;
+    flowPool.initializeFlow(ps, 10.0f, 10.0f, 0.0f, Vector3f(0.0f, 0.0f, -5.0f));
+    flowPool.update(0.0f, acceleration);
+    startTime = std::chrono::steady_clock::now();
+    for(int i = 1; i <= numSteps; ++i){
+        flowPool.update(i * timeStep, acceleration);
+        sum += flowPool.z()[i % numParticles];
+    }
+    elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    cout << "time per step of the flow [ms]: " << (elapsed / numSteps) << "\n"
+         << "checksum: " << sum << endl;
+
+    return (numErrors == 0) ? 0 : 1;
+}
@@ -16,6 +16,7 @@ ParticleSystem::ParticleSystem()
     initialSpeedVariation_ = 0.1f;
     emissionRange_ = static_cast<float>(PI / 3.0);
     acceleration_.setZero();
+    isCpuParticlesEnabled_ = false;
 }
 
 
@@ -30,6 +31,7 @@ ParticleSystem::ParticleSystem(const ParticleSystem& org)
     initialSpeedVariation_ = org.initialSpeedVariation_;
     emissionRange_ = org.emissionRange_;
     acceleration_ = org.acceleration_;
+    isCpuParticlesEnabled_ = org.isCpuParticlesEnabled_;
 }
 
 
@@ -49,6 +51,7 @@ void ParticleSystem::readParameters(const Mapping* info)
     info->read({ "initial_speed_variation", "initialSpeedVariation" }, initialSpeedVariation_);
     info->readAngle({ "emission_range", "emissionRange" }, emissionRange_);
     read(info, "acceleration", acceleration_);
+    info->read("cpu_particles", isCpuParticlesEnabled_);
 }
 
 
@@ -62,5 +65,8 @@ void ParticleSystem::writeParameters(Mapping* info) const
     info->write("initial_speed_variation", initialSpeedVariation_);
     info->write("emission_range", degree(emissionRange_));
     write(info, "acceleration", acceleration_);
+    if(isCpuParticlesEnabled_){
+        info->write("cpu_particles", true);
+    }
 }
    
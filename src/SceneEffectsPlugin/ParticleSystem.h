@@ -41,6 +41,10 @@ public:
     const Vector3f& acceleration() const { return acceleration_; }
     void setAcceleration(const Vector3f& a){ acceleration_ = a; }
 
+    //! The particle states are computed on CPU and streamed to the GPU when this is enabled
+    bool isCpuParticlesEnabled() const { return isCpuParticlesEnabled_; }
+    void setCpuParticlesEnabled(bool on) { isCpuParticlesEnabled_ = on; }
+
     void readParameters(const Mapping* info);
     void writeParameters(Mapping* info) const;
 
@@ -54,6 +58,7 @@ private:
     float initialSpeedVariation_;
     float emissionRange_;
     Vector3f acceleration_;
+    bool isCpuParticlesEnabled_;
 };
 
 }
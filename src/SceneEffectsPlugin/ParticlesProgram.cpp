@@ -20,6 +20,7 @@ ParticlesProgramBase::ParticlesProgramBase(GLSLSceneRenderer* renderer)
 {
     
     initializationState = NOT_INITIALIZED;
+    particlePoolVertexArray = 0;
 }
 
 
@@ -37,6 +38,7 @@ bool ParticlesProgramBase::initializeRendering(SceneParticles* particles)
     
     timeLocation = glsl.getUniformLocation("time");
     particleTexLocation = glsl.getUniformLocation("particleTex");
+    isCpuParticlesLocation = glsl.getUniformLocation("isCpuParticles");
 
     if(!particles->texture().empty()){
         QImage image(particles->texture().c_str());
@@ -98,6 +100,45 @@ float ParticlesProgramBase::frandom(float max)
     return floatDistribution(randomNumberGenerator);
 }
 
+void ParticlesProgramBase::renderParticlePool(SceneParticles* particles)
+{
+    auto& pool = particles->particlePool();
+
+    // The pool is usually advanced with the simulation by the scene device
+    if(particles->isParticlePoolUpdateNeeded()){
+        auto ps = particles->getParticleSystem();
+        particles->updateParticlePool(globalAttitude_.transpose() * ps->acceleration());
+    }
+
+    if(!particlePoolVertexArray){
+        glGenBuffers(4, particlePoolBuffers);
+        glGenVertexArrays(1, &particlePoolVertexArray);
+        glBindVertexArray(particlePoolVertexArray);
+        for(int i = 0; i < 4; ++i){
+            glBindBuffer(GL_ARRAY_BUFFER, particlePoolBuffers[i]);
+            glVertexAttribPointer(2 + i, 1, GL_FLOAT, GL_FALSE, 0, NULL);
+            glEnableVertexAttribArray(2 + i);
+        }
+        glBindVertexArray(0);
+    }
+
+    // Each buffer is orphaned before the upload so that the driver does not wait for the previous drawing
+    const float* arrays[] = { pool.x(), pool.y(), pool.z(), pool.alpha() };
+    const GLsizeiptr size = pool.size() * sizeof(float);
+    for(int i = 0; i < 4; ++i){
+        glBindBuffer(GL_ARRAY_BUFFER, particlePoolBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, arrays[i]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUniform1i(isCpuParticlesLocation, 1);
+    glBindVertexArray(particlePoolVertexArray);
+    glDrawArrays(GL_POINTS, 0, pool.size());
+    glUniform1i(isCpuParticlesLocation, 0);
+}
+
+
 void ParticlesProgramBase::render
 (SceneParticles* particles, const Affine3& position, const std::function<void()>& renderingFunction)
 {
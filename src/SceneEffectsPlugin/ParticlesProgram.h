@@ -28,6 +28,14 @@ public:
     }
     float frandom(float max = 1.0f);
 
+    /**
+       Draws the particles by streaming the particle states computed on CPU. The particle pool
+       of the scene node is updated here if it has not been updated for the current time.
+       This function must be called in the rendering function instead of the drawing with
+       the static buffers of the initial states.
+    */
+    void renderParticlePool(SceneParticles* particles);
+
 protected:
     virtual bool initializeRendering(SceneParticles* particles) = 0;
     virtual ShaderProgram* shaderProgram() = 0;
@@ -43,7 +51,10 @@ private:
     GLint angle2pixelsLocation;
     GLint timeLocation;
     GLint particleTexLocation;
+    GLint isCpuParticlesLocation;
     GLuint textureId;
+    GLuint particlePoolBuffers[4];
+    GLuint particlePoolVertexArray;
     Matrix3f globalAttitude_;
     std::mt19937 randomNumberGenerator;
     typedef std::uniform_real_distribution<float> FloatDistribution;
@@ -4,6 +4,7 @@
 #include <cnoid/StdBodyLoader>
 #include <cnoid/StdBodyWriter>
 #include <cnoid/SceneDevice>
+#include <cnoid/Link>
 
 namespace cnoid {
 
@@ -43,8 +44,15 @@ struct SceneEffectDeviceTypeRegistration
                     });
 
                 sceneDevice->setFunctionOnTimeChanged(
-                    [sceneNode](double time){
+                    [sceneNode, customDevice](double time){
                         sceneNode->setTime(time);
+                        // The CPU particles are advanced with the time of the device, which follows
+                        // the simulation, instead of in the rendering
+                        auto& ps = sceneNode->particleSystem();
+                        if(ps.isCpuParticlesEnabled()){
+                            Matrix3f R = (customDevice->link()->R() * customDevice->R_local()).template cast<float>();
+                            sceneNode->updateParticlePool(R.transpose() * ps.acceleration());
+                        }
                         sceneNode->notifyUpdate();
                     });
                 
@@ -53,6 +53,7 @@ SceneFire::SceneFire()
     : SceneParticles(findClassId<SceneFire>())
 {
     setTexture(":/SceneEffectsPlugin/texture/fire.png");
+    particlePool().setAlphaCurve(ParticlePool::QuadraticAlpha);
 }
 
 
@@ -171,25 +172,32 @@ void FireProgram::render(SceneFire* fire)
         return;
     }
 
-    if(numParticles != ps.numParticles() ||
-       lifeTime != ps.lifeTime() ||
-       emissionRange != ps.emissionRange() ||
-       initialSpeedAverage != ps.initialSpeedAverage() ||
-       initialSpeedVariation != ps.initialSpeedVariation()){
-        updateParticleBuffers(fire);
-    }
-    
-    setTime(fire->time() + ps.offsetTime());
-    glUniform1f(lifeTimeLocation, ps.lifeTime());
-    Vector3f accel = globalAttitude().transpose() * ps.acceleration();
-    glUniform3fv(accelLocation, 1, accel.data());
+    // The additive blending is used for both the GPU and CPU particles
     GLint blendSrc, blendDst;
     glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendSrc);
     glGetIntegerv(GL_BLEND_DST_ALPHA, &blendDst);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    if(ps.isCpuParticlesEnabled()){
+        renderParticlePool(fire);
+
+    } else {
+        if(numParticles != ps.numParticles() ||
+           lifeTime != ps.lifeTime() ||
+           emissionRange != ps.emissionRange() ||
+           initialSpeedAverage != ps.initialSpeedAverage() ||
+           initialSpeedVariation != ps.initialSpeedVariation()){
+            updateParticleBuffers(fire);
+        }
     
-    glBindVertexArray(vertexArray);
-    glDrawArrays(GL_POINTS, 0, ps.numParticles());
+        setTime(fire->time() + ps.offsetTime());
+        glUniform1f(lifeTimeLocation, ps.lifeTime());
+        Vector3f accel = globalAttitude().transpose() * ps.acceleration();
+        glUniform3fv(accelLocation, 1, accel.data());
+    
+        glBindVertexArray(vertexArray);
+        glDrawArrays(GL_POINTS, 0, ps.numParticles());
+    }
 
     glBlendFunc(blendSrc, blendDst);
 }
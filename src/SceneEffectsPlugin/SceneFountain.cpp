@@ -171,6 +171,11 @@ void FountainProgram::render(SceneFountain* fountain)
     if(!ps.on()){
         return;
     }
+
+    if(ps.isCpuParticlesEnabled()){
+        renderParticlePool(fountain);
+        return;
+    }
     
     if(numParticles != ps.numParticles() ||
        lifeTime != ps.lifeTime() ||
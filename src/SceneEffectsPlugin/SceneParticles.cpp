@@ -32,7 +32,37 @@ SceneParticles::SceneParticles(int classId)
 SceneParticles::SceneParticles(const SceneParticles& org)
     : SgNode(org),
       time_(org.time_),
-      texture_(org.texture_)
+      texture_(org.texture_),
+      particlePool_(org.particlePool_)
 {
 
 }
+
+
+void SceneParticles::updateParticlePool(const Vector3f& acceleration)
+{
+    auto ps = getParticleSystem();
+    if(isParticlePoolInitializationNeeded(particlePool_)){
+        initializeParticlePool(particlePool_);
+    }
+    particlePool_.update(time_ + ps->offsetTime(), acceleration);
+}
+
+
+bool SceneParticles::isParticlePoolUpdateNeeded()
+{
+    auto ps = getParticleSystem();
+    return isParticlePoolInitializationNeeded(particlePool_) || particlePool_.time() != time_ + ps->offsetTime();
+}
+
+
+void SceneParticles::initializeParticlePool(ParticlePool& pool)
+{
+    pool.initialize(*getParticleSystem());
+}
+
+
+bool SceneParticles::isParticlePoolInitializationNeeded(const ParticlePool& pool)
+{
+    return pool.isInitializationNeeded(*getParticleSystem());
+}
@@ -6,6 +6,7 @@
 #define CNOID_SCENE_EFFECTS_PLUGIN_SCENE_PARTICLES_H
 
 #include "ParticleSystem.h"
+#include "ParticlePool.h"
 #include <cnoid/SceneGraph>
 
 namespace cnoid {
@@ -25,9 +26,24 @@ public:
     const std::string& texture() const { return texture_; }
     void setTexture(const std::string& file) { texture_ = file; }
 
+    /**
+       The pool is used when the CPU particles are enabled in the particle system.
+       The given acceleration must be expressed in the local coordinate.
+    */
+    ParticlePool& particlePool() { return particlePool_; }
+    void updateParticlePool(const Vector3f& acceleration);
+
+    //! Returns true when the pool has not been updated for the current time and parameters
+    bool isParticlePoolUpdateNeeded();
+
+protected:
+    virtual void initializeParticlePool(ParticlePool& pool);
+    virtual bool isParticlePoolInitializationNeeded(const ParticlePool& pool);
+
 private:
     float time_;
     std::string texture_;
+    ParticlePool particlePool_;
 };
 
 }
@@ -72,6 +72,18 @@ ParticleSystem* SceneRainSnowBase::getParticleSystem()
 }
 
 
+void SceneRainSnowBase::initializeParticlePool(ParticlePool& pool)
+{
+    pool.initializeFlow(particleSystem_, radius_, top_, bottom_, velocity_);
+}
+
+
+bool SceneRainSnowBase::isParticlePoolInitializationNeeded(const ParticlePool& pool)
+{
+    return pool.isFlowInitializationNeeded(particleSystem_, radius_, top_, bottom_, velocity_);
+}
+
+
 SceneRain::SceneRain()
     : SceneRainSnowBase(findClassId<SceneRain>())
 {
@@ -134,7 +146,8 @@ bool RainSnowProgram::initializeRendering(SceneParticles* particles)
     auto rs = static_cast<SceneRainSnowBase*>(particles);
     auto& ps = rs->particleSystem();
 
-    // Initial position buffer
+    // Initial position buffer. The random sequence must be the same as the one of ParticlePool.
+    setRandomSeed();
     vector<GLfloat> data(ps.numParticles() * 3);
     const float r = rs->radius();
     const float r2 = r * 4;
@@ -192,6 +205,11 @@ void RainSnowProgram::render(SceneRainSnowBase* particles)
 {
     auto& ps = particles->particleSystem();
 
+    if(ps.isCpuParticlesEnabled()){
+        renderParticlePool(particles);
+        return;
+    }
+
     setTime(particles->time() + ps.offsetTime());
 
     glUniform1f(lifeTimeLocation, lifeTime);
@@ -32,6 +32,10 @@ public:
     const ParticleSystem& particleSystem() const { return particleSystem_; }
     ParticleSystem& particleSystem() { return particleSystem_; }
 
+protected:
+    virtual void initializeParticlePool(ParticlePool& pool) override;
+    virtual bool isParticlePoolInitializationNeeded(const ParticlePool& pool) override;
+
 private:
     ParticleSystem particleSystem_;
     float radius_;
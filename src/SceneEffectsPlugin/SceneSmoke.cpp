@@ -73,6 +73,13 @@ ParticleSystem* SceneSmoke::getParticleSystem()
 }
 
 
+void SceneSmoke::initializeParticlePool(ParticlePool& pool)
+{
+    // The initial speeds are distributed in the same range as SmokeProgram
+    pool.initialize(particleSystem_, 0.15f, 0.1f);
+}
+
+
 SmokeProgram::SmokeProgram(GLSLSceneRenderer* renderer)
     : ParticlesProgram(
         renderer,
@@ -166,6 +173,11 @@ void SmokeProgram::render(SceneSmoke* smoke)
         return;
     }
 
+    if(ps.isCpuParticlesEnabled()){
+        renderParticlePool(smoke);
+        return;
+    }
+
     if(numParticles != ps.numParticles() ||
        lifeTime != ps.lifeTime() ||
        emissionRange != ps.emissionRange()){
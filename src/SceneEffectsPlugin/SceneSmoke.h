@@ -22,6 +22,7 @@ public:
 
 protected:
     virtual Referenced* doClone(CloneMap* cloneMap) const override;
+    virtual void initializeParticlePool(ParticlePool& pool) override;
     
 private:
     ParticleSystem particleSystem_;
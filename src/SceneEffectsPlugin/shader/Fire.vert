@@ -3,9 +3,16 @@
 layout (location = 0) in vec3 vertexInitVel;
 layout (location = 1) in float offsetTime;
 
+// The particle states computed on CPU
+layout (location = 2) in float particleX;
+layout (location = 3) in float particleY;
+layout (location = 4) in float particleZ;
+layout (location = 5) in float particleAlpha;
+
 out vec3 position;
 out float alpha;
 
+uniform bool isCpuParticles = false;
 uniform float time;
 uniform float lifeTime;
 uniform vec3 accel = vec3(0.0, 0.0, 0.1);
@@ -19,7 +26,10 @@ void main()
 {
     vec3 pos;
     float t = time - offsetTime;
-    if(t > 0){
+    if(isCpuParticles){
+        pos = vec3(particleX, particleY, particleZ);
+        alpha = particleAlpha;
+    } else if(t > 0){
         t = mod(t, lifeTime);
         pos = vertexInitVel * t + accel * t * t;
         //alpha = 1.0 - t / lifeTime;
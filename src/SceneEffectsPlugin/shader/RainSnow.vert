@@ -3,9 +3,16 @@
 layout (location = 0) in vec3 vertexInitPos;
 layout (location = 1) in float offsetTime;
 
+// The particle states computed on CPU
+layout (location = 2) in float particleX;
+layout (location = 3) in float particleY;
+layout (location = 4) in float particleZ;
+layout (location = 5) in float particleAlpha;
+
 out vec3 position;
 out float alpha;
 
+uniform bool isCpuParticles = false;
 uniform float time;
 uniform float lifeTime;
 uniform vec3 velocity;
@@ -20,8 +27,10 @@ void main()
     vec3 pos = vertexInitPos;
     alpha = 0.0;
     float t = time - offsetTime;
-    //if(t > 0){
-    if(true){
+    if(isCpuParticles){
+        pos = vec3(particleX, particleY, particleZ);
+        alpha = particleAlpha;
+    } else {
         t = mod(t, lifeTime);
         pos = vertexInitPos + velocity * t;
         alpha = 1.0;
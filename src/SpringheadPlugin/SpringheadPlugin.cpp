@@ -19,6 +19,10 @@ public:
     SpringheadPlugin() : Plugin(PLUGIN_NAME)
         { 
             require("Body");
+
+            // The plugin is activated when the simulator item is used for the first time
+            declareItemClass("SpringheadSimulatorItem");
+            declareMenuItem("/File/New .../SpringheadSimulator");
         }
         
     virtual ~SpringheadPlugin()
@@ -0,0 +1,263 @@
+/**
+   @author Japan Atomic Energy Agency
+*/
+
+#include "NetworkEmulator.h"
+#include <algorithm>
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+const string emptyName;
+
+}
+
+NetworkEmulator::Link::Link()
+    : lossDistribution(0.0,100.0)
+{
+    delay=0.0;
+    bandWidth=0.0;
+    loss=0.0;
+    busyTime=0.0;
+    lastArrivalTime=0.0;
+}
+
+void
+NetworkEmulator::Link::seedRandomEngine(unsigned int seed, int portIndex, Direction direction)
+{
+    std::seed_seq seq{ seed, static_cast<unsigned int>(portIndex), static_cast<unsigned int>(direction) };
+    randomEngine.seed(seq);
+    lossDistribution.reset();
+}
+
+NetworkEmulator::NetworkEmulator()
+{
+    _time=0.0;
+    _randomSeed=std::mt19937::default_seed;
+    _numSentMessages=0;
+    _numLostMessages=0;
+    _numDeliveredMessages=0;
+}
+
+NetworkEmulator::~NetworkEmulator()
+{
+
+}
+
+void
+NetworkEmulator::clear()
+{
+    lock_guard<mutex> lock(_mutex);
+
+    _ports.clear();
+    _time=0.0;
+    _numSentMessages=0;
+    _numLostMessages=0;
+    _numDeliveredMessages=0;
+}
+
+void
+NetworkEmulator::setRandomSeed(unsigned int seed)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    _randomSeed=seed;
+    for(size_t i=0;i<_ports.size();i++) {
+        _ports[i].links[Outbound].seedRandomEngine(seed,i,Outbound);
+        _ports[i].links[Inbound].seedRandomEngine(seed,i,Inbound);
+    }
+}
+
+int
+NetworkEmulator::addPort(const string& name)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    for(size_t i=0;i<_ports.size();i++) {
+        if(_ports[i].name==name) {
+            return i;
+        }
+    }
+    const int index=_ports.size();
+    _ports.emplace_back();
+    Port& port=_ports.back();
+    port.name=name;
+    port.links[Outbound].seedRandomEngine(_randomSeed,index,Outbound);
+    port.links[Inbound].seedRandomEngine(_randomSeed,index,Inbound);
+
+    return index;
+}
+
+int
+NetworkEmulator::numPorts() const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    return _ports.size();
+}
+
+int
+NetworkEmulator::portIndex(const string& name) const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    for(size_t i=0;i<_ports.size();i++) {
+        if(_ports[i].name==name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+const string&
+NetworkEmulator::portName(int portIndex) const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    if(portIndex<0||portIndex>=static_cast<int>(_ports.size())) {
+        return emptyName;
+    }
+
+    return _ports[portIndex].name;
+}
+
+NetworkEmulator::Link*
+NetworkEmulator::findLink(int portIndex, Direction direction)
+{
+    if(portIndex<0||portIndex>=static_cast<int>(_ports.size())) {
+        return nullptr;
+    }
+
+    return &_ports[portIndex].links[direction];
+}
+
+void
+NetworkEmulator::setLinkParameters(int portIndex, Direction direction, double delay, double bandWidth, double loss)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    Link* link=findLink(portIndex,direction);
+    if(link==nullptr) return;
+
+    link->delay=std::max(delay,0.0);
+    link->bandWidth=std::max(bandWidth,0.0);
+    link->loss=std::min(std::max(loss,0.0),100.0);
+}
+
+void
+NetworkEmulator::setTime(double time)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    _time=time;
+}
+
+double
+NetworkEmulator::time() const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    return _time;
+}
+
+bool
+NetworkEmulator::send(int portIndex, Direction direction, const vector<char>& message)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    Link* link=findLink(portIndex,direction);
+    if(link==nullptr) return false;
+
+    _numSentMessages++;
+
+    if(link->loss>0.0&&link->lossDistribution(link->randomEngine)<link->loss) {
+        _numLostMessages++;
+        return false;
+    }
+
+    // The messages are serialized on the link like the rate option of netem
+    double startTime=std::max(_time,link->busyTime);
+    double transmissionTime=0.0;
+    if(link->bandWidth>0.0) {
+        transmissionTime=(message.size()*8.0)/(link->bandWidth*1000.0);
+    }
+    link->busyTime=startTime+transmissionTime;
+
+    // The order of the messages is kept even if the delay is decreased
+    double arrivalTime=std::max(link->busyTime+link->delay*1.0e-3,link->lastArrivalTime);
+    link->lastArrivalTime=arrivalTime;
+
+    link->queue.push_back(Message{ arrivalTime, message });
+
+    return true;
+}
+
+bool
+NetworkEmulator::send(const string& portName, Direction direction, const vector<char>& message)
+{
+    return send(portIndex(portName),direction,message);
+}
+
+bool
+NetworkEmulator::receive(int portIndex, Direction direction, vector<char>& out_message)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    Link* link=findLink(portIndex,direction);
+    if(link==nullptr) return false;
+
+    if(link->queue.empty()||link->queue.front().arrivalTime>_time) {
+        return false;
+    }
+
+    out_message=std::move(link->queue.front().data);
+    link->queue.pop_front();
+    _numDeliveredMessages++;
+
+    return true;
+}
+
+bool
+NetworkEmulator::receive(const string& portName, Direction direction, vector<char>& out_message)
+{
+    return receive(portIndex(portName),direction,out_message);
+}
+
+int
+NetworkEmulator::numPendingMessages(int portIndex, Direction direction) const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    if(portIndex<0||portIndex>=static_cast<int>(_ports.size())) {
+        return 0;
+    }
+
+    return _ports[portIndex].links[direction].queue.size();
+}
+
+int
+NetworkEmulator::numSentMessages() const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    return _numSentMessages;
+}
+
+int
+NetworkEmulator::numLostMessages() const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    return _numLostMessages;
+}
+
+int
+NetworkEmulator::numDeliveredMessages() const
+{
+    lock_guard<mutex> lock(_mutex);
+
+    return _numDeliveredMessages;
+}
@@ -0,0 +1,117 @@
+/**
+   @author Japan Atomic Energy Agency
+*/
+
+#pragma once
+
+#include <cnoid/Referenced>
+#include <string>
+#include <vector>
+#include <deque>
+#include <random>
+#include <mutex>
+#include "exportdecl.h"
+
+/**
+   The userspace emulation of the communication links of the ports. Each port has an outbound
+   and an inbound link whose delay, band width and loss rate are the same as the parameters of
+   TCSimulatorItem. The messages sent to a link are delivered when the simulation time
+   given by setTime reaches their arrival time, so the emulation does not require the root
+   privilege and the result only depends on the simulation time and the random seed.
+   Each link has its own random engine seeded with the random seed, the port index and the
+   direction so that the losses of a link do not depend on the order of the sending threads.
+   The functions can be called from the controller threads.
+*/
+class CNOID_EXPORT NetworkEmulator : public cnoid::Referenced
+{
+public:
+
+    enum Direction { Outbound = 0, Inbound = 1 };
+
+    NetworkEmulator();
+
+    ~NetworkEmulator();
+
+    void clear();
+
+    void setRandomSeed(unsigned int seed);
+
+    int addPort(const std::string& name);
+
+    int numPorts() const;
+
+    //! \return -1 if the port does not exist
+    int portIndex(const std::string& name) const;
+
+    const std::string& portName(int portIndex) const;
+
+    /**
+       \param delay The delay in milliseconds
+       \param bandWidth The band width in kbit/s. Zero means no limit.
+       \param loss The loss rate in percent
+    */
+    void setLinkParameters(int portIndex, Direction direction, double delay, double bandWidth, double loss);
+
+    void setTime(double time);
+
+    double time() const;
+
+    /**
+       \return false if the message is lost or the port does not exist
+    */
+    bool send(int portIndex, Direction direction, const std::vector<char>& message);
+
+    bool send(const std::string& portName, Direction direction, const std::vector<char>& message);
+
+    /**
+       \return false if there is no message which has arrived until the current time
+    */
+    bool receive(int portIndex, Direction direction, std::vector<char>& out_message);
+
+    bool receive(const std::string& portName, Direction direction, std::vector<char>& out_message);
+
+    int numPendingMessages(int portIndex, Direction direction) const;
+
+    //! The total numbers of the sent, lost and delivered messages
+    int numSentMessages() const;
+    int numLostMessages() const;
+    int numDeliveredMessages() const;
+
+private:
+
+    struct Message {
+        double arrivalTime;
+        std::vector<char> data;
+    };
+
+    struct Link {
+        double delay;
+        double bandWidth;
+        double loss;
+        // The time when the transmission of the last message finishes
+        double busyTime;
+        double lastArrivalTime;
+        std::deque<Message> queue;
+        std::mt19937 randomEngine;
+        std::uniform_real_distribution<double> lossDistribution;
+        Link();
+        void seedRandomEngine(unsigned int seed, int portIndex, Direction direction);
+    };
+
+    struct Port {
+        std::string name;
+        Link links[2];
+    };
+
+    Link* findLink(int portIndex, Direction direction);
+
+    std::vector<Port> _ports;
+    double _time;
+    unsigned int _randomSeed;
+    int _numSentMessages;
+    int _numLostMessages;
+    int _numDeliveredMessages;
+    mutable std::mutex _mutex;
+};
+
+typedef cnoid::ref_ptr<NetworkEmulator> NetworkEmulatorPtr;
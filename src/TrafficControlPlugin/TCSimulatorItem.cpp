@@ -9,6 +9,7 @@
 #include <cnoid/SimulatorItem>
 #include <cnoid/PutPropertyFunction>
 #include <cnoid/Archive>
+#include <cnoid/SimulationBatchRunner>
 #include <dirent.h>
 #include "gettext.h"
 
@@ -29,6 +30,8 @@ TCSimulatorItem::TCSimulatorItem()
     _curSimItem = nullptr;
     _preFuncId = _midFuncId = _postFuncId = -1;
     _enableTrafficControl=true;
+    _userspaceEmulation=false;
+    _emulator=new NetworkEmulator;
 
     TrafficControlShare* _share = TrafficControlShare::instance();
     _share->setTcsRunning(false);
@@ -146,9 +149,10 @@ TCSimulatorItem::TCSimulatorItem()
     }
     else {
         MessageView::mainInstance()->putln(
-            "TCSimulatorItem::TCSimulatorItem Configure file="+_config+" is invalid. Effective Port is nothing.",
+            "TCSimulatorItem::TCSimulatorItem Configure file="+_config+" is invalid. Effective Port is nothing."
+            " Only the userspace emulation is available with port "+EMULATION_PORT_NAME+".",
             MessageView::Error);
-        string eth="No valid port exists.";
+        string eth=EMULATION_PORT_NAME;
         _ethName[cnt]=eth;
         _communicationPort.setSymbol(0,eth);
         _communicationPort.resize(1);
@@ -173,16 +177,16 @@ TCSimulatorItem::TCSimulatorItem()
         _ipAddressP[i]="";
         _ipAddressT[i]="";
     }
-
-    if(_initTC==false) {
-        initTC();
-        _initTC=true;
-    }
 }
 
 TCSimulatorItem::TCSimulatorItem(const TCSimulatorItem& org) : SubSimulatorItem(org)
 {
+    _curSimItem = nullptr;
+    _preFuncId = _midFuncId = _postFuncId = -1;
+
     _enableTrafficControl=org._enableTrafficControl;
+    _userspaceEmulation=org._userspaceEmulation;
+    _emulator=new NetworkEmulator;
     _communicationPort=org._communicationPort;
 
     for(int i=0;i<NIC_MAX;i++) {
@@ -231,6 +235,21 @@ TCSimulatorItem::initializeSimulation(SimulatorItem* simulatorItem)
 
     _curSimItem = simulatorItem;
 
+    if(_userspaceEmulation) {
+        _emulator->clear();
+        _emulator->setRandomSeed(SimulationBatchRunner::randomSeed());
+        _emulator->setTime(simulatorItem->currentTime());
+        int portCount=_communicationPort.size();
+        for(int i=0;i<portCount;i++) {
+            _emulator->addPort(_ethName[i]);
+        }
+        _preFuncId = simulatorItem->addPreDynamicsFunction(std::bind(&TCSimulatorItem::onPreDynamicFunction, this));
+    }
+    else if(_initTC==false) {
+        initTC();
+        _initTC=true;
+    }
+
     if(_setSignal==false) {
         simulatorItem->sigSimulationPaused().connect(std::bind(&TCSimulatorItem::onPaused, this));
         simulatorItem->sigSimulationResumed().connect(std::bind(&TCSimulatorItem::onResumed, this));
@@ -319,6 +338,11 @@ TCSimulatorItem::finalizeSimulation()
     TrafficControlShare* _share = TrafficControlShare::instance();
     _share->setTcsRunning(false);
 
+    if(_preFuncId>=0) {
+        _curSimItem->removePreDynamicsFunction(_preFuncId);
+        _preFuncId=-1;
+    }
+
     _curSimItem = nullptr;
 
     _share->setTcsInstance(nullptr);
@@ -348,7 +372,7 @@ TCSimulatorItem::onResumed() {
 void
 TCSimulatorItem::onPreDynamicFunction()
 {
-
+    _emulator->setTime(_curSimItem->currentTime());
 }
 
 void
@@ -370,6 +394,8 @@ TCSimulatorItem::doPutProperties(PutPropertyFunction& putProperty)
 
     putProperty(_("EnableTrafficControl"),_enableTrafficControl, changeProperty(_enableTrafficControl));
 
+    putProperty(_("UserspaceEmulation"),_userspaceEmulation, changeProperty(_userspaceEmulation));
+
     putProperty(_("Port"), _communicationPort,
                 [&](int index){ _portChanged = true; _idxNew = index; return _communicationPort.selectIndex(index);});
 
@@ -451,6 +477,7 @@ TCSimulatorItem::store(Archive& archive)
     SubSimulatorItem::store(archive);
 
     archive.write("EnableTrafficControl",_enableTrafficControl);
+    archive.write("UserspaceEmulation",_userspaceEmulation);
 
     int portCount=_communicationPort.size();
     archive.write("PortCount",portCount);
@@ -498,6 +525,7 @@ TCSimulatorItem::restore(const Archive& archive)
     SubSimulatorItem::restore(archive);
 
     archive.read("EnableTrafficControl",_enableTrafficControl);
+    archive.read("UserspaceEmulation",_userspaceEmulation);
 
     int portCount = -1;
     archive.read("PortCount",portCount);
@@ -512,8 +540,9 @@ TCSimulatorItem::restore(const Archive& archive)
             portName="Port"+std::to_string(i);
             archive.read(portName, tmp);
             if(cnt<NIC_MAX) {
-                bool rc1=findNIC(tmp);
-                bool rc2=_pair.count(tmp)==1;
+                // The ports of the userspace emulation do not have to exist in this computer
+                bool rc1=_userspaceEmulation||findNIC(tmp);
+                bool rc2=_userspaceEmulation||_pair.count(tmp)==1;
                 if(rc1==false) {
                     MessageView::mainInstance()->putln(
                         "TCSimulatorItem::restore "+tmp+" does not exist in this computer.",
@@ -616,9 +645,10 @@ TCSimulatorItem::restore(const Archive& archive)
             }
             else {
                 MessageView::mainInstance()->putln(
-                    "TCSimulatorItem::restore This Project file is invalid and Configure file="+_config+" is invalid too.",
+                    "TCSimulatorItem::restore This Project file is invalid and Configure file="+_config+" is invalid too."
+                    " Only the userspace emulation is available with port "+EMULATION_PORT_NAME+".",
                     MessageView::Error);
-                string eth="No valid port exists.";
+                string eth=EMULATION_PORT_NAME;
                 _ethName[cnt]=eth;
                 _communicationPort.setSymbol(0,eth);
                 _communicationPort.resize(1);
@@ -827,7 +857,8 @@ TCSimulatorItem::setVirNIC() {
     int portCount=_communicationPort.size();
     for(int i=0;i<portCount;i++) {
         _ethName[i] = _communicationPort.symbol(i);
-        _virName[i] = _pair[_ethName[i]];
+        auto p = _pair.find(_ethName[i]);
+        _virName[i] = (p != _pair.end()) ? p->second : string();
     }
 }
 
@@ -844,6 +875,12 @@ TCSimulatorItem::doTC() {
     }
 }
 
+bool
+TCSimulatorItem::hasNIC(const int& ethIdxNo) {
+    // The port which is not defined in the configure file can only be used by the userspace emulation
+    return _userspaceEmulation||_virName[ethIdxNo].empty()==false;
+}
+
 void
 TCSimulatorItem::initTC() {
     for(auto itr = _pair.begin(); itr!=_pair.end();++itr) {
@@ -889,7 +926,15 @@ TCSimulatorItem::initTC() {
 
 void
 TCSimulatorItem::doTC(const int& ethIdxNo) {
-    if(_ipAddressC[ethIdxNo].compare(_ipAddressT[ethIdxNo])==0) {
+    if(hasNIC(ethIdxNo)==false) {
+        return;
+    }
+
+    if(_userspaceEmulation) {
+        // The IP address filters are not emulated and the parameters are applied to all the messages of the port
+        doTC2S(ethIdxNo);
+    }
+    else if(_ipAddressC[ethIdxNo].compare(_ipAddressT[ethIdxNo])==0) {
         doTC2S(ethIdxNo);
     }
     else {
@@ -929,6 +974,9 @@ TCSimulatorItem::doTC(const int& ethIdxNo) {
 
 void
 TCSimulatorItem::doTC2com(const int& ethIdxNo,const int *p1,const int *p2,const double *p3,const int *p4,const int *p5,const double *p6) {
+    if(hasNIC(ethIdxNo)==false) {
+        return;
+    }
 
     bool rc1=true;
 
@@ -950,7 +998,10 @@ TCSimulatorItem::doTC2com(const int& ethIdxNo,const int *p1,const int *p2,const
             MessageView::Error);
         rc1=false;
     }
-    if(rc1) {
+    if(rc1&&_userspaceEmulation) {
+        _emulator->setLinkParameters(ethIdxNo,NetworkEmulator::Outbound,p1[ethIdxNo],p2[ethIdxNo],p3[ethIdxNo]);
+    }
+    else if(rc1) {
         string cmd="tc qdisc replace dev "+_ethName[ethIdxNo]+" parent 1:1 handle 11: netem"+" delay "+std::to_string(p1[ethIdxNo])+"ms"+" rate "+std::to_string(p2[ethIdxNo])+"kbit"+" loss "+std::to_string(p3[ethIdxNo])+"%";
         sysCall(cmd);
     }
@@ -975,7 +1026,10 @@ TCSimulatorItem::doTC2com(const int& ethIdxNo,const int *p1,const int *p2,const
             MessageView::Error);
         rc2=false;
     }
-    if(rc2) {
+    if(rc2&&_userspaceEmulation) {
+        _emulator->setLinkParameters(ethIdxNo,NetworkEmulator::Inbound,p4[ethIdxNo],p5[ethIdxNo],p6[ethIdxNo]);
+    }
+    else if(rc2) {
         string cmd="tc qdisc replace dev "+_virName[ethIdxNo]+" parent 1:1 handle 11: netem"+" delay "+std::to_string(p4[ethIdxNo])+"ms"+" rate "+std::to_string(p5[ethIdxNo])+"kbit"+" loss "+std::to_string(p6[ethIdxNo])+"%";
         sysCall(cmd);
     }
@@ -8,6 +8,7 @@
 #include <cnoid/Selection>
 #include <map>
 #include <vector>
+#include "NetworkEmulator.h"
 #include "exportdecl.h"
 
 #ifndef NIC_MAX
@@ -42,6 +43,10 @@
 #define IP_SEPARATOR ','
 #endif
 
+#ifndef EMULATION_PORT_NAME
+#define EMULATION_PORT_NAME "emu0"
+#endif
+
 class CNOID_EXPORT TCSimulatorItem : public cnoid::SubSimulatorItem
 {
 public:
@@ -60,6 +65,16 @@ public:
 
 
     bool isEnableTrafficControl() { return _enableTrafficControl; }
+
+    /**
+       When the userspace emulation is enabled, the tc command is not used and the traffic
+       control parameters are applied to the links of the network emulator instead.
+       The controllers send and receive their messages through the emulator.
+    */
+    bool isUserspaceEmulationEnabled() const { return _userspaceEmulation; }
+    void setUserspaceEmulationEnabled(bool on) { _userspaceEmulation = on; }
+    NetworkEmulator* networkEmulator() { return _emulator; }
+
     int getEthIndexNo(const std::string &ethName);
     void bridgeTC(const int& ethIdxNo,const double& distance,const double& upDelay,const double& upRate,const double& upLoss,const double& dnDelay,const double& dnRate,const double& dnLoss);
     void bridgeInit();
@@ -94,10 +109,13 @@ private:
     void initTC();
     void resetTC();
     bool findNIC(const std::string &nic);
+    bool hasNIC(const int& ethIdxNo);
 
     int _preFuncId, _midFuncId, _postFuncId;
 
     bool _enableTrafficControl;
+    bool _userspaceEmulation;
+    NetworkEmulatorPtr _emulator;
     cnoid::Selection _communicationPort;
 
     int    _OutboundDelay[NIC_MAX];
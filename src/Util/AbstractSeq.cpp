@@ -62,6 +62,12 @@ void AbstractSeq::setSeqContentName(const std::string& name)
 }
 
 
+size_t AbstractSeq::estimateMemoryUsage() const
+{
+    return 0;
+}
+
+
 double AbstractSeq::defaultFrameRate()
 {
     return 100.0;
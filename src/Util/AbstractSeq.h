@@ -68,6 +68,11 @@ public:
 
     virtual void setSeqContentName(const std::string& name);
 
+    /**
+       An estimate of the bytes used by the frame data. The overhead of the container is not included.
+    */
+    virtual size_t estimateMemoryUsage() const;
+
     bool readSeq(const Mapping* archive, std::ostream& os = nullout());
     bool writeSeq(YAMLWriter& writer);
 
@@ -6,6 +6,9 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <array>
+#include <queue>
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 using namespace cnoid;
@@ -640,3 +643,408 @@ void MeshFilter::Impl::setVertexNormals(SgMesh* mesh, float givenCreaseAngle)
         }
     }
 }
+
+
+namespace {
+
+/**
+   Edge collapse decimation based on the quadric error metric.
+   See M. Garland and P. S. Heckbert, "Surface Simplification Using Quadric Error Metrics", SIGGRAPH 97.
+*/
+class MeshDecimator
+{
+public:
+    typedef Eigen::Matrix<double, 4, 4, Eigen::DontAlign> Quadric;
+
+    struct Collapse
+    {
+        double cost;
+        int vertex1;
+        int vertex2;
+        int version1;
+        int version2;
+        Vector3 position;
+        bool operator<(const Collapse& rhs) const { return cost > rhs.cost; }
+    };
+
+    vector<Vector3> positions;
+    vector<Quadric> quadrics;
+    vector<int> vertexVersions;
+    vector<char> isVertexRemoved;
+    vector<array<int, 3>> triangles;
+    vector<char> isTriangleRemoved;
+    vector<vector<int>> trianglesOfVertex;
+    std::priority_queue<Collapse> collapseQueue;
+    int numTriangles;
+
+    // Buffers used in a collapse
+    vector<int> neighbors1;
+    vector<int> neighbors2;
+
+    void initialize(SgMesh* mesh);
+    void addBoundaryConstraints();
+    void addCollapse(int v1, int v2);
+    double calcError(const Quadric& Q, const Vector3& p) const;
+    void getNeighbors(int vertex, vector<int>& out_neighbors);
+    bool checkIfCollapsible(const Collapse& collapse);
+    void collapse(const Collapse& collapse);
+    bool decimate(SgMesh* mesh, int targetNumTriangles);
+    void output(SgMesh* mesh);
+};
+
+//! Weight of the planes perpendicular to the boundary edges
+constexpr double BoundaryConstraintWeight = 1000.0;
+
+}
+
+
+bool MeshFilter::decimate(SgMesh* mesh, int targetNumTriangles)
+{
+    if(!mesh->hasVertices() || mesh->numTriangles() <= std::max(targetNumTriangles, 1)){
+        return false;
+    }
+    MeshDecimator decimator;
+    return decimator.decimate(mesh, targetNumTriangles);
+}
+
+
+bool MeshDecimator::decimate(SgMesh* mesh, int targetNumTriangles)
+{
+    initialize(mesh);
+
+    const int numOrgTriangles = mesh->numTriangles();
+
+    unordered_set<IdPair<int>> edges;
+    for(auto& triangle : triangles){
+        for(int j=0; j < 3; ++j){
+            IdPair<int> edge(triangle[j], triangle[(j + 1) % 3]);
+            if(edges.insert(edge).second){
+                addCollapse(edge(0), edge(1));
+            }
+        }
+    }
+
+    while(numTriangles > targetNumTriangles && !collapseQueue.empty()){
+        Collapse c = collapseQueue.top();
+        collapseQueue.pop();
+        if(isVertexRemoved[c.vertex1] || isVertexRemoved[c.vertex2] ||
+           c.version1 != vertexVersions[c.vertex1] || c.version2 != vertexVersions[c.vertex2]){
+            continue;
+        }
+        if(checkIfCollapsible(c)){
+            collapse(c);
+        }
+    }
+
+    if(numTriangles >= numOrgTriangles){
+        return false;
+    }
+    output(mesh);
+    return true;
+}
+
+
+void MeshDecimator::initialize(SgMesh* mesh)
+{
+    const auto& orgVertices = *mesh->vertices();
+    const int numOrgVertices = orgVertices.size();
+
+    // Merge the vertices at the same position
+    struct VertexHash {
+        std::size_t operator()(const Vector3f& v) const {
+            std::size_t seed = 0;
+            for(int i=0; i < 3; ++i){
+                seed ^= std::hash<float>()(v[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+    unordered_map<Vector3f, int, VertexHash, std::equal_to<Vector3f>,
+                  Eigen::aligned_allocator<std::pair<const Vector3f, int>>> vertexIndexMap;
+    vector<int> indexMap(numOrgVertices);
+    positions.clear();
+    positions.reserve(numOrgVertices);
+    for(int i=0; i < numOrgVertices; ++i){
+        auto inserted = vertexIndexMap.insert(make_pair(orgVertices[i], static_cast<int>(positions.size())));
+        if(inserted.second){
+            positions.push_back(orgVertices[i].cast<double>());
+        }
+        indexMap[i] = inserted.first->second;
+    }
+    const int numVertices = positions.size();
+
+    quadrics.assign(numVertices, Quadric::Zero());
+    vertexVersions.assign(numVertices, 0);
+    isVertexRemoved.assign(numVertices, false);
+    trianglesOfVertex.assign(numVertices, vector<int>());
+
+    const int numOrgTriangles = mesh->numTriangles();
+    triangles.clear();
+    triangles.reserve(numOrgTriangles);
+    for(int i=0; i < numOrgTriangles; ++i){
+        auto orgTriangle = mesh->triangle(i);
+        array<int, 3> triangle = { indexMap[orgTriangle[0]], indexMap[orgTriangle[1]], indexMap[orgTriangle[2]] };
+        if(triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]){
+            continue;
+        }
+        const int index = triangles.size();
+        triangles.push_back(triangle);
+        for(int j=0; j < 3; ++j){
+            trianglesOfVertex[triangle[j]].push_back(index);
+        }
+
+        const Vector3& p0 = positions[triangle[0]];
+        Vector3 n = (positions[triangle[1]] - p0).cross(positions[triangle[2]] - p0);
+        const double area2 = n.norm();
+        if(area2 > 0.0){
+            n /= area2;
+            Vector4 plane(n.x(), n.y(), n.z(), -n.dot(p0));
+            // The quadric is weighted by the triangle area
+            Quadric K = (0.5 * area2) * plane * plane.transpose();
+            for(int j=0; j < 3; ++j){
+                quadrics[triangle[j]] += K;
+            }
+        }
+    }
+    numTriangles = triangles.size();
+    isTriangleRemoved.assign(numTriangles, false);
+
+    addBoundaryConstraints();
+}
+
+
+void MeshDecimator::addBoundaryConstraints()
+{
+    for(auto& triangle : triangles){
+        for(int j=0; j < 3; ++j){
+            int v1 = triangle[j];
+            int v2 = triangle[(j + 1) % 3];
+            int numSharingTriangles = 0;
+            for(auto& k : trianglesOfVertex[v1]){
+                auto& triangle2 = triangles[k];
+                if(triangle2[0] == v2 || triangle2[1] == v2 || triangle2[2] == v2){
+                    ++numSharingTriangles;
+                }
+            }
+            if(numSharingTriangles == 1){
+                const Vector3& p0 = positions[triangle[0]];
+                const Vector3 faceNormal =
+                    (positions[triangle[1]] - p0).cross(positions[triangle[2]] - p0);
+                const Vector3 edge = positions[v2] - positions[v1];
+                Vector3 n = edge.cross(faceNormal);
+                const double norm = n.norm();
+                if(norm > 0.0){
+                    n /= norm;
+                    Vector4 plane(n.x(), n.y(), n.z(), -n.dot(positions[v1]));
+                    Quadric K = (BoundaryConstraintWeight * edge.squaredNorm()) * plane * plane.transpose();
+                    quadrics[v1] += K;
+                    quadrics[v2] += K;
+                }
+            }
+        }
+    }
+}
+
+
+double MeshDecimator::calcError(const Quadric& Q, const Vector3& p) const
+{
+    Vector4 v(p.x(), p.y(), p.z(), 1.0);
+    return v.dot(Q * v);
+}
+
+
+void MeshDecimator::addCollapse(int v1, int v2)
+{
+    Quadric Q = quadrics[v1] + quadrics[v2];
+
+    Collapse c;
+    c.vertex1 = v1;
+    c.vertex2 = v2;
+    c.version1 = vertexVersions[v1];
+    c.version2 = vertexVersions[v2];
+
+    bool solved = false;
+    const Matrix3 A = Q.topLeftCorner<3, 3>();
+    const Vector3 b = Q.topRightCorner<3, 1>();
+    Eigen::FullPivLU<Matrix3> lu(A);
+    if(lu.isInvertible()){
+        Vector3 p = lu.solve(-b);
+        // Reject the optimal position far from the edge caused by an ill-conditioned quadric
+        const Vector3& p1 = positions[v1];
+        const Vector3& p2 = positions[v2];
+        const double edgeLength = (p2 - p1).norm();
+        if((p - 0.5 * (p1 + p2)).norm() <= 2.0 * edgeLength){
+            c.position = p;
+            c.cost = calcError(Q, p);
+            solved = true;
+        }
+    }
+    if(!solved){
+        const Vector3 candidates[] = { positions[v1], positions[v2], 0.5 * (positions[v1] + positions[v2]) };
+        c.cost = std::numeric_limits<double>::max();
+        for(auto& p : candidates){
+            double error = calcError(Q, p);
+            if(error < c.cost){
+                c.cost = error;
+                c.position = p;
+            }
+        }
+    }
+    collapseQueue.push(c);
+}
+
+
+void MeshDecimator::getNeighbors(int vertex, vector<int>& out_neighbors)
+{
+    out_neighbors.clear();
+    for(auto& k : trianglesOfVertex[vertex]){
+        if(!isTriangleRemoved[k]){
+            for(auto& v : triangles[k]){
+                if(v != vertex){
+                    out_neighbors.push_back(v);
+                }
+            }
+        }
+    }
+    std::sort(out_neighbors.begin(), out_neighbors.end());
+    out_neighbors.erase(std::unique(out_neighbors.begin(), out_neighbors.end()), out_neighbors.end());
+}
+
+
+bool MeshDecimator::checkIfCollapsible(const Collapse& c)
+{
+    // The number of the common neighbors must be same as the number of the triangles sharing the edge
+    // to keep the mesh manifold
+    getNeighbors(c.vertex1, neighbors1);
+    getNeighbors(c.vertex2, neighbors2);
+    int numCommonNeighbors = 0;
+    auto p = neighbors1.begin();
+    auto q = neighbors2.begin();
+    while(p != neighbors1.end() && q != neighbors2.end()){
+        if(*p < *q){
+            ++p;
+        } else if(*q < *p){
+            ++q;
+        } else {
+            ++numCommonNeighbors;
+            ++p;
+            ++q;
+        }
+    }
+    int numSharingTriangles = 0;
+    for(auto& k : trianglesOfVertex[c.vertex1]){
+        if(!isTriangleRemoved[k]){
+            auto& triangle = triangles[k];
+            if(triangle[0] == c.vertex2 || triangle[1] == c.vertex2 || triangle[2] == c.vertex2){
+                ++numSharingTriangles;
+            }
+        }
+    }
+    if(numSharingTriangles == 0 || numCommonNeighbors != numSharingTriangles){
+        return false;
+    }
+
+    // The remaining triangles must not be flipped
+    for(int i=0; i < 2; ++i){
+        const int vertex = (i == 0) ? c.vertex1 : c.vertex2;
+        const int other = (i == 0) ? c.vertex2 : c.vertex1;
+        for(auto& k : trianglesOfVertex[vertex]){
+            if(isTriangleRemoved[k]){
+                continue;
+            }
+            auto& triangle = triangles[k];
+            if(triangle[0] == other || triangle[1] == other || triangle[2] == other){
+                continue;
+            }
+            Vector3 p[3];
+            for(int j=0; j < 3; ++j){
+                p[j] = (triangle[j] == vertex) ? c.position : positions[triangle[j]];
+            }
+            const Vector3& p0 = positions[triangle[0]];
+            const Vector3 n0 = (positions[triangle[1]] - p0).cross(positions[triangle[2]] - p0);
+            const Vector3 n1 = (p[1] - p[0]).cross(p[2] - p[0]);
+            if(n0.dot(n1) <= 0.0){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+void MeshDecimator::collapse(const Collapse& c)
+{
+    const int v1 = c.vertex1;
+    const int v2 = c.vertex2;
+
+    positions[v1] = c.position;
+    quadrics[v1] += quadrics[v2];
+
+    for(auto& k : trianglesOfVertex[v2]){
+        if(isTriangleRemoved[k]){
+            continue;
+        }
+        auto& triangle = triangles[k];
+        if(triangle[0] == v1 || triangle[1] == v1 || triangle[2] == v1){
+            isTriangleRemoved[k] = true;
+            --numTriangles;
+        } else {
+            for(auto& v : triangle){
+                if(v == v2){
+                    v = v1;
+                }
+            }
+            trianglesOfVertex[v1].push_back(k);
+        }
+    }
+    isVertexRemoved[v2] = true;
+    trianglesOfVertex[v2].clear();
+
+    auto& triangles1 = trianglesOfVertex[v1];
+    triangles1.erase(
+        std::remove_if(triangles1.begin(), triangles1.end(), [&](int k){ return isTriangleRemoved[k]; }),
+        triangles1.end());
+
+    ++vertexVersions[v1];
+    ++vertexVersions[v2];
+
+    getNeighbors(v1, neighbors1);
+    for(auto& v : neighbors1){
+        addCollapse(v1, v);
+    }
+}
+
+
+void MeshDecimator::output(SgMesh* mesh)
+{
+    vector<int> indexMap(positions.size(), -1);
+    auto& vertices = *mesh->vertices();
+    vertices.clear();
+    auto& triangleVertices = mesh->triangleVertices();
+    triangleVertices.clear();
+    triangleVertices.reserve(numTriangles * 3);
+
+    for(size_t i=0; i < triangles.size(); ++i){
+        if(isTriangleRemoved[i]){
+            continue;
+        }
+        for(auto& v : triangles[i]){
+            int& index = indexMap[v];
+            if(index < 0){
+                index = vertices.size();
+                vertices.push_back(positions[v].cast<float>());
+            }
+            triangleVertices.push_back(index);
+        }
+    }
+    vertices.shrink_to_fit();
+
+    mesh->setNormals(nullptr);
+    mesh->normalIndices().clear();
+    mesh->setColors(nullptr);
+    mesh->colorIndices().clear();
+    mesh->setTexCoords(nullptr);
+    mesh->texCoordIndices().clear();
+    mesh->setPrimitive(SgMesh::Mesh());
+    mesh->updateBoundingBox();
+}
@@ -43,6 +43,15 @@ public:
     [[deprecated("Use setNormalOverwritingEnabled")]]
     void setOverwritingEnabled(bool on);
 
+    /**
+       This function reduces the triangles of the mesh to the target number by collapsing the edges
+       in the order of the quadric error metric. The vertices at the same position are merged and
+       the boundary edges are preserved as much as possible. The normals, colors and texture
+       coordinates are removed from the mesh, so the normals must be generated again if necessary.
+       \return true if the number of the triangles is reduced
+    */
+    bool decimate(SgMesh* mesh, int targetNumTriangles);
+
 private:
     class Impl;
     Impl* impl;
@@ -133,6 +133,10 @@ public:
         return Container::colSize();
     }
 
+    virtual size_t estimateMemoryUsage() const override {
+        return static_cast<size_t>(numFrames()) * numParts() * sizeof(ElementType);
+    }
+
     double timeLength() const {
         return (frameRate_ > 0.0) ? (numFrames() / frameRate_) : 0.0;
     }
@@ -0,0 +1,235 @@
+#include "PhaseProfiler.h"
+#include "Tracer.h"
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <unordered_map>
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+constexpr int RingBufferSize = 1 << 16;
+
+/**
+   The ring buffer is written only by the owner thread and read only by the thread collecting
+   the samples, so the positions of both sides are enough to synchronize them.
+*/
+struct ThreadBuffer
+{
+    int index;
+    std::string name;
+    std::atomic<bool> isInUse;
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::unique_ptr<PhaseProfiler::Sample[]> samples;
+
+    ThreadBuffer(int index)
+        : index(index),
+          isInUse(false),
+          head(0),
+          tail(0),
+          samples(new PhaseProfiler::Sample[RingBufferSize]) { }
+};
+
+struct ThreadBufferHolder
+{
+    ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferHolder(){
+        if(buffer){
+            // The buffer is reused by another thread after the remaining samples are collected
+            buffer->isInUse.store(false, std::memory_order_release);
+        }
+    }
+};
+
+std::mutex registryMutex;
+vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+vector<string> phaseNames;
+unordered_map<string, int> phaseNameToIdMap;
+std::atomic<int64_t> numDroppedSamples_(0);
+std::atomic<bool> isProfilingEnabled(false);
+std::atomic<bool> isTracingEnabled(false);
+
+thread_local ThreadBufferHolder threadBufferHolder;
+// The name is kept here until the buffer of the thread is obtained by the first record
+thread_local std::string currentThreadName;
+
+std::once_flag calibrationFlag;
+double ticksPerSecond_ = 1.0e9;
+
+
+ThreadBuffer* getOrCreateThreadBuffer()
+{
+    auto& holder = threadBufferHolder;
+    if(!holder.buffer){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for(auto& buffer : threadBuffers){
+            if(!buffer->isInUse.load(std::memory_order_acquire)){
+                holder.buffer = buffer.get();
+                break;
+            }
+        }
+        if(!holder.buffer){
+            threadBuffers.emplace_back(new ThreadBuffer(threadBuffers.size()));
+            holder.buffer = threadBuffers.back().get();
+        }
+        holder.buffer->name = currentThreadName;
+        holder.buffer->isInUse.store(true, std::memory_order_relaxed);
+    }
+    return holder.buffer;
+}
+
+
+void calibrate()
+{
+#ifdef CNOID_PHASE_PROFILER_USE_TSC
+    auto time0 = std::chrono::steady_clock::now();
+    uint64_t ticks0 = PhaseProfiler::ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto time1 = std::chrono::steady_clock::now();
+    uint64_t ticks1 = PhaseProfiler::ticks();
+    double duration = std::chrono::duration<double>(time1 - time0).count();
+    if(duration > 0.0 && ticks1 > ticks0){
+        ticksPerSecond_ = (ticks1 - ticks0) / duration;
+    }
+#endif
+}
+
+}
+
+std::atomic<bool> PhaseProfiler::isEnabled_(false);
+
+
+int PhaseProfiler::registerPhase(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto inserted = phaseNameToIdMap.insert(make_pair(name, static_cast<int>(phaseNames.size())));
+    if(inserted.second){
+        phaseNames.push_back(name);
+    }
+    return inserted.first->second;
+}
+
+
+int PhaseProfiler::numPhases()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return phaseNames.size();
+}
+
+
+std::string PhaseProfiler::phaseName(int phaseId)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if(phaseId >= 0 && phaseId < static_cast<int>(phaseNames.size())){
+        return phaseNames[phaseId];
+    }
+    return string();
+}
+
+
+void PhaseProfiler::setEnabled(bool on)
+{
+    if(on){
+        // The calibration is done before any sample is recorded
+        std::call_once(calibrationFlag, calibrate);
+    }
+    isProfilingEnabled.store(on, std::memory_order_relaxed);
+    isEnabled_.store(on || isTracingEnabled.load(), std::memory_order_relaxed);
+}
+
+
+void PhaseProfiler::setTracingEnabled(bool on)
+{
+    isTracingEnabled.store(on, std::memory_order_relaxed);
+    isEnabled_.store(on || isProfilingEnabled.load(), std::memory_order_relaxed);
+}
+
+
+double PhaseProfiler::ticksPerSecond()
+{
+    std::call_once(calibrationFlag, calibrate);
+    return ticksPerSecond_;
+}
+
+
+/**
+   The buffer of the thread is not allocated by this function, so the function can be called
+   for every thread whether the profiler is enabled or not.
+*/
+void PhaseProfiler::setCurrentThreadName(const std::string& name)
+{
+    currentThreadName = name;
+    if(auto buffer = threadBufferHolder.buffer){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->name = name;
+    }
+    Tracer::setCurrentThreadName(name);
+}
+
+
+std::string PhaseProfiler::threadName(int threadIndex)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if(threadIndex >= 0 && threadIndex < static_cast<int>(threadBuffers.size())){
+        return threadBuffers[threadIndex]->name;
+    }
+    return string();
+}
+
+
+void PhaseProfiler::record(int phaseId, uint64_t beginTicks, uint64_t endTicks)
+{
+    if(isTracingEnabled.load(std::memory_order_relaxed)){
+        Tracer::complete(phaseId, beginTicks, endTicks);
+    }
+    if(!isProfilingEnabled.load(std::memory_order_relaxed)){
+        return;
+    }
+    auto buffer = getOrCreateThreadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if(head - buffer->tail.load(std::memory_order_acquire) >= RingBufferSize){
+        numDroppedSamples_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto& sample = buffer->samples[head & (RingBufferSize - 1)];
+    sample.beginTicks = beginTicks;
+    sample.endTicks = endTicks;
+    sample.phaseId = phaseId;
+    sample.threadIndex = buffer->index;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+
+void PhaseProfiler::collectSamples(std::vector<Sample>& out_samples)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(auto& buffer : threadBuffers){
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for(uint64_t i = tail; i < head; ++i){
+            out_samples.push_back(buffer->samples[i & (RingBufferSize - 1)]);
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+}
+
+
+int64_t PhaseProfiler::numDroppedSamples()
+{
+    return numDroppedSamples_.load(std::memory_order_relaxed);
+}
+
+
+void PhaseProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for(auto& buffer : threadBuffers){
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    numDroppedSamples_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,116 @@
+#ifndef CNOID_UTIL_PHASE_PROFILER_H
+#define CNOID_UTIL_PHASE_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CNOID_PHASE_PROFILER_USE_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+#include "exportdecl.h"
+
+namespace cnoid {
+
+/**
+   This class records the elapsed times of the named phases of the processes such as the
+   simulation steps. The time is measured by the time stamp counter on x86 processors and by
+   the steady clock on the other processors. Each thread records the samples into its own ring
+   buffer without any lock, and the samples of all the threads are collected by another thread
+   with the collectSamples function. When the ring buffer of a thread is full, the new samples
+   of the thread are dropped until the samples are collected. The phases are also recorded as
+   the events of Tracer while the tracer is enabled. Nothing is recorded when both of them are
+   disabled, and the cost of a timer is then only the check of the flag.
+*/
+class CNOID_EXPORT PhaseProfiler
+{
+public:
+    struct Sample
+    {
+        uint64_t beginTicks;
+        uint64_t endTicks;
+        int phaseId;
+        int threadIndex;
+    };
+
+    /**
+       \return The id of the phase. The same id is returned for the same name.
+       \note The id should be cached in a static variable to avoid the cost of the registration.
+    */
+    static int registerPhase(const std::string& name);
+    static int numPhases();
+    static std::string phaseName(int phaseId);
+
+    static void setEnabled(bool on);
+
+    //! \return true when the timers are active for the profiler or the tracer
+    static bool isEnabled() { return isEnabled_.load(std::memory_order_relaxed); }
+
+    static uint64_t ticks(){
+#ifdef CNOID_PHASE_PROFILER_USE_TSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    static double ticksPerSecond();
+    static double toSeconds(uint64_t ticks) { return ticks / ticksPerSecond(); }
+
+    //! The name is used to identify the thread in the outputs of the profiler and the tracer
+    static void setCurrentThreadName(const std::string& name);
+    static std::string threadName(int threadIndex);
+
+    static void record(int phaseId, uint64_t beginTicks, uint64_t endTicks);
+
+    //! The samples collected from the ring buffers are appended to the vector
+    static void collectSamples(std::vector<Sample>& out_samples);
+    static int64_t numDroppedSamples();
+
+    //! The samples which have not been collected yet are discarded
+    static void clear();
+
+private:
+    static std::atomic<bool> isEnabled_;
+    static void setTracingEnabled(bool on);
+    friend class Tracer;
+};
+
+
+class ScopedPhaseTimer
+{
+public:
+    ScopedPhaseTimer(int phaseId)
+        : phaseId(phaseId),
+          isEnabled(PhaseProfiler::isEnabled())
+    {
+        if(isEnabled){
+            beginTicks = PhaseProfiler::ticks();
+        }
+    }
+
+    ~ScopedPhaseTimer(){
+        if(isEnabled){
+            PhaseProfiler::record(phaseId, beginTicks, PhaseProfiler::ticks());
+        }
+    }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+private:
+    int phaseId;
+    bool isEnabled;
+    uint64_t beginTicks;
+};
+
+}
+
+#endif
@@ -365,6 +365,26 @@ void SgMeshBase::updateBoundingBox()
 }
 
 
+size_t SgMeshBase::estimateMemoryUsage() const
+{
+    size_t size = 0;
+    if(vertices_){
+        size += vertices_->capacity() * sizeof(SgVertexArray::value_type);
+    }
+    if(normals_){
+        size += normals_->capacity() * sizeof(SgNormalArray::value_type);
+    }
+    if(colors_){
+        size += colors_->capacity() * sizeof(SgColorArray::value_type);
+    }
+    if(texCoords_){
+        size += texCoords_->capacity() * sizeof(SgTexCoordArray::value_type);
+    }
+    size += (faceVertexIndices_.capacity() + normalIndices_.capacity() +
+             colorIndices_.capacity() + texCoordIndices_.capacity()) * sizeof(int);
+    return size;
+}
+
 SgVertexArray* SgMeshBase::setVertices(SgVertexArray* vertices)
 {
     if(vertices_){
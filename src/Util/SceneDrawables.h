@@ -258,6 +258,9 @@ public:
     void setBoundingBox(const BoundingBox& bb){ bbox = bb; };
     void setBoundingBox(const BoundingBoxf& bb){ bbox = bb; };
 
+    //! An estimate of the bytes used by the vertex attribute arrays and the index arrays
+    size_t estimateMemoryUsage() const;
+
     bool hasVertices() const { return (vertices_ && !vertices_->empty()); }
     SgVertexArray* vertices() { return vertices_; }
     const SgVertexArray* vertices() const { return vertices_; }
@@ -22,6 +22,9 @@ CloneMap::FlagId DisableMetaSceneCloning("SgObjectDisableMetaSceneCloning");
 
 const BoundingBox emptyBoundingBox;
 
+// The update object of the outermost SgUpdateBatchScope instance in the current thread
+thread_local SgUpdate* scopedBatchUpdate = nullptr;
+
 }
 
 
@@ -29,12 +32,14 @@ SgObject::SgObject()
 {
     attributes_ = 0;
     hasValidBoundingBoxCache_ = false;
+    isMarkedInUpdateBatch_ = false;
 }
 
 
 SgObject::SgObject(const SgObject& org)
     : attributes_(org.attributes_),
       hasValidBoundingBoxCache_(false),
+      isMarkedInUpdateBatch_(false),
       name_(org.name_)
 {
     if(org.uriInfo){
@@ -127,6 +132,17 @@ void SgObject::notifyUpperNodesOfUpdate(SgUpdate& update)
 
 void SgObject::notifyUpperNodesOfUpdate(SgUpdate& update, bool doInvalidateBoundingBox)
 {
+    if(!update.hasAction(SgUpdate::Added | SgUpdate::Removed)){
+        SgUpdate* batchUpdate = scopedBatchUpdate;
+        if(!batchUpdate && update.isBatchMode_){
+            batchUpdate = &update;
+        }
+        if(batchUpdate){
+            batchUpdate->batchAction_ |= update.action_;
+            markUpperNodesInUpdateBatch(*batchUpdate, doInvalidateBoundingBox);
+            return;
+        }
+    }
     update.pushNode(this);
     if(doInvalidateBoundingBox){
         invalidateBoundingBox();
@@ -139,6 +155,74 @@ void SgObject::notifyUpperNodesOfUpdate(SgUpdate& update, bool doInvalidateBound
 }
 
 
+/**
+   The traversal is stopped at the object which has already been marked because its upper
+   nodes have also been marked, unless its bounding box cache must be invalidated.
+*/
+void SgObject::markUpperNodesInUpdateBatch(SgUpdate& update, bool doInvalidateBoundingBox)
+{
+    if(isMarkedInUpdateBatch_){
+        if(!doInvalidateBoundingBox || !hasValidBoundingBoxCache_){
+            return;
+        }
+    } else {
+        isMarkedInUpdateBatch_ = true;
+        update.batchObjects_.push_back(this);
+    }
+    if(doInvalidateBoundingBox){
+        invalidateBoundingBox();
+    }
+    for(auto& parent : parents){
+        parent->markUpperNodesInUpdateBatch(update, doInvalidateBoundingBox);
+    }
+}
+
+
+void SgUpdate::endBatch()
+{
+    isBatchMode_ = false;
+    if(batchObjects_.empty()){
+        return;
+    }
+
+    std::vector<ReferencedPtr> objects;
+    objects.swap(batchObjects_);
+    for(auto& object : objects){
+        static_cast<SgObject*>(object.get())->isMarkedInUpdateBatch_ = false;
+    }
+
+    const char orgAction = action_;
+    action_ = batchAction_;
+    for(auto& object : objects){
+        auto sgObject = static_cast<SgObject*>(object.get());
+        path_.clear();
+        path_.push_back(sgObject);
+        sgObject->sigUpdated_(*this);
+    }
+    path_.clear();
+    action_ = orgAction;
+}
+
+
+SgUpdateBatchScope::SgUpdateBatchScope()
+{
+    if(!scopedBatchUpdate){
+        update.beginBatch();
+        scopedBatchUpdate = &update;
+    }
+}
+
+
+SgUpdateBatchScope::~SgUpdateBatchScope()
+{
+    if(scopedBatchUpdate == &update){
+        // The notifications issued by the listeners in the following are not deferred
+        scopedBatchUpdate = nullptr;
+        update.endBatch();
+    }
+}
+
+
 void SgObject::addParent(SgObject* parent, SgUpdateRef update)
 {
     parents.insert(parent);
@@ -147,7 +231,7 @@ void SgObject::addParent(SgObject* parent, SgUpdateRef update)
         update->clearPath();
         update->pushNode(this);
         parent->notifyUpperNodesOfUpdate(
-            update->withAction(SgUpdate::Added), hasAttribute(Geometry));
+            update->withAction(SgUpdate::Added), hasAttribute(Geometry | GroupNode));
     }
 
     if(parents.size() == 1){
@@ -649,7 +733,7 @@ SgGroup::iterator SgGroup::removeChild(iterator childIter, SgUpdateRef update)
         update->clearPath();
         update->pushNode(child);
         notifyUpperNodesOfUpdate(
-            update->withAction(SgUpdate::Removed), child->hasAttribute(Geometry));
+            update->withAction(SgUpdate::Removed), child->hasAttribute(Geometry | GroupNode));
     }
     return next;
 }
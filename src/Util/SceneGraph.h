@@ -169,6 +169,7 @@ protected:
 private:
     unsigned short attributes_;
     mutable bool hasValidBoundingBoxCache_;
+    bool isMarkedInUpdateBatch_;
     ParentContainer parents;
     Signal<void(const SgUpdate& update)> sigUpdated_;
     Signal<void(bool on)> sigGraphConnection_;
@@ -184,8 +185,11 @@ private:
     
     mutable std::unique_ptr<UriInfo> uriInfo;
 
+    void markUpperNodesInUpdateBatch(SgUpdate& update, bool doInvalidateBoundingBox);
     SgObject* findObject_(std::function<bool(SgObject* object)>& pred);
     bool traverseObjects_(std::function<TraverseStatus(SgObject* object)>& pred);
+
+    friend class SgUpdate;
 };
 
 typedef ref_ptr<SgObject> SgObjectPtr;
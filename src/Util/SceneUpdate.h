@@ -1,7 +1,9 @@
 #ifndef CNOID_UTIL_SCENE_UPDATE_H
 #define CNOID_UTIL_SCENE_UPDATE_H
 
+#include "Referenced.h"
 #include <vector>
+#include "exportdecl.h"
 
 namespace cnoid {
 
@@ -28,11 +30,15 @@ public:
 
     typedef std::vector<SgObject*> Path;
 
-    SgUpdate() : action_(MODIFIED), initialPathCapacity_(0) {  }
-    SgUpdate(int action) : action_(action), initialPathCapacity_(0) { }
+    SgUpdate() : action_(MODIFIED), initialPathCapacity_(0), isBatchMode_(false) {  }
+    SgUpdate(int action) : action_(action), initialPathCapacity_(0), isBatchMode_(false) { }
     SgUpdate(const SgUpdate& org)
-        : path_(org.path_), action_(org.action_), initialPathCapacity_(0) { }
-    ~SgUpdate() { }
+        : path_(org.path_), action_(org.action_), initialPathCapacity_(0), isBatchMode_(false) { }
+    ~SgUpdate() {
+        if(isBatchMode_){
+            endBatch();
+        }
+    }
     void setInitialPathCapacity(unsigned char n) { initialPathCapacity_ = n; }
     void reservePathCapacity(int n) { path_.reserve(n); }
     int action() const { return action_; }
@@ -51,6 +57,17 @@ public:
         }
     }
 
+    /**
+       In the batch mode, the modification notified with this update object is not propagated
+       immediately. The objects that would be notified are marked instead, and each of them is
+       notified only once with the accumulated action when the endBatch function is called.
+       The path of the deferred notification only contains the notified object itself.
+       The notifications including the Added or Removed action are not deferred.
+    */
+    void beginBatch() { isBatchMode_ = true; batchAction_ = None; }
+    CNOID_EXPORT void endBatch();
+    bool isBatchMode() const { return isBatchMode_; }
+
     [[deprecated("Use setAction.")]]
     void resetAction(int act = None) { setAction(act); }
     [[deprecated("Use clearPath()")]]
@@ -60,6 +77,30 @@ private:
     Path path_;
     char action_;
     unsigned char initialPathCapacity_;
+    bool isBatchMode_;
+    char batchAction_;
+    std::vector<ReferencedPtr> batchObjects_;
+
+    friend class SgObject;
+};
+
+
+/**
+   While an instance of this class exists, the modifications notified with any update object in
+   the current thread are deferred as in the batch mode of SgUpdate, and each modified object is
+   notified only once when the outermost instance is destroyed. This is used to coalesce the
+   updates of all the objects in a frame into a single notification of the root node.
+*/
+class CNOID_EXPORT SgUpdateBatchScope
+{
+public:
+    SgUpdateBatchScope();
+    ~SgUpdateBatchScope();
+    SgUpdateBatchScope(const SgUpdateBatchScope& org) = delete;
+    SgUpdateBatchScope& operator=(const SgUpdateBatchScope& rhs) = delete;
+
+private:
+    SgUpdate update;
 };
 
 
@@ -160,3 +160,48 @@ int cnoid::makeTransparent(SgNode* topNode, float transparency, CloneMap& cloneM
     }
     return 0;
 }
+
+
+size_t cnoid::estimateSceneMemoryUsage(SgObject* topObject, std::unordered_set<SgObject*>* visitedObjects)
+{
+    if(!topObject){
+        return 0;
+    }
+    std::unordered_set<SgObject*> localVisitedObjects;
+    if(!visitedObjects){
+        visitedObjects = &localVisitedObjects;
+    }
+    size_t size = 0;
+    topObject->traverseObjects(
+        [&](SgObject* object){
+            if(!visitedObjects->insert(object).second){
+                return SgObject::Next;
+            }
+            if(auto mesh = dynamic_cast<SgMeshBase*>(object)){
+                size += mesh->estimateMemoryUsage();
+                return SgObject::Next;
+            }
+            if(auto plot = dynamic_cast<SgPlot*>(object)){
+                if(auto vertices = plot->vertices()){
+                    size += vertices->capacity() * sizeof(SgVertexArray::value_type);
+                }
+                if(auto normals = plot->normals()){
+                    size += normals->capacity() * sizeof(SgNormalArray::value_type);
+                }
+                if(auto colors = plot->colors()){
+                    size += colors->capacity() * sizeof(SgColorArray::value_type);
+                }
+                size += (plot->normalIndices().capacity() + plot->colorIndices().capacity()) * sizeof(int);
+                if(auto lineSet = dynamic_cast<SgLineSet*>(plot)){
+                    size += lineSet->lineVertexIndices().capacity() * sizeof(int);
+                }
+                return SgObject::Next;
+            }
+            if(auto image = dynamic_cast<SgImage*>(object)){
+                size += static_cast<size_t>(image->width()) * image->height() * image->numComponents();
+                return SgObject::Next;
+            }
+            return SgObject::Continue;
+        });
+    return size;
+}
@@ -6,6 +6,7 @@
 #define CNOID_UTIL_SCENE_UTIL_H
 
 #include "SceneGraph.h"
+#include <unordered_set>
 #include "exportdecl.h"
 
 namespace cnoid {
@@ -19,6 +20,15 @@ CNOID_EXPORT Isometry3 calcRelativePosition(SgNodePath::const_iterator begin, Sg
 
 CNOID_EXPORT int makeTransparent(SgNode* topNode, float transparency, CloneMap& cloneMap, bool doKeepOrgTransparency = true);
 
+/**
+   This function returns an estimate of the bytes used by the meshes, the plots and the images
+   in the sub tree of the object. The objects contained in visitedObjects are skipped, and the
+   counted objects are inserted into it so that the objects shared by multiple scenes can be
+   counted only once.
+*/
+CNOID_EXPORT size_t estimateSceneMemoryUsage(
+    SgObject* topObject, std::unordered_set<SgObject*>* visitedObjects = nullptr);
+
 }
 
 #endif
@@ -97,6 +97,10 @@ public:
         }
     }
 
+    virtual size_t estimateMemoryUsage() const override {
+        return container.size() * sizeof(ElementType);
+    }
+
     void resize(int n){
         container.resize(n);
     }
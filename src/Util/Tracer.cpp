@@ -0,0 +1,276 @@
+#include "Tracer.h"
+#include "UTF8.h"
+#include "Format.h"
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+using namespace cnoid;
+
+namespace {
+
+constexpr int ChunkSize = 1 << 14;
+constexpr int MaxNumChunks = 1 << 10;
+
+enum EventType { BeginEvent, EndEvent, CompleteEvent, CounterEvent };
+
+struct Event
+{
+    uint64_t ticks;
+    uint64_t endTicks;
+    double value;
+    int nameId;
+    int type;
+};
+
+/**
+   The events of a thread are only appended by the thread, and the number of the events is
+   published after each event is written, so the buffer can be read by another thread without
+   any lock. The chunks are not released until the process exits.
+*/
+struct ThreadTrace
+{
+    int index;
+    std::string name;
+    std::atomic<int64_t> numEvents;
+    std::atomic<Event*> chunks[MaxNumChunks];
+
+    ThreadTrace(int index)
+        : index(index),
+          numEvents(0)
+    {
+        for(auto& chunk : chunks){
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~ThreadTrace(){
+        for(auto& chunk : chunks){
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+std::mutex registryMutex;
+vector<std::unique_ptr<ThreadTrace>> threadTraces;
+std::atomic<int64_t> numDroppedEvents_(0);
+thread_local ThreadTrace* currentThreadTrace = nullptr;
+// The name is kept here until the trace of the thread is created by the first event
+thread_local std::string currentThreadName;
+
+
+ThreadTrace* getOrCreateThreadTrace()
+{
+    if(!currentThreadTrace){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadTraces.emplace_back(new ThreadTrace(threadTraces.size()));
+        currentThreadTrace = threadTraces.back().get();
+        currentThreadTrace->name = currentThreadName;
+    }
+    return currentThreadTrace;
+}
+
+
+void addEvent(int type, int nameId, uint64_t ticks, uint64_t endTicks, double value)
+{
+    auto trace = getOrCreateThreadTrace();
+    int64_t n = trace->numEvents.load(std::memory_order_relaxed);
+    int chunkIndex = n / ChunkSize;
+    if(chunkIndex >= MaxNumChunks){
+        numDroppedEvents_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event* chunk = trace->chunks[chunkIndex].load(std::memory_order_relaxed);
+    if(!chunk){
+        chunk = new Event[ChunkSize];
+        trace->chunks[chunkIndex].store(chunk, std::memory_order_relaxed);
+    }
+    auto& event = chunk[n % ChunkSize];
+    event.ticks = ticks;
+    event.endTicks = endTicks;
+    event.value = value;
+    event.nameId = nameId;
+    event.type = type;
+    trace->numEvents.store(n + 1, std::memory_order_release);
+}
+
+
+string escapeJsonString(const string& s)
+{
+    string escaped;
+    for(auto c : s){
+        if(c == '"' || c == '\\'){
+            escaped += '\\';
+            escaped += c;
+        } else if(static_cast<unsigned char>(c) < 0x20){
+            escaped += formatC("\\u{:04x}", static_cast<int>(c));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+}
+
+std::atomic<bool> Tracer::isEnabled_(false);
+
+
+void Tracer::setEnabled(bool on)
+{
+    if(on){
+        // Calibrate the clock before any event is recorded
+        PhaseProfiler::ticksPerSecond();
+    }
+    isEnabled_.store(on, std::memory_order_relaxed);
+    PhaseProfiler::setTracingEnabled(on);
+}
+
+
+/**
+   The trace of the thread is not created by this function, so the function can be called
+   for every thread whether the tracer is enabled or not.
+*/
+void Tracer::setCurrentThreadName(const std::string& name)
+{
+    currentThreadName = name;
+    if(currentThreadTrace){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        currentThreadTrace->name = name;
+    }
+}
+
+
+void Tracer::begin(int nameId)
+{
+    if(isEnabled()){
+        addEvent(BeginEvent, nameId, PhaseProfiler::ticks(), 0, 0.0);
+    }
+}
+
+
+void Tracer::end(int nameId)
+{
+    if(isEnabled()){
+        addEvent(EndEvent, nameId, PhaseProfiler::ticks(), 0, 0.0);
+    }
+}
+
+
+void Tracer::complete(int nameId, uint64_t beginTicks, uint64_t endTicks)
+{
+    if(isEnabled()){
+        addEvent(CompleteEvent, nameId, beginTicks, endTicks, 0.0);
+    }
+}
+
+
+void Tracer::counter(int nameId, double value)
+{
+    if(isEnabled()){
+        addEvent(CounterEvent, nameId, PhaseProfiler::ticks(), 0, value);
+    }
+}
+
+
+int64_t Tracer::numDroppedEvents()
+{
+    return numDroppedEvents_.load(std::memory_order_relaxed);
+}
+
+
+bool Tracer::writeJsonFile(const std::string& filename, std::string& out_error)
+{
+    ofstream ofs(fromUTF8(filename));
+    if(!ofs){
+        out_error = formatC("\"{}\" cannot be opened.", filename);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    const int numNames = PhaseProfiler::numPhases();
+    vector<string> names(numNames);
+    for(int i=0; i < numNames; ++i){
+        names[i] = escapeJsonString(PhaseProfiler::phaseName(i));
+    }
+
+    auto getEvent = [](ThreadTrace* trace, int64_t index) -> const Event& {
+        return trace->chunks[index / ChunkSize].load(std::memory_order_relaxed)[index % ChunkSize];
+    };
+
+    // The time stamps are relative to the earliest event
+    uint64_t originTicks = std::numeric_limits<uint64_t>::max();
+    for(auto& trace : threadTraces){
+        const int64_t numEvents = trace->numEvents.load(std::memory_order_acquire);
+        for(int64_t i=0; i < numEvents; ++i){
+            originTicks = std::min(originTicks, getEvent(trace.get(), i).ticks);
+        }
+    }
+    const double ticksPerMicrosecond = PhaseProfiler::ticksPerSecond() * 1.0e-6;
+    auto toMicroseconds = [&](uint64_t ticks){
+        return static_cast<int64_t>(ticks - originTicks) / ticksPerMicrosecond;
+    };
+
+    ofs << "{\"traceEvents\":[\n";
+    bool isFirst = true;
+    auto separator = [&isFirst](){
+        if(isFirst){
+            isFirst = false;
+            return "";
+        }
+        return ",\n";
+    };
+
+    for(auto& trace : threadTraces){
+        const int64_t numEvents = trace->numEvents.load(std::memory_order_acquire);
+        if(numEvents == 0){
+            continue;
+        }
+        const int tid = trace->index;
+        string threadName = trace->name.empty() ? formatC("Thread {}", tid) : trace->name;
+        ofs << separator()
+            << formatC("{{\"ph\":\"M\",\"pid\":1,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":\"{}\"}}}}",
+                       tid, escapeJsonString(threadName));
+
+        for(int64_t i=0; i < numEvents; ++i){
+            auto& event = getEvent(trace.get(), i);
+            const string& name = names[event.nameId];
+            const double ts = toMicroseconds(event.ticks);
+            switch(event.type){
+            case BeginEvent:
+                ofs << separator() << formatC(
+                    "{{\"ph\":\"B\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"name\":\"{}\"}}", tid, ts, name);
+                break;
+            case EndEvent:
+                ofs << separator() << formatC(
+                    "{{\"ph\":\"E\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"name\":\"{}\"}}", tid, ts, name);
+                break;
+            case CompleteEvent:
+                ofs << separator() << formatC(
+                    "{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"name\":\"{}\"}}",
+                    tid, ts, (event.endTicks - event.ticks) / ticksPerMicrosecond, name);
+                break;
+            case CounterEvent:
+                ofs << separator() << formatC(
+                    "{{\"ph\":\"C\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"name\":\"{}\",\"args\":{{\"value\":{}}}}}",
+                    tid, ts, name, event.value);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    if(!ofs){
+        out_error = formatC("Writing \"{}\" failed.", filename);
+        return false;
+    }
+    return true;
+}
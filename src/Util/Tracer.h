@@ -0,0 +1,80 @@
+#ifndef CNOID_UTIL_TRACER_H
+#define CNOID_UTIL_TRACER_H
+
+#include "PhaseProfiler.h"
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include "exportdecl.h"
+
+namespace cnoid {
+
+/**
+   This class records the timeline events of the threads and writes them as a JSON file of the
+   Chrome trace event format, which can be viewed with Perfetto or the chrome://tracing page.
+   Each thread appends the events to its own buffer without any lock, and the buffers are kept
+   until the trace is written. The names of the events are shared with the phases of
+   PhaseProfiler, and the phases timed by ScopedPhaseTimer are also recorded as the events
+   while the tracer is enabled. Nothing is recorded when the tracer is disabled, and the cost of
+   an event is then only the check of the flag.
+*/
+class CNOID_EXPORT Tracer
+{
+public:
+    static int registerName(const std::string& name) { return PhaseProfiler::registerPhase(name); }
+
+    static void setEnabled(bool on);
+    static bool isEnabled() { return isEnabled_.load(std::memory_order_relaxed); }
+
+    //! The name is shown as the name of the track of the current thread
+    static void setCurrentThreadName(const std::string& name);
+
+    static void begin(int nameId);
+    static void end(int nameId);
+    static void complete(int nameId, uint64_t beginTicks, uint64_t endTicks);
+    static void counter(int nameId, double value);
+
+    //! The number of the events which were not recorded because the buffer of a thread was full
+    static int64_t numDroppedEvents();
+
+    /**
+       The events recorded until the call are written to the file. The tracer should be disabled
+       before the call to write the complete events of all the threads.
+    */
+    static bool writeJsonFile(const std::string& filename, std::string& out_error);
+
+private:
+    static std::atomic<bool> isEnabled_;
+};
+
+
+class ScopedTrace
+{
+public:
+    ScopedTrace(int nameId)
+        : nameId(nameId),
+          isEnabled(Tracer::isEnabled())
+    {
+        if(isEnabled){
+            beginTicks = PhaseProfiler::ticks();
+        }
+    }
+
+    ~ScopedTrace(){
+        if(isEnabled){
+            Tracer::complete(nameId, beginTicks, PhaseProfiler::ticks());
+        }
+    }
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    int nameId;
+    bool isEnabled;
+    uint64_t beginTicks;
+};
+
+}
+
+#endif